@@ -98,6 +98,12 @@ smileres_t smile_abort(smileobj_t *smileobj);
 // You must re-register any cExternalSink/cExternalMessageInterface callbacks, though.
 smileres_t smile_reset(smileobj_t *smileobj);
 
+// Resets openSMILE like 'smile_reset' and sets new values for the command-line options.
+// Options not given keep the values passed to 'smile_initialize'. The config file is not parsed again,
+// but all options referenced in it are re-evaluated. Use this function to process multiple inputs
+// (e.g. '-I file1.wav', '-I file2.wav', ...) with the same configuration without the overhead of a full initialization.
+smileres_t smile_reset_with_options(smileobj_t *smileobj, int nOptions, const smileopt_t *options);
+
 // Registers a callback function to be invoked for each log message.
 smileres_t smile_set_log_callback(smileobj_t *smileobj, LogCallback callback, void *param);
 
@@ -0,0 +1,224 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*
+ Stress test of the lock-free single-writer mode of cDataMemoryLevel
+ (cComponentManager.lockFreeLevels), used by the dataMemoryStress tool and the
+ unit tests. One writer thread writes blocks of frames of random length to a
+ small ring-buffer level, while several reader threads read it concurrently,
+ each with its own registered read index:
+   - readers 0, 3, 6, ... read matrices of random length,
+   - readers 1, 4, 7, ... read single frames, reader 1 occasionally skips
+     ahead with catchupCurR,
+   - readers 2, 5, 8, ... read matrices, and in between re-read frames before
+     their read index (history reads, as windowed or context components do),
+     which are protected from the writer only by the reader's pin.
+ Every frame holds values derived from its index, so a frame which is
+ overwritten before or while it is read is detected. The read and write
+ indices are checked after every operation:
+   - curW only increases and never runs more than nT frames ahead of the
+     slowest reader,
+   - the read index of a reader is the one expected after its last read
+     (history reads do not change it),
+   - at the end, all frames were written and read.
+*/
+
+#ifndef __DATAMEMORYSTRESS_HPP
+#define __DATAMEMORYSTRESS_HPP
+
+#include <core/smileCommon.hpp>
+#include <core/dataMemoryLevel.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#define STRESS_N        8   // elements per frame
+#define STRESS_MAXBLOCK 16  // maximum number of frames per read or write
+
+static std::atomic<long> stressErrors(0);
+
+static FLOAT_DMEM stressFrameValue(long vIdx, int j)
+{
+  // integers below 2^24 are exact in float
+  return (FLOAT_DMEM)((vIdx * STRESS_N + j) & 0xFFFFF);
+}
+
+static void stressError(const char *what, int id, long vIdx, long a, long b)
+{
+  if (stressErrors.fetch_add(1) < 20) {
+    fprintf(stderr, "ERROR (thread %i, vIdx %ld): %s (%ld, %ld)\n", id, vIdx, what, a, b);
+  }
+}
+
+static int stressCheckFrame(const FLOAT_DMEM *x, const TimeMetaInfo *tm, long vIdx, int id)
+{
+  for (int j = 0; j < STRESS_N; j++) {
+    if (x[j] != stressFrameValue(vIdx, j)) {
+      stressError("frame contents", id, vIdx, (long)x[j], (long)stressFrameValue(vIdx, j));
+      return 0;
+    }
+  }
+  if (tm != NULL && tm->vIdx != vIdx) {
+    stressError("time meta vIdx", id, vIdx, tm->vIdx, vIdx);
+    return 0;
+  }
+  return 1;
+}
+
+static void stressWriterThread(cDataMemoryLevel *level, long nFrames, long nT)
+{
+  std::mt19937 rng(1);
+  cMatrix *mat = new cMatrix(STRESS_N, STRESS_MAXBLOCK);
+  cVector *vec = new cVector(STRESS_N);
+  long v = 0, lastW = 0;
+  while (v < nFrames) {
+    long len = 1 + (long)(rng() % STRESS_MAXBLOCK);
+    if (len > nFrames - v) len = nFrames - v;
+    mat->allocData(STRESS_N, len);
+    for (long t = 0; t < len; t++) {
+      for (int j = 0; j < STRESS_N; j++) mat->data[t * STRESS_N + j] = stressFrameValue(v + t, j);
+    }
+    int ok = (len == 1) ? level->setFrame(v, mat->getCol(0, vec)) : level->setMatrix(v, mat);
+    long w = level->getCurW();
+    if (w < lastW) stressError("curW decreased", 0, v, w, lastW);
+    if (ok) {
+      if (w != v + len) stressError("curW after write", 0, v, w, v + len);
+      v += len;
+    } else {
+      if (w != v) stressError("curW changed by failed write", 0, v, w, v);
+      std::this_thread::yield();
+    }
+    long minR = level->getCurR();
+    if (w - minR > nT) stressError("writer ahead of the slowest reader by more than nT", 0, v, w, minR);
+    lastW = w;
+  }
+  delete mat;
+  delete vec;
+}
+
+// re-read up to nT frames before the read index of the reader, the frames may already be lost
+static void stressHistoryRead(cDataMemoryLevel *level, int rdId, std::mt19937 &rng, cMatrix *mat, long nT)
+{
+  int id = rdId + 1;
+  long r = level->getCurR(rdId);
+  long h = 1 + (long)(rng() % nT);
+  long len = 1 + (long)(rng() % STRESS_MAXBLOCK);
+  // the range must end before the read index, otherwise the read index is moved back to its start
+  if (len >= h) len = h - 1;
+  if (len < 1 || r - h < 0) return;
+  int res = 0;
+  cMatrix *m = level->getMatrix(r - h, r - h + len, -1, rdId, &res, mat);
+  if (m != NULL) {
+    if (m->nT != len) stressError("history matrix length", id, r - h, m->nT, len);
+    for (long t = 0; t < m->nT; t++) {
+      stressCheckFrame(m->data + t * STRESS_N, m->tmeta + t, r - h + t, id);
+    }
+  }
+  if (level->getCurR(rdId) != r) stressError("read index changed by history read", id, r - h, level->getCurR(rdId), r);
+}
+
+static void stressReaderThread(cDataMemoryLevel *level, int rdId, long nFrames, long nT)
+{
+  std::mt19937 rng(100 + rdId);
+  cMatrix *mat = new cMatrix(STRESS_N, STRESS_MAXBLOCK);
+  cVector *vec = new cVector(STRESS_N);
+  int id = rdId + 1;
+  long pos = 0, nOps = 0;
+  while (pos < nFrames) {
+    long len = 1;
+    if (rdId % 3 != 1) {
+      len = 1 + (long)(rng() % STRESS_MAXBLOCK);
+      if (len > nFrames - pos) len = nFrames - pos;
+    }
+    if (rdId % 3 == 2) stressHistoryRead(level, rdId, rng, mat, nT);
+    int res = 0;
+    long w0 = level->getCurW();
+    if (len == 1) {
+      cVector *r = level->getFrame(pos, -1, rdId, &res, vec);
+      if (r == NULL) { std::this_thread::yield(); continue; }
+      stressCheckFrame(r->data, r->tmeta, pos, id);
+    } else {
+      cMatrix *r = level->getMatrix(pos, pos + len, -1, rdId, &res, mat);
+      if (r == NULL) { std::this_thread::yield(); continue; }
+      if (r->nT != len) stressError("matrix length", id, pos, r->nT, len);
+      for (long t = 0; t < r->nT; t++) {
+        stressCheckFrame(r->data + t * STRESS_N, r->tmeta + t, pos + t, id);
+      }
+    }
+    // a read of the frames [pos, pos+len) sets the read index to pos + 1
+    long r = level->getCurR(rdId), w = level->getCurW();
+    if (r != pos + 1) stressError("read index after read", id, pos, r, pos + 1);
+    if (w < w0 || w < pos + len) stressError("curW smaller than frames read", id, pos, w, pos + len);
+    if (level->getNAvail(rdId) < 0 || level->getNAvail(rdId) > nT) {
+      stressError("number of available frames", id, pos, level->getNAvail(rdId), nT);
+    }
+    pos += len;
+    if (rdId == 1 && ++nOps % 1000 == 0) {
+      // skip to the current write index, the frames in between are not read
+      level->catchupCurR(rdId);
+      long rc = level->getCurR(rdId);
+      if (rc < pos || rc > level->getCurW()) stressError("read index after catchupCurR", id, pos, rc, level->getCurW());
+      pos = rc;
+    }
+  }
+  delete mat;
+  delete vec;
+}
+
+// runs the stress test on a new level of nT frames (lock-free, or with mutexes if locked = true),
+// returns the number of errors
+static long runDataMemoryStress(bool locked, long nFrames, int nReaders, long nT, bool verbose = false)
+{
+  stressErrors = 0;
+  if (nReaders < 1) nReaders = 1;
+  if (nT < 2 * STRESS_MAXBLOCK + 1) nT = 2 * STRESS_MAXBLOCK + 1;
+
+  sDmLevelConfig cfg("stress", 0.01, 0.01, nT, 1);
+  cDataMemoryLevel *level = new cDataMemoryLevel(0, cfg, "stress");
+  level->addField("x", STRESS_N);
+  level->fixateLevel();
+  level->setBlocksizeWriter(STRESS_MAXBLOCK);
+  level->queryReadConfig((long)STRESS_MAXBLOCK);
+  for (int i = 0; i < nReaders; i++) level->registerReader();
+  level->finaliseLevel();
+  level->allocReaders();
+  if (!locked && !level->enableLockFree()) {
+    fprintf(stderr, "ERROR: the level could not be switched to lock-free mode\n");
+    delete level;
+    return 1;
+  }
+  nT = level->getConfig()->nT;
+  if (verbose) {
+    printf("%s level, nT = %ld, %i reader(s), %ld frames\n", level->isLockFree() ? "lock-free" : "locked",
+        nT, nReaders, nFrames);
+  }
+
+  auto t0 = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  threads.emplace_back(stressWriterThread, level, nFrames, nT);
+  for (int i = 0; i < nReaders; i++) threads.emplace_back(stressReaderThread, level, i, nFrames, nT);
+  for (auto &t : threads) t.join();
+  double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  if (level->getCurW() != nFrames) stressError("final curW", 0, nFrames, level->getCurW(), nFrames);
+  for (int i = 0; i < nReaders; i++) {
+    long r = level->getCurR(i);
+    if (r < nFrames - STRESS_MAXBLOCK + 1 || r > nFrames) stressError("final read index", i + 1, nFrames, r, nFrames);
+  }
+  if (verbose) {
+    printf("%.3f s, %.1f ns per frame, %ld error(s)\n", sec, sec * 1e9 / (double)nFrames, stressErrors.load());
+  }
+  delete level;
+  return stressErrors.load();
+}
+
+#endif // __DATAMEMORYSTRESS_HPP
@@ -39,12 +39,15 @@ struct smileobj_t_ {
   LogCallback logCallback;
   void *logCallbackParam;
   cSmileLogger *logger;
+  cCommandlineParser *cmdline;  // referenced by configManager, must live as long as configManager
   cConfigManager *configManager;
   cComponentManager *cMan;
+  std::vector<std::string> cmdArgs;   // storage for the arguments parsed by cmdline
+  std::vector<const char *> cmdArgv;
   std::string lastError;
 
   smileobj_t_() : state(SMILE_UNINITIALIZED), stateCallback(NULL), stateCallbackParam(NULL),
-    logCallback(NULL), logCallbackParam(NULL), logger(NULL), configManager(NULL), cMan(NULL), lastError() {}
+    logCallback(NULL), logCallbackParam(NULL), logger(NULL), cmdline(NULL), configManager(NULL), cMan(NULL), lastError() {}
 };
 
 static smileres_t smile_fail_with(smileobj_t *smileobj, smileres_t result, const std::string &msg)
@@ -70,6 +73,24 @@ static void smile_set_state(smileobj_t *smileobj, smilestate_t state)
     smileobj->stateCallback(smileobj, state, smileobj->stateCallbackParam);
 }
 
+// converts 'options' to the format that cCommandlineParser expects (SMILExtract -key1 value1 ...)
+static void smile_set_cmdline_args(smileobj_t *smileobj, int nOptions, const smileopt_t *options)
+{
+  smileobj->cmdArgs.clear();
+  smileobj->cmdArgs.reserve(nOptions * 2 + 1);
+  smileobj->cmdArgs.push_back("SMILExtract");
+  for (int i = 0; i < nOptions; i++) {
+    smileobj->cmdArgs.push_back("-" + std::string(options[i].name));
+    if (options[i].value != NULL)
+      smileobj->cmdArgs.push_back(std::string(options[i].value));
+  }
+  // convert elements in cmdArgs to const char *
+  smileobj->cmdArgv.clear();
+  smileobj->cmdArgv.reserve(smileobj->cmdArgs.size());
+  for (const auto &arg : smileobj->cmdArgs)
+    smileobj->cmdArgv.push_back(arg.c_str());
+}
+
 smileobj_t *smile_new()
 {
   return new (std::nothrow) smileobj_t();
@@ -110,23 +131,9 @@ smileres_t smile_initialize(smileobj_t *smileobj, const char *configFile, int nO
       }
     });
 
-    // convert 'options' to the format that cCommandlineParser expects (SMILExtract -key1 value1 ...)
-    std::vector<std::string> cmdArgs;
-    cmdArgs.reserve(nOptions * 2 + 1);
-    cmdArgs.push_back("SMILExtract");
-    for (int i = 0; i < nOptions; i++) {
-      cmdArgs.push_back("-" + std::string(options[i].name));
-      if (options[i].value != NULL)
-        cmdArgs.push_back(std::string(options[i].value));
-    }
-    // convert elements in cmdArgs to const char *
-    std::vector<const char *> cmdArgs2;
-    cmdArgs2.reserve(cmdArgs.size());
-    for (const auto &arg : cmdArgs)
-      cmdArgs2.push_back(arg.c_str());
-
-    cCommandlineParser cmdline(cmdArgs2.size(), cmdArgs2.data());
-    if (cmdline.parse() == -1) {
+    smile_set_cmdline_args(smileobj, nOptions, options);
+    std::unique_ptr<cCommandlineParser> cmdline { new cCommandlineParser(smileobj->cmdArgv.size(), smileobj->cmdArgv.data()) };
+    if (cmdline->parse() == -1) {
       SMILE_FAIL_WITH(SMILE_FAIL, "command-line could not be parsed");
     }
 
@@ -138,7 +145,7 @@ smileres_t smile_initialize(smileobj_t *smileobj, const char *configFile, int nO
        (since component Manager unregisters plugin DLLs which might have allocated configTypes, etc.) */
     std::unique_ptr<cComponentManager> cMan;
     std::unique_ptr<cConfigManager> configManager;
-    configManager = std::unique_ptr<cConfigManager>(new cConfigManager(&cmdline));
+    configManager = std::unique_ptr<cConfigManager>(new cConfigManager(cmdline.get()));
     cMan = std::unique_ptr<cComponentManager>(new cComponentManager(configManager.get(),componentlist));
 
     // before parsing the config file, we temporarily
@@ -147,7 +154,7 @@ smileres_t smile_initialize(smileobj_t *smileobj, const char *configFile, int nO
     setlocale(LC_NUMERIC, "en_US.UTF8");
 
     try {
-      cFileConfigReader * reader = new cFileConfigReader(configFile, -1, &cmdline);
+      cFileConfigReader * reader = new cFileConfigReader(configFile, -1, cmdline.get());
       configManager->addReader(reader);      
       configManager->readConfig();
       setlocale(LC_NUMERIC, origLocale.c_str());
@@ -157,7 +164,9 @@ smileres_t smile_initialize(smileobj_t *smileobj, const char *configFile, int nO
     }
 
     /* re-parse the command-line to include options created in the config file */
-    cmdline.parse(true, false); // warn if unknown options are detected on the commandline
+    cmdline->parse(true, false); // warn if unknown options are detected on the commandline
+    // the option values given to smile_initialize are the defaults for smile_reset_with_options
+    cmdline->saveValues();
 
     try {
       /* create all instances specified in the config file */
@@ -167,6 +176,7 @@ smileres_t smile_initialize(smileobj_t *smileobj, const char *configFile, int nO
     }
 
     smileobj->logger = logger.release();
+    smileobj->cmdline = cmdline.release();
     smileobj->cMan = cMan.release();
     smileobj->configManager = configManager.release();
 
@@ -248,6 +258,52 @@ smileres_t smile_reset(smileobj_t *smileobj)
   return SMILE_SUCCESS;
 }
 
+smileres_t smile_reset_with_options(smileobj_t *smileobj, int nOptions, const smileopt_t *options)
+{
+  if (smileobj == NULL)
+    SMILE_FAIL_WITH(SMILE_INVALID_ARG, "smileobj argument must not be null");
+  if (nOptions > 0 && options == NULL)
+    SMILE_FAIL_WITH(SMILE_INVALID_ARG, "options argument must not be null");
+  if (smileobj->state != SMILE_ENDED)
+    SMILE_FAIL_WITH(SMILE_INVALID_STATE, "openSMILE must be in the ended state for resetting");
+
+  // in case this function gets called from a new thread, we need to set the global logger for it
+  smileobj->logger->useForCurrentThread();
+
+  try {
+    smile_set_cmdline_args(smileobj, nOptions, options);
+    smileobj->cmdline->restoreValues();
+    smileobj->cmdline->setArgs(smileobj->cmdArgv.size(), smileobj->cmdArgv.data());
+    smileobj->cmdline->parse(true, false);
+
+    // re-read the config to apply the new option values, see smile_initialize
+    std::string origLocale = setlocale(LC_NUMERIC, NULL);
+    setlocale(LC_NUMERIC, "en_US.UTF8");
+    try {
+      smileobj->configManager->readConfig();
+      setlocale(LC_NUMERIC, origLocale.c_str());
+    } catch (const cConfigException& ex) {
+      setlocale(LC_NUMERIC, origLocale.c_str());
+      SMILE_FAIL_WITH(SMILE_CONFIG_PARSE_FAIL, ex.getText());
+    }
+
+    smileobj->cMan->resetInstances();
+    try {
+      smileobj->cMan->createInstances(0);
+    } catch (const cConfigException& ex) {
+      SMILE_FAIL_WITH(SMILE_CONFIG_INIT_FAIL, ex.getText());
+    }
+  } catch (const cSMILException& ex) {
+    SMILE_FAIL_WITH(SMILE_FAIL, ex.getText());
+  } catch (...) {
+    SMILE_FAIL_WITH(SMILE_FAIL, "Unknown exception");
+  }
+
+  smile_set_state(smileobj, SMILE_INITIALIZED);
+
+  return SMILE_SUCCESS;
+}
+
 smileres_t smile_set_log_callback(smileobj_t *smileobj, LogCallback callback, void *param)
 {
   if (smileobj == NULL)
@@ -285,6 +341,8 @@ void smile_free(smileobj_t *smileobj)
       delete smileobj->configManager;
     if (smileobj->cMan != NULL)
       delete smileobj->cMan;
+    if (smileobj->cmdline != NULL)
+      delete smileobj->cmdline;
     if (smileobj->logger != NULL)
       delete smileobj->logger;  
     delete smileobj;
@@ -161,6 +161,8 @@ namespace AudEERING.openSMILE
         public static extern OpenSmileResult Smile_abort(IntPtr smileobj);
         [DllImport("SMILEapi", CharSet = CharSet.Ansi, EntryPoint = "smile_reset")]
         public static extern OpenSmileResult Smile_reset(IntPtr smileobj);
+        [DllImport("SMILEapi", CharSet = CharSet.Ansi, EntryPoint = "smile_reset_with_options")]
+        public static extern OpenSmileResult Smile_reset_with_options(IntPtr smileobj, int nOptions, [MarshalAs(UnmanagedType.LPArray, SizeParamIndex=1)] smileopt_t[] options);
         [DllImport("SMILEapi", CharSet = CharSet.Ansi, EntryPoint = "smile_get_state")]
         public static extern OpenSmileState Smile_get_state(IntPtr smileobj);
         [DllImport("SMILEapi", CharSet = CharSet.Ansi, EntryPoint = "smile_set_log_callback")]
@@ -734,6 +736,33 @@ namespace AudEERING.openSMILE
             CheckSmileResult(OpenSmileApi.Smile_reset(smileObj));
         }
 
+        /// <summary>
+        /// Resets openSMILE like <see cref="Reset"/> and sets new values for the command-line options.
+        /// Options not given keep the values passed to <see cref="Initialize"/>.
+        /// Use this method to process multiple inputs with the same configuration.
+        /// </summary>
+        /// <param name="options">Mapping of option names to values.</param>
+        /// <exception cref="ObjectDisposedException">
+        /// Thrown if the object has already been disposed.
+        /// </exception>
+        /// <exception cref="InvalidOperationException">
+        /// Thrown if openSMILE has not been initialized yet.
+        /// </exception>
+        /// <exception cref="OpenSmileException">
+        /// Thrown for internal openSMILE errors.
+        /// </exception>
+        public void Reset(Dictionary<string, string> options)
+        {
+            if (disposed)
+                throw new ObjectDisposedException(typeof(OpenSMILE).FullName);
+            if (smileObj == IntPtr.Zero)
+                throw new InvalidOperationException("openSMILE must be initialized first.");
+
+            smileopt_t[] opts = options?.Select(opt => new smileopt_t(opt.Key, opt.Value)).ToArray() ?? new smileopt_t[0];
+
+            CheckSmileResult(OpenSmileApi.Smile_reset_with_options(smileObj, opts.Length, opts));
+        }
+
         private void CheckSmileResult(OpenSmileResult result)
         {
             if (result != OpenSmileResult.SMILE_SUCCESS)
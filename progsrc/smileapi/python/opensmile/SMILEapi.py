@@ -173,6 +173,8 @@ smileapi.smile_abort.argtypes = [c_void_p]
 smileapi.smile_abort.restype = c_int
 smileapi.smile_reset.argtypes = [c_void_p]
 smileapi.smile_reset.restype = c_int
+smileapi.smile_reset_with_options.argtypes = [c_void_p, c_int, c_void_p]
+smileapi.smile_reset_with_options.restype = c_int
 smileapi.smile_set_log_callback.argtypes = [c_void_p, LogCallback, c_void_p]
 smileapi.smile_set_log_callback.restype = c_int
 smileapi.smile_get_state.argtypes = [c_void_p]
@@ -404,6 +406,16 @@ class OpenSMILE(object):
         """
         self._check_smile_result(smileapi.smile_reset(self._smileobj))
 
+    def reset_with_options(self, options: Dict[str, Any]):
+        """
+        Resets openSMILE like 'reset' and sets new values for the command-line options.
+        Options not given keep the values passed to 'initialize'.
+        Use this method to process multiple inputs with the same configuration.
+        """
+        options_flat = list(map(lambda v: bytes(str(v), "ascii"), sum(options.items(), ())))
+        options_char_arr = c_char_p_arr(options_flat)
+        self._check_smile_result(smileapi.smile_reset_with_options(self._smileobj, len(options), options_char_arr))
+
     def free(self):
         """
         Frees any internal resources allocated by openSMILE.
@@ -16,7 +16,10 @@ This is the main commandline application
 #include <core/configManager.hpp>
 #include <core/commandlineParser.hpp>
 #include <core/componentManager.hpp>
+#include <fstream>
 #include <memory>
+#include <string>
+#include <vector>
 
 #define MODULE "SMILExtract"
 
@@ -39,6 +42,79 @@ void INThandler(int sig)
 /*******************************************/
 
 
+/* splits a line of a file list into commandline arguments,
+   arguments are separated by whitespace, double quotes may be used for arguments containing whitespace */
+static void splitFileListEntry(const std::string &line, std::vector<std::string> &args)
+{
+  size_t i = 0;
+  while (i < line.size()) {
+    while (i < line.size() && isspace((unsigned char)line[i])) i++;
+    if (i >= line.size()) break;
+    std::string arg;
+    bool quoted = false;
+    while (i < line.size() && (quoted || !isspace((unsigned char)line[i]))) {
+      if (line[i] == '"') quoted = !quoted;
+      else arg += line[i];
+      i++;
+    }
+    args.push_back(arg);
+  }
+}
+
+/* processes all entries of a file list with the pipeline defined by the config file,
+   each line of the file list contains the commandline options for one input,
+   e.g. "-I input1.wav -csvoutput output1.csv"
+   the config types, plugins and the parsed config file are reused for all entries,
+   only the component instances are re-created for each entry (see cComponentManager::resetInstances) */
+static int processFileList(const std::string &filelist, const char *binname, cCommandlineParser &cmdline,
+    cConfigManager *configManager, cComponentManager *cMan)
+{
+  std::ifstream in(filelist);
+  if (!in.is_open()) {
+    SMILE_ERR(1,"cannot open file list '%s'", filelist.c_str());
+    return EXIT_ERROR;
+  }
+  std::vector<std::string> lines;
+  std::vector<std::vector<std::string>> entries;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::vector<std::string> args;
+    splitFileListEntry(line, args);
+    if (args.empty() || args[0][0] == '#' || args[0][0] == ';') continue;
+    lines.push_back(line);
+    entries.push_back(args);
+  }
+  SMILE_MSG(2,"file list '%s' contains %i entries", filelist.c_str(), (int)entries.size());
+
+  // options given on the main commandline are the defaults for all entries
+  cmdline.saveValues();
+  int nFailed = 0;
+  int nDone = 0;
+  for (size_t e = 0; e < entries.size() && !ctrlc; e++) {
+    std::vector<const char *> argv;
+    argv.push_back(binname);
+    for (const std::string &a : entries[e]) argv.push_back(a.c_str());
+    try {
+      SMILE_MSG(2,"processing file list entry %i of %i: %s", (int)e+1, (int)entries.size(), lines[e].c_str());
+      cmdline.restoreValues();
+      cmdline.setArgs((int)argv.size(), argv.data());
+      cmdline.parse(true, false);
+      configManager->readConfig();  // re-evaluates the commandline options referenced in the config file
+      if (e > 0) cMan->resetInstances();
+      cMan->createInstances(0);
+      cMan->runMultiThreaded(cmdline.getInt("nticks"));
+      nDone++;
+    } catch (...) {
+      SMILE_ERR(1,"processing of file list entry %i (line: '%s') failed", (int)e+1, lines[e].c_str());
+      nFailed++;
+    }
+  }
+  cmdline.setArgs(0, NULL);
+  SMILE_MSG(2,"processed %i of %i file list entries (%i failed)", nDone, (int)entries.size(), nFailed);
+  return nFailed > 0 ? EXIT_ERROR : EXIT_SUCCESS;
+}
+
+
 int main(int argc, const char *argv[])
 {
   try {
@@ -59,7 +135,7 @@ int main(int argc, const char *argv[])
 #ifdef DEBUG
     cmdline.addBoolean("debug", 'd', "Show debug messages", 0);
 #endif
-    cmdline.addInt("nticks", 't', "Number of ticks to process (-1 = infinite) (only works for single-thread processing, i.e. nThreads=1)", -1);
+    cmdline.addInt("nticks", 't', "Number of ticks to process (-1 = infinite)", -1);
     cmdline.addBoolean("components", 'L', "Show component list", 0);
     cmdline.addStr("configHelp", 'H', "Show documentation of registered config types (if an argument is given, show only documentation for config types beginning with the name given in the argument)", NULL, 0);
     cmdline.addStr("configDflt", 0, "Show default config section templates for each config type (if an argument is given, show only documentation for config types beginning with the name given in the argument, OR for a list of components in conjunctions with the 'cfgFileTemplate' option enabled)", NULL, 0);
@@ -70,6 +146,7 @@ int main(int argc, const char *argv[])
     cmdline.addStr("logfile", 0, "Set path of log file");
     cmdline.addBoolean("noconsoleoutput", 0, "Don't output any messages to the console (log file is not affected by this option)", 0);
     cmdline.addBoolean("appendLogfile", 0, "Append log messages to an existing logfile instead of overwriting the logfile at every start", 0);
+    cmdline.addStr("filelist", 0, "Process multiple inputs with the same configuration: path of a text file with one line of commandline options (e.g. '-I in.wav -O out.csv') per input. Options given on the commandline apply to all inputs.", NULL);
 
     int help = 0;
     if (cmdline.parse() == -1) {
@@ -149,13 +226,20 @@ int main(int argc, const char *argv[])
       return EXIT_ERROR;
     }
 
+    cmanGlob = cMan.get();
+    if (cmdline.isSet("filelist")) {
+      signal(SIGINT, INThandler); // install Ctrl+C signal handler
+      int ret = processFileList(std::string(cmdline.getStr("filelist")), argv[0], cmdline, configManager.get(), cMan.get());
+      if (ctrlc) return EXIT_CTRLC;
+      return ret;
+    }
+
     /* create all instances specified in the config file */
     cMan->createInstances(0); // 0 = do not read config (we already did that above..)
 
     /*
     MAIN TICK LOOP :
     */
-    cmanGlob = cMan.get();
     signal(SIGINT, INThandler); // install Ctrl+C signal handler
 
     bool run = true;
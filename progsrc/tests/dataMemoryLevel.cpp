@@ -0,0 +1,19 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+#include <catch2/catch.hpp>
+#include <tests/dataMemoryStress.hpp>
+
+TEST_CASE("lock-free level: concurrent writer and readers, including history reads", "[cDataMemoryLevel]") {
+  REQUIRE(runDataMemoryStress(false, 300000, 3, 64) == 0);
+  // several readers of each kind
+  REQUIRE(runDataMemoryStress(false, 100000, 6, 40) == 0);
+}
+
+TEST_CASE("locked level: concurrent writer and readers, including history reads", "[cDataMemoryLevel]") {
+  REQUIRE(runDataMemoryStress(true, 100000, 3, 64) == 0);
+}
@@ -0,0 +1,10 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+// the test cases are in the other source files of this directory
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
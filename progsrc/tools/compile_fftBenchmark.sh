@@ -0,0 +1,13 @@
+#!/bin/sh
+
+# This file is part of openSMILE.
+#
+# Copyright (c) audEERING. All rights reserved.
+# See the file COPYING for details on license terms.
+
+# Builds the FFT benchmark against libopensmile.
+# Usage: compile_fftBenchmark.sh [build directory (default: ../../build)]
+
+BUILDDIR=${1:-../../build}
+echo g++ -O3 -std=c++11 -I../../src/include -I$BUILDDIR/src/include fftBenchmark.cpp $BUILDDIR/libopensmile.a -lpthread -ldl -o fftBenchmark
+g++ -O3 -std=c++11 -I../../src/include -I$BUILDDIR/src/include fftBenchmark.cpp $BUILDDIR/libopensmile.a -lpthread -ldl -o fftBenchmark
@@ -0,0 +1,30 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*
+ Stress test of the lock-free single-writer mode of cDataMemoryLevel
+ (cComponentManager.lockFreeLevels), see progsrc/include/tests/dataMemoryStress.hpp.
+ With -locked, the level is run with mutexes (lockFreeLevels = 0) for comparison.
+
+ Usage: dataMemoryStress [-locked] [number of frames] [number of readers] [ring buffer size]
+*/
+
+#include <tests/dataMemoryStress.hpp>
+
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+  int a = 1, locked = 0;
+  if (argc > a && !strcmp(argv[a], "-locked")) { locked = 1; a++; }
+  long nFrames = (argc > a) ? atol(argv[a++]) : 2000000;
+  int nReaders = (argc > a) ? atoi(argv[a++]) : 3;
+  long nT = (argc > a) ? atol(argv[a++]) : 64;
+  return runDataMemoryStress(locked != 0, nFrames, nReaders, nT, true) ? 1 : 0;
+}
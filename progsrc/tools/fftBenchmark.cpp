@@ -0,0 +1,152 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*
+ Benchmark and accuracy check of the radix-4 engine of cSmileFft against
+ rdft() of the fftsg library, for the real FFT sizes used in the configs.
+ The accuracy of both is measured against a DFT computed in double precision.
+ The batched transform (cSmileFft::rdftBatch) is timed per frame for blocks
+ of frames, and its results are checked to be identical to cSmileFft::rdft.
+*/
+
+#include <core/smileCommon.hpp>
+#include <dspcore/fftXg.h>
+#include <dspcore/smileFft.hpp>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// reference real DFT in rdft format (see smileFft.hpp), computed in double precision
+static void refRdft(int isgn, const std::vector<float> &in, std::vector<double> &out)
+{
+  long N = (long)in.size();
+  out.assign(N, 0.0);
+  if (isgn >= 0) {
+    for (long k = 0; k <= N / 2; k++) {
+      double re = 0.0, im = 0.0;
+      for (long j = 0; j < N; j++) {
+        double phi = 2.0 * M_PI * (double)((j * k) % N) / (double)N;
+        re += in[j] * cos(phi);
+        im += in[j] * sin(phi);
+      }
+      if (k == 0) out[0] = re;
+      else if (k == N / 2) out[1] = re;
+      else { out[2 * k] = re; out[2 * k + 1] = im; }
+    }
+  } else {
+    for (long j = 0; j < N; j++) {
+      double v = 0.5 * (in[0] + in[1] * ((j & 1) ? -1.0 : 1.0));
+      for (long k = 1; k < N / 2; k++) {
+        double phi = 2.0 * M_PI * (double)((j * k) % N) / (double)N;
+        v += in[2 * k] * cos(phi) + in[2 * k + 1] * sin(phi);
+      }
+      out[j] = v;
+    }
+  }
+}
+
+// maximum absolute error relative to the maximum magnitude of the reference
+static double relError(const std::vector<float> &x, const std::vector<double> &ref)
+{
+  double maxErr = 0.0, maxRef = 0.0;
+  for (size_t i = 0; i < x.size(); i++) {
+    maxErr = std::max(maxErr, fabs(x[i] - ref[i]));
+    maxRef = std::max(maxRef, fabs(ref[i]));
+  }
+  return maxRef > 0.0 ? maxErr / maxRef : maxErr;
+}
+
+static double seconds(std::chrono::steady_clock::time_point t0)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char **argv)
+{
+  double minTime = 0.2;  // minimum run time per size and implementation in seconds
+  if (argc > 1) minTime = atof(argv[1]);
+
+  const long nBatch = 64;  // frames per block for the batched transform
+  printf("%6s %4s  %12s %12s %6s  %10s %10s %10s %8s %8s\n", "N", "dir", "err fftsg", "err smileFft", "batch",
+      "ns fftsg", "ns smileFft", "ns batch", "speedup", "batch");
+  for (long N = 64; N <= 4096; N *= 2) {
+    std::vector<float> input(N);
+    srand(1234);
+    for (long i = 0; i < N; i++) input[i] = (float)rand() / (float)RAND_MAX * 2.0f - 1.0f;
+
+    std::vector<int> ip(3 + (size_t)ceil(sqrt((double)N)) + N, 0);
+    std::vector<float> w(N * 5 / 4 + 2, 0.0f);
+    const cSmileFft *plan = cSmileFft::getPlan(N, SMILE_FFT_ENGINE_RADIX4);
+
+    for (int isgn = 1; isgn >= -1; isgn -= 2) {
+      std::vector<double> ref;
+      refRdft(isgn, input, ref);
+      std::vector<float> a = input, b = input;
+      rdft((int)N, isgn, a.data(), ip.data(), w.data());
+      plan->rdft(isgn, b.data());
+      double errOoura = relError(a, ref), errSmile = relError(b, ref);
+
+      // block of frames (scaled copies of the input) for the batched transform
+      std::vector<float> block(nBatch * N), blockIn(nBatch * N);
+      for (long f = 0; f < nBatch; f++) {
+        for (long i = 0; i < N; i++) blockIn[f * N + i] = input[i] * (float)(f + 1) / (float)nBatch;
+      }
+      block = blockIn;
+      plan->rdftBatch(isgn, block.data(), N, nBatch);
+      bool batchOk = true;
+      for (long f = 0; f < nBatch; f++) {
+        std::vector<float> c(blockIn.begin() + f * N, blockIn.begin() + (f + 1) * N);
+        plan->rdft(isgn, c.data());
+        for (long i = 0; i < N; i++) {
+          if (c[i] != block[f * N + i]) batchOk = false;
+        }
+      }
+
+      // timing: repeat the transform on the same buffer (values are re-set periodically to avoid overflows)
+      long nIter = 1000;
+      double tOoura = 0.0, tSmile = 0.0;
+      while (true) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (long it = 0; it < nIter; it++) {
+          if ((it & 15) == 0) a = input;
+          rdft((int)N, isgn, a.data(), ip.data(), w.data());
+        }
+        tOoura = seconds(t0);
+        t0 = std::chrono::steady_clock::now();
+        for (long it = 0; it < nIter; it++) {
+          if ((it & 15) == 0) b = input;
+          plan->rdft(isgn, b.data());
+        }
+        tSmile = seconds(t0);
+        if (tOoura >= minTime && tSmile >= minTime) break;
+        nIter *= 2;
+      }
+      long nIterBatch = 16;
+      double tBatch = 0.0;
+      while (true) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (long it = 0; it < nIterBatch; it++) {
+          if ((it & 15) == 0) block = blockIn;
+          plan->rdftBatch(isgn, block.data(), N, nBatch);
+        }
+        tBatch = seconds(t0);
+        if (tBatch >= minTime) break;
+        nIterBatch *= 2;
+      }
+      double nsBatch = tBatch / (double)(nIterBatch * nBatch) * 1e9;
+      printf("%6ld %4s  %12.3e %12.3e %6s  %10.1f %10.1f %10.1f %7.2fx %7.2fx\n", N, isgn > 0 ? "fwd" : "inv",
+          errOoura, errSmile, batchOk ? "same" : "DIFF",
+          tOoura / (double)nIter * 1e9, tSmile / (double)nIter * 1e9, nsBatch,
+          tOoura / tSmile, tOoura / (double)nIter * 1e9 / nsBatch);
+    }
+  }
+  return 0;
+}
@@ -217,6 +217,8 @@ int cOpenslesSource::setupNewNames(long nEl)
 {
   SMILE_IMSG(4, "calling setup new names: name = %s ; matrix rows: %i", outFieldName_, nChannelsEffective_);
   writer_->addField(outFieldName_, nChannelsEffective_);
+  // the data is written by the recording thread
+  writer_->setAsyncWriter();
   namesAreSet_ = 1;
   return nChannelsEffective_;
 }
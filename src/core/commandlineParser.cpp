@@ -22,6 +22,27 @@ cCommandlineParser::cCommandlineParser(int argc, const char **argv) :
 {
 }
 
+void cCommandlineParser::setArgs(int argc, const char **argv)
+{
+  this->argc = argc;
+  this->argv = argv;
+}
+
+void cCommandlineParser::saveValues()
+{
+  savedOptions = options;
+}
+
+void cCommandlineParser::restoreValues()
+{
+  if (savedOptions.size() != options.size())
+    COMP_ERR("restoreValues: options were added after saveValues() was called!");
+  options = savedOptions;
+  for (auto &opt : options) {
+    opt.isSet = false;
+  }
+}
+
 sCmdlineOpt &cCommandlineParser::addOpt(const char *name, char abbr, const char *description, eCmdlineOptType type, bool argMandatory, bool isMandatory)
 {
   if (name == NULL)
@@ -43,8 +43,15 @@ THUS: no progress for X ticks..AFTER at least one component has signalled EOP?
 */
 
 #include <core/componentManager.hpp>
+#include <core/dataMemory.hpp>
+#include <dspcore/smileFft.hpp>
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/prettywriter.h>
+#include <algorithm>
+#include <map>
 #include <string>
 #include <sstream>
+#include <thread>
 
 
 //TODO:
@@ -77,7 +84,7 @@ void cComponentManager::registerType(cConfigManager *_confman) {
     if (comp == NULL) OUT_OF_MEMORY;
     comp->setField( "type", "name of component type to create an instance of", (char*)NULL);
     comp->setField( "configInstance", "config instance to connect to component instance (UNTESTED?)", (char*)NULL);
-    comp->setField( "threadId", "thread nr. to run this component in (default = -1: either run in 1st thread or automatically run each component in one thread if nThread==0)", -1);
+    comp->setField( "threadId", "-2 = do not tick this component at all. Other values are ignored, components are assigned to threads automatically by the dependency-aware scheduler (default = -1).", -1);
 
     ConfigType *complist = new ConfigType( "cComponentManager" );
     if (complist == NULL) OUT_OF_MEMORY;
@@ -85,7 +92,15 @@ void cComponentManager::registerType(cConfigManager *_confman) {
     complist->setField( "printLevelStats", "1 = print detailed information about data memory level configuration, 2 = print even more details (?)",0);
     complist->setField( "printFinalLevelStates", "1 = print the state of all data memory levels at end of processing",0);
     complist->setField( "profiling", "1 = collect per component instance run-time stats and show summary at end of processing.", 0);
-    complist->setField( "nThreads", "number of threads to run (0=auto(=one thread per component), >0 = actual number of threads",1);
+    complist->setField( "profilingReport", "If set, collect profiling statistics (implies profiling = 1) and save them to this file in JSON format at the end of processing: wall and CPU time and tick counts by tick result per component instance, frames and bytes written and read, fill level histogram and maximum reader lag per data memory level.", (const char*)NULL);
+    complist->setField( "profilingTrace", "If set, record the start time and duration of every component tick in which work was performed (implies profiling = 1) and save them to this file in Chrome trace event format (viewable in chrome://tracing or Perfetto) at the end of processing.", (const char*)NULL);
+    complist->setField( "eventDriven", "1 = event-driven ticking: a component is only ticked if new data was written to one of its input levels, data was read from one of its output levels, it received a component message, or it performed work in its previous tick. Data sources are ticked always. This avoids the overhead of ticking idle components. The output is identical to ticking all components in every tick (eventDriven = 0) only for components whose work depends on their input data and messages alone, not for components which act on the wall-clock time or the number of ticks without new input (e.g. live sources with timeouts, or components flushing after a number of idle ticks), therefore it is disabled by default.", 0);
+    complist->setField( "lockFreeLevels", "1 = data memory ring-buffer levels with a single writer (growDyn = 0, noHang != 2) use atomic read and write indices instead of mutexes, so parallel readers of a level do not block each other. 0 = always lock levels with mutexes.", 1);
+    complist->setField( "dmemArena", "1 = allocate the buffers of all data memory levels of fixed size (growDyn = 0) from one contiguous memory block, with each level buffer aligned to 64 bytes. 0 = allocate each level buffer separately.", 1);
+    complist->setField( "dmemHugePages", "1 = request huge pages for the data memory arena (dmemArena = 1) from the operating system, if supported (Linux transparent huge pages).", 0);
+    complist->setField( "dmemAutoSize", "1 = ignore the configured buffer sizes of data memory ring-buffer levels (growDyn = 0, noHang != 2) and allocate the size required by the blocksizes of the level's writer and readers, plus the number of frames a reader of several levels waits for its other input levels (estimated from the blocksizes along the processing chains). If processing stalls because a level is nevertheless full, levels with locks (several writers, lockFreeLevels = 0) are doubled in size, lock-free levels cannot grow. The chosen sizes are shown by printLevelStats.", 0);
+    complist->setField( "fftEngine", "The FFT implementation used by all components computing FFTs (cTransformFFT, cAcf, cSpectrumFramer, cHarmonics, cLpc, cPitchJitter, cFunctionalModulation): 'fftsg' = the fftsg library (default, results identical to earlier versions), 'radix4' = SSE radix-4 kernels, about twice as fast. The results of 'radix4' differ from 'fftsg' by float rounding, which ill-conditioned features (e.g. LPC coefficients, formant bandwidths) can amplify to several percent.", "fftsg");
+    complist->setField( "nThreads", "number of threads to run (1 = single thread (default), 0 = auto (one thread per CPU core), >1 = actual number of threads). Components which do not depend on each other through a common data memory level or component messages are ticked in parallel, the output is identical to single thread processing.",1);
     complist->setField( "threadPriority", "The default thread scheduling priority (multi-thread mode) or the priority of the single thread (single thread mode). 0 is normal priority (-15 is background/idle priority, +15 is time critical). This option is currently only supported on windows!",0);
     complist->setField( "execDebug", "print summary of component run statistics to log for each tick", 0);
     complist->setField( "oldSingleIterationTickLoop", "1 = run the old single iteration tick loop with a single EOI tick loop after the main tick loop. Use this for backwards compatibility for older configs with components such as fullinputMean.", 0);
@@ -548,12 +563,8 @@ cComponentManager::cComponentManager(cConfigManager *_confman, const registerFun
   handlelist(NULL),
   regFnlist(NULL),
   nCompTsAlloc(0),
-  nWaiting(0),
-  nActive(0),
   printPlugins(1),
   execDebug(0),
-  //  threadNRun(NULL),
-  globalRunState(0),
   compTs(NULL),
   abortRequest(0),
   componentThreadId(NULL),
@@ -563,7 +574,8 @@ cComponentManager::cComponentManager(cConfigManager *_confman, const registerFun
   tickLoopPauseTimeout(10),
   pauseStartNr(-1),
   isConfigured(0), isFinalised(0), printLevelStats(0),
-  messageCounter(0), profiling(0),
+  messageCounter(0), profiling(0), profilingReport(NULL), profilingTrace(NULL),
+  eventDriven(0), lockFreeLevels(1), dmemArena(1), dmemHugePages(0), dmemAutoSize(0), fftEngine(SMILE_FFT_ENGINE_FFTSG), nTicksDispatched(0), nTicksSkipped(0),
   oldSingleIterationTickLoop(0),
   printFinalLevelStates(0)
 {
@@ -603,6 +615,159 @@ int cComponentManager::compIsDm(const char *_compn)
   return (!strcmp(_compn,COMPONENT_NAME_CDATAMEMORY)); 
 }
 
+void cComponentManager::sampleDmLevelProfiles()
+{
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] != NULL && compIsDm(component[i]->getTypeName())) {
+      ((cDataMemory *)component[i])->sampleLevelProfiles();
+    }
+  }
+}
+
+void cComponentManager::writeProfilingReport(const char *filename, long long nTicks, double wallTime)
+{
+  rapidjson::Document doc;
+  rapidjson::MemoryPoolAllocator<> &allocator = doc.GetAllocator();
+  doc.SetObject();
+  doc.AddMember("ticks", (int64_t)nTicks, allocator);
+  doc.AddMember("wallTime", wallTime, allocator);
+  doc.AddMember("nThreads", scheduler ? scheduler->getNworkers() : 1, allocator);
+  doc.AddMember("eventDriven", eventDriven != 0, allocator);
+  doc.AddMember("componentTicksCalled", (int64_t)nTicksDispatched, allocator);
+  doc.AddMember("componentTicksSkipped", (int64_t)nTicksSkipped, allocator);
+
+  // frames written to each level, by full level name (data memory instance name + '.' + level name)
+  std::map<std::string, long long> framesWritten;
+  rapidjson::Value levels(rapidjson::kArrayType);
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] != NULL && compIsDm(component[i]->getTypeName())) {
+      cDataMemory *dm = (cDataMemory *)component[i];
+      for (int level = 0; level < dm->getNlevels(); level++) {
+        framesWritten[std::string(dm->getInstName()) + "." + dm->getLevelName(level)] = dm->getFramesWritten(level);
+      }
+      rapidjson::Value dmLevels = dm->exportLevelProfiles(allocator);
+      for (auto &l : dmLevels.GetArray()) {
+        levels.PushBack(l, allocator);
+      }
+    }
+  }
+
+  std::vector<std::set<std::string>> rdLevels, wrLevels;
+  getComponentLevelAccess(rdLevels, wrLevels);
+  rapidjson::Value components(rapidjson::kArrayType);
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] == NULL || compIsDm(component[i]->getTypeName())) continue;
+    cSmileComponent *c = component[i];
+    rapidjson::Value comp(rapidjson::kObjectType);
+    comp.AddMember("name", rapidjson::Value(c->getInstName(), allocator), allocator);
+    comp.AddMember("type", rapidjson::Value(c->getTypeName(), allocator), allocator);
+    comp.AddMember("wallTime", c->getProfile(1), allocator);
+    comp.AddMember("cpuTime", c->getProfileCpuTime(), allocator);
+    rapidjson::Value ticks(rapidjson::kObjectType);
+    for (int r = 0; r < NUM_TICK_RESULTS; r++) {
+      ticks.AddMember(rapidjson::StringRef(tickResultStr((eTickResult)r)), (int64_t)c->getProfileTickCount((eTickResult)r), allocator);
+    }
+    ticks.AddMember("skipped", (int64_t)c->getProfileSkippedTicks(), allocator);
+    comp.AddMember("ticks", ticks, allocator);
+    long long nFrames = 0;
+    rapidjson::Value rd(rapidjson::kArrayType), wr(rapidjson::kArrayType);
+    for (const std::string &l : rdLevels[i]) rd.PushBack(rapidjson::Value(l.c_str(), allocator), allocator);
+    for (const std::string &l : wrLevels[i]) {
+      wr.PushBack(rapidjson::Value(l.c_str(), allocator), allocator);
+      nFrames += framesWritten[l];
+    }
+    comp.AddMember("levelsRead", rd, allocator);
+    comp.AddMember("levelsWritten", wr, allocator);
+    comp.AddMember("framesWritten", (int64_t)nFrames, allocator);
+    components.PushBack(comp, allocator);
+  }
+  doc.AddMember("components", components, allocator);
+  doc.AddMember("levels", levels, allocator);
+
+  FILE *f = fopen(filename, "w");
+  if (f == NULL) {
+    SMILE_ERR(1,"cannot open profiling report file '%s' for writing", filename);
+    return;
+  }
+  char buf[65536];
+  rapidjson::FileWriteStream os(f, buf, sizeof(buf));
+  rapidjson::PrettyWriter<rapidjson::FileWriteStream> writer(os);
+  doc.Accept(writer);
+  os.Put('\n');
+  os.Flush();
+  fclose(f);
+  SMILE_MSG(2,"profiling report saved to '%s'", filename);
+}
+
+void cComponentManager::writeProfilingTrace(const char *filename, std::chrono::steady_clock::time_point start)
+{
+  FILE *f = fopen(filename, "w");
+  if (f == NULL) {
+    SMILE_ERR(1,"cannot open profiling trace file '%s' for writing", filename);
+    return;
+  }
+  // the trace can be large, so it is written as a stream instead of building a document first
+  char buf[65536];
+  rapidjson::FileWriteStream os(f, buf, sizeof(buf));
+  rapidjson::Writer<rapidjson::FileWriteStream> writer(os);
+  writer.StartObject();
+  writer.Key("displayTimeUnit");
+  writer.String("ms");
+  writer.Key("traceEvents");
+  writer.StartArray();
+  int nThreadsTraced = 0;
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] == NULL) continue;
+    for (const sProfileTickEvent &e : component[i]->getProfileTrace()) {
+      typedef std::chrono::duration<double, std::micro> microseconds;
+      writer.StartObject();
+      writer.Key("name"); writer.String(component[i]->getInstName());
+      writer.Key("cat"); writer.String(component[i]->getTypeName());
+      writer.Key("ph"); writer.String("X");
+      writer.Key("ts"); writer.Double(std::chrono::duration_cast<microseconds>(e.start - start).count());
+      writer.Key("dur"); writer.Double(e.duration * 1e6);
+      writer.Key("pid"); writer.Int(1);
+      writer.Key("tid"); writer.Int(e.thread);
+      writer.Key("args");
+      writer.StartObject();
+      writer.Key("tick"); writer.Int64(e.tick);
+      writer.EndObject();
+      writer.EndObject();
+      if (e.thread >= nThreadsTraced) nThreadsTraced = e.thread + 1;
+    }
+  }
+  for (int t = 0; t < nThreadsTraced; t++) {
+    std::string name = "thread " + std::to_string(t);
+    writer.StartObject();
+    writer.Key("name"); writer.String("thread_name");
+    writer.Key("ph"); writer.String("M");
+    writer.Key("pid"); writer.Int(1);
+    writer.Key("tid"); writer.Int(t);
+    writer.Key("args");
+    writer.StartObject();
+    writer.Key("name"); writer.String(name.c_str());
+    writer.EndObject();
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.EndObject();
+  os.Put('\n');
+  os.Flush();
+  fclose(f);
+  SMILE_MSG(2,"profiling trace saved to '%s'", filename);
+}
+
+int cComponentManager::growFullDmLevels()
+{
+  int n = 0;
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] != NULL && compIsDm(component[i]->getTypeName())) {
+      n += ((cDataMemory *)component[i])->growFullLevels();
+    }
+  }
+  return n;
+}
+
 int cComponentManager::ciRegisterComps(int _dm)
 {
 #ifdef DEBUG
@@ -853,6 +1018,13 @@ void cComponentManager::createInstances(int readConfig)
   tmp = myvprint("%s.profiling",CM_CONF_INST);
   profiling = confman->getInt(tmp);
   free(tmp);
+  tmp = myvprint("%s.profilingReport",CM_CONF_INST);
+  profilingReport = confman->getStr(tmp);
+  free(tmp);
+  tmp = myvprint("%s.profilingTrace",CM_CONF_INST);
+  profilingTrace = confman->getStr(tmp);
+  free(tmp);
+  if (profilingReport != NULL || profilingTrace != NULL) profiling = 1;
   //#ifdef DEBUG
   tmp = myvprint("%s.execDebug",CM_CONF_INST);
   execDebug = confman->getInt(tmp);
@@ -864,6 +1036,28 @@ void cComponentManager::createInstances(int readConfig)
   tmp = myvprint("%s.printFinalLevelStates",CM_CONF_INST);
   printFinalLevelStates = confman->getInt(tmp);
   free(tmp);
+  tmp = myvprint("%s.eventDriven",CM_CONF_INST);
+  eventDriven = confman->getInt(tmp);
+  free(tmp);
+  tmp = myvprint("%s.lockFreeLevels",CM_CONF_INST);
+  lockFreeLevels = confman->getInt(tmp);
+  free(tmp);
+  tmp = myvprint("%s.dmemArena",CM_CONF_INST);
+  dmemArena = confman->getInt(tmp);
+  free(tmp);
+  tmp = myvprint("%s.dmemHugePages",CM_CONF_INST);
+  dmemHugePages = confman->getInt(tmp);
+  free(tmp);
+  tmp = myvprint("%s.dmemAutoSize",CM_CONF_INST);
+  dmemAutoSize = confman->getInt(tmp);
+  free(tmp);
+  tmp = myvprint("%s.fftEngine",CM_CONF_INST);
+  const char *fftEngineName = confman->getStr(tmp);
+  free(tmp);
+  fftEngine = cSmileFft::getEngineByName(fftEngineName);
+  if (fftEngine < 0) {
+    COMP_ERR("unknown fftEngine '%s' (allowed: fftsg, radix4)", fftEngineName);
+  }
 
   // create component instances (datamemory, readers, writers, and the rest)
   //     const char **getArrayKeys(const char *_name, int *N=NULL) const;
@@ -877,11 +1071,7 @@ void cComponentManager::createInstances(int readConfig)
 
     // prepare threads:
     nThreads = confman->getInt_f(myvprint("%s.nThreads",CM_CONF_INST));
-    // multi-threaded processing is broken at the moment. For compatibility, we keep the nThreads option but force it to be 1 (single thread).
-    if (nThreads != 1) {
-      nThreads = 1;
-      SMILE_WRN(2,"componentManager: starting with version 3.0, multi-threaded processing (nThreads != 1) is no longer supported and is ignored.");
-    }
+    if (nThreads < 0) nThreads = 1;
     threadPriority = confman->getInt_f(myvprint("%s.threadPriority",CM_CONF_INST));
     if (threadPriority < -15) threadPriority = -15;
     if (threadPriority > 20) threadPriority = 20;
@@ -898,12 +1088,12 @@ void cComponentManager::createInstances(int readConfig)
         if (ci == NULL) ci = k;
         SMILE_DBG(2," adding %i. component instance: name '%s', type '%s', configInstance '%s'",i,k,tp,ci);
         int tmpId = confman->getInt_f(myvprint("%s.instance[%s].threadId",CM_CONF_INST,k));
-        if (tmpId < -2) tmpId = -1;  // NOTE: threadId = -2 => do not tick this component at all!!
-        if (tmpId >= nThreads) {
-          //CONF_INVALID_ERR("%s.instance[%s].threadId must be < %s.nThreads (first Id = 0)!",CM_CONF_INST,k,CM_CONF_INST);
-          SMILE_MSG(1, "[componentManager] threadId of instance %s must be < nThreads (%i). Setting to threadId 0.", k, nThreads);
-          tmpId = 0;
-        }
+        if (tmpId < -2 || tmpId >= 0) {
+          // components are assigned to threads by the scheduler
+          SMILE_WRN(2,"%s.instance[%s].threadId = %i is ignored, components are assigned to threads automatically (only threadId = -2, i.e. do not tick the component, is supported)",
+            CM_CONF_INST,k,tmpId);
+          tmpId = -1;
+        }  // NOTE: threadId = -2 => do not tick this component at all!!
         /* TODO: add the reading of a *per component* threadPriority here, which will be passed to addComponent call */
         /*
         int threadPrio = threadPriority;
@@ -949,6 +1139,7 @@ void cComponentManager::configureAndFinaliseComponents()
   isConfigured=1;
 
   if (ciConfigureComps(1)) COMP_ERR("createInstances: failed configuring dataMemory instances");
+  if (dmemAutoSize) setDmLevelReaderLags();
   if (ciFinaliseComps(1,&nFinD)) COMP_ERR("createInstances: failed finalising dataMemory instances");
   isFinalised=1;
 
@@ -993,7 +1184,7 @@ int cComponentManager::addComponent(const char *_instname, const char *_type, co
     cSmileComponent *c = createComponent(_instname,t);
     if (c==NULL) COMP_ERR("failed creating component '%s' (type: '%s')",_instname,_type);
     if (_ci != NULL) c->setConfigInstanceName(_ci);
-    if (profiling) c->setProfiling(1, 0);
+    if (profiling) c->setProfiling(1, 0, profilingTrace != NULL);
     return registerComponentInstance(c, _type, _threadId /*, threadPrio */);
   } else {
     SMILE_ERR(1,"cannot add component (instname='%s' type='%s'): unknown component type!!",_instname,_type);
@@ -1163,6 +1354,7 @@ int cComponentManager::sendComponentMessage(int compid, cComponentMessage *_msg)
       smileMutexUnlock(messageMtx);
     }
     ret = c->receiveComponentMessage(_msg);
+    c->wakeup();
   }
   return ret;
 }
@@ -1237,17 +1429,38 @@ void cComponentManager::tick(int threadId, long long tickNr, long lastNrun, long
     return;
   }
   int nRunnable = 0;
-  for (int i=0; i<=lastComponent; i++) {
-    if (component[i] != NULL) {
-      if (((threadId == -1)||(threadId == componentThreadId[i]))&&(componentThreadId[i]!=-2)) {
-        nRunnable++;
-        SMILE_DBG(4,"~~~~> 'ticking' component '%s' (idx %i)",component[i]->getInstName(),i);
-        eTickResult ret = component[i]->tick(tickNr, EOIcondition, lastNrun);
-        SMILE_DBG(4,"%s.tick() returned %s",component[i]->getInstName(),tickResultStr(ret));
-        tickResultCounts[ret]++;       
+  long nSkipped = 0;
+  if (scheduler && threadId == -1) {
+    // multi-threaded: tick all components in parallel, respecting the dependencies between them
+    scheduler->tick(tickNr, EOIcondition, lastNrun, tickResultCounts);
+    nRunnable = scheduler->getNtasks();
+    nSkipped = scheduler->getLastNskipped();
+  } else {
+    for (int i=0; i<=lastComponent; i++) {
+      if (component[i] != NULL) {
+        if (((threadId == -1)||(threadId == componentThreadId[i]))&&(componentThreadId[i]!=-2)) {
+          nRunnable++;
+          eTickResult ret;
+          if (eventDriven) {
+            bool skipped;
+            ret = component[i]->tickIfAwake(tickNr, EOIcondition, lastNrun, &skipped);
+            if (skipped) {
+              nSkipped++;
+              tickResultCounts[ret]++;
+              continue;
+            }
+          } else {
+            ret = component[i]->tick(tickNr, EOIcondition, lastNrun);
+          }
+          SMILE_DBG(4,"~~~~> 'ticked' component '%s' (idx %i)",component[i]->getInstName(),i);
+          SMILE_DBG(4,"%s.tick() returned %s",component[i]->getInstName(),tickResultStr(ret));
+          tickResultCounts[ret]++;       
+        }
       }
     }
   }
+  nTicksDispatched += nRunnable - nSkipped;
+  nTicksSkipped += nSkipped;
   if (tickResultCounts[TICK_SUCCESS] < nRunnable) { 
     SMILE_DBG(4,"not all components were run during tick %i (threadID: %i)! (%i<%i)",
       tickNr,threadId,tickResultCounts[TICK_SUCCESS],nRunnable);
@@ -1260,6 +1473,15 @@ void cComponentManager::tick(int threadId, long long tickNr, long lastNrun, long
   }
 }
 
+void cComponentManager::wakeupAllComponents()
+{
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] != NULL) {
+      component[i]->wakeup();
+    }
+  }
+}
+
 // Notifies each component of a pause of the tick loop.
 // Returns 0 if at least one of the components rejected the pause, otherwise 1.
 int cComponentManager::pausedNotifyComponents(int threadId, int isPause)
@@ -1279,6 +1501,7 @@ int cComponentManager::pausedNotifyComponents(int threadId, int isPause)
         } else {
           SMILE_DBG(4,"~~~~> resuming component '%s' (idx %i)",component[i]->getInstName(),i);
           component[i]->resume();
+          component[i]->wakeup();
         }
       }
     }
@@ -1296,7 +1519,6 @@ timeout :  if how=2, then max number of ticks of nRun>0 , after which pause requ
 */
 void cComponentManager::pause(int how, int timeout)
 {
-  // WARNING: pause/resume is currently only implemented for single thread processing!
   smileMutexLock(pauseMtx);
   if (tickLoopPaused && how > 0) {
     smileMutexUnlock(pauseMtx);  
@@ -1384,9 +1606,6 @@ void cComponentManager::requestAbort() {
   smileMutexLock(abortMtx);
   abortRequest = 1;
   signalDataAvailable();
-  if (nThreads != 1) { 
-    smileCondSignal(controlCond); 
-  }
   smileMutexUnlock(abortMtx);
 }
   
@@ -1417,7 +1636,19 @@ long long cComponentManager::runSingleThreaded(long long maxtick)
 {
   if (!ready) return 0;
   SMILE_MSG(2,"starting single thread processing loop");
-  
+  return runTickLoop(maxtick);
+}
+
+// tick loop, calls tick() until all components report EOI
+// if the scheduler exists, tick() runs the components on multiple threads
+long long cComponentManager::runTickLoop(long long maxtick)
+{
+  if (eventDriven) {
+    setupEventDrivenTicking();
+  }
+  nTicksDispatched = 0;
+  nTicksSkipped = 0;
+
 #ifdef __WINDOWS
   // set priority of current thread here...
   SetThreadPriority(GetCurrentThread(), threadPriority);
@@ -1427,6 +1658,13 @@ long long cComponentManager::runSingleThreaded(long long maxtick)
   long long tickNr = -1;
   bool firstTickAfterEOIReset = false;
 
+  // data memory object allocation statistics for the profiling summary
+  long long nAllocsStart = dmemGetAllocationCount();
+  long long nAllocsLast = nAllocsStart;
+  long long nAllocTicks = 0;     // number of ticks during which allocations were performed
+  long long lastAllocTick = -1;
+  std::chrono::steady_clock::time_point loopStart = std::chrono::steady_clock::now();
+
   do { // outer tick loop
     long lastNRun = -1;
 
@@ -1439,6 +1677,16 @@ long long cComponentManager::runSingleThreaded(long long maxtick)
       long tickResultCounts[NUM_TICK_RESULTS];
       tick(-1, tickNr, lastNRun, tickResultCounts);
 
+      if (profiling) {
+        sampleDmLevelProfiles();
+        long long nAllocs = dmemGetAllocationCount();
+        if (nAllocs != nAllocsLast) {
+          nAllocTicks++;
+          lastAllocTick = tickNr;
+          nAllocsLast = nAllocs;
+        }
+      }
+
       long nRun = tickResultCounts[TICK_SUCCESS];
       long nWaiting = tickResultCounts[TICK_EXT_SOURCE_NOT_AVAIL] + tickResultCounts[TICK_EXT_DEST_NO_SPACE];
       lastNRun = nRun;
@@ -1465,11 +1713,16 @@ long long cComponentManager::runSingleThreaded(long long maxtick)
         if (nWaiting2 > 0) {
           // at least one component is waiting for data, continue tick loop
           SMILE_DBG(4,"%i component(s) could not run because they were waiting for data. Continuing tick loop now.", nWaiting2);
+          wakeupAllComponents();
         } else {
           if (nWaiting > 0) {
             // at least one component is waiting for data, block, then continue tick loop
             SMILE_DBG(4,"%i component(s) could not run because they are waiting for data. Blocking until new data is available.", nWaiting);
             smileCondWait(dataAvailableCond);
+            wakeupAllComponents();
+          } else if (dmemAutoSize && tickResultCounts[TICK_DEST_NO_SPACE] > 0 && growFullDmLevels() > 0) {
+            // automatically sized levels were too small, continue tick loop with the grown levels
+            wakeupAllComponents();
           } else {
             if (tickResultCounts[TICK_DEST_NO_SPACE] > 0) {
               std::string msg = "The following component(s) could not perform any work because destination levels are full but no other component performed any work either:";
@@ -1501,7 +1754,7 @@ long long cComponentManager::runSingleThreaded(long long maxtick)
         }
       }
 
-      // Implements pausing/resuming functionality. Currently only implemented for single-thread processing.
+      // Implements pausing/resuming functionality.
       // This function may block as long as processing is paused.
       bool forceContinueTickLoop = pauseThisTickLoop(-1, nRun, tickNr);
       if (forceContinueTickLoop) {
@@ -1545,17 +1798,23 @@ long long cComponentManager::runSingleThreaded(long long maxtick)
 
   // show profiling information:
   if (profiling) {
-    double elapsedTotal = 0.0;
+    typedef std::chrono::duration<double> seconds;
+    double wallTime = std::chrono::duration_cast<seconds>(std::chrono::steady_clock::now() - loopStart).count();
+    double elapsedTotal = 0.0, cpuTotal = 0.0;
     std::vector<double> elapsedPerComponent;
     elapsedPerComponent.resize(lastComponent + 1);
     for (int i=0; i<=lastComponent; i++) {
       if (component[i] != NULL) {
         elapsedPerComponent[i] = component[i]->getProfile(1);
         elapsedTotal += elapsedPerComponent[i];
+        cpuTotal += component[i]->getProfileCpuTime();
       }
     }
     SMILE_PRINT(" == Component run-time profiling ==");
-    SMILE_PRINT("    Total time in component tick() in seconds: %f", elapsedTotal);
+    SMILE_PRINT("    Total time in component tick() in seconds: %f (CPU time: %f, tick loop wall time: %f)", elapsedTotal, cpuTotal, wallTime);
+    SMILE_PRINT("    Component ticks: %lld called, %lld skipped (eventDriven = %i)", nTicksDispatched, nTicksSkipped, eventDriven);
+    SMILE_PRINT("    Data memory object allocations: %lld before the tick loop, %lld in %lld of %lld ticks (last in tick %lld)",
+        nAllocsStart, nAllocsLast - nAllocsStart, nAllocTicks, tickNr + 1, lastAllocTick);
     // normalise to percentages:
     if (elapsedTotal > 0.0) {
       for (int i=0; i<=lastComponent; i++) {
@@ -1565,6 +1824,8 @@ long long cComponentManager::runSingleThreaded(long long maxtick)
         }
       }
     }
+    if (profilingReport != NULL) writeProfilingReport(profilingReport, tickNr + 1, wallTime);
+    if (profilingTrace != NULL) writeProfilingTrace(profilingTrace, loopStart);
   }
 
   if (printFinalLevelStates) {
@@ -1589,636 +1850,296 @@ long long cComponentManager::runSingleThreaded(long long maxtick)
   return tickNr;
 }
 
-SMILE_THREAD_RETVAL threadRunner(void *_data)
+// returns the index of the component which owns the (sub-)component instance _instname,
+// i.e. the component whose name is equal to _instname or is a prefix of _instname followed by a '.'
+// returns -1 if no such component exists
+int cComponentManager::findOwnerComponentInstance(const char *_instname) const
 {
-  sThreadData *data = (sThreadData*)_data;
-  if ((data != NULL)&&(data->obj!=NULL)) {
-    // ensures log messages created in this thread are sent to the global logger
-    data->obj->getLogger()->useForCurrentThread();
-    data->obj->waitForController(data->threadId,0);
-    data->obj->tickLoopA(data->maxtick, data->threadId, data);
-    // wait for all threads to be in this state....
-    data->obj->waitForController(data->threadId,2);
-    // post EOI processing
-    data->obj->tickLoopA(data->maxtick, data->threadId, data);
-  }
-  SMILE_THREAD_RET;
-}
-
-void cComponentManager::waitForAllThreads(int threadID)
-{
-  smileMutexLock(waitEndMtx);
-  SMILE_DBG(4,"thread controller entered waiting state.. %i threads of %i are now waiting\n",threadID,waitEndCnt,nThreads);
-
-  if (waitEndCnt < nThreads) { 
-    smileCondWaitWMtx(waitEndCond,waitEndMtx);
-  }
-  EOI = 1; 
-  nActive = nThreads; //??
-  //smileCondBroadcast(waitEndCond);
-  endOfLoop=0;
-  waitEndCnt = 0;
-  controllerPresent = 0;
-  smileMutexUnlock(waitEndMtx);
-}
-
-void cComponentManager::waitForController(int threadID, int stage)
-{
-  smileMutexLock(waitEndMtx);
-  if (stage==2) {
-    waitEndCnt++; 
-    SMILE_DBG(4,"thread %i entered waiting state.. %i threads of %i are now waiting\n",threadID,waitEndCnt,nThreads);
-    if (waitEndCnt == nThreads) {
-      smileCondSignal(waitEndCond);
+  if (_instname == NULL) return -1;
+  int owner = -1;
+  size_t ownerLen = 0;
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] != NULL) {
+      const char *n = component[i]->getInstName();
+      size_t len = strlen(n);
+      if (len >= ownerLen && !strncmp(_instname, n, len) && (_instname[len] == 0 || _instname[len] == '.')) {
+        owner = i;
+        ownerLen = len;
+      }
     }
-    smileCondWaitWMtx(waitControllerCond,waitEndMtx);
-  } else {
-    if (!controllerPresent) { smileCondWaitWMtx(waitControllerCond,waitEndMtx); }
   }
-  //EOI = _eoi; 
-  //nActive = nThreads; //??
-  //  smileCondBroadcast(waitEndCond);
-  //endOfLoop=0;
-  smileMutexUnlock(waitEndMtx);
+  return owner;
 }
 
-SMILE_THREAD_RETVAL threadRunnerControl(void *_data)
+void cComponentManager::getComponentLevelAccess(std::vector<std::set<std::string>> &rdLevels, std::vector<std::set<std::string>> &wrLevels) const
 {
-  sThreadData *data = (sThreadData*)_data;
-  if ((data != NULL)&&(data->obj!=NULL)) {
-    // ensures log messages created in this thread are sent to the global logger
-    data->obj->getLogger()->useForCurrentThread();
-    data->obj->controlLoopA();
-    // wait for all threads to be in this state....
-    data->obj->waitForAllThreads(-1); // thread ID is only used for display of messages
-    //    fprintf(stderr,"CR eoi=1\n");
-    // post EOI processing
-    data->obj->controlLoopA();
-  }
-  SMILE_THREAD_RET;
+  rdLevels.assign(lastComponent + 1, std::set<std::string>());
+  wrLevels.assign(lastComponent + 1, std::set<std::string>());
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] != NULL && !strcmp(component[i]->getTypeName(), COMPONENT_NAME_CDATAMEMORY)) {
+      cDataMemory *dm = (cDataMemory *)component[i];
+      std::string prefix = std::string(dm->getInstName()) + ".";
+      for (const auto &rq : dm->getReadRequests()) {
+        int c = findOwnerComponentInstance(rq.instanceName);
+        if (c >= 0) rdLevels[c].insert(prefix + rq.levelName);
+      }
+      for (const auto &rq : dm->getWriteRequests()) {
+        int c = findOwnerComponentInstance(rq.instanceName);
+        if (c >= 0) wrLevels[c].insert(prefix + rq.levelName);
+      }
+    }
+  }
 }
 
-void cComponentManager::controlLoopA()
+// A component reading from several levels can only process data which has arrived in all of them, so
+// data in a level which is filled earlier than the others waits for the slower levels. The latency of
+// every level (time in seconds after the input at which its data is written) is the longest chain of
+// reader and writer blocksizes from a source to the level. Each input level of such a reader must buffer
+// the difference between the largest and the smallest latency of the reader's input levels: the levels
+// with small latency wait for the others while processing, and at the end of the input the levels with
+// large latency are padded by their writers (e.g. windows reaching past the end) and run ahead of the others.
+void cComponentManager::setDmLevelReaderLags()
 {
-  int run = 1;
-
-  smileMutexLock(syncCondMtx);
-  endOfLoop=0;
-
-  smileMutexLock(waitEndMtx);
-  waitEndCnt=0;
-  controllerPresent=1;
-  smileCondBroadcast(waitControllerCond);
-  smileMutexUnlock(waitEndMtx);
+  std::vector<std::set<std::string>> rdLevels;
+  std::vector<std::set<std::string>> wrLevels;
+  getComponentLevelAccess(rdLevels, wrLevels);
 
-  do {
-    if (!abortRequest) smileCondWaitWMtx(controlCond,syncCondMtx);
-    // if control cond was signald, all thread are waiting...!
-    // set a flag, an thus execute each thread loop excatly ONCE!
-    // then check the status, if still all are waiting, exit, else continue!
-    if (probeFlag) {
-      //      fprintf(stderr,"probe end  cr=%i nP %i nA %i\n",compRunFlag,nProbe,nActive);fflush(stderr);
-      if (compRunFlag == 0) {
-        // final exit!
-        run = 0;
-      } else {
-        // continue
-        nProbe = 0;
-        nWaiting = 0;
-        probeFlag = 0;
-        //cnt = 0;
+  struct sLevelRef { cDataMemory *dm; int level; double latency; long lag; };
+  std::map<std::string, sLevelRef> levels;
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] != NULL && !strcmp(component[i]->getTypeName(), COMPONENT_NAME_CDATAMEMORY)) {
+      cDataMemory *dm = (cDataMemory *)component[i];
+      std::string prefix = std::string(dm->getInstName()) + ".";
+      for (int l = 0; l < dm->getNlevels(); l++) {
+        levels[prefix + dm->getLevelName(l)] = { dm, l, 0.0, 0 };
       }
-    } else {
-      // probe components..
-      //      fprintf(stderr,"probe start nW %i\n",nWaiting); fflush(stderr);
-      nWaiting = 0;
-      compRunFlag = 0;
-      probeFlag = 1;
-      nProbe = 0;
     }
+  }
+  auto config = [&levels](const std::string &name) -> const sDmLevelConfig * {
+    auto it = levels.find(name);
+    return (it != levels.end()) ? it->second.dm->getLevelConfig(it->second.level) : NULL;
+  };
 
-    smileMutexLock(abortMtx);
-    if (abortRequest) { run = 0; }
-    else if (run==0) { endOfLoop = 1; }
-    smileMutexUnlock(abortMtx);
-    //    fprintf(stderr,"cr stat nW %i nP %i ab %i run %i pf %i\n",nWaiting,nProbe,abortRequest,run,probeFlag); fflush(stderr);
-
-    smileCondBroadcast(syncCond); 
-
-  } while(run);
-  smileMutexUnlock(syncCondMtx);
+  // longest paths, a cycle of levels stops after one pass over all levels
+  for (size_t it = 0; it < levels.size(); it++) {
+    bool changed = false;
+    for (int i=0; i<=lastComponent; i++) {
+      double inLatency = 0.0;
+      for (const auto &name : rdLevels[i]) {
+        const sDmLevelConfig *c = config(name);
+        if (c != NULL) inLatency = std::max(inLatency, levels[name].latency + c->blocksizeReader * c->T);
+      }
+      for (const auto &name : wrLevels[i]) {
+        const sDmLevelConfig *c = config(name);
+        if (c == NULL) continue;
+        double latency = inLatency + c->blocksizeWriter * c->T;
+        if (latency > levels[name].latency + 1e-9) {
+          levels[name].latency = latency;
+          changed = true;
+        }
+      }
+    }
+    if (!changed) break;
+  }
 
-  compRunFlag = 0; probeFlag = 0; nProbe = 0; nWaiting = 0;
+  for (int i=0; i<=lastComponent; i++) {
+    if (rdLevels[i].size() < 2) continue;
+    double maxLatency = 0.0, minLatency = -1.0;
+    for (const auto &name : rdLevels[i]) {
+      if (!levels.count(name)) continue;
+      maxLatency = std::max(maxLatency, levels[name].latency);
+      if (minLatency < 0.0 || levels[name].latency < minLatency) minLatency = levels[name].latency;
+    }
+    for (const auto &name : rdLevels[i]) {
+      const sDmLevelConfig *c = config(name);
+      if (c == NULL || c->T <= 0.0) continue;
+      long lag = (long)ceil((maxLatency - minLatency) / c->T - 1e-6);
+      if (lag > levels[name].lag) levels[name].lag = lag;
+    }
+  }
+  for (const auto &l : levels) {
+    if (l.second.lag > 0) {
+      SMILE_DBG(3,"level '%s': readers lag up to %ld frames behind the writer",l.first.c_str(),l.second.lag);
+      l.second.dm->setReaderLag(l.second.level, l.second.lag);
+    }
+  }
 }
 
-
-long long cComponentManager::tickLoopA(long long maxtick, int threadId, sThreadData *_data)
+// Sets up event-driven ticking: each data memory level gets the list of components to wake up when
+// data is written to it (the components reading from it) or read from it (the component writing to it).
+// Components which do not read from any level (e.g. data sources waiting for external data) are always awake.
+void cComponentManager::setupEventDrivenTicking()
 {
-  long nRun; int _abort = 0; int doYield=0;
-  long long tickNr = -1;
-
-  SMILE_MSG(3,"starting processing loop of thread %i",threadId);
-
-  do {
-    smileMutexLock(syncCondMtx);
-    // if runFlag == 0 here...
-    runFlag[threadId] = 0;
-    tickNr++; //fprintf(stderr, "tick %i eol %i eoi %i\n",tickNr,endOfLoop,EOI); fflush(stderr);
-    SMILE_DBG(3,"<------- TICK # %i (thread %i) ---------->",tickNr,threadId);
-    smileMutexUnlock(syncCondMtx);
-    long tickResultCounts[NUM_TICK_RESULTS];
-    tick(threadId, tickNr, -1, tickResultCounts);
-    nRun = tickResultCounts[TICK_SUCCESS];
-    long nWaiting = tickResultCounts[TICK_EXT_SOURCE_NOT_AVAIL] + tickResultCounts[TICK_EXT_DEST_NO_SPACE];
-    SMILE_DBG(3,"nRun = %i (thread %i)",nRun,threadId);
-
-    smileMutexLock(abortMtx);
-    if (abortRequest) {
-      _abort = 1;
-    }
-    smileMutexUnlock(abortMtx);
-
-    if (!_abort) {
-
-      smileMutexLock(syncCondMtx);
-      //    fprintf(stderr,"mutlock...%i\n",threadId);
-      if (nRun==0) {
-        if (runFlag[threadId] == 1) {
-          runFlag[threadId] = 0;
-          nRun = 1;
-        } else {
-          if (!probeFlag) {
-            nWaiting++;
-            if (nWaiting < nActive) {
-              //SMILE_MSG(3, "thread %i sleeping (tick %i) (nAct %i, nWait %i)", threadId, tickNr, nActive, nWaiting);
-              smileCondWaitWMtx(syncCond,syncCondMtx); // sleep until another thread or the controller thread wakes us
-              //nRun = 1; // runStatus is set by the controller thread, it is 1 by default (=continue)
-            } else {
-              smileCondSignal(controlCond); // wake up controller thread...
-              //SMILE_MSG(3, "thread %i sleeping and signalled controller (tick %i) (nAct %i, nWait %i)", threadId, tickNr, nActive, nWaiting);
-              smileCondWaitWMtx(syncCond,syncCondMtx); // and sleep until the controller thread OR ANOTHER THREAD! wakes us
-              //nRun = 1; // runStatus is set by the controller thread, it is 1 by default (=continue)
-            }
-            if (!probeFlag && nWaiting > 0)
-              nWaiting--;
-          } else {
-            nProbe++;
-            //nWaiting++;
-            if (nProbe == nActive) {
-              smileCondSignal(controlCond); // wake up controller thread if we are the last in the probe...
-              //SMILE_MSG(3, "PROBE: thread %i signalled controller (tick %i), nprobe = %i, nA %i, nW %i", threadId, tickNr, nProbe, nActive, nWaiting);
+  std::vector<bool> readsLevel(lastComponent + 1, false);
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] != NULL && compIsDm(component[i]->getTypeName())) {
+      cDataMemory *dm = (cDataMemory *)component[i];
+      for (int level = 0; level < dm->getNlevels(); level++) {
+        const char *levelName = dm->getLevelName(level);
+        std::vector<cSmileComponent *> readers;
+        cSmileComponent *writer = NULL;
+        for (const auto &rq : dm->getReadRequests()) {
+          if (!strcmp(rq.levelName, levelName)) {
+            int c = findOwnerComponentInstance(rq.instanceName);
+            if (c >= 0) {
+              readsLevel[c] = true;
+              if (std::find(readers.begin(), readers.end(), component[c]) == readers.end()) {
+                readers.push_back(component[c]);
+              }
             }
-            //SMILE_MSG(3, "PROBE: thread %i sleeping (tick %i), nprobe = %i", threadId, tickNr, nProbe);
-            smileCondWaitWMtx(syncCond,syncCondMtx); // sleep until the controller thread OR ANOTHER THREAD! wakes us
-            //if (nWaiting > 0) nWaiting--;
-            //if (probeFlag) nProbe--;
           }
-          nRun = 1;
-          doYield = 0;
         }
-      } else {
-        for (int i = 0; i < nActive; i++) {
-          runFlag[i] = 1;
-        }
-        //for (int i=0; i<nActive; i++){
-        //  smileCondSignalRaw(syncCond);
-        //}
-        //if (!probeFlag) 
-        //else {
-        compRunFlag = 1; 
-        //SMILE_MSG(3, "PROCESSED thread %i run>0 (tick %i), nprobe = %i", threadId, tickNr, nProbe);
-        if (probeFlag) {
-          nProbe++;
-          // TODO: actually once one component has run, we can exit probe.. however, if we do the nWaiting counter is wrong and we enter a deadlock (all waiting afterwards)
-          if (nProbe == nActive) {
-            //SMILE_MSG(3, "PROBE: thread %i run>0 and signalled controller (tick %i), nprobe = %i, nA %i, nW %i", threadId, tickNr, nProbe, nActive, nWaiting);
-            smileCondSignal(controlCond);
+        for (const auto &rq : dm->getWriteRequests()) {
+          if (!strcmp(rq.levelName, levelName)) {
+            int c = findOwnerComponentInstance(rq.instanceName);
+            if (c >= 0) writer = component[c];
           }
-          //SMILE_MSG(3, "PROBE: thread %i run>0 sleeping (tick %i), nprobe = %i", threadId, tickNr, nProbe);
-          smileCondWaitWMtx(syncCond,syncCondMtx); // sleep until the controller thread OR ANOTHER THREAD! wakes us
         }
-        /*else {
-          smileCondBroadcastRaw(syncCond);
-          if (nWaiting == nActive - 1) {
-            nWaiting++;
-            //SMILE_MSG(3, "thread %i sleeping while waiting for others (tick %i) (nAct %i, nWait %i)", threadId, tickNr, nActive, nWaiting);
-            smileCondWaitWMtx(syncCond,syncCondMtx); // sleep until the controller thread OR ANOTHER THREAD! wakes us
-          }
-        }*/
-        //nProbe++;
-        //if (nProbe == nActive) smileCondSignal(controlCond); // wake up controller thread...
-        //smileCondWaitWMtx(syncCond,syncCondMtx); // and sleep until the controller thread wakes us
-        //}
-        doYield=0;
-
-        // TODO: if all others waiting... make sure we sleep at the end
-
+        dm->setWakeupComponents(level, readers, writer);
       }
-      if ((_data->maxtick != -1)&&(tickNr >= _data->maxtick)) nRun = 0;
-      smileMutexUnlock(syncCondMtx);
     }
-
-    smileMutexLock(abortMtx);
-    if ((endOfLoop)||(_abort)) { nRun = 0; }
-    smileMutexUnlock(abortMtx);
-
-    smileMutexLock(syncCondMtx);
-    if (nRun == 0) nActive--;
-    smileMutexUnlock(syncCondMtx);
-    if (doYield) { smileYield(); doYield = 0; }
-
-  } while (nRun>0) ;
-
-  SMILE_MSG(3,"leaving processing loop of thread %i (ticks: %i)",threadId,tickNr);
-  // first part... now enter EOI state, however wait for other threads...???
-
-  return tickNr;
-
+  }
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] != NULL) {
+      component[i]->setAlwaysAwake(!readsLevel[i]);
+      component[i]->wakeup();
+    }
+  }
 }
 
-
-#if 0
-long long cComponentManager::tickLoopA(long long maxtick, int threadId, sThreadData *_data)
+// Component messages are processed synchronously in the thread of the sender (see sendComponentMessage),
+// thus a sender and its recipients must not be ticked in parallel. The recipients are not registered
+// anywhere, so they are taken from the configuration: every component instance which is named in a
+// string option of the sender (e.g. messageRecp, eventRecp or resultRecp, which may list several
+// names separated by ',') is considered a recipient.
+void cComponentManager::getComponentMessagePeers(std::vector<std::set<int>> &recipients)
 {
-  int nRun; int _abort = 0; int doYield=0;
-  long long tickNr = -1;
-  int weDidRun = 0;
-  SMILE_MSG(3,"starting processing loop of thread %i",threadId);
-
-  do {
-    smileMutexLock(syncCondMtx);
-    // if runFlag == 0 here...
-    runFlag[threadId] = 0;
-    tickNr++; //fprintf(stderr, "tick %i eol %i eoi %i\n",tickNr,endOfLoop,EOI); fflush(stderr);
-    SMILE_DBG(3,"<------- TICK # %i (thread %i) ---------->",tickNr,threadId);
-    smileMutexUnlock(syncCondMtx);
-    nRun = tick(threadId,tickNr);
-    SMILE_DBG(3,"nRun = %i (thread %i)",nRun,threadId);
-    smileMutexLock(abortMtx);
-    if (abortRequest) {
-      _abort = 1;
-    }
-    smileMutexUnlock(abortMtx);
-
-    if (!_abort) {
-      smileMutexLock(syncCondMtx);
-      if (nWaiting == nActive - 1) {  // all waiting except us.. looks like a probe round
-        nProbe++;
-      }
-      if (nRun > 0) {
-        smileCondBroadcastRaw(syncCond);
-        SMILE_MSG(3, "thread %i processed data (%i)", threadId, (int)tickNr);
-        //compRunFlag = 1;
-        for (int i = 0; i < nActive; i++) {
-            runFlag[i] = 1;
-        }
-        weDidRun = 1;
-        // we need some mechanism to ensure that if we just ran, but then will be waiting for all other threads,
-        // that all other threads have had a chance to run before we terminate!
-      } else {
-        if (runFlag[threadId] == 1) {
-          runFlag[threadId] = 0;
-          nRun = 1;
-        } else {
-          //smileCondBroadcastRaw(syncCond);
-          nWaiting++;
-          // actually: if nWaiting==nActive  terminate!
-          if (nWaiting == nActive) {
-            // we need some mechanism to ensure that if we just ran, but then will be waiting for all other threads,
-                    // that all other threads have had a chance to run before we terminate!
-            if (weDidRun == 1) {
-              // check a counter == nActive - 1?
-              if (nProbe == nActive - 1) {
-                nRun = 0;
-                SMILE_MSG(3, "thread %i ending AFTER PROBE, tick %i -> ALL WAITING NOW (nW = %i)", threadId, (int)tickNr, nWaiting);
-              } else {
-                nRun = 1;
-                SMILE_MSG(3, "thread %i re-run (probe), tick %i -> ALL WAITING NOW (nW = %i)", threadId, (int)tickNr, nWaiting);
-              }
-            } else {
-              SMILE_MSG(3, "thread %i ending, tick %i -> ALL WAITING NOW (nW = %i)", threadId, (int)tickNr, nWaiting);
-              nRun = 0;
-            }
-            nWaiting--;
-          } else {
-            SMILE_MSG(3, "thread %i sleeping, tick %i (nW = %i)", threadId, (int)tickNr, nWaiting);
-            smileCondWaitWMtx(syncCond,syncCondMtx); // sleep until another thread or the controller thread wakes us
-            nWaiting--;
-            SMILE_MSG(3, "thread %i woken (%i)", threadId, (int)tickNr);
-            nRun = 1;
-            weDidRun = 0;
+  recipients.assign(lastComponent + 1, std::set<int>());
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] == NULL || compIsDm(component[i]->getTypeName())) continue;
+    const char *cfname = component[i]->getConfigInstanceName();
+    if (cfname == NULL || strchr(cfname, '.') != NULL) continue;
+    ConfigInstance *ci = confman->getInstance(cfname);
+    if (ci == NULL) continue;
+    for (int n = 0; n < ci->getN(); n++) {
+      int tp = ci->getType(n);
+      if (tp != CFTP_STR && tp != CFTP_STR_ARR) continue;
+      const ConfigValue *v = ci->getValue(n);
+      if (v == NULL) continue;
+      int nEl = (tp == CFTP_STR_ARR) ? v->getN() : 1;
+      for (int el = 0; el < nEl; el++) {
+        const ConfigValue *e = (tp == CFTP_STR_ARR) ? (*(const ConfigValueArr *)v)[el] : v;
+        if (e == NULL || !e->isSet() || e->getStr() == NULL) continue;
+        std::istringstream names(e->getStr());
+        std::string name;
+        while (std::getline(names, name, ',')) {
+          int c = findOwnerComponentInstance(name.c_str());
+          if (c >= 0 && c != i && !compIsDm(component[c]->getTypeName())) {
+            recipients[i].insert(c);
           }
         }
       }
-      if (nProbe >= nActive - 1) {
-        nProbe = 0;
-        weDidRun = 1;
-      }
-      smileMutexUnlock(syncCondMtx);
-      if ((_data->maxtick != -1)&&(tickNr >= _data->maxtick)) nRun = 0;
     }
-    smileMutexLock(abortMtx);
-    if (_abort) { nRun = 0; }
-    smileMutexUnlock(abortMtx);
-  } while (nRun>0) ;
-
-  smileMutexLock(syncCondMtx);
-  nActive--;
-  smileMutexUnlock(syncCondMtx);
-
-  SMILE_MSG(3,"leaving processing loop of thread %i (ticks: %i)",threadId,tickNr);
-  // first part... now enter EOI state, however wait for other threads...???
-
-  return tickNr;
-
+  }
 }
-#endif
-#if 0
-// multi thread tick loop (tick loop for one of many threads)
-long long cComponentManager::tickLoopA(long long maxtick, int threadId, sThreadData *_data)
-{
-  int nRun;
-  long long tickNr = -1;
-  int nRun0cnt = 0;
-
-  SMILE_MSG(2,"starting processing loop of thread %i",threadId);
-
-  /*
-  smileMutexLock(syncCondMtx);
-  // TODO: BUG, if nActive == 1, because other threads have not yet been started!!! (maybe initialise nActive with nThreads!?)
-  nActive++;
-  smileMutexUnlock(syncCondMtx);
-  */
 
-  do {
-    tickNr++;
-    SMILE_DBG(4,"<------- TICK # %i (thread %i) ---------->",tickNr,threadId);
-    nRun = tick(threadId,tickNr);
-    //    smileYield();
-    SMILE_DBG(4,"nRun = %i (thread %i)",nRun,threadId);
-    smileMutexLock(syncCondMtx);
-    //    fprintf(stderr,"mutlock...%i\n",threadId);
-    if (nRun==0) {
-      // if not all waiting... wait!
-      //          fprintf(stderr,"wc? %i nW %i nA %i\n",threadId,nWaiting,nActive); fflush(stderr);
-      //if (nWaiting+nWaiting2 < nActive) {
-
-      if (nWaiting+nWaiting2 < nActive-1) {
-        if (_data->status == THREAD_ACTIVE) {
-          nWaiting++;
-        }
-        if (_data->status == THREAD_WAIT_B) {
-          nWaiting2--;
-          nWaiting++;
-        }
-        _data->status = THREAD_WAIT_A;
-
-        nRun0cnt = 0;
-        //fprintf(stderr,"entering wait cond %i  (T=%i) nW %i nA %i\n",threadId,tickNr,nWaiting,nActive); fflush(stderr);
-        //smileCondBroadcastRaw(syncCond);
-        //fprintf(stderr,"w1 state %i  (T=%i) nW %i nA %i nW2 %i\n",threadId,tickNr,nWaiting,nActive,nWaiting2); fflush(stderr);
-        if (nWaiting + nWaiting2 >= nActive) { smileCondBroadcastRaw(syncCond); }
-        smileCondWaitWMtx(syncCond,syncCondMtx);
-        //fprintf(stderr,"w1 state end %i  (T=%i) nW %i nA %i nW2 %i\n",threadId,tickNr,nWaiting,nActive,nWaiting2); fflush(stderr);
-        //fprintf(stderr,"exiting wait cond %i\n",threadId); fflush(stderr);
-        //nWaiting--;
-        nRun=1;
-      } //else  //all threads seem to have failed.... nRun=0, this will exit the first loop
-      else {
-        if (_data->status == THREAD_WAIT_A) {
-          nWaiting--; 
-        }
-        if (_data->status != THREAD_WAIT_B) {
-          nWaiting2++; _data->status = THREAD_WAIT_B;
-        }
-        int nWaiting_old = nWaiting;
-        fprintf(stderr,"w2 state %i  (T=%i) nW %i nA %i nW2 %i\n",threadId,tickNr,nWaiting,nActive,nWaiting2); fflush(stderr);
-        //nWaiting2++;
-        //_data->status = THREAD_WAIT_B;
-        //if (nWaiting + nWaiting2 >= nActive) {smileCondBroadcastRaw(syncCond); }
-        smileCondBroadcastRaw(syncCond);
-        //fprintf(stderr,"bc w2\n"); fflush(stderr);
-        if (nWaiting2 < nActive) {
-          nRun = 1;
-          smileCondWaitWMtx(syncCond,syncCondMtx);
-        } else {
-          // exit for sure (?)... inform other threads?
-          fprintf(stderr,"exit of %i\n",threadId); fflush(stderr);
-        }
-        if (nWaiting_old > nWaiting) {
-          _data->status = THREAD_ACTIVE;
-          nWaiting2--;
-        }
-
-        //fprintf(stderr,"w2 state end %i  (T=%i) nW %i nA %i nW2 %i\n",threadId,tickNr,nWaiting,nActive,nWaiting2); fflush(stderr);
-
-        //nRun0cnt++;
-
-        //if (nRun0cnt <= 1) { nRun = 1; 
-        //fprintf(stderr,"nRun0cnt %i = %i\n",threadId,nRun0cnt); fflush(stderr);
-        //nWaiting++;
-        //           nWaiting++;
-        //        smileCondBroadcastRaw(syncCond);
-        //smileCondWaitWMtx(syncCond,syncCondMtx);
-        //        smileMutexUnlock(syncCondMtx);
-        //        smileYield();
-        //        smileMutexLock(syncCondMtx);
-        //        nWaiting--;
-        //smileCondWaitWMtx(syncCond,syncCondMtx);
-        //nWaiting--;
-        //}
-      }
-      //}
-    } else {
-      //      smileMutexLock(syncCondMtx);
-      if (_data->status == THREAD_WAIT_A) {
-        _data->status = THREAD_ACTIVE;
-        nWaiting--;
-      } else
-        if (_data->status == THREAD_WAIT_B) {
-          _data->status = THREAD_ACTIVE;
-          //nWaiting--; 
-          nWaiting2--;
-        }
+static bool levelSetsIntersect(const std::set<std::string> &a, const std::set<std::string> &b)
+{
+  const std::set<std::string> &s = a.size() < b.size() ? a : b;
+  const std::set<std::string> &l = a.size() < b.size() ? b : a;
+  for (const auto &x : s) {
+    if (l.count(x)) return true;
+  }
+  return false;
+}
 
-        smileCondBroadcastRaw(syncCond); 
-        //fprintf(stderr,"bc ok\n"); fflush(stderr);
-        nRun0cnt = 0;
+// Creates the scheduler for multi-threaded processing. Each component that is ticked is added as a task.
+// Dependencies are derived from the read and write requests registered in the data memories:
+// if two components access a common level and at least one of them writes to it, the component with
+// the higher index must run after the one with the lower index. Thus, all operations on a level are
+// performed in the same order as in the single-threaded tick loop. The same applies to components which
+// send component messages and their recipients (see getComponentMessagePeers).
+void cComponentManager::createScheduler(int nWorkers)
+{
+  std::vector<std::set<std::string>> rdLevels;
+  std::vector<std::set<std::string>> wrLevels;
+  getComponentLevelAccess(rdLevels, wrLevels);
+  std::vector<std::set<int>> msgRecipients;
+  getComponentMessagePeers(msgRecipients);
+  std::vector<bool> isDm(lastComponent + 1, false);
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] != NULL && compIsDm(component[i]->getTypeName())) {
+      isDm[i] = true;
     }
-    if ((maxtick != -1)&&(tickNr >= maxtick)) nRun = 0;
-    smileMutexLock(abortMtx);
-    if (abortRequest) {
-      nRun = 0;
+  }
+
+  scheduler.reset(new cComponentScheduler(logger, nWorkers, eventDriven != 0));
+  std::vector<int> taskComp;
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] != NULL && componentThreadId[i] != -2) {
+      scheduler->addTask(component[i]);
+      taskComp.push_back(i);
     }
-    smileMutexUnlock(abortMtx);
-
-    if (nRun == 0) nActive--;
-
-    smileMutexUnlock(syncCondMtx);
-
-    smileYield(); // !!!!?
-  } while(nRun > 0);
-
-  //  smileMutexLock(syncCondMtx);
-  // we must signal, if we exit, in order to wake up other threads, to allow them to check , if they are finished too
-  //  smileCondBroadcastRaw(syncCond);
-  //  smileMutexUnlock(syncCondMtx);
-  if (_data->status == THREAD_WAIT_A) {
-    _data->status = THREAD_ACTIVE;
-    nWaiting--;
-  } else
-    if (_data->status == THREAD_WAIT_B) {
-      _data->status = THREAD_ACTIVE;
-      //nWaiting--; 
-      nWaiting2--;
+  }
+  int nDeps = 0;
+  int nSerial = 0;
+  int nMsgDeps = 0;
+  for (size_t a = 0; a < taskComp.size(); a++) {
+    int ca = taskComp[a];
+    // components that do not access any data memory level may interact with other components in
+    // ways unknown to us (e.g. via component messages or shared resources), they are never run in parallel
+    bool serialA = !isDm[ca] && rdLevels[ca].empty() && wrLevels[ca].empty();
+    if (serialA) nSerial++;
+    for (size_t b = a + 1; b < taskComp.size(); b++) {
+      int cb = taskComp[b];
+      bool serialB = !isDm[cb] && rdLevels[cb].empty() && wrLevels[cb].empty();
+      bool msg = msgRecipients[ca].count(cb) || msgRecipients[cb].count(ca);
+      if (serialA || serialB || msg
+          || levelSetsIntersect(wrLevels[ca], rdLevels[cb])
+          || levelSetsIntersect(wrLevels[ca], wrLevels[cb])
+          || levelSetsIntersect(rdLevels[ca], wrLevels[cb])) {
+        scheduler->addDependency((int)a, (int)b);
+        nDeps++;
+        if (msg) nMsgDeps++;
+      }
     }
-
-    smileCondBroadcastRaw(syncCond); 
-    SMILE_MSG(2,"leaving processing loop of thread %i (ticks: %i)",threadId,tickNr);
-    // first part... now enter EOI state, however wait for other threads...???
-
-    return tickNr;
+  }
+  SMILE_MSG(3,"scheduler: %i components, %i dependencies (%i between message senders and recipients), %i components without data memory access (not run in parallel)",
+    (int)taskComp.size(), nDeps, nMsgDeps, nSerial);
+  scheduler->start();
 }
-#endif
-
-// multi thread tick loop (tick loop for one of many threads)
-//long long cComponentManager::tickLoopB(long long maxtick, int threadId)//
-//{
-//TODO... post EOI processing... (not needed... we will try to use tickLoopA again..)
-
-//  return 0;
-//}
 
 //
 // !!! THIS function should be always preferred, since it determines single/multi thread from config !!!
 //
-// multi threaded run: create threads for multiple tick loops and control/synchronize them...
+// multi threaded run: ticks components in parallel with the scheduler, using the same tick loop as single threaded processing
 long long cComponentManager::runMultiThreaded(long long maxtick)
 {
   if (!ready) return 0;
-  int i;
 
-  // 
-  if (nThreads == 1) {
+  int nWorkers = nThreads;
+  if (nWorkers == 0) {
+    nWorkers = (int)std::thread::hardware_concurrency();
+  }
+  int nTickable = 0;
+  for (int i=0; i<=lastComponent; i++) {
+    if (component[i] != NULL && componentThreadId[i] != -2) nTickable++;
+  }
+  if (nWorkers > nTickable) nWorkers = nTickable;
+  if (nWorkers <= 1) {
     return runSingleThreaded(maxtick);
-  } else {
-    if (nThreads == 0) {
-      int j=0;
-      // int * threadPrios = (int *) calloc(1,sizeof(int)*lastComponent);
-      for (i=0; i<lastComponent; i++) {
-        if (componentThreadId[i] != -2) {
-          /* TODO : store threadPrio in an array indexed by 1..j 
-          threadPrios[j] = componentThreadPrio[i];
-          */
-          componentThreadId[i] = j++;
-        }
-      }
-      nThreads = j;
-    } else {
-      for (i=0; i<lastComponent; i++) {
-        if (componentThreadId[i] == -1) componentThreadId[i] = 0; // run in first thread
-      }
-    }
-    SMILE_MSG(2,"starting mutli-thread processing with %i threads",nThreads);
-    // create thread handles and data structures
-    runFlag = (int *)malloc(sizeof(int) * nThreads);
-    sThreadData *threadData = (sThreadData*)malloc(sizeof(sThreadData) * nThreads);
-    smileThread *threadHandles = (smileThread *)malloc(sizeof(smileThread) * nThreads);
-    smileMutexCreate(syncCondMtx);
-    smileCondCreate(syncCond);
-    smileCondCreate(waitEndCond);
-    smileCondCreate(waitControllerCond);
-
-    nActive = nThreads;
-    waitEndCnt = 0;
-    smileMutexCreate(waitEndMtx);
-
-    // create the controller thread...
-    smileCondCreate(controlCond);
-    sThreadData control;
-    control.obj = this;
-    control.threadId = -1;
-    smileThread controlThr;
-    runStatus = 1; compRunFlag = 0; probeFlag = 0; nProbe = 0; endOfLoop=0; controllerPresent=0;
-    if (!(int)smileThreadCreate(controlThr, threadRunnerControl, &control)) {
-      SMILE_ERR(1,"error creating controller thread!!",i);
-    }
-    // create all the threads....
-    for (i=0; i<nThreads; i++) {
-      threadData[i].obj = this;
-      threadData[i].maxtick = maxtick;
-      threadData[i].threadId = i;
-      threadData[i].status = THREAD_ACTIVE;
-      if (!(int)smileThreadCreate(threadHandles[i], threadRunner, &(threadData[i]))) {
-        //      if (!((long)(threadHandles[i] = (HANDLE)_beginthread(threadRunner,0,&(threadData[i]))) != -1)) {
-        SMILE_ERR(1,"error creating thread with threadId %i!!",i);
-        smileMutexLock(syncCondMtx);
-        nActive--;
-        smileMutexUnlock(syncCondMtx);
-      } else {
-        /* TODO: set priority of current thread here... */
-#ifdef __WINDOWS
-        //SetThreadPriority(threadHandles[i] , threadPrios[i] );
-#endif
-      }
-    }
-    //free(threadPrios);
-
-    // wait for all threads to finish
-    for (i=0; i<nThreads; i++) {
-      //      fprintf(stderr,"joining thr %i (nA=%i)\n",i,nActive); fflush(stderr);
-      smileThreadJoin(threadHandles[i]);
-      threadData[i].status = THREAD_INACTIVE;
-    }
-
-    // and the controller thread
-    //    fprintf(stderr,"joining controller (nA=%i)\n",nActive); fflush(stderr);
-    smileCondSignal(controlCond);
-    smileThreadJoin(controlThr);
-    //fprintf(stderr,"joined controller\n");
-
-    smileMutexDestroy(waitEndMtx);
-    smileMutexDestroy(syncCondMtx);
-    smileCondDestroy(syncCond);
-    smileCondDestroy(controlCond);
-    smileCondDestroy(waitEndCond);
-    smileCondDestroy(waitControllerCond);
-
-    // destroy all threads and thread data:
-    if (runFlag != NULL) free(runFlag);
-    if (threadData != NULL) free(threadData);
-    if (threadHandles != NULL) free(threadHandles);
-
-    // do profiling (TODO: correct for multi-threading!?):
-    if (profiling) {
-      double psum = 0.0;
-      double *ps = (double*)calloc(1, sizeof(double) * (lastComponent + 1));
-      for (int i=0; i<=lastComponent; i++) {
-        if (component[i] != NULL) {
-          ps[i] = component[i]->getProfile(1);
-          psum += ps[i];
-        }
-      }
-      SMILE_PRINT(" == Component run-time profiling ==");
-      SMILE_PRINT("    Total time in component tick() in seconds: %f", psum);
-      // normalise to percentages:
-      if (psum > 0.0) {
-        for (int i=0; i<=lastComponent; i++) {
-          if (component[i] != NULL) {
-            ps[i] /= psum;
-            SMILE_PRINT("  %s:   %.1f %s", component[i]->getInstName(), ps[i] * 100.0, "%");
-          }
-        }
-      }
-      free(ps);
-    }
   }
-  return 1; // TODO: tickNr??
-}
 
+  SMILE_MSG(2,"starting multi-thread processing loop with %i threads",nWorkers);
+  createScheduler(nWorkers);
+  long long tickNr = runTickLoop(maxtick);
+  scheduler.reset();
+  return tickNr;
+}
 
 cComponentManager::~cComponentManager()
 {
+  scheduler.reset();
   resetInstances();
 
   for (int i=0; i<lastComponent; i++) {
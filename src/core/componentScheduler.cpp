@@ -0,0 +1,282 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*
+   dependency-aware scheduler for multi-threaded ticking of components
+   (see componentScheduler.hpp for a description)
+ */
+
+
+#include <core/componentScheduler.hpp>
+
+#define MODULE "cComponentScheduler"
+
+// number of unsuccessful attempts to find a task before an idle worker goes to sleep
+#define SCHEDULER_SPIN_COUNT 64
+
+static SMILE_THREAD_RETVAL schedulerWorkerRunner(void *_data)
+{
+  sSchedulerWorker *w = (sSchedulerWorker *)_data;
+  if (w != NULL && w->obj != NULL) {
+    w->obj->workerLoop(w->id);
+  }
+  SMILE_THREAD_RET;
+}
+
+cComponentScheduler::cComponentScheduler(cSmileLogger *_logger, int _nWorkers, bool _eventDriven) :
+  logger(_logger), nWorkers(_nWorkers), started(false), eventDriven(_eventDriven),
+  remaining(0), nQueued(0), nSkipped(0), stopFlag(false),
+  curTickNr(0), curEOIcondition(0), curLastNrun(0),
+  failed(false)
+{
+  if (nWorkers < 1) nWorkers = 1;
+  smileMutexCreate(errorMtx);
+  for (int i = 0; i < nWorkers; i++) {
+    sSchedulerWorker *w = new sSchedulerWorker();
+    w->obj = this;
+    w->id = i;
+    w->sleeping = false;
+    smileMutexCreate(w->queueMtx);
+    smileCondCreate(w->wakeCond);
+    workers.emplace_back(w);
+  }
+}
+
+int cComponentScheduler::addTask(cSmileComponent *c)
+{
+  if (started) COMP_ERR("addTask: cannot add tasks after the scheduler has been started");
+  sSchedulerTask t;
+  t.component = c;
+  t.nPredecessors = 0;
+  t.result = TICK_INACTIVE;
+  tasks.push_back(t);
+  return (int)tasks.size() - 1;
+}
+
+void cComponentScheduler::addDependency(int before, int after)
+{
+  if (started) COMP_ERR("addDependency: cannot add dependencies after the scheduler has been started");
+  if (before < 0 || after < 0 || before >= (int)tasks.size() || after >= (int)tasks.size() || before >= after) {
+    COMP_ERR("addDependency: invalid dependency %i -> %i (dependencies must follow the task order)", before, after);
+  }
+  tasks[before].successors.push_back(after);
+  tasks[after].nPredecessors++;
+}
+
+void cComponentScheduler::start()
+{
+  if (started) return;
+  pending.reset(new std::atomic<int>[tasks.size()]);
+  for (size_t i = 0; i < tasks.size(); i++) {
+    pending[i] = tasks[i].nPredecessors;
+  }
+  started = true;
+  for (int i = 1; i < nWorkers; i++) {
+    if (!smileThreadCreate(workers[i]->thread, schedulerWorkerRunner, workers[i].get())) {
+      SMILE_ERR(1,"error creating scheduler worker thread %i, running with %i threads", i, i);
+      workers.resize(i);
+      nWorkers = i;
+      break;
+    }
+  }
+  SMILE_MSG(3,"scheduling %i components on %i threads", (int)tasks.size(), nWorkers);
+}
+
+void cComponentScheduler::wakeSleepingWorker()
+{
+  for (int i = 0; i < nWorkers; i++) {
+    if (workers[i]->sleeping.load()) {
+      smileCondSignal(workers[i]->wakeCond);
+      return;
+    }
+  }
+}
+
+void cComponentScheduler::pushTask(int workerId, int task)
+{
+  sSchedulerWorker *w = workers[workerId].get();
+  smileMutexLock(w->queueMtx);
+  w->queue.push_back(task);
+  smileMutexUnlock(w->queueMtx);
+  nQueued++;
+  wakeSleepingWorker();
+}
+
+int cComponentScheduler::popTask(int workerId)
+{
+  int task = -1;
+  sSchedulerWorker *w = workers[workerId].get();
+  smileMutexLock(w->queueMtx);
+  if (!w->queue.empty()) {
+    task = w->queue.back();
+    w->queue.pop_back();
+    nQueued--;
+  }
+  smileMutexUnlock(w->queueMtx);
+  return task;
+}
+
+int cComponentScheduler::stealTask(int workerId)
+{
+  for (int i = 1; i < nWorkers; i++) {
+    sSchedulerWorker *v = workers[(workerId + i) % nWorkers].get();
+    int task = -1;
+    smileMutexLock(v->queueMtx);
+    if (!v->queue.empty()) {
+      task = v->queue.front();
+      v->queue.pop_front();
+      nQueued--;
+    }
+    smileMutexUnlock(v->queueMtx);
+    if (task >= 0) return task;
+  }
+  return -1;
+}
+
+void cComponentScheduler::executeTask(int workerId, int task)
+{
+  sSchedulerTask &t = tasks[task];
+  if (!failed.load()) {
+    try {
+      if (eventDriven) {
+        bool skipped;
+        t.result = t.component->tickIfAwake(curTickNr, curEOIcondition, curLastNrun, &skipped);
+        if (skipped) nSkipped++;
+      } else {
+        t.result = t.component->tick(curTickNr, curEOIcondition, curLastNrun);
+      }
+      SMILE_DBG(4,"%s.tick() returned %s (worker %i)",t.component->getInstName(),tickResultStr(t.result),workerId);
+    } catch (...) {
+      smileMutexLock(errorMtx);
+      if (!failed.load()) {
+        error = std::current_exception();
+        failed = true;
+      }
+      smileMutexUnlock(errorMtx);
+      t.result = TICK_INACTIVE;
+    }
+  } else {
+    t.result = TICK_INACTIVE;
+  }
+  // release successors, the first one that becomes ready is kept for this worker
+  for (int s : t.successors) {
+    if (pending[s].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      pushTask(workerId, s);
+    }
+  }
+  if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    // last task of this tick, wake up worker 0 which is waiting for the end of the tick
+    smileCondSignal(workers[0]->wakeCond);
+  }
+}
+
+void cComponentScheduler::workerLoop(int workerId)
+{
+  // ensures log messages created in this thread are sent to the global logger
+  if (logger != NULL) logger->useForCurrentThread();
+  sSchedulerWorker *w = workers[workerId].get();
+  int spins = 0;
+  while (!stopFlag.load()) {
+    int task = popTask(workerId);
+    if (task < 0) task = stealTask(workerId);
+    if (task >= 0) {
+      executeTask(workerId, task);
+      spins = 0;
+      continue;
+    }
+    if (++spins < SCHEDULER_SPIN_COUNT) {
+      smileYield();
+      continue;
+    }
+    w->sleeping = true;
+    if (nQueued.load() == 0 && !stopFlag.load()) {
+      smileCondWait(w->wakeCond);
+    }
+    w->sleeping = false;
+    spins = 0;
+  }
+}
+
+void cComponentScheduler::runTick()
+{
+  sSchedulerWorker *w = workers[0].get();
+  int spins = 0;
+  while (remaining.load(std::memory_order_acquire) > 0) {
+    int task = popTask(0);
+    if (task < 0) task = stealTask(0);
+    if (task >= 0) {
+      executeTask(0, task);
+      spins = 0;
+      continue;
+    }
+    if (++spins < SCHEDULER_SPIN_COUNT) {
+      smileYield();
+      continue;
+    }
+    w->sleeping = true;
+    if (nQueued.load() == 0 && remaining.load() > 0) {
+      smileCondWait(w->wakeCond);
+    }
+    w->sleeping = false;
+    spins = 0;
+  }
+}
+
+void cComponentScheduler::tick(long long tickNr, int EOIcondition, long lastNrun, long tickResultCounts[NUM_TICK_RESULTS])
+{
+  memset(tickResultCounts, 0, sizeof(long) * NUM_TICK_RESULTS);
+  if (!started) start();
+  if (tasks.empty()) return;
+
+  curTickNr = tickNr;
+  curEOIcondition = EOIcondition;
+  curLastNrun = lastNrun;
+  for (size_t i = 0; i < tasks.size(); i++) {
+    pending[i].store(tasks[i].nPredecessors, std::memory_order_relaxed);
+  }
+  nSkipped = 0;
+  remaining.store((int)tasks.size(), std::memory_order_release);
+
+  // distribute the tasks without dependencies over all workers
+  int k = 0;
+  for (size_t i = 0; i < tasks.size(); i++) {
+    if (tasks[i].nPredecessors == 0) {
+      pushTask(k, (int)i);
+      k = (k + 1) % nWorkers;
+    }
+  }
+  runTick();
+
+  if (failed.load()) {
+    std::exception_ptr e = error;
+    error = nullptr;
+    failed = false;
+    std::rethrow_exception(e);
+  }
+  for (size_t i = 0; i < tasks.size(); i++) {
+    tickResultCounts[tasks[i].result]++;
+  }
+}
+
+cComponentScheduler::~cComponentScheduler()
+{
+  stopFlag = true;
+  if (started) {
+    for (int i = 1; i < nWorkers; i++) {
+      smileCondSignal(workers[i]->wakeCond);
+    }
+    for (int i = 1; i < nWorkers; i++) {
+      smileThreadJoin(workers[i]->thread);
+    }
+  }
+  for (auto &w : workers) {
+    smileMutexDestroy(w->queueMtx);
+    smileCondDestroy(w->wakeCond);
+  }
+  smileMutexDestroy(errorMtx);
+}
@@ -3045,7 +3045,7 @@ void cConfigManager::printTypeDfltConfig(const char *selection, int _subtype, in
     }
     SMILE_PRINT(" // Here you can control the amount of detail displayed for the data memory\n  // level configuration. 0 is no information at all, 5 is maximum detail.");
     SMILE_PRINT("printLevelStats = 1");
-    SMILE_PRINT(" // You can set the number of parallel threads (experimental):");
+    SMILE_PRINT(" // You can set the number of parallel threads (0 = one per CPU core):");
     SMILE_PRINT("nThreads = 1");
 
     SMILE_PRINT("\n// ============= component configuration sections begin here ==============\n");
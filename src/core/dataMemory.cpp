@@ -9,6 +9,14 @@
 #include <core/dataMemory.hpp>
 #include <core/componentManager.hpp>
 #include <algorithm>
+#ifdef __WINDOWS
+#include <malloc.h>
+#elif defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// huge pages are usually 2 MiB, an arena backed by huge pages is rounded up to a multiple of this size
+#define DMEM_HUGE_PAGE_SIZE  (2*1024*1024)
 
 #define MODULE "dataMemory"
 
@@ -49,9 +57,73 @@ SMILECOMPONENT_REGCOMP(cDataMemory)
 
 SMILECOMPONENT_CREATE(cDataMemory)
 
-cDataMemory::cDataMemory() : cSmileComponent("dataMemory") {}
+cDataMemory::cDataMemory() : cSmileComponent("dataMemory"), arena(NULL), arenaSize(0), arenaMapped(false) {}
+
+cDataMemory::cDataMemory(const char *_name) : cSmileComponent(_name), arena(NULL), arenaSize(0), arenaMapped(false) {}
+
+void cDataMemory::allocArena(size_t size, bool hugePages)
+{
+  freeArena();
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (hugePages) {
+    size_t mapSize = ((size + DMEM_HUGE_PAGE_SIZE - 1) / DMEM_HUGE_PAGE_SIZE) * DMEM_HUGE_PAGE_SIZE;
+    void *mem = mmap(NULL, mapSize, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    if (mem != MAP_FAILED) {
+      if (madvise(mem, mapSize, MADV_HUGEPAGE) != 0) {
+        SMILE_IWRN(2,"huge pages are not available for the data memory arena, using normal pages");
+      }
+      // anonymous mappings are zero-initialised
+      arena = (char *)mem;
+      arenaSize = mapSize;
+      arenaMapped = true;
+      return;
+    }
+    SMILE_IWRN(2,"could not map %ld bytes for the data memory arena with huge pages, using malloc",(long)mapSize);
+  }
+#else
+  if (hugePages) {
+    SMILE_IWRN(2,"huge pages for the data memory arena are not supported on this platform");
+  }
+#endif
+  void *mem = NULL;
+#ifdef __WINDOWS
+  mem = _aligned_malloc(size, DMEM_ARENA_ALIGN);
+#else
+  if (posix_memalign(&mem, DMEM_ARENA_ALIGN, size) != 0) mem = NULL;
+#endif
+  if (mem == NULL) OUT_OF_MEMORY;
+  memset(mem, 0, size);
+  arena = (char *)mem;
+  arenaSize = size;
+  arenaMapped = false;
+}
+
+void cDataMemory::freeArena()
+{
+  if (arena == NULL) return;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (arenaMapped) {
+    munmap(arena, arenaSize);
+  } else
+#endif
+  {
+#ifdef __WINDOWS
+    _aligned_free(arena);
+#else
+    free(arena);
+#endif
+  }
+  arena = NULL;
+  arenaSize = 0;
+  arenaMapped = false;
+}
 
-cDataMemory::cDataMemory(const char *_name) : cSmileComponent(_name) {}
+cDataMemory::~cDataMemory()
+{
+  // the levels must be destroyed before the arena holding their buffers
+  levels.clear();
+  freeArena();
+}
 
 int cDataMemory::registerLevel(cDataMemoryLevel *l)
 {
@@ -193,20 +265,61 @@ int cDataMemory::myFinaliseInstance()
   // now finalise the levels (allocate storage memory and finalise config):
   if (!levels.empty()) {
     int i;
+    if (getCompMan() != NULL && getCompMan()->getDmemAutoSize()) {
+      for (i=0; i<levels.size(); i++) {
+        levels[i]->setAutoSize(true);
+      }
+    }
+    if (getCompMan() != NULL && getCompMan()->getProfiling()) {
+      for (i=0; i<levels.size(); i++) {
+        levels[i]->enableProfiling();
+      }
+    }
+    // fix the buffer sizes of all levels, finaliseLevel uses them as they are
+    for (i=0; i<levels.size(); i++) {
+      levels[i]->finaliseConfig();
+    }
+    // the buffers of all levels of fixed size are placed in one arena, which is sized up front
+    size_t totalArenaSize = 0;
+    if (getCompMan() == NULL || getCompMan()->getDmemArena()) {
+      for (i=0; i<levels.size(); i++) {
+        totalArenaSize += levels[i]->getArenaSize();
+      }
+      if (totalArenaSize > 0) {
+        allocArena(totalArenaSize, getCompMan() != NULL && getCompMan()->getDmemHugePages());
+      }
+    }
+    char *arenaPos = arena;
     for (i=0; i<levels.size(); i++) {
       // actually finalise now
       SMILE_DBG(3,"finalising level %i (allocating buffer, etc.)",i);
-      int ret = levels[i]->finaliseLevel();
+      size_t levelArenaSize = (arenaPos != NULL) ? levels[i]->getArenaSize() : 0;
+      int ret = levels[i]->finaliseLevel(levelArenaSize > 0 ? arenaPos : NULL);
       if (!ret) {
         SMILE_IERR(1,"level '%s' could not be finalised!");
         return 0;
       }
+      if (arenaPos != NULL) arenaPos += levelArenaSize;
     }
+    size_t bufferSize = getBufferSize();
+    SMILE_IMSG(3,"data memory footprint: %.2f MiB in %i level(s), arena: %.2f MiB%s",
+        (double)bufferSize/1048576.0, (int)levels.size(), (double)arenaSize/1048576.0, arenaMapped ? " (huge pages)" : "");
     // allocate reader config array
     SMILE_DBG(4,"allocating reader positions in %i level(s)",levels.size());
     for (i=0; i<levels.size(); i++) {
       levels[i]->allocReaders();
     }
+    if (getCompMan() == NULL || getCompMan()->getLockFreeLevels()) {
+      // levels written by exactly one component do not need to lock their data for mutual exclusion of writers
+      int nLockFree = 0;
+      for (i=0; i<levels.size(); i++) {
+        long nWriters = std::count_if(wrq.begin(), wrq.end(), [this, i](const sDmLevelRWRequest &rq) {
+          return !strcmp(rq.levelName, levels[i]->getName());
+        });
+        if (nWriters == 1) nLockFree += levels[i]->enableLockFree();
+      }
+      SMILE_IDBG(2,"%i of %i level(s) use lock-free ring buffers",nLockFree,(int)levels.size());
+    }
   } else {
     SMILE_ERR(1,"it makes no sense to finalise a dataMemory without levels! cannot finalise dataMemory '%s'!",getInstName());
     return 0;
@@ -267,10 +380,14 @@ int cDataMemory::setMatrix(int _level, long vIdx, const cMatrix *mat, int specia
 int cDataMemory::checkRead(int _level, long vIdx, int special, int rdId, long len, int *result)
   { if ((_level>=0)&&(_level<levels.size())) return levels[_level]->checkRead(vIdx,special,rdId,len,result); else return -1; }
 
-cVector * cDataMemory::getFrame(int _level, long vIdx, int special, int rdId, int *result)
-  { if ((_level>=0)&&(_level<levels.size())) return levels[_level]->getFrame(vIdx,special,rdId,result); else return NULL; }
-cMatrix * cDataMemory::getMatrix(int _level, long vIdx, long vIdxEnd, int special, int rdId, int *result)
-  { if ((_level>=0)&&(_level<levels.size())) return levels[_level]->getMatrix(vIdx,vIdxEnd,special,rdId,result); else return NULL; }
+cVector * cDataMemory::getFrame(int _level, long vIdx, int special, int rdId, int *result, cVector *vec)
+  { if ((_level>=0)&&(_level<levels.size())) return levels[_level]->getFrame(vIdx,special,rdId,result,vec); else return NULL; }
+cMatrix * cDataMemory::getMatrix(int _level, long vIdx, long vIdxEnd, int special, int rdId, int *result, cMatrix *mat)
+  { if ((_level>=0)&&(_level<levels.size())) return levels[_level]->getMatrix(vIdx,vIdxEnd,special,rdId,result,mat); else return NULL; }
+const cVector * cDataMemory::getFrameView(int _level, long vIdx, cVector *view, int special, int rdId, int *result)
+  { if ((_level>=0)&&(_level<levels.size())) return levels[_level]->getFrameView(vIdx,view,special,rdId,result); else return NULL; }
+const cMatrix * cDataMemory::getMatrixView(int _level, long vIdx, long vIdxEnd, cMatrix *view, int special, int rdId, int *result)
+  { if ((_level>=0)&&(_level<levels.size())) return levels[_level]->getMatrixView(vIdx,vIdxEnd,view,special,rdId,result); else return NULL; }
 
 void cDataMemory::catchupCurR(int _level, int rdId, long _curR /* if >= 0, value that curR[rdId] will be set to! */ ) 
   { if ((_level>=0)&&(_level<levels.size())) levels[_level]->catchupCurR(rdId,_curR); }
@@ -289,6 +406,8 @@ long cDataMemory::getMinR(int _level) const
   { if ((_level>=0)&&(_level<levels.size())) return levels[_level]->getMinR(); else return -1; }
 long cDataMemory::getNreaders(int _level) const
   { if ((_level>=0)&&(_level<levels.size())) return levels[_level]->getNreaders(); else return -1; }
+long long cDataMemory::getFramesWritten(int _level) const
+  { if ((_level>=0)&&(_level<levels.size())) return levels[_level]->getFramesWritten(); else return -1; }
 
 int cDataMemory::namesAreSet(int _level) const
   { if ((_level>=0)&&(_level<levels.size())) { return levels[_level]->namesAreSet(); } else return 0; }
@@ -313,8 +432,53 @@ void cDataMemory::setFrameSizeSec(int _level, double fss)
 void cDataMemory::setBlocksizeWriter(int _level, long _bsw)
   { if ((_level>=0)&&(_level<levels.size())) levels[_level]->setBlocksizeWriter(_bsw);  }
 
+void cDataMemory::setAsyncWriter(int _level)
+  { if ((_level>=0)&&(_level<levels.size())) levels[_level]->setAsyncWriter();  }
+
+void cDataMemory::setReaderLag(int _level, long lag)
+  { if ((_level>=0)&&(_level<levels.size())) levels[_level]->setReaderLag(lag);  }
+
+void cDataMemory::setWakeupComponents(int _level, const std::vector<cSmileComponent *> &readers, cSmileComponent *writer)
+  { if ((_level>=0)&&(_level<levels.size())) levels[_level]->setWakeupComponents(readers, writer);  }
+
 void cDataMemory::printDmLevelStats(int detail)
-  { for (int i=0; i<levels.size(); i++) levels[i]->printLevelStats(detail); }
+{
+  for (int i=0; i<levels.size(); i++) levels[i]->printLevelStats(detail);
+  if (detail) {
+    SMILE_PRINT("==> total size of level buffers: %ld bytes (%.2f MiB), arena: %ld bytes%s",
+        (long)getBufferSize(), (double)getBufferSize()/1048576.0, (long)arenaSize, arenaMapped ? " (huge pages)" : "");
+  }
+}
+
+size_t cDataMemory::getBufferSize() const
+{
+  size_t size = 0;
+  for (int i=0; i<levels.size(); i++) size += levels[i]->getBufferSize();
+  return size;
+}
+
+int cDataMemory::growFullLevels()
+{
+  int n = 0;
+  for (int i=0; i<levels.size(); i++) n += levels[i]->growIfFull();
+  return n;
+}
+
+void cDataMemory::sampleLevelProfiles()
+{
+  for (int i=0; i<levels.size(); i++) levels[i]->sampleProfile();
+}
+
+rapidjson::Value cDataMemory::exportLevelProfiles(rapidjson::MemoryPoolAllocator<> &allocator) const
+{
+  rapidjson::Value ret(rapidjson::kArrayType);
+  for (int i=0; i<levels.size(); i++) {
+    rapidjson::Value level = levels[i]->exportProfile(allocator);
+    level.AddMember("dataMemory", rapidjson::Value(getInstName(), allocator), allocator);
+    ret.PushBack(level, allocator);
+  }
+  return ret;
+}
 
 long cDataMemory::secToVidx(int _level, double sec) const
   { if ((_level>=0)&&(_level<levels.size())) return levels[_level]->secToVidx(sec); else return -1; }
@@ -340,13 +504,13 @@ Log message fields:
 -DATA
 */
 
-void datamemoryLogger(const char *name, const char*dir, long cnt, long vIdx0, long vIdx, long rIdx, long nT, int special, long curR, long curW, long EOI, int nReaders, long *curRr, cVector *vec)
+void datamemoryLogger(const char *name, const char*dir, long cnt, long vIdx0, long vIdx, long rIdx, long nT, int special, long curR, long curW, long EOI, int nReaders, const std::atomic<long> *curRr, cVector *vec)
 {
 #ifdef DM_DEBUG_LOGGER
   long i;
   fprintf(stderr,"xxDMemLOGxx:: level:%s dir:%s cnt:%i vIdx0:%i vIdx:%i rIdx:%i nT:%i special:%i EOI:%i curR:%i curW:%i :: nReaders:%i ",name,dir,cnt,vIdx0,vIdx,rIdx,nT,special,EOI,curR,curW,nReaders);
   for (i=0; i<nReaders; i++) {
-    fprintf(stderr,"curRr%i:%i ",i,curRr[i]);
+    fprintf(stderr,"curRr%i:%i ",i,curRr[i].load());
   }
   fprintf(stderr,"::: DATA(%i) ::: ",vec->N);
   for (i=0; i<vec->N; i++) {
@@ -356,13 +520,13 @@ void datamemoryLogger(const char *name, const char*dir, long cnt, long vIdx0, lo
 #endif
 }
 
-void datamemoryLogger(const char *name, long vIdx0, long vIdx, long rIdx, long nT, int special, long curR, long curW, long EOI, int nReaders, long *curRr, cMatrix *mat)
+void datamemoryLogger(const char *name, long vIdx0, long vIdx, long rIdx, long nT, int special, long curR, long curW, long EOI, int nReaders, const std::atomic<long> *curRr, cMatrix *mat)
 {
 #ifdef DM_DEBUG_LOGGER
   long i,j;
   fprintf(stderr,"xxDMemLOGxx:: level:%s dir:%s cnt:%i vIdx0:%i vIdx:%i rIdx:%i nT:%i special:%i EOI:%i curR:%i curW:%i :: nReaders:%i ",name,dir,cnt,vIdx0,vIdx,rIdx,nT,special,EOI,curR,curW,nReaders);
   for (i=0; i<nReaders; i++) {
-    fprintf(stderr,"curRr%i:%i ",i,curRr[i]);
+    fprintf(stderr,"curRr%i:%i ",i,curRr[i].load());
   }
   fprintf(stderr,"::: DATA[%ix%i] ::: ",vec->N,vec->nT); // row x column
   for (j=0; j<vec->nT; j++) {
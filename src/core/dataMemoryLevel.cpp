@@ -16,6 +16,21 @@
 
 #define MODULE "dataMemoryLevel"
 
+/**** allocation statistics *********
+ **************************************/
+
+static std::atomic<long long> dmemAllocationCount(0);
+
+void dmemCountAllocation()
+{
+  dmemAllocationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+long long dmemGetAllocationCount()
+{
+  return dmemAllocationCount.load(std::memory_order_relaxed);
+}
+
 /**** field meta information *********
    meta information for one field
  **************************************/
@@ -44,11 +59,13 @@ FieldMetaInfo::~FieldMetaInfo() {
 }
 
 cVectorMeta::cVectorMeta() : ID(0), text(NULL), custom(NULL), customLength(0) {
+  dmemCountAllocation();
   std::fill(iData, iData + 8, 0);
   std::fill(fData, fData + 8, 0.0);
 }
 
 cVectorMeta::cVectorMeta(const cVectorMeta &v) {
+  dmemCountAllocation();
   ID = v.ID;
   std::copy(v.iData, v.iData + 8, iData);
   std::copy(v.fData, v.fData + 8, fData);
@@ -83,20 +100,32 @@ cVectorMeta::cVectorMeta(cVectorMeta &&v) {
 }
 
 cVectorMeta &cVectorMeta::operator=(const cVectorMeta &v) {
+  if (this == &v) return *this;
   ID = v.ID;
   std::copy(v.iData, v.iData + 8, iData);
   std::copy(v.fData, v.fData + 8, fData);
 
-  if (text != NULL) free(text);
-  if (v.text != NULL) {      
-    text = strdup(v.text);
+  // reuse the existing text and custom buffers if they are large enough
+  if ((text != NULL)&&(v.text != NULL)&&(strlen(text) >= strlen(v.text))) {
+    strcpy(text, v.text);
   } else {
-    text = NULL;
+    if (text != NULL) free(text);
+    if (v.text != NULL) {      
+      text = strdup(v.text);
+      dmemCountAllocation();
+    } else {
+      text = NULL;
+    }
   }
 
+  if ((customLength>0)&&(custom != NULL)&&(customLength == v.customLength)&&(v.custom != NULL)) {
+    memcpy(custom, v.custom, v.customLength);
+    return *this;
+  }
   // if customLength <= 0, we are not supposed to free custom
   if ((customLength>0)&&(custom != NULL)) free(custom); 
   if ((v.customLength > 0)&&(v.custom != NULL)) {
+    dmemCountAllocation();
     custom = malloc(v.customLength);
     memcpy(custom, v.custom, v.customLength);
     customLength = v.customLength;
@@ -354,6 +383,7 @@ TimeMetaInfo::TimeMetaInfo(TimeMetaInfo &&tm) :
 {}
 
 TimeMetaInfo &TimeMetaInfo::operator=(const TimeMetaInfo &tm) {
+  if (this == &tm) return *this;
   filled = tm.filled;
   vIdx = tm.vIdx;
   period = tm.period;
@@ -362,7 +392,8 @@ TimeMetaInfo &TimeMetaInfo::operator=(const TimeMetaInfo &tm) {
   framePeriod = tm.framePeriod;
   smileTime = tm.smileTime;
   if (tm.metadata != NULL) {
-    metadata = std::unique_ptr<cVectorMeta>(new cVectorMeta(*tm.metadata));
+    if (metadata != NULL) *metadata = *tm.metadata; // reuse the existing object
+    else metadata = std::unique_ptr<cVectorMeta>(new cVectorMeta(*tm.metadata));
   } else {
     metadata = NULL;
   }
@@ -383,16 +414,41 @@ TimeMetaInfo &TimeMetaInfo::operator=(TimeMetaInfo &&tm) {
 
 /******* datatypes ************/
 
+void cVector::useOwnData(long n, bool zero) {
+  if ((n > 0)&&((dataOwn == NULL)||(n > nDataAlloc))) {
+    if (dataOwn != NULL) free(dataOwn);
+    dataOwn = (FLOAT_DMEM*)calloc(1,sizeof(FLOAT_DMEM)*n);
+    if (dataOwn==NULL) OUT_OF_MEMORY;
+    nDataAlloc = n;
+    dmemCountAllocation();
+  } else if ((zero)&&(n > 0)) {
+    memset(dataOwn, 0, sizeof(FLOAT_DMEM)*n);
+  }
+  data = dataOwn;
+  dataAlien = 0;
+}
+
+void cVector::useOwnTimeMeta(long n) {
+  if ((n > 0)&&((tmetaOwn == NULL)||(n > nTmetaAlloc))) {
+    if (tmetaOwn != NULL) delete[] tmetaOwn;
+    tmetaOwn = new TimeMetaInfo[n]();
+    if (tmetaOwn == NULL) OUT_OF_MEMORY;
+    nTmetaAlloc = n;
+    dmemCountAllocation();
+  }
+  tmeta = tmetaOwn;
+  tmetaAlien = 0;
+}
+
 cVector::cVector(int lN, bool noTimeMeta) :
-  N(0), data(NULL), fmeta(NULL), tmeta(NULL), tmetaAlien(0)
+  tmetaAlien(0), dataAlien(0), dataOwn(NULL), nDataAlloc(0), tmetaOwn(NULL), nTmetaAlloc(0),
+  N(0), tmeta(NULL), fmeta(NULL), data(NULL)
 {
   if (lN>0) {
-    data = (FLOAT_DMEM*)calloc(1,sizeof(FLOAT_DMEM)*lN);
-    if (data==NULL) OUT_OF_MEMORY;
+    useOwnData(lN);
     N = lN;
     if (!noTimeMeta) {
-      tmeta = new TimeMetaInfo[1]();
-      if (tmeta == NULL) OUT_OF_MEMORY;
+      useOwnTimeMeta(1);
     }
   }
 }
@@ -422,51 +478,52 @@ std::string cVector::name(int n, int *lN) const
 }
 
 void cVector::setTimeMeta(TimeMetaInfo *xtmeta) {
-  if ((tmeta != NULL)&&(!tmetaAlien)) {
-    delete[] tmeta;
-  }
   tmetaAlien = 1;
   tmeta = xtmeta;
 }
 
 void cVector::copyTimeMeta(const TimeMetaInfo *xtmeta) {
-  if ((tmeta != NULL)&&(!tmetaAlien)) {
-    delete[] tmeta;
-  }
   if (xtmeta != NULL) {
-    tmeta = new TimeMetaInfo[1] { *xtmeta };
+    useOwnTimeMeta(1);
+    tmeta[0] = *xtmeta;
   } else {
     tmeta = NULL;
+    tmetaAlien = 0;
   }
-  tmetaAlien = 0;
 }
 
-cVector::~cVector() {
-  if (data!=NULL) free(data);
-  if ((tmeta!=NULL)&&(!tmetaAlien)) {
-    delete[] tmeta;
+void cVector::borrowData(FLOAT_DMEM *_data, long lN, TimeMetaInfo *xtmeta) {
+  data = _data;
+  dataAlien = 1;
+  N = lN;
+  if (xtmeta != NULL) {
+    tmeta = xtmeta;
+    tmetaAlien = 1;
+  } else {
+    useOwnTimeMeta(1);
   }
 }
 
-cMatrix::~cMatrix()
-{
-  if ((tmeta!=NULL)&&(!tmetaAlien)) {
-    delete[] tmeta;
-  }
-  tmeta = NULL;
+void cVector::allocData(long lN) {
+  useOwnData(lN, false);
+  useOwnTimeMeta(1);
+  N = lN;
+}
+
+cVector::~cVector() {
+  if (dataOwn!=NULL) free(dataOwn);
+  if (tmetaOwn!=NULL) delete[] tmetaOwn;
 }
 
 cMatrix::cMatrix(int lN, int lnT, bool noTimeMeta) :
   cVector(0), nT(0)
 {
   if ((lN>0)&&(lnT>0)) {
-    data = (FLOAT_DMEM*)calloc(1,sizeof(FLOAT_DMEM)*lN*lnT);
-    if (data==NULL) OUT_OF_MEMORY;
+    useOwnData((long)lN*lnT);
     N = lN;
     nT = lnT;
     if (!noTimeMeta) {
-      tmeta = new TimeMetaInfo[lnT];
-      if (tmeta == NULL) OUT_OF_MEMORY;
+      useOwnTimeMeta(lnT);
     }
   }
 }
@@ -501,7 +558,7 @@ cMatrix * cMatrix::getRow(long R, cMatrix *r) const {
   bool noTimeMeta = tmeta == NULL;
   if (r==NULL) r = new cMatrix(1,nT,noTimeMeta);
   else {
-    if (r->nT != nT) { delete r; r = new cMatrix(1,nT,noTimeMeta); }
+    if (r->nT != nT) r->allocData(1,nT);
   }
   long nn = MIN(nT,r->nT);
   FLOAT_DMEM *df = data+R;
@@ -538,34 +595,46 @@ void cMatrix::setRow(long R, const cMatrix *row) { // NOTE: set row does not cha
 }
 
 int cMatrix::resize(long _new_nT) {
-  int ret=1;
   if (_new_nT < nT) return 1;
 
-  FLOAT_DMEM *tmp = (FLOAT_DMEM *)crealloc(data, _new_nT*sizeof(FLOAT_DMEM)*N, nT*sizeof(FLOAT_DMEM)*N);
-  if (tmp==NULL) ret = 0;
-  else data = tmp;
-
-  if (ret) {
-    // tmeta
-    if (tmeta != NULL) {
-      TimeMetaInfo *old = tmeta;
-      tmeta = new (std::nothrow) TimeMetaInfo[_new_nT];
-      if (tmeta == NULL) { ret=0; tmeta = old; }
-      else {          
-        if (!tmetaAlien) {
-          std::move(old, old + nT, tmeta);
-          delete[] old;
-        } else {
-          std::copy(old, old + nT, tmeta);
-        }
-        tmetaAlien = 0;
-      }
+  long nOld = nT*N;
+  long nNew = _new_nT*N;
+  if (nNew > 0) {
+    if ((dataOwn == NULL)||(nNew > nDataAlloc)) {
+      FLOAT_DMEM *tmp;
+      // borrowed data cannot be reallocated, it is copied to a buffer owned by this matrix below
+      if (dataAlien) tmp = (FLOAT_DMEM *)malloc(nNew*sizeof(FLOAT_DMEM));
+      else tmp = (FLOAT_DMEM *)realloc(dataOwn, nNew*sizeof(FLOAT_DMEM));
+      if (tmp==NULL) return 0;
+      if ((dataAlien)&&(dataOwn != NULL)) free(dataOwn);
+      dataOwn = tmp;
+      nDataAlloc = nNew;
+      dmemCountAllocation();
+    }
+    if ((dataAlien)&&(data != NULL)) memcpy(dataOwn, data, nOld*sizeof(FLOAT_DMEM));
+    memset(dataOwn+nOld, 0, (nNew-nOld)*sizeof(FLOAT_DMEM));
+    data = dataOwn;
+    dataAlien = 0;
+  }
+
+  // tmeta
+  if ((tmeta != NULL)&&(_new_nT > 0)) {
+    if ((tmetaOwn == NULL)||(_new_nT > nTmetaAlloc)) {
+      TimeMetaInfo *tm = new (std::nothrow) TimeMetaInfo[_new_nT];
+      if (tm == NULL) return 0;
+      if (!tmetaAlien) std::move(tmeta, tmeta + nT, tm);
+      if (tmetaOwn != NULL) delete[] tmetaOwn;
+      tmetaOwn = tm;
+      nTmetaAlloc = _new_nT;
+      dmemCountAllocation();
     }
+    if (tmetaAlien) std::copy(tmeta, tmeta + nT, tmetaOwn);
+    tmeta = tmetaOwn;
+    tmetaAlien = 0;
   }
 
-  if (ret) nT = _new_nT;
-
-  return ret;
+  nT = _new_nT;
+  return 1;
 }
 
 void cMatrix::copyData(void *dest, long destIdx, void *src, long srcIdx, long nT, long N, bool zeroSource) {
@@ -592,25 +661,54 @@ void cMatrix::copyFrom(void *src, long srcIdx, long destIdx, long nT, bool zeroS
 }
 
 void cMatrix::setTimeMeta(TimeMetaInfo *_tmeta) {
-  if ((tmeta != NULL)&&(!tmetaAlien)) {
-    delete[] tmeta;
-    tmetaAlien = 1;
-  }
+  tmetaAlien = 1;
   tmeta = _tmeta;
 }
 
 void cMatrix::copyTimeMeta(const TimeMetaInfo *_tmeta, long _nT) {
   if (_nT == -1) _nT = nT;
-  if ((tmeta != NULL)&&(!tmetaAlien)) {
-    delete[] tmeta;
-  }
   if (_tmeta != NULL) {
-    tmeta = new TimeMetaInfo[nT];
-    std::copy(_tmeta, _tmeta + (std::min)(nT, _nT), tmeta);
+    long n = (std::min)(nT, _nT);
+    useOwnTimeMeta(nT);
+    std::copy(_tmeta, _tmeta + n, tmeta);
+    std::fill(tmeta + n, tmeta + nT, TimeMetaInfo());
   } else {
     tmeta = NULL;
+    tmetaAlien = 0;
+  }
+}
+
+void cMatrix::borrowData(FLOAT_DMEM *_data, long lN, long lnT, TimeMetaInfo *_tmeta, bool noTimeMeta) {
+  data = _data;
+  dataAlien = 1;
+  N = lN;
+  if (_tmeta != NULL) {
+    tmeta = _tmeta;
+    tmetaAlien = 1;
+  } else if (noTimeMeta) {
+    tmeta = NULL;
+    tmetaAlien = 0;
+  } else {
+    useOwnTimeMeta(lnT);
+  }
+  nT = lnT;
+}
+
+void cMatrix::allocData(long lN, long lnT) {
+  useOwnData(lN*lnT, false);
+  useOwnTimeMeta(lnT);
+  N = lN;
+  nT = lnT;
+}
+
+void cMatrix::getSquashedTimeMeta(TimeMetaInfo *tm, double period) const {
+  if (tmeta != NULL) {
+    *tm = tmeta[0];
+    tm->framePeriod = tmeta[0].period;
+    if (period != -1.0)
+      tm->period = period;
+    tm->lengthSec = tmeta[nT-1].time - tmeta[0].time + tmeta[nT-1].lengthSec;
   }
-  tmetaAlien = 0;
 }
 
 // convert a matrix tmeta to a vector tmeta spanning the whole matrix by adjusting size, period, etc.
@@ -764,14 +862,31 @@ sDmLevelConfig::~sDmLevelConfig() {
 cDataMemoryLevel::cDataMemoryLevel(int _levelId, sDmLevelConfig &cfg, const char *_name) :
   myId(_levelId), _parent(NULL),
   lcfg(_name, cfg), fmetaNalloc(0),
-  data(NULL), tmeta(NULL), EOI(0), EOIcondition(0),
-  curW(0), curR(0), curRr(NULL), nReaders(0), 
-  minRAtLastGrowth(0), nCurRdr(0), writeReqFlag(0)
+  data(NULL), tmeta(NULL), inArena(false), segT(0),
+  profiling(false), nFramesWritten(0), nFramesRead(0), maxReaderLag(0),
+  autoSize(false), nTconfig(0), configFinalised(false), readerLag(0),
+  EOI(0), EOIcondition(0),
+  curW(0), curR(0), curRr(NULL), pinRr(NULL), curWres(0), nReaders(0), 
+  minRAtLastGrowth(0), nCurRdr(0), writeReqFlag(0),
+  lockFree(false), asyncWriter(false), wakeOnRead(NULL)
 {
   //if ((nT == 0)&&(cfg.lenSec > 0.0)&&(cfg.T>0.0)) { nT = (long)ceil( cfg.lenSec / cfg.T ); }
   if (lcfg.T < 0.0) COMP_ERR("cannot create dataMemoryLevel with period (%f) < 0.0",lcfg.T);
   if (lcfg.nT <= 0) COMP_ERR("cannot create empty dataMemoryLevel nT = %i <= 0",lcfg.nT);
   lcfg.fmeta = &fmeta;
+  std::fill(fillHist, fillHist + DMEM_FILL_HIST_BINS, 0);
+}
+
+void cDataMemoryLevel::wakeupReaders() const {
+  for (cSmileComponent *c : wakeOnWrite) {
+    c->wakeup();
+  }
+}
+
+void cDataMemoryLevel::wakeupWriter() const {
+  if (wakeOnRead != NULL) {
+    wakeOnRead->wakeup();
+  }
 }
 
 void cDataMemoryLevel::checkCurRr() {
@@ -780,8 +895,8 @@ void cDataMemoryLevel::checkCurRr() {
     for (int i=0; i<nReaders; i++) {
       // if any curRr is behind global curR, set it to curR
       if (curRr[i] < curR) {
-        SMILE_DBG(3,"(level='%s') auto increasing reader %i 's read index to %i",getName(),i,curR);
-        curRr[i] = curR;
+        SMILE_DBG(3,"(level='%s') auto increasing reader %i 's read index to %i",getName(),i,(long)curR);
+        curRr[i] = curR.load();
       }
       // new global curR is minimum of all curRr
       if (curRr[i] < newCurR) newCurR=curRr[i];
@@ -790,9 +905,68 @@ void cDataMemoryLevel::checkCurRr() {
   }
 }
 
+long cDataMemoryLevel::getReadIdxLF(int rdId) const {
+  long r = curR.load(std::memory_order_acquire);
+  if ((rdId >= 0)&&(rdId < nReaders)) {
+    long rr = curRr[rdId].load(std::memory_order_acquire);
+    return rr > r ? rr : r;
+  }
+  if (nReaders > 0) {
+    long minR = (std::numeric_limits<long>::max)();
+    for (int i=0; i<nReaders; i++) {
+      long rr = curRr[i].load(std::memory_order_acquire);
+      if (rr < minR) minR = rr;
+    }
+    if (minR > r) r = minR;
+  }
+  return r;
+}
+
+void cDataMemoryLevel::commitReadIdxLF(int rdId, long newCurR) {
+  if (newCurR < 0) return;
+  if ((rdId >= 0)&&(rdId < nReaders)) {
+    // only the reader itself modifies its read index (apart from catchupCurR)
+    curRr[rdId].store(newCurR, std::memory_order_release);
+  } else {
+    // unregistered readers may run in parallel, the global read index is only ever increased
+    long r = curR.load(std::memory_order_relaxed);
+    while (newCurR > r && !curR.compare_exchange_weak(r, newCurR, std::memory_order_release, std::memory_order_relaxed));
+  }
+}
+
+long cDataMemoryLevel::pinFrameLF(int rdId, long vIdx, long *w) {
+  pinRr[pinSlotLF(rdId)].store(vIdx, std::memory_order_seq_cst);
+  long wres = curWres.load(std::memory_order_seq_cst);
+  // a write in progress which would overwrite the frame has either not seen the pin and is
+  // going to be published, or it has seen the pin and is rolled back: wait until it is decided
+  while ((vIdx < wres-lcfg.nT)&&(vIdx >= *w-lcfg.nT)) {
+    smileYield();
+    *w = curW.load(std::memory_order_acquire);
+    wres = curWres.load(std::memory_order_seq_cst);
+  }
+  return wres;
+}
+
+long cDataMemoryLevel::getLowestPinLF() const {
+  long minPin = (std::numeric_limits<long>::max)();
+  for (int i=0; i<=nReaders; i++) {
+    long p = pinRr[i].load(std::memory_order_seq_cst);
+    if (p < minPin) minPin = p;
+  }
+  return minPin;
+}
+
+int cDataMemoryLevel::enableLockFree() {
+  if (!lcfg.finalised || !lcfg.isRb || lcfg.growDyn || lcfg.noHang == 2) return 0;
+  lockFree = true;
+  SMILE_DBG(3,"level '%s' switched to lock-free single-writer mode",getName());
+  return 1;
+}
+
 int cDataMemoryLevel::growLevel(long newSize)
 {
   SMILE_DBG(3,"increasing buffer size of level '%s' from nT=%i to nT=%i",getName(),lcfg.nT,newSize);
+  if (segT > 0) return addSegments(newSize);
   // resize underlying data buffer
   if (!data->resize(newSize)) {
     SMILE_ERR(1,"could not increase buffer size of level '%s' from nT=%i to nT=%i. Out of memory.",getName(),lcfg.nT,newSize);
@@ -841,44 +1015,145 @@ int cDataMemoryLevel::growLevel(long newSize)
       free(tmp);
     }
 
-    if (data->tmeta != NULL) {
-      // also re-order data->tmeta in the same way
-      TimeMetaInfo *tmetatmp = new TimeMetaInfo[lcfg.nT];
-      std::move(data->tmeta, data->tmeta + lcfg.nT, tmetatmp);
-      std::fill(data->tmeta, data->tmeta + lcfg.nT, TimeMetaInfo());
-      for (long t = curR; t < curW; t++) {
-        data->tmeta[t % newSize] = std::move(tmetatmp[t % lcfg.nT]);
-      }
-      delete[] tmetatmp;
-
-      // resize tmeta
+    if (tmeta != NULL) {
+      // resize and re-order tmeta in the same way
       TimeMetaInfo * tmeta_new = new TimeMetaInfo[newSize]();
       for (long t = curR; t < curW; t++) {
-        tmeta_new[t % newSize] = tmeta[t % lcfg.nT];
+        tmeta_new[t % newSize] = std::move(tmeta[t % lcfg.nT]);
       }
-      delete[] tmeta;
+      freeTmeta();
       tmeta = tmeta_new;
     }
 
     minRAtLastGrowth = curR;
   } else {
-    if (data->tmeta != NULL) {
+    if (tmeta != NULL) {
       // for non-ring buffers, no re-ordering of the data is needed
       // resize tmeta
       TimeMetaInfo * tmeta_new = new TimeMetaInfo[newSize]();
       std::copy(tmeta, tmeta + lcfg.nT, tmeta_new);
-      delete[] tmeta;
+      freeTmeta();
       tmeta = tmeta_new;
     }
   }
   lcfg.lenSec *= (double)newSize / lcfg.nT;
   lcfg.nT = newSize;    
+  // the grown buffers are allocated on the heap (data->resize copies borrowed arena memory)
+  inArena = false;
   return 1;  
 }
 
+int cDataMemoryLevel::addSegments(long newSize)
+{
+  long n = segData.size() * segT;
+  while (n < newSize) {
+    FLOAT_DMEM *d = (FLOAT_DMEM *)calloc(segT * lcfg.N, sizeof(FLOAT_DMEM));
+    if (d == NULL) {
+      SMILE_ERR(1,"could not increase buffer size of level '%s' from nT=%i to nT=%i. Out of memory.",getName(),n,n+segT);
+      return 0;
+    }
+    segData.push_back(d);
+    if (!lcfg.noTimeMeta) segTmeta.push_back(new TimeMetaInfo[segT]());
+    n += segT;
+  }
+  if (lcfg.nT > 0) lcfg.lenSec *= (double)n / lcfg.nT;
+  lcfg.nT = n;
+  return 1;
+}
+
+void cDataMemoryLevel::freeSegments()
+{
+  for (FLOAT_DMEM *d : segData) free(d);
+  for (TimeMetaInfo *tm : segTmeta) delete[] tm;
+  segData.clear();
+  segTmeta.clear();
+}
+
+void cDataMemoryLevel::freeTmeta()
+{
+  if (tmeta == NULL) return;
+  if (inArena) {
+    // memory is owned by the arena, only destroy the objects
+    for (long i=0; i<lcfg.nT; i++) tmeta[i].~TimeMetaInfo();
+  } else {
+    delete[] tmeta;
+  }
+  tmeta = NULL;
+}
+
+int cDataMemoryLevel::growIfFull()
+{
+  if (!autoSize || !lcfg.finalised || !lcfg.isRb) return 0;
+  if (lockFree) {
+    if (getNFree() < lcfg.blocksizeWriter) {
+      SMILE_WRN(2,"automatically sized lock-free level '%s' is full (%ld frames) and cannot grow, set its buffer size (nT) in the configuration",getName(),lcfg.nT);
+    }
+    return 0;
+  }
+  // exclusive write lock, as for setFrame / setMatrix
+  smileMutexLock(RWstatMtx);
+  writeReqFlag = 1;
+  smileMutexUnlock(RWstatMtx);
+  smileMutexLock(RWmtx);
+  smileMutexLock(RWstatMtx);
+  writeReqFlag = 0;
+  smileMutexUnlock(RWstatMtx);
+  smileMutexLock(RWptrMtx);
+  int ret = 0;
+  long oldSize = lcfg.nT;
+  if (lcfg.nT - (curW - curR) < lcfg.blocksizeWriter) {
+    ret = growLevel(lcfg.nT * 2);
+  }
+  smileMutexUnlock(RWptrMtx);
+  smileMutexUnlock(RWmtx);
+  if (ret) SMILE_MSG(3,"automatically sized level '%s' is full, increased buffer size from %ld to %ld frames",getName(),oldSize,lcfg.nT);
+  return ret;
+}
+
+rapidjson::Value cDataMemoryLevel::exportProfile(rapidjson::MemoryPoolAllocator<> &allocator) const
+{
+  rapidjson::Value ret(rapidjson::kObjectType);
+  long long bytesPerFrame = (long long)(sizeof(FLOAT_DMEM) * lcfg.N);
+  ret.AddMember("name", rapidjson::Value(getName(), allocator), allocator);
+  ret.AddMember("nT", (int64_t)lcfg.nT, allocator);
+  ret.AddMember("N", (int64_t)lcfg.N, allocator);
+  ret.AddMember("isRb", lcfg.isRb != 0, allocator);
+  ret.AddMember("nReaders", nReaders, allocator);
+  ret.AddMember("bufferBytes", (uint64_t)getBufferSize(), allocator);
+  ret.AddMember("framesWritten", (int64_t)nFramesWritten.load(), allocator);
+  ret.AddMember("framesRead", (int64_t)nFramesRead.load(), allocator);
+  ret.AddMember("bytesWritten", (int64_t)(nFramesWritten.load() * bytesPerFrame), allocator);
+  ret.AddMember("bytesRead", (int64_t)(nFramesRead.load() * bytesPerFrame), allocator);
+  ret.AddMember("maxReaderLag", (int64_t)maxReaderLag, allocator);
+  rapidjson::Value hist(rapidjson::kArrayType);
+  for (int i=0; i<DMEM_FILL_HIST_BINS; i++) hist.PushBack((int64_t)fillHist[i], allocator);
+  ret.AddMember("fillHistogram", hist, allocator);
+  return ret;
+}
+
+void cDataMemoryLevel::sampleProfile()
+{
+  if (!profiling || !lcfg.finalised) return;
+  long w = curW.load(std::memory_order_acquire);
+  long r = 0;
+  if (lcfg.isRb) {
+    r = lockFree ? getReadIdxLF() : curR.load(std::memory_order_acquire);
+    if (r < w - lcfg.nT) r = w - lcfg.nT;
+  }
+  long fill = w - r;
+  int bin = (int)(fill * DMEM_FILL_HIST_BINS / lcfg.nT);
+  if (bin >= DMEM_FILL_HIST_BINS) bin = DMEM_FILL_HIST_BINS - 1;
+  if (bin < 0) bin = 0;
+  fillHist[bin]++;
+  if (nReaders > 0) {
+    long lag = w - (lockFree ? getReadIdxLF() : curR.load(std::memory_order_acquire));
+    if (lag > maxReaderLag) maxReaderLag = lag;
+  }
+}
+
 long cDataMemoryLevel::validateIdxW(long *vIdx, int special)
 {
-  SMILE_DBG(5,"validateIdxW ('%s')\n         vidx=%i special=%i curW=%i curR=%i nT=%i",getName(),*vIdx,special,curW,curR,lcfg.nT);
+  SMILE_DBG(5,"validateIdxW ('%s')\n         vidx=%i special=%i curW=%i curR=%i nT=%i",getName(),*vIdx,special,(long)curW,(long)curR,lcfg.nT);
 
   if (special == DMEM_IDX_CURW) *vIdx = curW;
   else if (special != -1) return -1;
@@ -909,7 +1184,7 @@ long cDataMemoryLevel::validateIdxW(long *vIdx, int special)
         SMILE_DBG(3,"data lost while writing value to level '%s'",getName());
         return -1;
       } 
-      if (!growLevel(lcfg.nT * 2)) return -1;
+      if (!growLevel(segT > 0 ? *vIdx + 1 : lcfg.nT * 2)) return -1;
     }
     if (*vIdx==curW) curW++;
     return *vIdx;
@@ -918,13 +1193,13 @@ long cDataMemoryLevel::validateIdxW(long *vIdx, int special)
 
 long cDataMemoryLevel::validateIdxRangeW(long *vIdx, long vIdxEnd, int special)
 {
-  SMILE_DBG(5,"validateIdxRangeW ('%s')\n         vidx=%i vidxend=%i special=%i curW=%i curR=%i nT=%i",getName(),*vIdx,vIdxEnd,special,curW,curR,lcfg.nT);
+  SMILE_DBG(5,"validateIdxRangeW ('%s')\n         vidx=%i vidxend=%i special=%i curW=%i curR=%i nT=%i",getName(),*vIdx,vIdxEnd,special,(long)curW,(long)curR,lcfg.nT);
 
   if (vIdxEnd < *vIdx) { SMILE_ERR(3,"validateIdxRangeW: vIdxEnd (%i) cannot be smaller than vIdx (%i)!",vIdxEnd,*vIdx); return -1; }
   if (special == DMEM_IDX_CURW) { vIdxEnd -= *vIdx; *vIdx = curW; vIdxEnd += curW; }
   else if (special != -1) return -1;
   if (*vIdx < 0 || *vIdx > curW) return -1;
-  SMILE_DBG(5,"validateIdxRangeW(2) vidx=%i vidxend=%i special=%i curW=%i curR=%i nT=%i",*vIdx,vIdxEnd,special,curW,curR,lcfg.nT);
+  SMILE_DBG(5,"validateIdxRangeW(2) vidx=%i vidxend=%i special=%i curW=%i curR=%i nT=%i",*vIdx,vIdxEnd,special,(long)curW,(long)curR,lcfg.nT);
 
   if (lcfg.isRb) {
     if (vIdxEnd-*vIdx > (lcfg.nT - (curW-curR))) {
@@ -943,7 +1218,7 @@ long cDataMemoryLevel::validateIdxRangeW(long *vIdx, long vIdxEnd, int special)
     }
     if (vIdxEnd>=curW) curW = vIdxEnd;
     if ((lcfg.noHang==2)&&(vIdxEnd-*vIdx > (lcfg.nT - (curW-curR)))) {
-      SMILE_DBG(3,"data lost while writing matrix to ringbuffer level '%s' (vIdxEnd %i, *vIdx %i, lcfg.nT %i, curW %i, curR %i)",getName(),vIdxEnd,*vIdx,lcfg.nT,curW,curR);
+      SMILE_DBG(3,"data lost while writing matrix to ringbuffer level '%s' (vIdxEnd %i, *vIdx %i, lcfg.nT %i, curW %i, curR %i)",getName(),vIdxEnd,*vIdx,lcfg.nT,(long)curW,(long)curR);
     }
     return *vIdx%lcfg.nT;
   } else { // no ringbuffer
@@ -955,6 +1230,7 @@ long cDataMemoryLevel::validateIdxRangeW(long *vIdx, long vIdxEnd, int special)
       long newS = lcfg.nT*2;
       if (newS < vIdxEnd) newS = vIdxEnd+10;
       if (newS < *vIdx) newS = *vIdx+10;
+      if (segT > 0) newS = vIdxEnd;  // segments are appended without copying, no need to reserve more
 
       if (!growLevel(newS)) return -1;
     }
@@ -965,10 +1241,10 @@ long cDataMemoryLevel::validateIdxRangeW(long *vIdx, long vIdxEnd, int special)
 
 long cDataMemoryLevel::validateIdxR(long *vIdx, int special, int rdId, int noUpd)
 {
-  long *_curR;
+  std::atomic<long> *_curR;
   if ((rdId >= 0)&&(rdId<nReaders)) _curR = curRr+rdId;
   else _curR=&curR;
-  SMILE_DBG(5,"validateIdxR ('%s')\n         vidx=%i special=%i curW=%i curR=%i nT=%i",getName(),*vIdx,special,curW,*_curR,lcfg.nT);
+  SMILE_DBG(5,"validateIdxR ('%s')\n         vidx=%i special=%i curW=%i curR=%i nT=%i",getName(),*vIdx,special,(long)curW,_curR->load(),lcfg.nT);
 
   if ((lcfg.isRb) && (*_curR < curW-lcfg.nT)) { *_curR = curW-lcfg.nT; SMILE_DBG(3,"validateIdxR: rb data possibly lost, curR < curW-nT, curR was automatically increased!"); }
   if (special == DMEM_IDX_CURR) *vIdx = *_curR;
@@ -1004,11 +1280,11 @@ long cDataMemoryLevel::validateIdxR(long *vIdx, int special, int rdId, int noUpd
 // Or we get rid of special indices completely as it does not seem to be used anywhere (except in unit tests).
 long cDataMemoryLevel::validateIdxRangeR(long actualVidx, long *vIdx, long vIdxEnd, int special, int rdId, int noUpd, int *padEnd)
 {
-  SMILE_DBG(5,"validateIdxRangeR ('%s')\n         vidx=%i vidxend=%i special=%i curW=%i curR=%i nT=%i",getName(),*vIdx,vIdxEnd,special,curW,curR,lcfg.nT);
-  long *_curR;
+  SMILE_DBG(5,"validateIdxRangeR ('%s')\n         vidx=%i vidxend=%i special=%i curW=%i curR=%i nT=%i",getName(),*vIdx,vIdxEnd,special,(long)curW,(long)curR,lcfg.nT);
+  std::atomic<long> *_curR;
   if ((rdId >= 0)&&(rdId<nReaders)) _curR = curRr+rdId;
   else _curR=&curR;
-  SMILE_DBG(5,"validateIdxRangeR(2) '%s' vidx=%i vidxend=%i special=%i curW=%i _curR=%i nT=%i",this->lcfg.name,*vIdx,vIdxEnd,special,curW,*_curR,lcfg.nT);
+  SMILE_DBG(5,"validateIdxRangeR(2) '%s' vidx=%i vidxend=%i special=%i curW=%i _curR=%i nT=%i",this->lcfg.name,*vIdx,vIdxEnd,special,(long)curW,_curR->load(),lcfg.nT);
 
   if ((lcfg.isRb) && (*_curR < curW-lcfg.nT)) {
     *_curR = curW-lcfg.nT;
@@ -1044,9 +1320,95 @@ long cDataMemoryLevel::validateIdxRangeR(long actualVidx, long *vIdx, long vIdxE
   return -1;
 }
 
+long cDataMemoryLevel::validateIdxRangeWLF(long *vIdx, long vIdxEnd, int special, long *newCurW)
+{
+  // curW is only modified by the (single) writer calling this function
+  long w = curW.load(std::memory_order_relaxed);
+  SMILE_DBG(5,"validateIdxRangeWLF ('%s')\n         vidx=%i vidxend=%i special=%i curW=%i nT=%i",getName(),*vIdx,vIdxEnd,special,w,lcfg.nT);
+
+  if (vIdxEnd < *vIdx) { SMILE_ERR(3,"validateIdxRangeW: vIdxEnd (%i) cannot be smaller than vIdx (%i)!",vIdxEnd,*vIdx); return -1; }
+  if (special == DMEM_IDX_CURW) { vIdxEnd -= *vIdx; *vIdx = w; vIdxEnd += w; }
+  else if (special != -1) return -1;
+  if (*vIdx < 0 || *vIdx > w) return -1;
+
+  // announce the write before checking the pins of the readers (see pinFrameLF)
+  long newW = (vIdxEnd > w) ? vIdxEnd : w;
+  curWres.store(newW, std::memory_order_seq_cst);
+  // the readers publish their read indices after reading, thus the frames before the read index may be overwritten,
+  // unless a reader is still reading them (e.g. the history before its read index)
+  if (getLowestPinLF() < vIdxEnd-lcfg.nT) {
+    curWres.store(w, std::memory_order_seq_cst);
+    SMILE_DBG(3,"ringbuffer level '%s': cannot write, the frames are being read",getName());
+    return -1;
+  }
+  if (vIdxEnd-*vIdx > (lcfg.nT - (w-getReadIdxLF()))) {
+    bool nh = (lcfg.noHang == 1 && nReaders == 0);
+    if (!nh) {
+      curWres.store(w, std::memory_order_seq_cst);
+      SMILE_DBG(3,"data lost while writing value to ringbuffer level '%s'",getName());
+      return -1;
+    }
+  }
+  *newCurW = newW;
+  return *vIdx%lcfg.nT;
+}
+
+long cDataMemoryLevel::validateIdxRLF(long *vIdx, int special, int rdId, long *newCurR)
+{
+  long w = curW.load(std::memory_order_acquire);
+  long r = getReadIdxLF(rdId);
+  SMILE_DBG(5,"validateIdxRLF ('%s')\n         vidx=%i special=%i curW=%i curR=%i nT=%i",getName(),*vIdx,special,w,r,lcfg.nT);
+
+  *newCurR = -1;
+  if (r < w-lcfg.nT) { *newCurR = r = w-lcfg.nT; SMILE_DBG(3,"validateIdxR: rb data possibly lost, curR < curW-nT, curR was automatically increased!"); }
+  if (special == DMEM_IDX_CURR) *vIdx = r;
+  else if ((special != DMEM_IDX_ABS)&&(special!=DMEM_PAD_ZERO)&&(special!=DMEM_PAD_FIRST)&&(special!=DMEM_PAD_NONE)) return -1;
+  if (*vIdx < 0) return -2;
+  // the frame may be before the read index, pin it until it has been read
+  long wres = pinFrameLF(rdId, *vIdx, &w);
+  if ((*vIdx < w)&&(*vIdx >= wres-lcfg.nT)) {
+    if (*vIdx >= r) *newCurR = *vIdx+1;
+    return *vIdx%lcfg.nT;
+  } else if (*vIdx >= w) { return -3; } // OOR_right
+  return -2; // OOR_left
+}
+
+long cDataMemoryLevel::validateIdxRangeRLF(long actualVidx, long *vIdx, long vIdxEnd, int special, int rdId, long *newCurR, int *padEnd)
+{
+  long w = curW.load(std::memory_order_acquire);
+  long r = getReadIdxLF(rdId);
+  SMILE_DBG(5,"validateIdxRangeRLF ('%s')\n         vidx=%i vidxend=%i special=%i curW=%i curR=%i nT=%i",getName(),*vIdx,vIdxEnd,special,w,r,lcfg.nT);
+
+  *newCurR = -1;
+  if (r < w-lcfg.nT) {
+    *newCurR = r = w-lcfg.nT;
+    SMILE_WRN(4, "level: '%s': validateIdxRangeR: rb data possibly lost, curR < curW-nT, curR was automatically increased!", lcfg.name);
+  }
+  if (vIdxEnd < *vIdx) { SMILE_ERR(2,"validateIdxRangeR: vIdxEnd (%i) cannot be smaller than vIdx (%i)!",vIdxEnd,*vIdx); return -1; }
+  if (special == DMEM_IDX_CURR) { vIdxEnd -= *vIdx; actualVidx = *vIdx = r; vIdxEnd += r; }
+  else if ((special != DMEM_IDX_ABS)&&(special!=DMEM_PAD_ZERO)&&(special!=DMEM_PAD_FIRST)&&(special!=DMEM_PAD_NONE)) return -1;
+  if (*vIdx < 0) return -1;
+  // the range may start before the read index, pin it until it has been read
+  long wres = pinFrameLF(rdId, *vIdx, &w);
+
+  if ((vIdxEnd > w)&&(isEOI())) { // pad
+    if (padEnd != NULL) {
+      *padEnd = vIdxEnd - w;
+      if (*padEnd >= vIdxEnd-*vIdx) { *padEnd = vIdxEnd-*vIdx;  return -1; }
+    }
+    vIdxEnd = w;
+  }
+  if ((*vIdx < w)&&(vIdxEnd <= w)&&(*vIdx >= wres-lcfg.nT)) {
+    if (vIdxEnd >= r) *newCurR = actualVidx+1;
+    return *vIdx%lcfg.nT;
+  }
+  if (padEnd != NULL) *padEnd = 0;
+  return -1;
+}
+
 void cDataMemoryLevel::frameWr(long rIdx, const FLOAT_DMEM *_data)
 {
-  FLOAT_DMEM *f = data->data + rIdx*lcfg.N;
+  FLOAT_DMEM *f = frameData(rIdx);
   FLOAT_DMEM *end = f+lcfg.N;
   for ( ; f < end; f++) {
     *f = *_data;
@@ -1056,7 +1418,7 @@ void cDataMemoryLevel::frameWr(long rIdx, const FLOAT_DMEM *_data)
 
 void cDataMemoryLevel::frameRd(long rIdx, FLOAT_DMEM *_data) const
 {
-  FLOAT_DMEM *f = data->data + rIdx*lcfg.N;
+  FLOAT_DMEM *f = frameData(rIdx);
   FLOAT_DMEM *end = f+lcfg.N;
   for ( ; f < end; f++) {
     *_data = *f;
@@ -1064,10 +1426,51 @@ void cDataMemoryLevel::frameRd(long rIdx, FLOAT_DMEM *_data) const
   }
 }
 
+void cDataMemoryLevel::matrixRd(long rIdx, long vIdxold, long vIdx, long vIdxEnd, int special, int padEnd, cMatrix *mat) const
+{
+  long i,j;
+  if (vIdxold < 0) {
+    long i0 = 0-vIdxold;
+    for (i=0; i<i0; i++) {
+      if (special == DMEM_PAD_ZERO) for (j=0; j<mat->N; j++) mat->data[i*lcfg.N+j] = 0.0; // pad with value
+      else frameRd((rIdx)%lcfg.nT, mat->data + (i*lcfg.N)); // fill with first frame
+      getTimeMeta((rIdx)%lcfg.nT, vIdx + i, mat->tmeta + i);
+    }
+    for (i=0; i<vIdxEnd; i++) { 
+      frameRd((rIdx+i)%lcfg.nT, mat->data + (i+i0)*lcfg.N);
+      getTimeMeta((rIdx+i)%lcfg.nT, vIdx + i + i0, mat->tmeta + i +i0);
+    }
+  } else if (padEnd>0) {
+    for (i=0; i<(vIdxEnd-vIdx)-padEnd; i++) {
+      frameRd((rIdx+i)%lcfg.nT, mat->data + (i*lcfg.N));
+      getTimeMeta((rIdx+i)%lcfg.nT, vIdx + i, mat->tmeta + i);
+    }
+    long i0 = i-1;
+    for (; i<(vIdxEnd-vIdx); i++) {
+      if (special == DMEM_PAD_ZERO) for (j=0; j<mat->N; j++) mat->data[i*lcfg.N+j] = 0.0; // pad with value
+      else frameRd((rIdx+i0)%lcfg.nT, mat->data + (i*lcfg.N)); // fill with last frame
+      getTimeMeta((rIdx+i0)%lcfg.nT, vIdx + i, mat->tmeta + i);
+    }
+    // TODO: Test DMEM_PAD_NONE option to truncate the frame!!
+    if (special == DMEM_PAD_NONE) {
+      mat->nT = (vIdxEnd-vIdx)-padEnd;
+    }
+  } else {
+    for (i=0; i<mat->nT; i++) {
+      frameRd((rIdx+i)%lcfg.nT, mat->data + i*lcfg.N);
+      getTimeMeta((rIdx+i)%lcfg.nT, vIdx + i, mat->tmeta + i);
+    }
+  }
+}
+
 void cDataMemoryLevel::printLevelStats(int detail) const
 {
   if (detail) {
-    SMILE_PRINT("==> LEVEL '%s'  +++  Buffersize(frames) = %i  +++  nReaders = %i",getName(),lcfg.nT,nReaders);
+    if (autoSize) {
+      SMILE_PRINT("==> LEVEL '%s'  +++  Buffersize(frames) = %i (automatic, configured: %i)  +++  nReaders = %i",getName(),lcfg.nT,nTconfig,nReaders);
+    } else {
+      SMILE_PRINT("==> LEVEL '%s'  +++  Buffersize(frames) = %i  +++  nReaders = %i",getName(),lcfg.nT,nReaders);
+    }
     if (detail >= 2) {
     // TODO: more details  AND warn if nReaders == 0 or size == 0, etc.
       SMILE_PRINT("     Period(in seconds) = %f \t frameSize(in seconds) = %f (last: %f)",
@@ -1075,11 +1478,12 @@ void cDataMemoryLevel::printLevelStats(int detail) const
       SMILE_PRINT("     BlocksizeRead(frames) = %i \t BlocksizeWrite(frames) = %i",
           lcfg.blocksizeReader, lcfg.blocksizeWriter);
       SMILE_PRINT("     noTimeMeta = %d", lcfg.noTimeMeta);
+      if (segT > 0) SMILE_PRINT("     buffer segments = %i x %i frames", (int)segData.size(), segT);
       if (detail >= 3) {
         SMILE_PRINT("     Number of elements: %i \t Number of fields: %i",lcfg.N,lcfg.Nf);
         if (detail >= 4) {
           const char * typeStr = "float";
-          SMILE_PRINT("     type = %s   noHang = %i   isRingbuffer(isRb) = %i   growDyn = %i",typeStr,lcfg.noHang,lcfg.isRb,lcfg.growDyn);
+          SMILE_PRINT("     type = %s   noHang = %i   isRingbuffer(isRb) = %i   growDyn = %i   lockFree = %i",typeStr,lcfg.noHang,lcfg.isRb,lcfg.growDyn,(int)lockFree);
           if (detail >= 5) {
             // TODO: print data element names ??
             int i; long idx = 0;
@@ -1182,8 +1586,12 @@ void cDataMemoryLevel::setBlocksizeWriter(long _bsw, int _force)
 void cDataMemoryLevel::allocReaders() {
   // allocate and initialize *curRr
   if (nReaders > 0) { // if registered readers are present...
-    curRr = (long*)calloc(1,sizeof(long)*nReaders);
+    curRr = new std::atomic<long>[nReaders];
+    for (int i=0; i<nReaders; i++) curRr[i] = 0;
   }
+  // pins of the registered readers and the unregistered readers (lock-free mode)
+  pinRr = new std::atomic<long>[nReaders+1];
+  for (int i=0; i<=nReaders; i++) pinRr[i] = (std::numeric_limits<long>::max)();
 }
 
 // set time meta information for frame at rIdx
@@ -1191,7 +1599,7 @@ void cDataMemoryLevel::setTimeMeta(long rIdx, long vIdx, const TimeMetaInfo *tm)
 {
   if (lcfg.noTimeMeta)
     COMP_ERR("cannot set time meta information for a level without TimeMetaInfo (noTimeMeta = 1)");
-  TimeMetaInfo *cur = tmeta+rIdx;
+  TimeMetaInfo *cur = frameTmeta(rIdx);
   if (tm!=NULL) {
     *cur = *tm; 
     cur->vIdx = vIdx;
@@ -1212,11 +1620,12 @@ void cDataMemoryLevel::setTimeMeta(long rIdx, long vIdx, const TimeMetaInfo *tm)
       if (lcfg.T!=0.0) cur->time = (double)vIdx * lcfg.T;
       else if (tm->time != 0.0) {
         // TODO: check if the above if does not break anything else...
-        cur->time = tmeta[(rIdx-1+lcfg.nT)%lcfg.nT].time + tmeta[(rIdx-1+lcfg.nT)%lcfg.nT].lengthSec;
+        const TimeMetaInfo *prev = frameTmeta((rIdx-1+lcfg.nT)%lcfg.nT);
+        cur->time = prev->time + prev->lengthSec;
       }
     }
     if (!(cur->filled)) {
-      if (cur->lengthSec == 0.0) cur->lengthSec = tmeta[(rIdx-1+lcfg.nT)%lcfg.nT].lengthSec;
+      if (cur->lengthSec == 0.0) cur->lengthSec = frameTmeta((rIdx-1+lcfg.nT)%lcfg.nT)->lengthSec;
       if (cur->lengthSec == 0.0) cur->lengthSec = lcfg.T;
       cur->filled = 1;
     }
@@ -1229,8 +1638,7 @@ void cDataMemoryLevel::setTimeMeta(long rIdx, long vIdx, const TimeMetaInfo *tm)
 void cDataMemoryLevel::getTimeMeta(long rIdx, long vIdx, TimeMetaInfo *tm) const
 {
   if (!lcfg.noTimeMeta) {
-    TimeMetaInfo *cur = tmeta+rIdx;
-    *tm = *cur;
+    *tm = *frameTmeta(rIdx);
   } else {
     // if no time meta was stored, we reconstruct basic information from vIdx and lcfg.T
     // at least, this should ensure compatibility of components that do not depend on any special metadata fields
@@ -1340,16 +1748,22 @@ int cDataMemoryLevel::configureLevel()
 }
 
 // Finalizes config and allocates data memory buffer
-int cDataMemoryLevel::finaliseLevel()
+void cDataMemoryLevel::finaliseConfig()
 {
-  if (lcfg.finalised)
-    return 1;
+  if (configFinalised) return;
   long minBuf;
   if (lcfg.blocksizeReader <= lcfg.blocksizeWriter) {
     minBuf = 2 * lcfg.blocksizeWriter + 1;  // +1 just for safety...
   } else {
     minBuf = lcfg.blocksizeReader + 2 * lcfg.blocksizeWriter; // +1 just for safety...
   }
+  if (nTconfig == 0) nTconfig = lcfg.nT;
+  // only ring-buffers which wait for their readers can grow again if the minimum size is too small
+  if (autoSize && (!lcfg.isRb || lcfg.growDyn || lcfg.noHang == 2)) autoSize = false;
+  if (autoSize) {
+    lcfg.nT = minBuf + readerLag;
+    lcfg.lenSec = lcfg.T * lcfg.nT;
+  }
   // adjust level buffersize based on blocksize from write requests...
   if (lcfg.nT < minBuf) {
     lcfg.nT = minBuf;
@@ -1359,16 +1773,57 @@ int cDataMemoryLevel::finaliseLevel()
     COMP_ERR("cannot finalise level '%s' : blocksizeIsSet=%i, namesAreSet=%i (both should be 1...)",
         getName(), lcfg.blocksizeIsSet, lcfg.namesAreSet);
   }
+  configFinalised = true;
+}
+
+size_t cDataMemoryLevel::getArenaSize() const
+{
+  if (lcfg.growDyn) return 0;  // growing levels must be able to reallocate their buffers
+  size_t size = DMEM_ARENA_ROUND(sizeof(FLOAT_DMEM) * lcfg.N * lcfg.nT);
+  if (!lcfg.noTimeMeta) size += DMEM_ARENA_ROUND(sizeof(TimeMetaInfo) * lcfg.nT);
+  return size;
+}
+
+size_t cDataMemoryLevel::getBufferSize() const
+{
+  if (!lcfg.finalised) return 0;
+  size_t size = sizeof(FLOAT_DMEM) * lcfg.N * lcfg.nT;
+  if ((tmeta != NULL)||(!segTmeta.empty())) size += sizeof(TimeMetaInfo) * lcfg.nT;
+  return size;
+}
+
+int cDataMemoryLevel::finaliseLevel(char *arenaMem)
+{
+  if (lcfg.finalised)
+    return 1;
+  // usually done by cDataMemory before sizing the arena
+  finaliseConfig();
 
-  // allocate data matrix
+  // allocate data matrix (the time meta information is stored in tmeta, not in data)
   if ((lcfg.N<=0)||(lcfg.nT<=0)) COMP_ERR("cDataMemoryLevel::finaliseLevel: cannot allocate matrix with one (or more) dimensions == 0. did you add fields to this level ['%s']? (N=%i, nT=%i)",getName(),lcfg.N,lcfg.nT);
-  data = new cMatrix(lcfg.N,lcfg.nT,lcfg.noTimeMeta);
-  if (data==NULL) COMP_ERR("cannot allocate level (out of memory)!");
+  if ((arenaMem != NULL)&&(getArenaSize() > 0)) {
+    // frame data at the (aligned) start of the arena block, followed by tmeta
+    data = new cMatrix(0,0,true);
+    data->borrowData((FLOAT_DMEM *)arenaMem, lcfg.N, lcfg.nT, NULL, true);
+    if (!lcfg.noTimeMeta) {
+      tmeta = (TimeMetaInfo *)(arenaMem + DMEM_ARENA_ROUND(sizeof(FLOAT_DMEM) * lcfg.N * lcfg.nT));
+      for (long i=0; i<lcfg.nT; i++) new (tmeta+i) TimeMetaInfo();
+    }
+    inArena = true;
+  } else if (lcfg.growDyn && !lcfg.isRb) {
+    // segmented buffer, the configured size is rounded up to a whole segment
+    segT = DMEM_SEGMENT_MIN_SIZE / (sizeof(FLOAT_DMEM) * lcfg.N);
+    if (segT < lcfg.nT) segT = lcfg.nT;
+    if (!addSegments(segT)) OUT_OF_MEMORY;
+  } else {
+    data = new cMatrix(lcfg.N,lcfg.nT,true);
+    if (data==NULL) COMP_ERR("cannot allocate level (out of memory)!");
   
-  if (!lcfg.noTimeMeta) {
-    // allocate tmeta
-    tmeta = new TimeMetaInfo[lcfg.nT]();
-    if (tmeta == NULL) OUT_OF_MEMORY;
+    if (!lcfg.noTimeMeta) {
+      // allocate tmeta
+      tmeta = new TimeMetaInfo[lcfg.nT]();
+      if (tmeta == NULL) OUT_OF_MEMORY;
+    }
   }
   
   // initialise mutexes:
@@ -1388,11 +1843,16 @@ int cDataMemoryLevel::checkRead(long vIdx, int special, int rdId, long len, int
   if ((vIdx < 0)&&(vIdxEnd > 0)) vIdx = 0;
   if (len < 0) return 0;
 
-  smileMutexLock(RWptrMtx);
-  if (len<=1) rIdx = validateIdxR(&vIdx,special,rdId,1);
-  else rIdx = validateIdxRangeR(vIdxold,&vIdx,vIdxEnd,special,rdId,1);
-
-  smileMutexUnlock(RWptrMtx);
+  if (lockFree) {
+    long newCurR; // not published, this is only a check
+    if (len<=1) rIdx = validateIdxRLF(&vIdx,special,rdId,&newCurR);
+    else rIdx = validateIdxRangeRLF(vIdxold,&vIdx,vIdxEnd,special,rdId,&newCurR);
+  } else {
+    smileMutexLock(RWptrMtx);
+    if (len<=1) rIdx = validateIdxR(&vIdx,special,rdId,1);
+    else rIdx = validateIdxRangeR(vIdxold,&vIdx,vIdxEnd,special,rdId,1);
+    smileMutexUnlock(RWptrMtx);
+  }
   if (result!=NULL) {
     if (rIdx == -2) *result=DMRES_OORleft|DMRES_ERR;
     else if (rIdx == -3) *result=DMRES_OORright|DMRES_ERR;
@@ -1412,21 +1872,34 @@ int cDataMemoryLevel::checkRead(long vIdx, int special, int rdId, long len, int
 
 void cDataMemoryLevel::catchupCurR(int rdId, int _curR) 
 {
+  if (lockFree) {
+    long w = curW.load(std::memory_order_acquire);
+    long newCurR = ((_curR >= 0)&&(_curR <= w)) ? _curR : w;
+    if ((rdId < 0)||(rdId >= nReaders)) {
+      commitReadIdxLF(-1, newCurR); // raises the lower bound of all readers' indices
+    } else {
+      curRr[rdId].store(newCurR, std::memory_order_release);
+    }
+    wakeupWriter();
+    return;
+  }
   smileMutexLock(RWptrMtx);
   if ((rdId < 0)||(rdId >= nReaders)) { 
     if ((_curR >= 0)&&(_curR <= curW)) curR = _curR;
-    else curR = curW;
+    else curR = curW.load();
     checkCurRr(); // sync new global with readers' indicies
   } else {
     if ((_curR >= 0)&&(_curR <= curW)) curRr[rdId] = _curR;
-    else curRr[rdId] = curW;
+    else curRr[rdId] = curW.load();
     checkCurRr(); // sync new readers' indicies with global
   }
   smileMutexUnlock(RWptrMtx);
+  wakeupWriter();
 }
 
 long cDataMemoryLevel::getCurW() const 
 {
+  if (lockFree) return curW.load(std::memory_order_acquire);
   smileMutexLock(RWptrMtx);
   long res = curW;
   smileMutexUnlock(RWptrMtx);
@@ -1435,6 +1908,7 @@ long cDataMemoryLevel::getCurW() const
 
 long cDataMemoryLevel::getCurR(int rdId) const
 {
+  if (lockFree) return getReadIdxLF(rdId);
   long res;
   smileMutexLock(RWptrMtx);
   if ((rdId < 0)||(rdId >= nReaders)) { 
@@ -1448,14 +1922,15 @@ long cDataMemoryLevel::getCurR(int rdId) const
 
 long cDataMemoryLevel::getNFree(int rdId) const
 { 
+  if (lockFree) return lcfg.nT - (curW.load(std::memory_order_acquire) - getReadIdxLF(rdId));
   long ret=0;
   smileMutexLock(RWptrMtx);
   if (lcfg.isRb) {
     if ((rdId>=0)&&(rdId<nReaders)) {
-      SMILE_DBG(5,"getNFree(rdId=%i) level='%s' curW=%i curRr=%i nT=%i free=%i",rdId,getName(),curW,curRr[rdId],lcfg.nT,lcfg.nT - (curW-curRr[rdId]));
+      SMILE_DBG(5,"getNFree(rdId=%i) level='%s' curW=%i curRr=%i nT=%i free=%i",rdId,getName(),(long)curW,(long)curRr[rdId],lcfg.nT,lcfg.nT - (curW-curRr[rdId]));
       ret = lcfg.nT - (curW-curRr[rdId]);
     } else {
-      SMILE_DBG(5,"getNFree:: level='%s' curW=%i curR=%i nT=%i free=%i",getName(),curW,curR,lcfg.nT,lcfg.nT - (curW-curR));
+      SMILE_DBG(5,"getNFree:: level='%s' curW=%i curR=%i nT=%i free=%i",getName(),(long)curW,(long)curR,lcfg.nT,lcfg.nT - (curW-curR));
       ret = lcfg.nT - (curW-curR);
     }
   } else {
@@ -1467,13 +1942,14 @@ long cDataMemoryLevel::getNFree(int rdId) const
 
 long cDataMemoryLevel::getNAvail(int rdId) const
 { 
+  if (lockFree) return curW.load(std::memory_order_acquire) - getReadIdxLF(rdId);
   long ret=0;
   smileMutexLock(RWptrMtx);
   if ((rdId>=0)&&(rdId<nReaders)) {
-    SMILE_DBG(5,"getNAvail(rdId=%i) level='%s' curW=%i curRr=%i nT=%i avail=%i",rdId,getName(),curW,curRr[rdId],lcfg.nT,(curW-curRr[rdId]));
+    SMILE_DBG(5,"getNAvail(rdId=%i) level='%s' curW=%i curRr=%i nT=%i avail=%i",rdId,getName(),(long)curW,(long)curRr[rdId],lcfg.nT,(curW-curRr[rdId]));
     ret = curW - curRr[rdId];
   } else {
-    SMILE_DBG(5,"getNAvail:: level='%s' curW=%i curR=%i nT=%i avail=%i",getName(),curW,curR,lcfg.nT,(curW-curR));
+    SMILE_DBG(5,"getNAvail:: level='%s' curW=%i curR=%i nT=%i avail=%i",getName(),(long)curW,(long)curR,lcfg.nT,(curW-curR));
     ret = curW - curR;
   }
   smileMutexUnlock(RWptrMtx);
@@ -1491,26 +1967,33 @@ int cDataMemoryLevel::setFrame(long vIdx, const cVector *vec, int special)  // i
   if (lcfg.N != vec->N) { COMP_ERR("setFrame: cannot set frame in level '%s', framesize mismatch: %i != %i (expected)",getName(),vec->N,lcfg.N); }
 
 //****** acquire write lock.... *******
-  smileMutexLock(RWstatMtx);
-  // set write request flag, in case the level is currently locked for reading
-  writeReqFlag = 1;
-  smileMutexUnlock(RWstatMtx);
-  smileMutexLock(RWmtx); // get exclusive lock for writing..
-  smileMutexLock(RWstatMtx);
-  writeReqFlag = 0;
-  smileMutexUnlock(RWstatMtx);
+  if (!lockFree) {
+    smileMutexLock(RWstatMtx);
+    // set write request flag, in case the level is currently locked for reading
+    writeReqFlag = 1;
+    smileMutexUnlock(RWstatMtx);
+    smileMutexLock(RWmtx); // get exclusive lock for writing..
+    smileMutexLock(RWstatMtx);
+    writeReqFlag = 0;
+    smileMutexUnlock(RWstatMtx);
+  }
 //****************
 
-  smileMutexLock(RWptrMtx);
 #ifdef DM_DEBUG_LOGGER
   long vIdx0=vIdx;
 #endif
-  long rIdx = validateIdxW(&vIdx,special);
+  long rIdx, newCurW = 0;
+  if (lockFree) {
+    rIdx = validateIdxRangeWLF(&vIdx,vIdx+1,special,&newCurW);
+  } else {
+    smileMutexLock(RWptrMtx);
+    rIdx = validateIdxW(&vIdx,special);
+    smileMutexUnlock(RWptrMtx);
+  }
 #ifdef DM_DEBUG_LOGGER
   // logging in setFrame:
   datamemoryLogger(this->lcfg.name, vIdx0, vIdx, rIdx, lcfg.nT, special, this->curR, this->curW, this->EOI, this->nReaders, this->curRr, vec);
 #endif
-  smileMutexUnlock(RWptrMtx);
   
   int ret = 0;
   if (rIdx>=0) {
@@ -1519,11 +2002,18 @@ int cDataMemoryLevel::setFrame(long vIdx, const cVector *vec, int special)  // i
       setTimeMeta(rIdx,vIdx,vec->tmeta);
     }
     ret= 1;
+    countWrite(1);
   } else {
     SMILE_ERR(4,"setFrame: frame index (vIdx %i -> rIdx %i) out of range, frame was not set (level '%s')!",vIdx,rIdx,getName());
   }
 
-  smileMutexUnlock(RWmtx);
+  if (lockFree) {
+    // publish the new frame to the readers
+    if (ret) curW.store(newCurW, std::memory_order_release);
+  } else {
+    smileMutexUnlock(RWmtx);
+  }
+  if (ret) wakeupReaders();
   return ret;
 }
 
@@ -1538,20 +2028,27 @@ int cDataMemoryLevel::setMatrix(long vIdx, const cMatrix *mat, int special)  //
   if (lcfg.N != mat->N) { COMP_ERR("setMatrix: cannot set frames in level '%s', framesize mismatch: %i != %i (expected)",getName(),mat->N,lcfg.N); }
 
 //****** acquire write lock.... *******
-  smileMutexLock(RWstatMtx);
-  // set write request flag, in case the level is currently locked for reading
-  writeReqFlag = 1;
-  smileMutexUnlock(RWstatMtx);
-  smileMutexLock(RWmtx); // get exclusive lock for writing..
-  smileMutexLock(RWstatMtx);
-  writeReqFlag = 0;
-  smileMutexUnlock(RWstatMtx);
+  if (!lockFree) {
+    smileMutexLock(RWstatMtx);
+    // set write request flag, in case the level is currently locked for reading
+    writeReqFlag = 1;
+    smileMutexUnlock(RWstatMtx);
+    smileMutexLock(RWmtx); // get exclusive lock for writing..
+    smileMutexLock(RWstatMtx);
+    writeReqFlag = 0;
+    smileMutexUnlock(RWstatMtx);
+  }
 //****************
 
   // validate start index
-  smileMutexLock(RWptrMtx);
-  long rIdx = validateIdxRangeW(&vIdx,vIdx+mat->nT,special);
-  smileMutexUnlock(RWptrMtx);
+  long rIdx, newCurW = 0;
+  if (lockFree) {
+    rIdx = validateIdxRangeWLF(&vIdx,vIdx+mat->nT,special,&newCurW);
+  } else {
+    smileMutexLock(RWptrMtx);
+    rIdx = validateIdxRangeW(&vIdx,vIdx+mat->nT,special);
+    smileMutexUnlock(RWptrMtx);
+  }
 
   int ret = 0;
   if (rIdx>=0) {
@@ -1573,11 +2070,18 @@ int cDataMemoryLevel::setMatrix(long vIdx, const cMatrix *mat, int special)  //
       }
     }
     ret = 1;
+    countWrite(mat->nT);
   } else {
     SMILE_DBG(4,"ERROR, setMatrix: frame index range (vIdxStart %i - vIdxEnd %i  => rIdxStart %i) out of range, frame was not set (level '%s')!",vIdx,vIdx+mat->nT,rIdx,getName());
   }
 
-  smileMutexUnlock(RWmtx);
+  if (lockFree) {
+    // publish the new frames to the readers
+    if (ret) curW.store(newCurW, std::memory_order_release);
+  } else {
+    smileMutexUnlock(RWmtx);
+  }
+  if (ret) wakeupReaders();
   return ret;
 }
 
@@ -1590,39 +2094,50 @@ int cDataMemoryLevel::setMatrix(long vIdx, const cMatrix *mat, int special)  //
 //                repeat first/last possible frames...
 
 // NOTE: caller must free the returned vector!!
-cVector * cDataMemoryLevel::getFrame(long vIdx, int special, int rdId, int *result)
+cVector * cDataMemoryLevel::getFrame(long vIdx, int special, int rdId, int *result, cVector *vec)
 {
   if (!lcfg.finalised) { COMP_ERR("cannot get frame from non-finalised level '%s'! call finalise() first!",getName()); }
 
 //****** acquire read lock.... *******
-  smileMutexLock(RWstatMtx);
-  // check for urgent write request:
-  while (writeReqFlag) { // wait until write request has been served!
-    smileMutexUnlock(RWstatMtx);
-    smileYield();
+  if (!lockFree) {
     smileMutexLock(RWstatMtx);
+    // check for urgent write request:
+    while (writeReqFlag) { // wait until write request has been served!
+      smileMutexUnlock(RWstatMtx);
+      smileYield();
+      smileMutexLock(RWstatMtx);
+    }
+    if (nCurRdr == 0) {
+      smileMutexLock(RWmtx); // no other readers, so lock mutex to exclude writes...
+    }
+    nCurRdr++;
+    smileMutexUnlock(RWstatMtx);
+  } else if (pinSlotLF(rdId) == nReaders) {
+    smileMutexLock(RWstatMtx); // unregistered readers share one pin
   }
-  if (nCurRdr == 0) {
-    smileMutexLock(RWmtx); // no other readers, so lock mutex to exclude writes...
-  }
-  nCurRdr++;
-  smileMutexUnlock(RWstatMtx);
 //****************
 
-  smileMutexLock(RWptrMtx);
-  long rIdx = validateIdxR(&vIdx,special,rdId);
-  smileMutexUnlock(RWptrMtx);
+  long rIdx, newCurR = -1;
+  if (lockFree) {
+    rIdx = validateIdxRLF(&vIdx,special,rdId,&newCurR);
+  } else {
+    smileMutexLock(RWptrMtx);
+    rIdx = validateIdxR(&vIdx,special,rdId);
+    smileMutexUnlock(RWptrMtx);
+  }
 
-  cVector *vec=NULL;
   if (rIdx>=0) {
-    vec = new cVector(lcfg.N);
+    if (vec == NULL) vec = new cVector(lcfg.N);
+    else vec->allocData(lcfg.N);
     if (vec == NULL) OUT_OF_MEMORY;
     frameRd(rIdx, vec->data);
     getTimeMeta(rIdx,vIdx,vec->tmeta);
     vec->fmeta = &(fmeta);
     if (result!=NULL) *result=DMRES_OK;
+    countRead(1);
   } else {
     SMILE_DBG(4,"getFrame: frame index (vIdx %i -> rIdx %i) out of range, frame cannot be read (level '%s')!",vIdx,rIdx,getName());
+    vec = NULL;
     if (result!=NULL) {
       if (rIdx == -2) *result=DMRES_OORleft|DMRES_ERR;
       else if (rIdx == -3) *result=DMRES_OORright|DMRES_ERR;
@@ -1632,23 +2147,31 @@ cVector * cDataMemoryLevel::getFrame(long vIdx, int special, int rdId, int *resu
   }
 
   //**** now unlock ******
-  smileMutexLock(RWstatMtx);
-  nCurRdr--;
-  if (nCurRdr < 0) { // ERROR!!
-    SMILE_ERR(1,"nCurRdr < 0  while unlocking dataMemory!! This is a BUG!!!");
-    nCurRdr = 0;
+  if (lockFree) {
+    // publish the new read index, the frames before it may now be overwritten
+    commitReadIdxLF(rdId, newCurR);
+    unpinFrameLF(rdId);
+    if (pinSlotLF(rdId) == nReaders) smileMutexUnlock(RWstatMtx);
+  } else {
+    smileMutexLock(RWstatMtx);
+    nCurRdr--;
+    if (nCurRdr < 0) { // ERROR!!
+      SMILE_ERR(1,"nCurRdr < 0  while unlocking dataMemory!! This is a BUG!!!");
+      nCurRdr = 0;
+    }
+    if (nCurRdr==0) smileMutexUnlock(RWmtx);
+    smileMutexUnlock(RWstatMtx);
   }
-  if (nCurRdr==0) smileMutexUnlock(RWmtx);
-  smileMutexUnlock(RWstatMtx);
   //********************
 
+  if (vec != NULL) wakeupWriter();
   return vec;
 }
 
 //TODO: add an optimized 'simple' level for high performance and low overhead wave handling
 //  no tmeta, very simple access functions etc.
 //  tmeta if accessed will be emulated?
-cMatrix * cDataMemoryLevel::getMatrix(long vIdx, long vIdxEnd, int special, int rdId, int *result)
+cMatrix * cDataMemoryLevel::getMatrix(long vIdx, long vIdxEnd, int special, int rdId, int *result, cMatrix *mat)
 {
   if (!lcfg.finalised) { COMP_ERR("cannot get matrix from non-finalised level! call finalise() first!"); }
 
@@ -1658,88 +2181,240 @@ cMatrix * cDataMemoryLevel::getMatrix(long vIdx, long vIdxEnd, int special, int
   int padEnd = 0; // will be filled with the number of samples at the end of the matrix to be padded
 
 //****** acquire read lock.... *******
-  smileMutexLock(RWstatMtx);
-  // check for urgent write request:
-  while (writeReqFlag) { // wait until write request has been served!
-    smileMutexUnlock(RWstatMtx);
-    smileYield();
+  if (!lockFree) {
     smileMutexLock(RWstatMtx);
+    // check for urgent write request:
+    while (writeReqFlag) { // wait until write request has been served!
+      smileMutexUnlock(RWstatMtx);
+      smileYield();
+      smileMutexLock(RWstatMtx);
+    }
+    if (nCurRdr == 0) {
+      smileMutexLock(RWmtx); // no other readers, so lock mutex to exclude writes...
+    }
+    nCurRdr++;
+    smileMutexUnlock(RWstatMtx);
+  } else if (pinSlotLF(rdId) == nReaders) {
+    smileMutexLock(RWstatMtx); // unregistered readers share one pin
   }
-  if (nCurRdr == 0) {
-    smileMutexLock(RWmtx); // no other readers, so lock mutex to exclude writes...
-  }
-  nCurRdr++;
-  smileMutexUnlock(RWstatMtx);
 //****************
 
-  smileMutexLock(RWptrMtx);
   // TODO : if EOI state, then allow vIdxEnd out of range! pad frame...
-  long rIdx = validateIdxRangeR(vIdxold, &vIdx, vIdxEnd, special, rdId, 0, &padEnd);
-  smileMutexUnlock(RWptrMtx);
+  long rIdx, newCurR = -1;
+  if (lockFree) {
+    rIdx = validateIdxRangeRLF(vIdxold, &vIdx, vIdxEnd, special, rdId, &newCurR, &padEnd);
+  } else {
+    smileMutexLock(RWptrMtx);
+    rIdx = validateIdxRangeR(vIdxold, &vIdx, vIdxEnd, special, rdId, 0, &padEnd);
+    smileMutexUnlock(RWptrMtx);
+  }
 
-  cMatrix *mat=NULL;
   if (rIdx>=0) {
-    if (vIdxold < 0) mat = new cMatrix(lcfg.N,vIdxEnd-vIdxold);
-    else mat = new cMatrix(lcfg.N,vIdxEnd-vIdx);
+    long len = (vIdxold < 0) ? vIdxEnd-vIdxold : vIdxEnd-vIdx;
+    if (mat == NULL) mat = new cMatrix(lcfg.N,len);
+    else mat->allocData(lcfg.N,len);
     SMILE_DBG(4,"creating new data matrix (%s)  vIdxold=%i , vIdx=%i, vIdxEnd=%i, lcfg.N=%i",this->getName(),vIdxold,vIdx,vIdxEnd,lcfg.N)
     if (mat == NULL) OUT_OF_MEMORY;
-    long i,j;
-    if (vIdxold < 0) {
-      long i0 = 0-vIdxold;
-      for (i=0; i<i0; i++) {
-        if (special == DMEM_PAD_ZERO) for (j=0; j<mat->N; j++) mat->data[i*lcfg.N+j] = 0.0; // pad with value
-        else frameRd((rIdx)%lcfg.nT, mat->data + (i*lcfg.N)); // fill with first frame
-        getTimeMeta((rIdx)%lcfg.nT, vIdx + i, mat->tmeta + i);
-      }
-      for (i=0; i<vIdxEnd; i++) { 
-        frameRd((rIdx+i)%lcfg.nT, mat->data + (i+i0)*lcfg.N);
-        getTimeMeta((rIdx+i)%lcfg.nT, vIdx + i + i0, mat->tmeta + i +i0);
-      }
-    } else if (padEnd>0) {
-      for (i=0; i<(vIdxEnd-vIdx)-padEnd; i++) {
-        frameRd((rIdx+i)%lcfg.nT, mat->data + (i*lcfg.N));
-        getTimeMeta((rIdx+i)%lcfg.nT, vIdx + i, mat->tmeta + i);
-      }
-      long i0 = i-1;
-      for (; i<(vIdxEnd-vIdx); i++) {
-        if (special == DMEM_PAD_ZERO) for (j=0; j<mat->N; j++) mat->data[i*lcfg.N+j] = 0.0; // pad with value
-        else frameRd((rIdx+i0)%lcfg.nT, mat->data + (i*lcfg.N)); // fill with last frame
-        getTimeMeta((rIdx+i0)%lcfg.nT, vIdx + i, mat->tmeta + i);
-      }
-      // TODO: Test DMEM_PAD_NONE option to truncate the frame!!
-      if (special == DMEM_PAD_NONE) {
-        mat->nT = (vIdxEnd-vIdx)-padEnd;
-      }
-    } else {
-      for (i=0; i<mat->nT; i++) {
-        frameRd((rIdx+i)%lcfg.nT, mat->data + i*lcfg.N);
-        getTimeMeta((rIdx+i)%lcfg.nT, vIdx + i, mat->tmeta + i);
-      }
-    }
+    matrixRd(rIdx, vIdxold, vIdx, vIdxEnd, special, padEnd, mat);
     mat->fmeta = &(fmeta);
     if (result!=NULL) *result=DMRES_OK;
+    countRead(vIdxEnd - vIdx - padEnd);
   } else {
     SMILE_DBG(4,"ERROR, getMatrix: frame index range (vIdxStart %i - vIdxEnd %i  => rIdxStart %i) out of range, matrix cannot be read (level '%s')!",vIdx,vIdxEnd,rIdx,getName());
+    mat = NULL;
     if (result!=NULL) *result=DMRES_ERR;
   }
   
   //**** now unlock ******
-  smileMutexLock(RWstatMtx);
-  nCurRdr--;
-  if (nCurRdr < 0) { // ERROR!!
-    SMILE_ERR(1,"nCurRdr < 0  while unlocking dataMemory!! This is a BUG!!!");
-    nCurRdr = 0;
+  if (lockFree) {
+    // publish the new read index, the frames before it may now be overwritten
+    commitReadIdxLF(rdId, newCurR);
+    unpinFrameLF(rdId);
+    if (pinSlotLF(rdId) == nReaders) smileMutexUnlock(RWstatMtx);
+  } else {
+    smileMutexLock(RWstatMtx);
+    nCurRdr--;
+    if (nCurRdr < 0) { // ERROR!!
+      SMILE_ERR(1,"nCurRdr < 0  while unlocking dataMemory!! This is a BUG!!!");
+      nCurRdr = 0;
+    }
+    if (nCurRdr==0) smileMutexUnlock(RWmtx);
+    smileMutexUnlock(RWstatMtx);
   }
-  if (nCurRdr==0) smileMutexUnlock(RWmtx);
-  smileMutexUnlock(RWstatMtx);
   //********************
   
+  if (mat != NULL) wakeupWriter();
+  return mat;
+}
+
+const cVector * cDataMemoryLevel::getFrameView(long vIdx, cVector *view, int special, int rdId, int *result)
+{
+  if (!lcfg.finalised) { COMP_ERR("cannot get frame from non-finalised level '%s'! call finalise() first!",getName()); }
+  if (view == NULL) { COMP_ERR("getFrameView: view object must not be NULL (level '%s')",getName()); }
+
+//****** acquire read lock.... *******
+  if (!lockFree) {
+    smileMutexLock(RWstatMtx);
+    // check for urgent write request:
+    while (writeReqFlag) { // wait until write request has been served!
+      smileMutexUnlock(RWstatMtx);
+      smileYield();
+      smileMutexLock(RWstatMtx);
+    }
+    if (nCurRdr == 0) {
+      smileMutexLock(RWmtx); // no other readers, so lock mutex to exclude writes...
+    }
+    nCurRdr++;
+    smileMutexUnlock(RWstatMtx);
+  } else if (pinSlotLF(rdId) == nReaders) {
+    smileMutexLock(RWstatMtx); // unregistered readers share one pin
+  }
+//****************
+
+  long rIdx, newCurR = -1;
+  if (lockFree) {
+    rIdx = validateIdxRLF(&vIdx,special,rdId,&newCurR);
+  } else {
+    smileMutexLock(RWptrMtx);
+    rIdx = validateIdxR(&vIdx,special,rdId);
+    smileMutexUnlock(RWptrMtx);
+  }
+
+  const cVector *vec=NULL;
+  if (rIdx>=0) {
+    if (asyncWriter) {
+      // the writer may overwrite the frame while the view is used: copy to the view's own buffer
+      view->allocData(lcfg.N);
+      frameRd(rIdx, view->data);
+      getTimeMeta(rIdx,vIdx,view->tmeta);
+    } else {
+      // a single frame is always stored contiguously
+      view->borrowData(frameData(rIdx), lcfg.N, lcfg.noTimeMeta ? NULL : frameTmeta(rIdx));
+      if (lcfg.noTimeMeta) getTimeMeta(rIdx,vIdx,view->tmeta);
+    }
+    view->fmeta = &(fmeta);
+    vec = view;
+    if (result!=NULL) *result=DMRES_OK;
+    countRead(1);
+  } else {
+    SMILE_DBG(4,"getFrameView: frame index (vIdx %i -> rIdx %i) out of range, frame cannot be read (level '%s')!",vIdx,rIdx,getName());
+    if (result!=NULL) {
+      if (rIdx == -2) *result=DMRES_OORleft|DMRES_ERR;
+      else if (rIdx == -3) *result=DMRES_OORright|DMRES_ERR;
+      else if (rIdx == -4) *result=DMRES_OORbs|DMRES_ERR;
+      else *result=DMRES_ERR;
+    }
+  }
+
+  //**** now unlock ******
+  if (lockFree) {
+    // publish the new read index, the frames before it may now be overwritten
+    commitReadIdxLF(rdId, newCurR);
+    unpinFrameLF(rdId);
+    if (pinSlotLF(rdId) == nReaders) smileMutexUnlock(RWstatMtx);
+  } else {
+    smileMutexLock(RWstatMtx);
+    nCurRdr--;
+    if (nCurRdr < 0) { // ERROR!!
+      SMILE_ERR(1,"nCurRdr < 0  while unlocking dataMemory!! This is a BUG!!!");
+      nCurRdr = 0;
+    }
+    if (nCurRdr==0) smileMutexUnlock(RWmtx);
+    smileMutexUnlock(RWstatMtx);
+  }
+  //********************
+
+  if (vec != NULL) wakeupWriter();
+  return vec;
+}
+
+const cMatrix * cDataMemoryLevel::getMatrixView(long vIdx, long vIdxEnd, cMatrix *view, int special, int rdId, int *result)
+{
+  if (!lcfg.finalised) { COMP_ERR("cannot get matrix from non-finalised level! call finalise() first!"); }
+  if (view == NULL) { COMP_ERR("getMatrixView: view object must not be NULL (level '%s')",getName()); }
+
+  long vIdxold=vIdx;
+  if (vIdx < 0) vIdx = 0;
+  int padEnd = 0; // will be filled with the number of samples at the end of the matrix to be padded
+
+//****** acquire read lock.... *******
+  if (!lockFree) {
+    smileMutexLock(RWstatMtx);
+    // check for urgent write request:
+    while (writeReqFlag) { // wait until write request has been served!
+      smileMutexUnlock(RWstatMtx);
+      smileYield();
+      smileMutexLock(RWstatMtx);
+    }
+    if (nCurRdr == 0) {
+      smileMutexLock(RWmtx); // no other readers, so lock mutex to exclude writes...
+    }
+    nCurRdr++;
+    smileMutexUnlock(RWstatMtx);
+  } else if (pinSlotLF(rdId) == nReaders) {
+    smileMutexLock(RWstatMtx); // unregistered readers share one pin
+  }
+//****************
+
+  long rIdx, newCurR = -1;
+  if (lockFree) {
+    rIdx = validateIdxRangeRLF(vIdxold, &vIdx, vIdxEnd, special, rdId, &newCurR, &padEnd);
+  } else {
+    smileMutexLock(RWptrMtx);
+    rIdx = validateIdxRangeR(vIdxold, &vIdx, vIdxEnd, special, rdId, 0, &padEnd);
+    smileMutexUnlock(RWptrMtx);
+  }
+
+  const cMatrix *mat=NULL;
+  if (rIdx>=0) {
+    if ((!asyncWriter)&&(vIdxold >= 0)&&(padEnd == 0)&&(vIdxEnd-vIdx <= nContiguous(rIdx))) {
+      // frames are stored contiguously in the level buffer, no copy required
+      view->borrowData(frameData(rIdx), lcfg.N, vIdxEnd-vIdx, lcfg.noTimeMeta ? NULL : frameTmeta(rIdx));
+      if (lcfg.noTimeMeta) {
+        for (long i=0; i<view->nT; i++) getTimeMeta(rIdx+i, vIdx+i, view->tmeta+i);
+      }
+    } else {
+      // ring buffer wraps around, frames span buffer segments, padding is required, or the writer may overwrite
+      // the frames while the view is used: copy to the view's own buffer
+      if (vIdxold < 0) view->allocData(lcfg.N,vIdxEnd-vIdxold);
+      else view->allocData(lcfg.N,vIdxEnd-vIdx);
+      matrixRd(rIdx, vIdxold, vIdx, vIdxEnd, special, padEnd, view);
+    }
+    view->fmeta = &(fmeta);
+    mat = view;
+    if (result!=NULL) *result=DMRES_OK;
+    countRead(vIdxEnd - vIdx - padEnd);
+  } else {
+    SMILE_DBG(4,"ERROR, getMatrixView: frame index range (vIdxStart %i - vIdxEnd %i  => rIdxStart %i) out of range, matrix cannot be read (level '%s')!",vIdx,vIdxEnd,rIdx,getName());
+    if (result!=NULL) *result=DMRES_ERR;
+  }
+
+  //**** now unlock ******
+  if (lockFree) {
+    // publish the new read index, the frames before it may now be overwritten
+    commitReadIdxLF(rdId, newCurR);
+    unpinFrameLF(rdId);
+    if (pinSlotLF(rdId) == nReaders) smileMutexUnlock(RWstatMtx);
+  } else {
+    smileMutexLock(RWstatMtx);
+    nCurRdr--;
+    if (nCurRdr < 0) { // ERROR!!
+      SMILE_ERR(1,"nCurRdr < 0  while unlocking dataMemory!! This is a BUG!!!");
+      nCurRdr = 0;
+    }
+    if (nCurRdr==0) smileMutexUnlock(RWmtx);
+    smileMutexUnlock(RWstatMtx);
+  }
+  //********************
+
+  if (mat != NULL) wakeupWriter();
   return mat;
 }
 
 // methods to get info about current level fill status (e.g. number of frames written, curW, curR(global) and freeSpace, etc.)
 long cDataMemoryLevel::getMaxR() const  // maximum readable index or -1 if level is empty
 { 
+  if (lockFree) return curW.load(std::memory_order_acquire)-1;
   smileMutexLock(RWptrMtx);
   long res = curW-1;
   smileMutexUnlock(RWptrMtx);
@@ -1747,6 +2422,10 @@ long cDataMemoryLevel::getMaxR() const  // maximum readable index or -1 if level
 }
 
 long cDataMemoryLevel::getMinR() const {  // minimum readable index or -1 if level is empty (relevant only for ringbuffers, otherwise it will always return -1 or 0)
+  if (lockFree) {
+    long w = curW.load(std::memory_order_acquire);
+    return (w > 0) ? (std::max)(w-lcfg.nT, 0L) : -1;
+  }
   long res;
   smileMutexLock(RWptrMtx);
   if (lcfg.isRb) {
@@ -1799,7 +2478,9 @@ cDataMemoryLevel::~cDataMemoryLevel() {
     smileMutexDestroy(RWmtx);
   }
 
-  if (tmeta != NULL) delete[] tmeta;
+  freeTmeta();
+  freeSegments();
   if (data != NULL) delete data;
-  if (curRr != NULL) free(curRr);
+  if (curRr != NULL) delete[] curRr;
+  if (pinRr != NULL) delete[] pinRr;
 }
@@ -45,6 +45,8 @@ cDataReader::cDataReader(const char *_name) : cSmileComponent(_name),
   level(NULL),
   V_(NULL),
   m(NULL),
+  vView_(NULL),
+  mView_(NULL),
   curR(0),
   stepM(1),
   lengthM(0),
@@ -347,6 +349,18 @@ long cDataReader::getMinR()
   return minR;
 }
 
+long cDataReader::getMaxR()
+{
+  // "maximum index that is readable", thus we must take the MIN among all input levels
+  long maxR = dm->getMaxR(level[0]);
+  int i;
+  for (i=1; i<nLevels; i++) {
+    long tmp = dm->getMaxR(level[i]);
+    if (tmp < maxR) maxR = tmp;
+  }
+  return maxR;
+}
+
 void cDataReader::catchupCurR(long _curR)
 {
   int i;
@@ -393,9 +407,10 @@ cVector * cDataReader::getFrame(long vIdx, int special, int privateVec, int *res
       }
       long e = 0;
       long f = 0;
+      if (vView_ == NULL) vView_ = new cVector(0);
       for (i = 0; i < nLevels; i++) {
         int myResult = 0;
-        cVector *f2 = dm->getFrame(level[i],vIdx, special, rdId[i], &myResult);
+        const cVector *f2 = dm->getFrameView(level[i],vIdx, vView_, special, rdId[i], &myResult);
         if (result != NULL)
           *result |= myResult;
         if (f2 != NULL) {
@@ -417,7 +432,6 @@ cVector * cDataReader::getFrame(long vIdx, int special, int privateVec, int *res
             //f += f2->fmeta->N;
           }
           VV->fmeta = myfmeta;
-          delete f2;
         } else {
           SMILE_ERR(1,"no data was read from one of multiple input levels, this is a BUG! checkRead <-> getFrame ! a bogus data vector will now be returned!");
         }
@@ -431,11 +445,9 @@ cVector * cDataReader::getFrame(long vIdx, int special, int privateVec, int *res
       return NULL;
     }
   } else {
-    // TODO: speed-up by passing our V object to dm->getFrame,
-    // which fills it and does not have to reallocate an object!
-    cVector *f2 = dm->getFrame(level[0],vIdx, special, rdId[0], result);
+    // the reader's own vector is reused for all non-private reads
+    cVector *f2 = dm->getFrame(level[0],vIdx, special, rdId[0], result, privateVec ? NULL : V_);
     if ((f2 != NULL)&&(!privateVec)) {
-      if (V_ != NULL) delete V_;
       V_ = f2;
     }
     //if ((f2 != NULL)&&(vIdx>curR)) curR=vIdx;
@@ -461,13 +473,8 @@ cMatrix * cDataReader::getMatrix(long vIdx, long length, int special, int privat
       r &= dm->checkRead(level[i],vIdx,special,rdId[i],length);
     }
     if (r) {
-      if (my_m!=NULL) {
-        if (length != my_m->nT) {
-          delete my_m;
-          my_m=NULL;
-        }
-      }
       if (my_m == NULL) my_m = new cMatrix(myLcfg->N,length);
+      else my_m->allocData(myLcfg->N,length);
       
       int fmetaUpdate = 0;
       if (myfmeta == NULL) { 
@@ -483,9 +490,10 @@ cMatrix * cDataReader::getMatrix(long vIdx, long length, int special, int privat
       long N = myLcfg->N;
       long f=0;
       long minlen = length;
+      if (mView_ == NULL) mView_ = new cMatrix(0,0);
       for (i=0; i<nLevels; i++) {
 
-        cMatrix *m2 = dm->getMatrix(level[i],vIdx,vIdx+length, special, rdId[i]);
+        const cMatrix *m2 = dm->getMatrixView(level[i],vIdx,vIdx+length, mView_, special, rdId[i]);
         if (m2 != NULL) {
           if (m2->nT < minlen) { minlen = m2->nT; }
           // copy data from f2 into V at the correct position
@@ -505,25 +513,22 @@ cMatrix * cDataReader::getMatrix(long vIdx, long length, int special, int privat
               //f += f2->fmeta->N;
             }
             my_m->fmeta = myfmeta;
-
-          delete m2;
         }
       }
       if (minlen < length) {
-        // TODO: if the matrix size increases again, we cannot increase! Introduce cMatrix->nAlloc variable?
         my_m->nT = minlen;
       }
 
       if (!privateVec) m=my_m;
-      return m;
+      return my_m;
     } else {
       return NULL;
     }
 
   } else {
-    cMatrix *m2 = dm->getMatrix(level[0],vIdx,vIdx+length, special, rdId[0]);
+    // the reader's own matrix is reused for all non-private reads
+    cMatrix *m2 = dm->getMatrix(level[0],vIdx,vIdx+length, special, rdId[0], NULL, privateVec ? NULL : m);
     if ((m2 != NULL)&&(!privateVec)) {
-      if (m != NULL) delete m;
       m = m2;
       // ???:
       //if (vIdx+length > curR) curR = vIdx+length;
@@ -555,7 +560,7 @@ cVector * cDataReader::getNextFrame(int privateVec, int *result)
   return ret;
 }
 
-cMatrix * cDataReader::getNextMatrix(int privateVec, int readToEnd, int special)
+int cDataReader::nextMatrixLength(int readToEnd, long *length)
 {
   if (stepM == 0 || readToEnd == 1) { // read complete input...
     if (isEOI() && EOIlevelIsMatch()) { 
@@ -568,28 +573,77 @@ cMatrix * cDataReader::getNextMatrix(int privateVec, int readToEnd, int special)
         else if (tmp < fl) fl = tmp;
       }
       if ((curR==0||readToEnd==1)&&(fl > 0)) {
-        /* TODO: curR will not be set correctly be getMatrix for arbitrary reads.. */
-        cMatrix *ret = getMatrix(curR,fl,-1,privateVec);
-        long tmpR = dm->getMinR(level[0]);
-        //		printf("avail: %i  free: %i\n ",dm->getNAvail(level[0]), dm->getNFree(level[0]));
-        //		printf("curW: %i  curR(int): %i   curR: \n ",dm->getCurW(level[0]),curR);
-        SMILE_IDBG(3,"fullinput: read %i frames (idx %i -> %i).",fl,tmpR,tmpR+fl);
-
-        if (((tmpR > 0)||((myLcfg->growDyn==0)&&(myLcfg->nT < fl)))&&(ret!=NULL)) {
-          if (errorOnFullInputIncomplete) SMILE_IERR(1,"reading of full input is incomplete: read %i frames (idx %i -> %i). start index should be zero! you are having a problem with your buffersizes (%i)!",fl,tmpR,tmpR+fl,myLcfg->nT)
-          else SMILE_IWRN(2,"reading of full input is incomplete: read %i frames (idx %i -> %i). start index should be zero! you are having a problem with your buffersizes (%i)!",fl,tmpR,tmpR+fl,myLcfg->nT)
-        }
-        if (ret != NULL) { curR += fl; }
-        return ret;
-      } else { return NULL; }
-    } else { return NULL; }
+        *length = fl;
+        return 1;
+      }
+    }
+    return 0;
+  }
+  *length = lengthM;
+  return 2;
+}
+
+void cDataReader::nextMatrixRead(int mode, long length, const cMatrix *ret)
+{
+  if (mode == 1) {
+    /* TODO: curR will not be set correctly be getMatrix for arbitrary reads.. */
+    long fl = length;
+    long tmpR = dm->getMinR(level[0]);
+    //		printf("avail: %i  free: %i\n ",dm->getNAvail(level[0]), dm->getNFree(level[0]));
+    //		printf("curW: %i  curR(int): %i   curR: \n ",dm->getCurW(level[0]),curR);
+    SMILE_IDBG(3,"fullinput: read %i frames (idx %i -> %i).",fl,tmpR,tmpR+fl);
+
+    if (((tmpR > 0)||((myLcfg->growDyn==0)&&(myLcfg->nT < fl)))&&(ret!=NULL)) {
+      if (errorOnFullInputIncomplete) SMILE_IERR(1,"reading of full input is incomplete: read %i frames (idx %i -> %i). start index should be zero! you are having a problem with your buffersizes (%i)!",fl,tmpR,tmpR+fl,myLcfg->nT)
+      else SMILE_IWRN(2,"reading of full input is incomplete: read %i frames (idx %i -> %i). start index should be zero! you are having a problem with your buffersizes (%i)!",fl,tmpR,tmpR+fl,myLcfg->nT)
+    }
+    if (ret != NULL) { curR += fl; }
   } else {
-    cMatrix *ret = getMatrix(curR, lengthM, special, privateVec);
     if (ret != NULL) curR += stepM;
-    return ret;
   }
 }
 
+cMatrix * cDataReader::getNextMatrix(int privateVec, int readToEnd, int special)
+{
+  long length = 0;
+  int mode = nextMatrixLength(readToEnd, &length);
+  if (mode == 0) return NULL;
+  cMatrix *ret = getMatrix(curR, length, (mode == 1) ? -1 : special, privateVec);
+  nextMatrixRead(mode, length, ret);
+  return ret;
+}
+
+const cVector * cDataReader::getFrameView(long vIdx, int special, int *result)
+{
+  if (nLevels > 1) return getFrame(vIdx, special, 0, result);
+  if (vView_ == NULL) vView_ = new cVector(0);
+  return dm->getFrameView(level[0], vIdx, vView_, special, rdId[0], result);
+}
+
+const cMatrix * cDataReader::getMatrixView(long vIdx, long length, int special)
+{
+  if (nLevels > 1) return getMatrix(vIdx, length, special, 0);
+  if (mView_ == NULL) mView_ = new cMatrix(0,0);
+  return dm->getMatrixView(level[0], vIdx, vIdx+length, mView_, special, rdId[0]);
+}
+
+const cVector * cDataReader::getNextFrameView(int *result)
+{
+  const cVector *ret = getFrameView(curR,-1,result);
+  if ((ret != NULL)||(curR < 0)) curR++;
+  return ret;
+}
+
+const cMatrix * cDataReader::getNextMatrixView(int readToEnd, int special)
+{
+  long length = 0;
+  int mode = nextMatrixLength(readToEnd, &length);
+  if (mode == 0) return NULL;
+  const cMatrix *ret = getMatrixView(curR, length, (mode == 1) ? -1 : special);
+  nextMatrixRead(mode, length, ret);
+  return ret;
+}
+
 long cDataReader::getNAvail()
 {
   long fl = -1; // fl = nAvailable
@@ -679,6 +733,8 @@ int cDataReader::setupSequentialMatrixReading(double step, double length, double
 cDataReader::~cDataReader() {
   if (V_!=NULL) delete V_;
   if (m!=NULL) delete m;
+  if (vView_!=NULL) delete vView_;
+  if (mView_!=NULL) delete mView_;
   if (dmLevel!=NULL) free(dmLevel);
   if (rdId != NULL) free(rdId);
   if (level!=NULL)  free(level);
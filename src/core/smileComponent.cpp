@@ -50,6 +50,9 @@ cWriterComponent     - writes data to dataMemory (takes vector, (or matrix??)),
 
 #include <core/smileComponent.hpp>
 #include <core/componentManager.hpp>
+#include <dspcore/smileFft.hpp>
+#include <algorithm>
+#include <time.h>
 
 #define MODULE "cSmileComponent"
 
@@ -170,9 +173,17 @@ cSmileComponent::cSmileComponent(const char *instname) :
   runMe_(1),
   doProfile_(DO_PROFILING),
   printProfile_(PRINT_PROFILING),
-  profileCur_(0.0), profileSum_(0.0)
+  traceProfile_(0),
+  profileCur_(0.0), profileSum_(0.0),
+  profileCpuStart_(0.0), profileCpuSum_(0.0),
+  profileSkipped_(0),
+  lastTickResult_(TICK_INACTIVE),
+  lastNrun_(-1),
+  awake_(true),
+  alwaysAwake_(false)
 {
   smileMutexCreate(messageMtx_);
+  std::fill(profileTicks_, profileTicks_ + NUM_TICK_RESULTS, 0);
   if (instname == NULL) COMP_ERR("cannot create cSmileComponent with instanceName == NULL!");
   iname_ = strdup(instname);
   cfname_ = iname_;
@@ -266,6 +277,12 @@ double cSmileComponent::getSmileTime() const
   return 0.0;
 }
 
+int cSmileComponent::getFftEngine() const
+{
+  if (compman_ != NULL) return compman_->getFftEngine();
+  else return SMILE_FFT_ENGINE_FFTSG;
+}
+
 int cSmileComponent::isAbort() const
 { 
   if (compman_ != NULL) return compman_->isAbort();
@@ -292,17 +309,49 @@ int cSmileComponent::finaliseInstance()
   return isFinalised_;
 }
 
+// CPU time in seconds consumed by the calling thread
+static double threadCpuTime()
+{
+#ifdef __WINDOWS
+  FILETIME creationTime, exitTime, kernelTime, userTime;
+  if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) return 0.0;
+  ULARGE_INTEGER k, u;
+  k.LowPart = kernelTime.dwLowDateTime; k.HighPart = kernelTime.dwHighDateTime;
+  u.LowPart = userTime.dwLowDateTime; u.HighPart = userTime.dwHighDateTime;
+  return (double)(k.QuadPart + u.QuadPart) * 1e-7;
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0.0;
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#else
+  return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+int cSmileComponent::getProfileThreadId()
+{
+  static std::atomic<int> nThreads(0);
+  thread_local int id = nThreads++;
+  return id;
+}
+
 void cSmileComponent::startProfile(long long t, int EOI)
 {
-  startTime_ = std::chrono::high_resolution_clock::now();
+  profileCpuStart_ = threadCpuTime();
+  startTime_ = std::chrono::steady_clock::now();
 }
 
 void cSmileComponent::endProfile(long long t, int EOI)
 {
-  endTime_ = std::chrono::high_resolution_clock::now();
+  endTime_ = std::chrono::steady_clock::now();
   typedef std::chrono::duration<double> seconds;
   profileCur_ = std::chrono::duration_cast<seconds>(endTime_ - startTime_).count();
   profileSum_ += profileCur_;
+  profileCpuSum_ += threadCpuTime() - profileCpuStart_;
+  profileTicks_[lastTickResult_]++;
+  if (traceProfile_ && lastTickResult_ == TICK_SUCCESS) {
+    profileTrace_.push_back({ t, startTime_, profileCur_, getProfileThreadId() });
+  }
   if (printProfile_) {
     SMILE_IMSG(2, "~~~~profile~~~~ cur=%f  sum=%f  tick=%i\n", getProfile(0), getProfile(1), t);
   }
@@ -0,0 +1,212 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*
+   pool of worker threads for data-parallel loops within components
+   (see smileThreadPool.hpp for a description)
+ */
+
+
+#include <core/smileThreadPool.hpp>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+#define MODULE "cSmileThreadPool"
+
+// number of blocks per thread the indices of a loop are split into
+#define THREADPOOL_BLOCKS_PER_THREAD 4
+
+// the process-wide pool and the number of its users
+static std::mutex sharedPoolMtx;
+static cSmileThreadPool *sharedPool = NULL;
+static int sharedPoolUsers = 0;
+
+static SMILE_THREAD_RETVAL threadPoolWorkerRunner(void *_data)
+{
+  sThreadPoolWorker *w = (sThreadPoolWorker *)_data;
+  if (w != NULL && w->obj != NULL) {
+    w->obj->workerLoop(w);
+  }
+  SMILE_THREAD_RET;
+}
+
+cSmileThreadPool::cSmileThreadPool(int _nThreads) :
+  nThreads(1), stopFlag(false)
+{
+  smileMutexCreate(mtx);
+  addThreads(_nThreads);
+}
+
+cSmileThreadPool * cSmileThreadPool::acquireShared(int nThreads)
+{
+  if (nThreads == 0) nThreads = (int)std::thread::hardware_concurrency();
+  std::lock_guard<std::mutex> lock(sharedPoolMtx);
+  if (sharedPool == NULL) {
+    sharedPool = new cSmileThreadPool(nThreads);
+  } else {
+    sharedPool->addThreads(nThreads);
+  }
+  sharedPoolUsers++;
+  return sharedPool;
+}
+
+void cSmileThreadPool::releaseShared()
+{
+  std::lock_guard<std::mutex> lock(sharedPoolMtx);
+  if (sharedPoolUsers > 0 && --sharedPoolUsers == 0) {
+    delete sharedPool;
+    sharedPool = NULL;
+  }
+}
+
+void cSmileThreadPool::addThreads(int _nThreads)
+{
+  smileMutexLock(mtx);
+  for (int i = nThreads.load(); i < _nThreads; i++) {
+    sThreadPoolWorker *w = new sThreadPoolWorker();
+    w->obj = this;
+    w->id = i;
+    smileCondCreate(w->wakeCond);
+    if (!smileThreadCreate(w->thread, threadPoolWorkerRunner, w)) {
+      SMILE_ERR(1,"error creating thread pool worker thread %i, running with %i threads", i, i);
+      smileCondDestroy(w->wakeCond);
+      delete w;
+      break;
+    }
+    workers.emplace_back(w);
+    nThreads = i + 1;
+  }
+  smileMutexUnlock(mtx);
+}
+
+void cSmileThreadPool::runLoop(sThreadPoolLoop *loop, int threadId)
+{
+  while (!loop->failed.load()) {
+    long i0 = loop->next.fetch_add(loop->block);
+    if (i0 >= loop->n) break;
+    long i1 = MIN(i0 + loop->block, loop->n);
+    try {
+      for (long i = i0; i < i1; i++) {
+        (*loop->func)(threadId, i);
+      }
+    } catch (...) {
+      smileMutexLock(mtx);
+      if (!loop->failed.load()) {
+        loop->error = std::current_exception();
+        loop->failed = true;
+      }
+      smileMutexUnlock(mtx);
+    }
+  }
+}
+
+sThreadPoolLoop * cSmileThreadPool::takeLoop(int threadId)
+{
+  sThreadPoolLoop *loop = NULL;
+  smileMutexLock(mtx);
+  for (sThreadPoolLoop *l : loops) {
+    if (threadId < l->maxThreads && l->next.load() < l->n && !l->failed.load()) {
+      loop = l;
+      loop->nActive++;
+      break;
+    }
+  }
+  smileMutexUnlock(mtx);
+  return loop;
+}
+
+void cSmileThreadPool::leaveLoop(sThreadPoolLoop *loop)
+{
+  smileMutexLock(mtx);
+  if (--loop->nActive == 0 && loop->finished) {
+    smileCondSignal(loop->doneCond);
+  }
+  smileMutexUnlock(mtx);
+}
+
+void cSmileThreadPool::workerLoop(sThreadPoolWorker *w)
+{
+  cSmileLogger *curLogger = NULL;
+  while (true) {
+    smileCondWait(w->wakeCond);
+    if (stopFlag.load()) break;
+    sThreadPoolLoop *loop;
+    while ((loop = takeLoop(w->id)) != NULL) {
+      // ensures log messages created in this thread are sent to the logger of the calling component
+      if (loop->logger != NULL && loop->logger != curLogger) {
+        curLogger = loop->logger;
+        curLogger->useForCurrentThread();
+      }
+      runLoop(loop, w->id);
+      leaveLoop(loop);
+    }
+  }
+}
+
+void cSmileThreadPool::parallelFor(long n, const std::function<void(int threadId, long i)> &func, int maxThreads)
+{
+  if (n <= 0) return;
+  if (maxThreads <= 0 || maxThreads > nThreads.load()) maxThreads = nThreads.load();
+  if (maxThreads == 1 || n == 1) {
+    for (long i = 0; i < n; i++) {
+      func(0, i);
+    }
+    return;
+  }
+
+  sThreadPoolLoop loop;
+  loop.func = &func;
+  loop.n = n;
+  loop.block = n / (maxThreads * THREADPOOL_BLOCKS_PER_THREAD);
+  if (loop.block < 1) loop.block = 1;
+  loop.maxThreads = maxThreads;
+  loop.logger = SMILE_LOG_GLOBAL;
+  loop.next.store(0);
+  loop.nActive = 0;
+  loop.finished = 0;
+  loop.failed = false;
+  smileCondCreate(loop.doneCond);
+
+  smileMutexLock(mtx);
+  loops.push_back(&loop);
+  for (auto &w : workers) {
+    if (w->id < maxThreads) smileCondSignal(w->wakeCond);
+  }
+  smileMutexUnlock(mtx);
+
+  runLoop(&loop, 0);
+
+  // no worker joins the loop after it was removed, wait for those still running blocks
+  smileMutexLock(mtx);
+  loops.erase(std::find(loops.begin(), loops.end(), &loop));
+  loop.finished = 1;
+  int nActive = loop.nActive;
+  smileMutexUnlock(mtx);
+  if (nActive > 0) {
+    smileCondWait(loop.doneCond);
+  }
+  smileCondDestroy(loop.doneCond);
+
+  if (loop.failed.load()) {
+    std::rethrow_exception(loop.error);
+  }
+}
+
+cSmileThreadPool::~cSmileThreadPool()
+{
+  stopFlag = true;
+  for (auto &w : workers) {
+    smileCondSignal(w->wakeCond);
+  }
+  for (auto &w : workers) {
+    smileThreadJoin(w->thread);
+    smileCondDestroy(w->wakeCond);
+  }
+  smileMutexDestroy(mtx);
+}
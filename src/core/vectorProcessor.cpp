@@ -53,6 +53,7 @@ cVectorProcessor::cVectorProcessor(const char *_name) :
   fNi(NULL),
   fNo(NULL),
   vecO(NULL),
+  matO(NULL),
   confBs(NULL),
   fconf(NULL),
   fconfInv(NULL),
@@ -294,8 +295,8 @@ eTickResult cVectorProcessor::myTick(long long t)
   if (!(writer_->checkWrite(1))) return TICK_DEST_NO_SPACE;
   // printf("'%s' checkwrite ok\n",getInstName());
 
-  // get next frame from dataMemory
-  cVector *vec = reader_->getNextFrame();
+  // get next frame from dataMemory (read-only view, no copy)
+  const cVector *vec = reader_->getNextFrameView();
   int i;
   int iO = 0;
   int toSet = 1;
@@ -315,7 +316,7 @@ eTickResult cVectorProcessor::myTick(long long t)
   if (vec == NULL && !isEOI())
     return TICK_SOURCE_NOT_AVAIL;
 
-  FLOAT_DMEM *dFi = NULL;
+  const FLOAT_DMEM *dFi = NULL;
   if (vec != NULL) {
     dFi = vec->data;
   }
@@ -393,6 +394,39 @@ eTickResult cVectorProcessor::myTick(long long t)
   return ret ? TICK_SUCCESS : TICK_INACTIVE;
 }
 
+eTickResult cVectorProcessor::tickBatched(long long t, long maxFrames)
+{
+  if (maxFrames < 2 || processArrayFields == 2 || Nfi != 1 || Nfo != 1) {
+    return cVectorProcessor::myTick(t);
+  }
+  long Nsrc = fNi[0];
+  long Ndst = fNo[0];
+  if (Nsrc != reader_->getLevelN() || Ndst != writer_->getLevelN()) {
+    return cVectorProcessor::myTick(t);
+  }
+  long curR = reader_->getCurR();
+  long n = reader_->getMaxR() + 1 - curR;
+  if (n < blocksizeR_ && !isEOI() && reader_->getNFree() > 0) {
+    return TICK_SOURCE_NOT_AVAIL;
+  }
+  if (n > maxFrames) n = maxFrames;
+  if (n > 1 && !writer_->checkWrite(n)) n = writer_->getNFree();
+  if (n < 2) return cVectorProcessor::myTick(t);
+
+  const cMatrix *matI = reader_->getMatrixView(curR, n);
+  if (matI == NULL) return cVectorProcessor::myTick(t);
+
+  if (matO == NULL) matO = new cMatrix(Ndst, n);
+  else matO->allocData(Ndst, n);
+  if (!processVectorBatch(matI->data, matO->data, Nsrc, Ndst, n)) {
+    return cVectorProcessor::myTick(t);
+  }
+  reader_->setCurR(curR + n);
+  SMILE_IDBG(4, "tick # %i, processed %ld frames", t, n);
+  matO->copyTimeMeta(matI->tmeta, n);
+  writer_->setNextMatrix(matO);
+  return TICK_SUCCESS;
+}
 
 void cVectorProcessor::multiConfFree(void *x)
 {
@@ -420,6 +454,8 @@ cVectorProcessor::~cVectorProcessor()
     free(confBs);
   if (vecO != NULL)
     delete vecO;
+  if (matO != NULL)
+    delete matO;
   if (bufTransposeOutput_ != NULL)
     free(bufTransposeOutput_);
   if (bufTransposeInput_ != NULL)
@@ -81,6 +81,7 @@ SMILECOMPONENT_REGCOMP(cWinToVecProcessor)
     ct->setField("frameCenterFrames","The frame sampling center in input level frames (overrides frameCenter, if set), (0=left)",0,0,0);
     ct->setField("frameCenterSpecial","The frame sampling center (overrides the other frameCenter options, if set). The available special frame sampling points as strings are: 'mid' = middle (first frame from -frameSize/2 to frameSize/2), 'left' = sample at the beginning of the frame (first frame from 0 to frameSize), 'right' = sample at the end of the frame (first frame from -frameSize to 0)","left");
     ct->setField("noPostEOIprocessing","1 = do not process incomplete windows at the end of the input",1);
+    ct->setField("incremental", "1 = in frameMode 'fixed' with overlapping windows (frameStep < frameSize) and frameCenter at the left, components which support it (cFunctionals) update their results from the previous window by adding the new and removing the expired input frames, instead of processing each window from scratch. In frameMode 'full', components which support it (cFunctionals with functionals which do not need the stored input) process the input frames as they arrive, so the input level does not need to hold the whole input (it can be a ring buffer). Streaming uses the same input frames as the stored full input, i.e. those available in the first tick at the end of the input. The results differ from the non-incremental ones by rounding errors, which can be large relative to results close to zero (e.g. means of delta coefficients), and percentiles are approximate (see cFunctionalPercentiles.sketch). With a ring buffer input level smaller than the input, only streaming processes the whole input.", 0);
 //    ct->setField("frameBorderList","array list of frame borders (in seconds), if frameMode==list",(const char*)NULL, ARRAY_TYPE);
 //    ct->setField("frameList","array list of frame start/end times (in seconds) (specifiy as: '0.3-1.7 ; 0.9-2.1', for example), if frameMode==list (use either this OR frameBorderList)",(const char*)NULL, ARRAY_TYPE);
   )
@@ -112,6 +113,7 @@ cWinToVecProcessor::cWinToVecProcessor(const char *_name) :
   lastText(NULL), lastCustom(NULL),
   tmpFrameF(NULL),
   noPostEOIprocessing(0),
+  incremental(0), useIncremental(0), useStreaming(0), streamStarted(0), streamFlushed(0), streamEnd(0.0),
   nQ(0),
   frameMode(FRAMEMODE_FIXED),
   ivSec(NULL), ivFrames(NULL),
@@ -320,6 +322,7 @@ void cWinToVecProcessor::myFetchConfig()
 
   noPostEOIprocessing = getInt("noPostEOIprocessing");
   if (noPostEOIprocessing) { SMILE_IDBG(2,"not processing incomplete frames at end of input"); }
+  incremental = getInt("incremental");
   
   const char *tmp = getStr("frameMode");
   if (tmp != NULL) {
@@ -668,6 +671,27 @@ int cWinToVecProcessor::dataProcessorCustomFinalise()
     if (Mult*Ni != No) COMP_ERR("Mult not constant (as returned by setupNamesForField! This is not allowed! Mult*Ni=%i <> No=%i",Mult*Ni,No);
     if (tmpFrameF==NULL) tmpFrameF=(FLOAT_DMEM*)calloc(1,sizeof(FLOAT_DMEM)*Mult);
   }
+
+  useIncremental = 0;
+  useStreaming = 0;
+  if (incremental && frameMode == FRAMEMODE_FULL) {
+    if (!supportsStreaming() || wholeMatrixMode) {
+      SMILE_IWRN(2,"option 'incremental' with frameMode = full is not supported by this component (with this configuration), ignoring it");
+    } else {
+      useStreaming = 1;
+      SMILE_IDBG(2,"processing the full input frame by frame as it arrives");
+    }
+  } else if (incremental) {
+    if (!supportsIncremental() || wholeMatrixMode) {
+      SMILE_IWRN(2,"option 'incremental' is not supported by this component (with this configuration), ignoring it");
+    } else if ((frameMode != FRAMEMODE_FIXED) || (pre != 0)
+        || (frameStepFrames <= 0) || (frameStepFrames >= frameSizeFrames)) {
+      SMILE_IWRN(2,"option 'incremental' requires frameMode = fixed, frameStep < frameSize and frameCenter at the left, ignoring it");
+    } else {
+      useIncremental = 1;
+      SMILE_IDBG(2,"processing overlapping windows incrementally");
+    }
+  }
   return 1;
 }
 
@@ -719,7 +743,7 @@ int cWinToVecProcessor::myFinaliseInstance()
 }
 */
 
-int cWinToVecProcessor::doProcessMatrix(int idxi, cMatrix *in, FLOAT_DMEM *out, long nOut)
+int cWinToVecProcessor::doProcessMatrix(int idxi, const cMatrix *in, FLOAT_DMEM *out, long nOut)
 {
   SMILE_IERR(1,"doProcessMatrix (type FLOAT_DMEM) is not implemented in this component, however for some reason the 'wholeMatrixMode' variable was set to 1...!");
   return 0;
@@ -742,6 +766,13 @@ int cWinToVecProcessor::doProcess(int idxi, cMatrix *row, FLOAT_DMEM*y)
   // return -1 if you don't want to set a new output frame...
 }
 
+// default for components which do not support incremental processing: process the full row
+int cWinToVecProcessor::doProcessIncremental(int idxi, const cMatrix *win, long vIdx, FLOAT_DMEM *y)
+{
+  tmpRow = win->getRow(idxi,tmpRow);
+  return doProcess(idxi,tmpRow,y);
+}
+
 int cWinToVecProcessor::doFlush(int idxi, FLOAT_DMEM*y)
 {
   //SMILE_IERR(1,"dataType FLOAT_DMEM not yet supported!");
@@ -856,7 +887,8 @@ void cWinToVecProcessor::addVecToBuf(cVector *ve)
     matBuf = new cMatrix(ve->N, MATBUF_ALLOC_STEP);
   }
   if (matBuf->nT <= matBufN) {
-    matBuf->resize(matBufN + MATBUF_ALLOC_STEP);
+    // grow geometrically, so that the number of reallocations is logarithmic in the segment length
+    matBuf->resize(MAX(matBufN + MATBUF_ALLOC_STEP, 2*matBuf->nT));
   }
   long i;
   for (i=0; i<ve->N; i++) {
@@ -879,9 +911,10 @@ eTickResult cWinToVecProcessor::myTick(long long t)
   if (!(writer_->checkWrite(1))) return TICK_DEST_NO_SPACE;
 
   int customID = 0;
-  cMatrix *mat=NULL;
+  const cMatrix *mat=NULL;
   cVector * vec=NULL;
   int isFinal = 0;
+  long winVidx = 0;  // start of the window in frameMode fixed and full
   // get next frame from dataMemory
   if (frameMode == FRAMEMODE_META) { 
     vec = reader_->getNextFrame();
@@ -920,7 +953,7 @@ eTickResult cWinToVecProcessor::myTick(long long t)
     double end = 0.0;
     if (peekNextFrameData(&start, &end, &isFinal, &customID)) { // TODO: add turn end flag here (isFinal)
       SMILE_IDBG(3,"getting frame based on received message: vIdx %i - %i",(long)start, (long)end);
-      mat = reader_->getMatrix((long)start,(long)(end-start)+1);
+      mat = reader_->getMatrixView((long)start,(long)(end-start)+1);
       if (mat != NULL) {
         SMILE_IDBG(2,"successfully got frame based on received message: vIdx %i - %i (nT:%i)",(long)start, (long)end, mat->nT);
         clearNextFrameData();
@@ -944,7 +977,7 @@ eTickResult cWinToVecProcessor::myTick(long long t)
       long end = ivFrames[frameIdx*2+1];
       SMILE_IDBG(3,"attempting to get next frame from list: vIdx %i - %i",(long)start, (long)end);
       if (end > 0) {
-        mat = reader_->getMatrix((long)start,(long)(end-start) + 1);
+        mat = reader_->getMatrixView((long)start,(long)(end-start) + 1);
       } else if (end == -2) {
         SMILE_IWRN(1,"a segment boundary from current position to end of input is not yet supported!");
       }
@@ -964,23 +997,53 @@ eTickResult cWinToVecProcessor::myTick(long long t)
       return TICK_INACTIVE;
     }
 
+  } else if (useStreaming) {
+
+    // pass all frames available to the rows, the results are produced by doFlush at the end of the
+    // input. Like the stored full input, which is read in the first tick at the end of the input,
+    // the frames written to the input level(s) after this tick are not included.
+    if (streamFlushed) return TICK_INACTIVE;
+    long curR = reader_->getCurR();
+    long n = reader_->getMaxR() + 1 - curR;
+    int i, nRead = 0;
+    if (n > 0) {
+      const cMatrix *frames = reader_->getMatrixView(curR, n);
+      if (frames != NULL) {
+        if (!streamStarted) {
+          streamFirst = frames->tmeta[0];
+          streamStarted = 1;
+        }
+        streamEnd = frames->tmeta[frames->nT-1].time + frames->tmeta[frames->nT-1].lengthSec;
+        for (i=0; i<Ni; i++) {
+          doProcessStream(i, frames, curR);
+        }
+        reader_->setCurR(curR + frames->nT);
+        nRead = 1;
+      }
+    }
+    if (!(isEOI()&&EOIlevelIsMatch())) {
+      return nRead ? TICK_SUCCESS : TICK_SOURCE_NOT_AVAIL;
+    }
+    // at the end of the input mat is NULL, which flushes the streamed frames below
+
   } else {
+    winVidx = reader_->getCurR();
     if (allow_last_frame_incomplete_ == 1) {
-      mat = reader_->getNextMatrix(0, 0, DMEM_PAD_NONE);
+      mat = reader_->getNextMatrixView(0, DMEM_PAD_NONE);
 #ifdef DEBUG
       long ss = 0;
       if (mat != NULL) ss = mat->nT;
       SMILE_IDBG(4, "winToVecProcessor: get mat with DMEM_PAD_NONE, eoi = %i, mat = %ld (size %ld)\n", isEOI(), mat, ss);
 #endif
     } else if (allow_last_frame_incomplete_ == 2) {
-      mat = reader_->getNextMatrix(0, 0, DMEM_PAD_ZERO);
+      mat = reader_->getNextMatrixView(0, DMEM_PAD_ZERO);
 #ifdef DEBUG
       long ss = 0;
       if (mat != NULL) ss = mat->nT;
       SMILE_IDBG(4, "winToVecProcessor: get mat with DMEM_PAD_ZERO, eoi = %i, mat = %ld (size %ld)\n", isEOI(), mat, ss);
 #endif
     } else {
-      mat = reader_->getNextMatrix();
+      mat = reader_->getNextMatrixView();
 #ifdef DEBUG
       long ss = 0;
       if (mat != NULL) ss = mat->nT;
@@ -1041,44 +1104,57 @@ eTickResult cWinToVecProcessor::myTick(long long t)
 
   } else { // process each row independently and concatenate output vectors
 
-    for (i=0; i<Ni; i++) {
-      long Mu;
-      //cMatrix *r=NULL;
-      if (mat!=NULL) {
-        tmpRow = mat->getRow(i,tmpRow);
-        Mu = doProcess(i,tmpRow,tmpFrameF);
-      } else {
-        Mu = doFlush(i,tmpFrameF);
-      }
-      if ((Mu > 0)&&(toSet==1)) {
-        // copy data into main vector
-        Mu = MIN(Mu,Mult);
-        memcpy( tmpVec->data+i*Mult, tmpFrameF, sizeof(FLOAT_DMEM)*Mu ); // was: *Mult
-        if (Mu<Mult)
-          memset( tmpVec->data+i*Mult+Mu, 0, sizeof(FLOAT_DMEM)*(Mult-Mu) );
-      } else { 
-        toSet=0;
-        if (Mu==0) {
-          ret=0;
+    int incr = (mat!=NULL)&&(useIncremental)&&(mat->nT == frameSizeFrames);
+    if ((mat==NULL)||(!doProcessRows(mat,winVidx,incr,tmpVec->data))) {
+      for (i=0; i<Ni; i++) {
+        long Mu;
+        //cMatrix *r=NULL;
+        if (incr) {
+          Mu = doProcessIncremental(i,mat,winVidx,tmpFrameF);
+        } else if (mat!=NULL) {
+          tmpRow = mat->getRow(i,tmpRow);
+          Mu = doProcess(i,tmpRow,tmpFrameF);
+        } else {
+          Mu = doFlush(i,tmpFrameF);
         }
+        if ((Mu > 0)&&(toSet==1)) {
+          // copy data into main vector
+          Mu = MIN(Mu,Mult);
+          memcpy( tmpVec->data+i*Mult, tmpFrameF, sizeof(FLOAT_DMEM)*Mu ); // was: *Mult
+          if (Mu<Mult)
+            memset( tmpVec->data+i*Mult+Mu, 0, sizeof(FLOAT_DMEM)*(Mult-Mu) );
+        } else { 
+          toSet=0;
+          if (Mu==0) {
+            ret=0;
+          }
+        }
+        //if (r!=NULL) delete r;
       }
-      //if (r!=NULL) delete r;
     }
   }
   
   if (toSet == 1) {
     if (frameMode == FRAMEMODE_META) { 
-      mat->nT = matBufNalloc;
+      matBuf->nT = matBufNalloc;
       matBufN = 0; // (the vector we just added)
       addVecToBuf(vec);
     } else {
       // generate new tmeta from first and last tmeta
+      // (mat may be a view into the data memory, so its tmeta must not be modified)
       if (mat != NULL) {
-        mat->squashTimeMeta();
+        mat->getSquashedTimeMeta(tmpVec->tmeta);
         if (frameCenterFrames>0) {
-          mat->tmeta[0].time += frameCenter;
+          tmpVec->tmeta[0].time += frameCenter;
+        }
+      } else if (useStreaming && streamStarted) {
+        // squashed time meta info of all streamed frames
+        *(tmpVec->tmeta) = streamFirst;
+        tmpVec->tmeta->framePeriod = streamFirst.period;
+        tmpVec->tmeta->lengthSec = streamEnd - streamFirst.time;
+        if (frameCenterFrames>0) {
+          tmpVec->tmeta[0].time += frameCenter;
         }
-        tmpVec->setTimeMeta(mat->tmeta);  // copyTimeMeta ??
       } else {
         // ugly TODO: compute correct tmeta...
       }
@@ -1094,6 +1170,10 @@ eTickResult cWinToVecProcessor::myTick(long long t)
     // save to dataMemory
     writer_->setNextFrame(tmpVec);
   }
+  if (useStreaming && mat == NULL && streamStarted) {
+    streamStarted = 0;
+    streamFlushed = 1;
+  }
 
   return ret ? TICK_SUCCESS : TICK_INACTIVE;
 }
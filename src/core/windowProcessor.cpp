@@ -173,8 +173,8 @@ eTickResult cWindowProcessor::myTick(long long t)
   
   if (!(writer_->checkWrite(blocksizeW_))) return TICK_DEST_NO_SPACE;
 
-  // get next block from dataMemory
-  cMatrix *mat = reader_->getNextMatrix();
+  // get next block from dataMemory (read-only view, no copy)
+  const cMatrix *mat = reader_->getNextMatrixView();
   // TODO: if blocksize< order!! also check if we need to increase the read counter!
   if (mat != NULL) {
 
@@ -213,9 +213,8 @@ eTickResult cWindowProcessor::myTick(long long t)
     }
     // set next matrix...
     if (toSet==1)  {
-      mat->tmeta += pre; // TODO::: skip "order" elements of tmeta array ..ok?
-      matnew->setTimeMeta(mat->tmeta); 
-      mat->tmeta -= pre;
+      // TODO::: skip "order" elements of tmeta array ..ok?
+      matnew->setTimeMeta(mat->tmeta + pre);
       writer_->setNextMatrix(matnew);
     }
   } else {
@@ -8,7 +8,8 @@
 
 /*  openSMILE component: resmapler
 
-resampling using fft and ideal sin/cos interpolation
+resampling using fft and ideal sin/cos interpolation,
+or polyphase windowed-sinc FIR filtering in the time domain
 
 */
 
@@ -16,6 +17,11 @@ resampling using fft and ideal sin/cos interpolation
 #include <dsp/smileResample.hpp>
 #include <dspcore/fftXg.h>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SMILERESAMPLE_SSE
+#endif
+
 #define MODULE "cSmileResample"
 
 
@@ -35,7 +41,12 @@ SMILECOMPONENT_REGCOMP(cSmileResample)
     ct->setField("resampleRatio","A fixed resample ratio a (a=fsNew/fsCurrent). If set, this overrides targetFs",1.0,0,0);
     ct->setField("pitchRatio","Low-quality pitch scaling factor, if != 1.0 ",1.0);
     ct->setField("useQuickAlgo","Use a quick algo for low-quality integer-ratio DOWN(!)sampling.",0);
-    ct->setField("winSize","Internal window size in seconds (will be rounded to nearest power of 2 framesize internally). This affects the quality of the resampling and the accuracy of the target sampling rate. Larger window sizes allow for a more accurate target sampling frequency, i.e. less pitch distortion.",0.030);  
+    ct->setField("winSize","Internal window size in seconds (will be rounded to nearest power of 2 framesize internally). This affects the quality of the resampling and the accuracy of the target sampling rate. Larger window sizes allow for a more accurate target sampling frequency, i.e. less pitch distortion. With polyphase = 1 this is the maximum size of the blocks read from the input level, it does not affect the output.",0.030);  
+    ct->setField("polyphase","1 = resample in the time domain with a polyphase FIR filter (Kaiser windowed sinc) instead of the spectral domain algorithm. The resampling ratio is approximated by a fraction L/M with L <= maxPhases (exact for integer sampling rates, e.g. 160/441 for 44.1 kHz to 16 kHz). The output is sample exact (ceil(N*L/M) output samples for N input samples, the first output sample is aligned with the first input sample) and the delay is only half the filter length (zeroCrossings/cutoff input samples for upsampling). pitchRatio is not supported in this mode.",0);
+    ct->setField("zeroCrossings","(polyphase = 1) Number of zero crossings of the sinc function on each side of the filter, i.e. half the filter length in samples at the lower of the input and output sampling rates. Higher values give a steeper lowpass filter.",16);
+    ct->setField("cutoff","(polyphase = 1) Cutoff frequency of the anti-aliasing/interpolation lowpass filter relative to the Nyquist frequency of the lower of the input and output sampling rates.",0.95);
+    ct->setField("kaiserBeta","(polyphase = 1) Parameter beta of the Kaiser window applied to the sinc function. Higher values give a higher stopband attenuation but a wider transition band.",8.0);
+    ct->setField("maxPhases","(polyphase = 1) Maximum number of filter phases L, i.e. the maximum numerator of the resampling ratio L/M. For sampling rates that are not integers, or ratios that would require more phases, the ratio is approximated by the closest fraction with at most this numerator.",1024);
     // NOTE: blocksize will be determined by winSize
     //ct->setField("blocksize", "size of data blocks to process in frames", 0);
     ct->disableField("blocksize");
@@ -54,7 +65,9 @@ cSmileResample::cSmileResample(const char *_name) :
   cDataProcessor(_name),   
   inputBuf(NULL), outputBuf(NULL), lastOutputBuf(NULL),
   resampleWork(NULL), rowout(NULL), matnew(NULL), row(NULL),
-  flushed(0)
+  flushed(0), polyphase(0), firL(1), firM(1), firH(0), fir(NULL),
+  pbuf(NULL), pbufCap(0), pbufStart(0), pbufN(0),
+  inIdx(0), phase(0), totalIn(-1), matout(NULL)
 {
 }
 
@@ -89,6 +102,32 @@ void cSmileResample::myFetchConfig()
  useQuickAlgo = getInt("useQuickAlgo");
  SMILE_IDBG(2,"useQuickAlgo = %i",useQuickAlgo);
 
+ polyphase = getInt("polyphase");
+ SMILE_IDBG(2,"polyphase = %i",polyphase);
+ if (polyphase) {
+   zeroCrossings = getInt("zeroCrossings");
+   if (zeroCrossings < 1) {
+     SMILE_IERR(1,"zeroCrossings must be >= 1 (is %i), setting it to 1",zeroCrossings);
+     zeroCrossings = 1;
+   }
+   cutoff = getDouble("cutoff");
+   if (cutoff <= 0.0 || cutoff > 1.0) {
+     SMILE_IERR(1,"cutoff must be > 0.0 and <= 1.0 (is %f), setting it to 0.95",cutoff);
+     cutoff = 0.95;
+   }
+   kaiserBeta = getDouble("kaiserBeta");
+   maxPhases = getInt("maxPhases");
+   if (maxPhases < 1) maxPhases = 1;
+   if (useQuickAlgo) {
+     SMILE_IWRN(1,"useQuickAlgo is ignored, because polyphase = 1");
+     useQuickAlgo = 0;
+   }
+   if (pitchRatio != 1.0) {
+     SMILE_IWRN(1,"pitchRatio is not supported with polyphase = 1, it will be ignored");
+     pitchRatio = 1.0;
+   }
+ }
+
 }
 
 int cSmileResample::configureWriter(sDmLevelConfig &c)
@@ -111,6 +150,22 @@ int cSmileResample::configureWriter(sDmLevelConfig &c)
     targetFs = resampleRatio * sr;
   }
 
+  if (polyphase) {
+    computePolyphaseFilter(sr);
+    // the reader does not wait for full blocks, all available input is processed in each tick
+    blocksizeR_ = (long)round(winSize/bT);
+    if (blocksizeR_ < 2*firH) blocksizeR_ = 2*firH;
+    blocksizeR_sec_ = (double)blocksizeR_ * bT;
+    blocksizeW_ = blocksizeR_ * firL / firM + 1;
+    blocksizeW_sec_ = (double)blocksizeW_ / targetFs;
+    c.blocksizeWriter = blocksizeW_;
+    c.T = 1.0/targetFs;
+    // like audio sources, the output samples have no individual time meta information
+    c.noTimeMeta = true;
+    reader_->setBlocksize(blocksizeR_);
+    return 1;
+  }
+
   if (useQuickAlgo) {
     if (resampleRatio > 1.0) {
       COMP_ERR("cannot use quick resampling algo for upsampling!");
@@ -178,6 +233,17 @@ int cSmileResample::dataProcessorCustomFinalise()
 
   // allocate buffers:
   Ni = reader_->getLevelN();
+  if (polyphase) {
+    // history of 2*firH-1 frames, a block of new input, and firH zeros appended at the end of input
+    pbufCap = 3*firH + blocksizeR_;
+    pbuf = (FLOAT_DMEM*)calloc(1,sizeof(FLOAT_DMEM)*Ni*pbufCap);
+    if (pbuf == NULL) OUT_OF_MEMORY;
+    // input before the first sample is zero
+    pbufStart = -(firH-1);
+    pbufN = firH-1;
+    matout = new cMatrix(Ni, blocksizeW_);
+    return 1;
+  }
   outputBuf = (FLOAT_DMEM*)calloc(1,sizeof(FLOAT_DMEM)*Ni*winSizeFramesTarget);
   lastOutputBuf = (FLOAT_DMEM*)calloc(1,sizeof(FLOAT_DMEM)*Ni*(winSizeFramesTarget/2+1));
   inputBuf = (FLOAT_TYPE_FFT*)calloc(1,sizeof(FLOAT_TYPE_FFT)*Ni*winSizeFrames);
@@ -187,6 +253,122 @@ int cSmileResample::dataProcessorCustomFinalise()
 
 
 
+// modified Bessel function of the first kind, order 0 (for the Kaiser window)
+static double besselI0(double x)
+{
+  double sum = 1.0, term = 1.0;
+  for (int k = 1; k < 100; k++) {
+    double y = x / (2.0 * (double)k);
+    term *= y * y;
+    sum += term;
+    if (term < 1e-12 * sum) break;
+  }
+  return sum;
+}
+
+void cSmileResample::computePolyphaseFilter(double sr)
+{
+  // resampling ratio as a fraction firL/firM
+  firL = 0;
+  double rsr = round(sr);
+  double rfs = round(targetFs);
+  if (rsr >= 1.0 && rfs >= 1.0 && fabs(sr - rsr) < 1e-6 && fabs(targetFs - rfs) < 1e-6) {
+    long a = (long)rfs, b = (long)rsr;
+    while (b != 0) { long r = a % b; a = b; b = r; }
+    firL = (long)rfs / a;
+    firM = (long)rsr / a;
+  }
+  if (firL < 1 || firL > maxPhases) {
+    // closest convergent of the continued fraction expansion with a numerator <= maxPhases
+    long p0 = 0, q0 = 1, p1 = 1, q1 = 0;
+    double x = resampleRatio;
+    for (int i = 0; i < 64; i++) {
+      double a = floor(x);
+      if (a > (double)maxPhases * 1e6) break;
+      long p2 = (long)a * p1 + p0;
+      long q2 = (long)a * q1 + q0;
+      if (p2 > maxPhases || q2 > 1000000000L) break;
+      p0 = p1; q0 = q1; p1 = p2; q1 = q2;
+      if (x - a < 1e-12) break;
+      x = 1.0 / (x - a);
+    }
+    firL = p1; firM = q1;
+    if (firL < 1) {
+      firL = 1;
+      firM = (long)round(1.0 / resampleRatio);
+    }
+  }
+  double newFs = sr * (double)firL / (double)firM;
+  if (newFs != targetFs) {
+    SMILE_IMSG(2,"NOTE: actual output rate is targetRate* = %f (resampling ratio %ld/%ld, increase maxPhases for more accuracy)",newFs,firL,firM);
+  }
+  SMILE_IMSG(3,"polyphase resampling with ratio %ld/%ld",firL,firM);
+  targetFs = newFs;
+  resampleRatio = (double)firL / (double)firM;
+
+  // lowpass cutoff relative to the input Nyquist frequency
+  double fc = cutoff;
+  if (firL < firM) fc *= (double)firL / (double)firM;
+  firH = (long)ceil((double)zeroCrossings / fc);
+  if (firH & 1) firH++;  // number of taps is a multiple of 4 (SSE)
+  long nTaps = 2*firH;
+  SMILE_IDBG(2,"polyphase filter: %ld phases of %ld taps",firL,nTaps);
+
+  if (fir != NULL) free(fir);
+  fir = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*firL*nTaps);
+  double *h = (double*)malloc(sizeof(double)*nTaps);
+  if (fir == NULL || h == NULL) OUT_OF_MEMORY;
+  double i0beta = besselI0(kaiserBeta);
+  for (long p = 0; p < firL; p++) {
+    double frac = (double)p / (double)firL;
+    double sum = 0.0;
+    for (long k = 0; k < nTaps; k++) {
+      // distance of input sample k from the output sample position (in input samples)
+      double tt = (double)(k - firH + 1) - frac;
+      double r = tt / (double)firH;
+      h[k] = 0.0;
+      if (fabs(r) < 1.0) {
+        h[k] = fc * besselI0(kaiserBeta * sqrt(1.0 - r*r)) / i0beta;
+        if (tt != 0.0) h[k] *= smileDsp_sinc(M_PI * fc * tt);
+      }
+      sum += h[k];
+    }
+    // normalise each phase to unity gain at DC
+    FLOAT_DMEM *f = fir + p*nTaps;
+    for (long k = 0; k < nTaps; k++) {
+      f[k] = (FLOAT_DMEM)(h[k] / sum);
+    }
+  }
+  free(h);
+}
+
+// inner product of n filter taps and n input samples (n is a multiple of 4)
+static inline FLOAT_DMEM firDotProduct(const FLOAT_DMEM *h, const FLOAT_DMEM *x, long n)
+{
+#ifdef SMILERESAMPLE_SSE
+  __m128 s0 = _mm_setzero_ps();
+  __m128 s1 = _mm_setzero_ps();
+  long k = 0;
+  for (; k + 8 <= n; k += 8) {
+    s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(h+k), _mm_loadu_ps(x+k)));
+    s1 = _mm_add_ps(s1, _mm_mul_ps(_mm_loadu_ps(h+k+4), _mm_loadu_ps(x+k+4)));
+  }
+  if (k < n) {
+    s0 = _mm_add_ps(s0, _mm_mul_ps(_mm_loadu_ps(h+k), _mm_loadu_ps(x+k)));
+  }
+  s0 = _mm_add_ps(s0, s1);
+  float sum[4];
+  _mm_storeu_ps(sum, s0);
+  return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+#else
+  FLOAT_DMEM sum = 0.0;
+  for (long k = 0; k < n; k++) {
+    sum += h[k] * x[k];
+  }
+  return sum;
+#endif
+}
+
 int cSmileResample::getOutput(FLOAT_DMEM *cur, FLOAT_DMEM *last, long N, FLOAT_DMEM *out, long Nout)
 {
   long i;
@@ -203,10 +385,93 @@ int cSmileResample::getOutput(FLOAT_DMEM *cur, FLOAT_DMEM *last, long N, FLOAT_D
   return 1;
 }
 
+eTickResult cSmileResample::polyphaseTick(long long t)
+{
+  long i, j;
+  long nTaps = 2*firH;
+
+  // append the available input to the history buffer
+  long nIn = 0;
+  int padded = 0;
+  if (totalIn < 0) {
+    long curR = reader_->getCurR();
+    nIn = reader_->getMaxR() + 1 - curR;
+    if (nIn > pbufCap - firH - pbufN) nIn = pbufCap - firH - pbufN;
+    if (nIn > 0) {
+      const cMatrix *mat = reader_->getMatrixView(curR, nIn);
+      if (mat != NULL) {
+        for (j=0; j<Ni; j++) {
+          FLOAT_DMEM *b = pbuf + j*pbufCap + pbufN;
+          const FLOAT_DMEM *x = mat->data + j;
+          for (i=0; i<nIn; i++) {
+            b[i] = x[i*Ni];
+          }
+        }
+        reader_->setCurR(curR + nIn);
+        pbufN += nIn;
+      } else {
+        nIn = 0;
+      }
+    }
+    // end of input: append zeros for the filter lookahead of the last output samples
+    if (isEOI() && reader_->getMaxR() + 1 <= reader_->getCurR()) {
+      totalIn = pbufStart + pbufN;
+      for (j=0; j<Ni; j++) {
+        memset(pbuf + j*pbufCap + pbufN, 0, sizeof(FLOAT_DMEM)*firH);
+      }
+      pbufN += firH;
+      padded = 1;
+    }
+  }
+
+  // compute all output samples for which the input is complete
+  long nFree = blocksizeW_;
+  if (!writer_->checkWrite(nFree)) nFree = writer_->getNFree();
+  matout->allocData(Ni, blocksizeW_);
+  long end = pbufStart + pbufN;
+  long nOut = 0;
+  while (nOut < nFree && inIdx + firH < end) {
+    const FLOAT_DMEM *h = fir + phase*nTaps;
+    const FLOAT_DMEM *x = pbuf + (inIdx - firH + 1 - pbufStart);
+    FLOAT_DMEM *out = matout->data + nOut*Ni;
+    for (j=0; j<Ni; j++) {
+      out[j] = firDotProduct(h, x + j*pbufCap, nTaps);
+    }
+    nOut++;
+    phase += firM;
+    inIdx += phase / firL;
+    phase %= firL;
+  }
+
+  // drop input which is no longer needed
+  long drop = inIdx - firH + 1 - pbufStart;
+  if (drop > pbufN) drop = pbufN;
+  if (drop > 0) {
+    for (j=0; j<Ni; j++) {
+      memmove(pbuf + j*pbufCap, pbuf + j*pbufCap + drop, sizeof(FLOAT_DMEM)*(pbufN - drop));
+    }
+    pbufStart += drop;
+    pbufN -= drop;
+  }
+
+  if (nOut > 0) {
+    matout->allocData(Ni, nOut);
+    writer_->setNextMatrix(matout);
+  }
+  SMILE_IDBG(4,"tick # %i, read %ld input frames, wrote %ld output frames",t,nIn,nOut);
+
+  if (nIn > 0 || nOut > 0 || padded) return TICK_SUCCESS;
+  if (nFree <= 0) return TICK_DEST_NO_SPACE;
+  if (totalIn >= 0) return TICK_INACTIVE;
+  return TICK_SOURCE_NOT_AVAIL;
+}
+
 eTickResult cSmileResample::myTick(long long t)
 {
   long i,j;
 
+  if (polyphase) return polyphaseTick(t);
+
   SMILE_IDBG(4,"tick # %i, running resampler",t);
   //if ((isEOI())&&(noPostEOIprocessing)) return 0;
   if ((isEOI())) {
@@ -314,6 +579,9 @@ cSmileResample::~cSmileResample()
   if (row != NULL) delete row;
   if (rowout != NULL) delete rowout;
   if (matnew != NULL) delete matnew;
+  if (matout != NULL) delete matout;
+  if (fir != NULL) free(fir);
+  if (pbuf != NULL) free(pbuf);
   smileDsp_resampleWorkFree(resampleWork);
 }
 
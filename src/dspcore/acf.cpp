@@ -69,9 +69,8 @@ expBeforeAbs(0),
 cosLifterCepstrum(0),
 usePower(0), cepstrum(0), inverse(0),
 data(NULL),
-w(NULL),
-ip(NULL),
-winFunc(NULL)
+winFunc(NULL),
+fft(NULL)
 {
 }
 
@@ -158,9 +157,7 @@ int cAcf::setupNamesForField(int i, const char*name, long nEl)
 
 int cAcf::dataProcessorCustomFinalise()
 {
-  if (ip == NULL) ip = (int**)multiConfAlloc();
-  if (w == NULL) w = (FLOAT_TYPE_FFT**)multiConfAlloc();
-  if (data == NULL) data = (FLOAT_TYPE_FFT**)multiConfAlloc();
+  if (data == NULL) data = (FLOAT_DMEM**)multiConfAlloc();
   if (winFunc == NULL) winFunc = (FLOAT_DMEM**)multiConfAlloc();
 
   return cVectorProcessor::dataProcessorCustomFinalise();
@@ -171,29 +168,32 @@ int cAcf::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long
 {
   long i,n;
   idxi=getFconf(idxi);
-  FLOAT_TYPE_FFT *_data = data[idxi];
-  int *_ip = ip[idxi];
-  FLOAT_TYPE_FFT *_w = w[idxi];
+  FLOAT_DMEM *_data = data[idxi];
 
   if (inverse) {
     long N = Nsrc;
     if (symmetricData) {
       N = Nsrc * 2;
     }
+    if (!smileMath_isPowerOf2(N)) {
+      SMILE_IERR(1,"input size %i is not a power of 2, this is required for the fft!", N);
+      return 0;
+    }
     if (_data == NULL) {
-      _data = (FLOAT_TYPE_FFT*)malloc(sizeof(FLOAT_TYPE_FFT)*N);
+      _data = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*N);
+    }
+    if (fft == NULL || fft->getN() != N) {
+      fft = cSmileFft::getPlan(N, getFftEngine());
     }
-    if (_ip==NULL) _ip = (int *)calloc(1,sizeof(int)*(N+2));
-    if (_w==NULL) _w = (FLOAT_TYPE_FFT *)calloc(1,sizeof(FLOAT_TYPE_FFT)*(N*5)/4+2);
 
     // normal fft  (time -> spec)  // TODO: check dim of data etc.
     if (cepstrum && cosLifterCepstrum) {
       for (i = 0; i < Nsrc; i++) {
-        _data[i] = (FLOAT_TYPE_FFT)src[i] * winFunc[idxi][i];
+        _data[i] = (FLOAT_DMEM)src[i] * winFunc[idxi][i];
       }
     } else {
       for (i = 0; i < Nsrc; i++) {
-        _data[i] = (FLOAT_TYPE_FFT)src[i];
+        _data[i] = (FLOAT_DMEM)src[i];
       }
     }
 
@@ -203,7 +203,7 @@ int cAcf::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long
       }
     }
 
-    rdft(N, 1, _data, _ip, _w);
+    fft->rdft(1, _data);
 
     // do exp for inverse cepstrum
     if (cepstrum && expBeforeAbs) {
@@ -267,18 +267,19 @@ int cAcf::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long
 
     // data preparation for inverse fft:
     if (_data == NULL) {
-      _data = (FLOAT_TYPE_FFT*)malloc(sizeof(FLOAT_TYPE_FFT)*N);
+      _data = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*N);
+    }
+    if (fft == NULL || fft->getN() != N) {
+      fft = cSmileFft::getPlan(N, getFftEngine());
     }
-    if (_ip==NULL) _ip = (int *)calloc(1,sizeof(int)*(N+2));
-    if (_w==NULL) _w = (FLOAT_TYPE_FFT *)calloc(1,sizeof(FLOAT_TYPE_FFT)*(N*5)/4+2);
 
     if (cepstrum) {
       if (oldCompatCepstrum_) {
-        _data[0] = (FLOAT_TYPE_FFT)(src[0]);
-        _data[1] = (FLOAT_TYPE_FFT)(src[Nsrc-1]);
+        _data[0] = (FLOAT_DMEM)(src[0]);
+        _data[1] = (FLOAT_DMEM)(src[Nsrc-1]);
         for (i=2; i<N-1; i += 2) {
           if (src[i>>1] > 0.0) {
-            _data[i] = (FLOAT_TYPE_FFT)log(src[i>>1]);
+            _data[i] = (FLOAT_DMEM)log(src[i>>1]);
           } else {
             _data[i] = 0.0;
           }
@@ -286,18 +287,18 @@ int cAcf::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long
         }
       } else {
         if (src[0] > 0.0) {
-          _data[0] = (FLOAT_TYPE_FFT)(log(src[0] + 1.0));
+          _data[0] = (FLOAT_DMEM)(log(src[0] + 1.0));
         } else {
           _data[0] = 0.0;
         }
         if (src[Nsrc - 1] > 0.0) {
-          _data[1] = (FLOAT_TYPE_FFT)(log(src[Nsrc - 1] + 1.0));
+          _data[1] = (FLOAT_DMEM)(log(src[Nsrc - 1] + 1.0));
         } else {
           _data[1] = 0.0;
         }
         for (i=2; i<N-1; i += 2) {
           if (src[i>>1] > 0.0) {
-            _data[i] = (FLOAT_TYPE_FFT)log(src[i>>1] + 1.0);
+            _data[i] = (FLOAT_DMEM)log(src[i>>1] + 1.0);
           } else {
             _data[i] = 0.0;
           }
@@ -305,16 +306,16 @@ int cAcf::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long
         }
       }
     } else {
-      _data[0] = (FLOAT_TYPE_FFT)(src[0]);
-      _data[1] = (FLOAT_TYPE_FFT)(src[Nsrc-1]);
+      _data[0] = (FLOAT_DMEM)(src[0]);
+      _data[1] = (FLOAT_DMEM)(src[Nsrc-1]);
       for (i=2; i<N-1; i += 2) {
-        _data[i] = (FLOAT_TYPE_FFT)(src[i>>1]);
+        _data[i] = (FLOAT_DMEM)(src[i>>1]);
         _data[i+1] = 0.0;
       }
     }
 
     // inverse fft
-    rdft(N, -1, _data, _ip, _w);
+    fft->rdft(-1, _data);
 
     // NOTE: The symmetricData option is implicitly handled by (i<N)&&(i<Ndst) and Ndst limiting the output size.
     // TODO : debug the symmetricData option when doing cepstrum and inv cepstrum
@@ -348,15 +349,11 @@ int cAcf::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long
     if ((usePower)&&(_src!=NULL)) free((void *)_src);
   }
   data[idxi] = _data;
-  ip[idxi] = _ip;
-  w[idxi] = _w;
   return 1;
 }
 
 cAcf::~cAcf()
 {
-  multiConfFree(ip);
-  multiConfFree(w);
   multiConfFree(data);
   multiConfFree(winFunc);
 }
@@ -175,6 +175,48 @@ int cFFTmagphase::setupNamesForField(int i, const char*name, long nEl)
 
 
 
+// magnitude computation, shared with cSpectrumFramer
+void cFFTmagphase::computeMagnitude(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, int normalise, int power,
+    int dBpsd, FLOAT_DMEM dBpnorm, FLOAT_DMEM mindBp)
+{
+  long n;
+  if (!dBpsd && !normalise && !power) {
+    dst[0] = fabs(src[0]);
+    for(n=2; n<Nsrc; n += 2) {
+      dst[n/2] = sqrt(src[n]*src[n] + src[n+1]*src[n+1]);
+    }
+    dst[Nsrc/2] = fabs(src[1]);
+  } else if (!dBpsd && normalise && !power) {
+    dst[0] = ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*fabs(src[0]);
+    for(n=2; n<Nsrc; n += 2) {
+      dst[n/2] = ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*sqrt(src[n]*src[n] + src[n+1]*src[n+1]);
+    }
+    dst[Nsrc/2] = ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*fabs(src[1]);
+  } else if (!dBpsd && normalise && power) {
+    dst[0] = ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*src[0]; 
+    dst[0] *= dst[0];
+    for(n=2; n<Nsrc; n += 2) {
+      dst[n/2] = ((FLOAT_DMEM)1.0/((FLOAT_DMEM)Nsrc*(FLOAT_DMEM)Nsrc))*(src[n]*src[n] + src[n+1]*src[n+1]);
+    }
+    dst[Nsrc/2] = ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*fabs(src[1]);
+    dst[Nsrc/2] *= dst[Nsrc/2];
+  } else if (!dBpsd && !normalise && power) {
+    dst[0] = fabs(src[0]); 
+    dst[0] *= dst[0];
+    for(n=2; n<Nsrc; n += 2) {
+      dst[n/2] = (src[n]*src[n] + src[n+1]*src[n+1]);
+    }
+    dst[Nsrc/2] = fabs(src[1]);
+    dst[Nsrc/2] *= dst[Nsrc/2];
+  } else if (dBpsd) {
+    dst[0] = MAX(mindBp, (dBpnorm + (FLOAT_DMEM)20.0 * log10( ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*fabs(src[0]) )));
+    for(n=2; n<Nsrc; n += 2) {
+      dst[n/2] = MAX(mindBp, (dBpnorm + (FLOAT_DMEM)10.0 * log10( ((FLOAT_DMEM)1.0/((FLOAT_DMEM)Nsrc*(FLOAT_DMEM)Nsrc))*(src[n]*src[n] + src[n+1]*src[n+1]) )) );
+    }
+    dst[Nsrc/2] = MAX(mindBp, (dBpnorm + (FLOAT_DMEM)20.0 * log10( ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*fabs(src[1]) )));
+  }
+}
+
 // a derived class should override this method, in order to implement the actual processing
 int cFFTmagphase::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi) // idxi=input field index
 {
@@ -211,48 +253,8 @@ int cFFTmagphase::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsr
       doMag = 1;
     }
 
-    if (doMag) {
-      if (magnitude && !dBpsd && !normalise && !power) {
-        dst[0] = fabs(src[0]);
-        for(n=2; n<Nsrc; n += 2) {
-          dst[n/2] = sqrt(src[n]*src[n] + src[n+1]*src[n+1]);
-        }
-        dst[Nsrc/2] = fabs(src[1]);
-        //dst += Nsrc/2+1;
-        //    dst += Nsrc/2;
-      } else if (magnitude && !dBpsd && normalise && !power) {
-        dst[0] = ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*fabs(src[0]);
-        for(n=2; n<Nsrc; n += 2) {
-          dst[n/2] = ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*sqrt(src[n]*src[n] + src[n+1]*src[n+1]);
-        }
-        dst[Nsrc/2] = ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*fabs(src[1]);
-        //dst += Nsrc/2+1;
-      } else if (magnitude && !dBpsd && normalise && power) {
-        dst[0] = ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*src[0]; 
-        dst[0] *= dst[0];
-        for(n=2; n<Nsrc; n += 2) {
-          dst[n/2] = ((FLOAT_DMEM)1.0/((FLOAT_DMEM)Nsrc*(FLOAT_DMEM)Nsrc))*(src[n]*src[n] + src[n+1]*src[n+1]);
-        }
-        dst[Nsrc/2] = ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*fabs(src[1]);
-        dst[Nsrc/2] *= dst[Nsrc/2];
-        //dst += Nsrc/2+1;
-      } else if (magnitude && !dBpsd && !normalise && power) {
-        dst[0] = fabs(src[0]); 
-        dst[0] *= dst[0];
-        for(n=2; n<Nsrc; n += 2) {
-          dst[n/2] = (src[n]*src[n] + src[n+1]*src[n+1]);
-        }
-        dst[Nsrc/2] = fabs(src[1]);
-        dst[Nsrc/2] *= dst[Nsrc/2];
-        //dst += Nsrc/2+1;
-      } else if (magnitude && dBpsd) {
-        dst[0] = MAX(mindBp, (dBpnorm + (FLOAT_DMEM)20.0 * log10( ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*fabs(src[0]) )));
-        for(n=2; n<Nsrc; n += 2) {
-          dst[n/2] = MAX(mindBp, (dBpnorm + (FLOAT_DMEM)10.0 * log10( ((FLOAT_DMEM)1.0/((FLOAT_DMEM)Nsrc*(FLOAT_DMEM)Nsrc))*(src[n]*src[n] + src[n+1]*src[n+1]) )) );
-        }
-        dst[Nsrc/2] = MAX(mindBp, (dBpnorm + (FLOAT_DMEM)20.0 * log10( ((FLOAT_DMEM)1.0/(FLOAT_DMEM)Nsrc)*fabs(src[1]) )));
-        //dst += Nsrc/2+1;
-      }
+    if (doMag && magnitude) {
+      computeMagnitude(src, dst, Nsrc, normalise, power, dBpsd, dBpnorm, mindBp);
     }
     if (phase) {
       if (joinMagphase && magnitude) {
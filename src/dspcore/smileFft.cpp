@@ -0,0 +1,565 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*
+   shared FFT engine for real-valued FFTs of power-of-2 sizes
+   (see smileFft.hpp for a description)
+ */
+
+
+#include <dspcore/smileFft.hpp>
+#include <dspcore/fftXg.h>
+#include <smileutil/smileUtil.h>
+#include <map>
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define SMILE_FFT_SSE
+#endif
+
+#define MODULE "cSmileFft"
+
+cSmileFft::cSmileFft(long _N, int _engine) :
+  N(_N), M(_N / 2), engine(_engine), nStages4(0), radix2(false)
+{
+  if (engine == SMILE_FFT_ENGINE_FFTSG) {
+    if (N >= 4) {
+      // rdft initialises the tables on its first call, a transform of zeros does this here,
+      // so that the tables are read-only when the plan is shared
+      ip.assign(N + 2, 0);
+      w.assign((N * 5) / 4 + 2, 0.0f);
+      std::vector<float> a(N, 0.0f);
+      ::rdft((int)N, 1, a.data(), ip.data(), w.data());
+    }
+    return;
+  }
+
+  // twiddle factors of the complex FFT stages
+  long n = M;
+  while (n >= 4) {
+    long m = n / 4;
+    size_t off = stageTw.size();
+    stageTw.resize(off + 6 * m);
+    float *tw = stageTw.data() + off;
+    for (long p = 0; p < m; p++) {
+      for (int k = 1; k <= 3; k++) {
+        double phi = -2.0 * M_PI * (double)(k * p) / (double)n;
+        tw[(2 * k - 2) * m + p] = (float)cos(phi);
+        tw[(2 * k - 1) * m + p] = (float)sin(phi);
+      }
+    }
+    nStages4++;
+    n = m;
+  }
+  radix2 = (n == 2);
+
+  // twiddle factors of the split step
+  splitCos.resize(M / 2 + 1);
+  splitSin.resize(M / 2 + 1);
+  for (long k = 0; k <= M / 2; k++) {
+    double phi = 2.0 * M_PI * (double)k / (double)N;
+    splitCos[k] = (float)cos(phi);
+    splitSin[k] = (float)sin(phi);
+  }
+}
+
+const cSmileFft * cSmileFft::getPlan(long N, int engine)
+{
+  static std::mutex plansMtx;
+  static std::map<std::pair<long, int>, std::unique_ptr<cSmileFft>> plans;
+
+  if (N < 2 || !smileMath_isPowerOf2(N)) {
+    COMP_ERR("getPlan: FFT size %ld is not a power of 2", N);
+  }
+  if (engine != SMILE_FFT_ENGINE_FFTSG && engine != SMILE_FFT_ENGINE_RADIX4) {
+    COMP_ERR("getPlan: unknown FFT engine %i", engine);
+  }
+  std::lock_guard<std::mutex> lock(plansMtx);
+  std::unique_ptr<cSmileFft> &plan = plans[std::make_pair(N, engine)];
+  if (plan == nullptr) {
+    plan.reset(new cSmileFft(N, engine));
+    SMILE_DBG(3, "created FFT plan for size %ld (engine %i)", N, engine);
+  }
+  return plan.get();
+}
+
+int cSmileFft::getEngineByName(const char *name)
+{
+  if (name == NULL) return SMILE_FFT_ENGINE_FFTSG;
+  if (!strcasecmp(name, "fftsg")) return SMILE_FFT_ENGINE_FFTSG;
+  if (!strcasecmp(name, "radix4")) return SMILE_FFT_ENGINE_RADIX4;
+  return -1;
+}
+
+/**** complex FFT kernels ****/
+
+// radix-4 butterflies for stride s (s=1 or s multiple of 4 with SSE)
+static void fftRadix4(long m, long s, const float *xr, const float *xi, float *yr, float *yi,
+    const float *w1r, const float *w1i, const float *w2r, const float *w2i, const float *w3r, const float *w3i)
+{
+  long p = 0;
+#ifdef SMILE_FFT_SSE
+  if (s == 1 && m >= 4) {
+    // first stage: 4 values of p at a time, transpose the results to store them contiguously
+    for (; p + 4 <= m; p += 4) {
+      __m128 ar = _mm_loadu_ps(xr + p),         ai = _mm_loadu_ps(xi + p);
+      __m128 br = _mm_loadu_ps(xr + p + m),     bi = _mm_loadu_ps(xi + p + m);
+      __m128 cr = _mm_loadu_ps(xr + p + 2 * m), ci = _mm_loadu_ps(xi + p + 2 * m);
+      __m128 dr = _mm_loadu_ps(xr + p + 3 * m), di = _mm_loadu_ps(xi + p + 3 * m);
+      __m128 apcr = _mm_add_ps(ar, cr), apci = _mm_add_ps(ai, ci);
+      __m128 amcr = _mm_sub_ps(ar, cr), amci = _mm_sub_ps(ai, ci);
+      __m128 bpdr = _mm_add_ps(br, dr), bpdi = _mm_add_ps(bi, di);
+      __m128 bmdr = _mm_sub_ps(br, dr), bmdi = _mm_sub_ps(bi, di);
+      __m128 y0r = _mm_add_ps(apcr, bpdr), y0i = _mm_add_ps(apci, bpdi);
+      __m128 t1r = _mm_add_ps(amcr, bmdi), t1i = _mm_sub_ps(amci, bmdr);
+      __m128 t2r = _mm_sub_ps(apcr, bpdr), t2i = _mm_sub_ps(apci, bpdi);
+      __m128 t3r = _mm_sub_ps(amcr, bmdi), t3i = _mm_add_ps(amci, bmdr);
+      __m128 c1r = _mm_loadu_ps(w1r + p), c1i = _mm_loadu_ps(w1i + p);
+      __m128 c2r = _mm_loadu_ps(w2r + p), c2i = _mm_loadu_ps(w2i + p);
+      __m128 c3r = _mm_loadu_ps(w3r + p), c3i = _mm_loadu_ps(w3i + p);
+      __m128 y1r = _mm_sub_ps(_mm_mul_ps(c1r, t1r), _mm_mul_ps(c1i, t1i));
+      __m128 y1i = _mm_add_ps(_mm_mul_ps(c1r, t1i), _mm_mul_ps(c1i, t1r));
+      __m128 y2r = _mm_sub_ps(_mm_mul_ps(c2r, t2r), _mm_mul_ps(c2i, t2i));
+      __m128 y2i = _mm_add_ps(_mm_mul_ps(c2r, t2i), _mm_mul_ps(c2i, t2r));
+      __m128 y3r = _mm_sub_ps(_mm_mul_ps(c3r, t3r), _mm_mul_ps(c3i, t3i));
+      __m128 y3i = _mm_add_ps(_mm_mul_ps(c3r, t3i), _mm_mul_ps(c3i, t3r));
+      _MM_TRANSPOSE4_PS(y0r, y1r, y2r, y3r);
+      _MM_TRANSPOSE4_PS(y0i, y1i, y2i, y3i);
+      _mm_storeu_ps(yr + 4 * p,      y0r); _mm_storeu_ps(yi + 4 * p,      y0i);
+      _mm_storeu_ps(yr + 4 * p + 4,  y1r); _mm_storeu_ps(yi + 4 * p + 4,  y1i);
+      _mm_storeu_ps(yr + 4 * p + 8,  y2r); _mm_storeu_ps(yi + 4 * p + 8,  y2i);
+      _mm_storeu_ps(yr + 4 * p + 12, y3r); _mm_storeu_ps(yi + 4 * p + 12, y3i);
+    }
+  } else if (s >= 4) {
+    // later stages: 4 values of q at a time with the same twiddle factors
+    for (; p < m; p++) {
+      __m128 c1r = _mm_set1_ps(w1r[p]), c1i = _mm_set1_ps(w1i[p]);
+      __m128 c2r = _mm_set1_ps(w2r[p]), c2i = _mm_set1_ps(w2i[p]);
+      __m128 c3r = _mm_set1_ps(w3r[p]), c3i = _mm_set1_ps(w3i[p]);
+      const float *xar = xr + s * p, *xai = xi + s * p;
+      float *yar = yr + s * 4 * p, *yai = yi + s * 4 * p;
+      for (long q = 0; q < s; q += 4) {
+        __m128 ar = _mm_loadu_ps(xar + q),             ai = _mm_loadu_ps(xai + q);
+        __m128 br = _mm_loadu_ps(xar + q + s * m),     bi = _mm_loadu_ps(xai + q + s * m);
+        __m128 cr = _mm_loadu_ps(xar + q + 2 * s * m), ci = _mm_loadu_ps(xai + q + 2 * s * m);
+        __m128 dr = _mm_loadu_ps(xar + q + 3 * s * m), di = _mm_loadu_ps(xai + q + 3 * s * m);
+        __m128 apcr = _mm_add_ps(ar, cr), apci = _mm_add_ps(ai, ci);
+        __m128 amcr = _mm_sub_ps(ar, cr), amci = _mm_sub_ps(ai, ci);
+        __m128 bpdr = _mm_add_ps(br, dr), bpdi = _mm_add_ps(bi, di);
+        __m128 bmdr = _mm_sub_ps(br, dr), bmdi = _mm_sub_ps(bi, di);
+        __m128 t1r = _mm_add_ps(amcr, bmdi), t1i = _mm_sub_ps(amci, bmdr);
+        __m128 t2r = _mm_sub_ps(apcr, bpdr), t2i = _mm_sub_ps(apci, bpdi);
+        __m128 t3r = _mm_sub_ps(amcr, bmdi), t3i = _mm_add_ps(amci, bmdr);
+        _mm_storeu_ps(yar + q, _mm_add_ps(apcr, bpdr));
+        _mm_storeu_ps(yai + q, _mm_add_ps(apci, bpdi));
+        _mm_storeu_ps(yar + q + s, _mm_sub_ps(_mm_mul_ps(c1r, t1r), _mm_mul_ps(c1i, t1i)));
+        _mm_storeu_ps(yai + q + s, _mm_add_ps(_mm_mul_ps(c1r, t1i), _mm_mul_ps(c1i, t1r)));
+        _mm_storeu_ps(yar + q + 2 * s, _mm_sub_ps(_mm_mul_ps(c2r, t2r), _mm_mul_ps(c2i, t2i)));
+        _mm_storeu_ps(yai + q + 2 * s, _mm_add_ps(_mm_mul_ps(c2r, t2i), _mm_mul_ps(c2i, t2r)));
+        _mm_storeu_ps(yar + q + 3 * s, _mm_sub_ps(_mm_mul_ps(c3r, t3r), _mm_mul_ps(c3i, t3i)));
+        _mm_storeu_ps(yai + q + 3 * s, _mm_add_ps(_mm_mul_ps(c3r, t3i), _mm_mul_ps(c3i, t3r)));
+      }
+    }
+  }
+#endif
+  for (; p < m; p++) {
+    float c1r = w1r[p], c1i = w1i[p], c2r = w2r[p], c2i = w2i[p], c3r = w3r[p], c3i = w3i[p];
+    for (long q = 0; q < s; q++) {
+      long i0 = q + s * p;
+      float ar = xr[i0],             ai = xi[i0];
+      float br = xr[i0 + s * m],     bi = xi[i0 + s * m];
+      float cr = xr[i0 + 2 * s * m], ci = xi[i0 + 2 * s * m];
+      float dr = xr[i0 + 3 * s * m], di = xi[i0 + 3 * s * m];
+      float apcr = ar + cr, apci = ai + ci;
+      float amcr = ar - cr, amci = ai - ci;
+      float bpdr = br + dr, bpdi = bi + di;
+      float bmdr = br - dr, bmdi = bi - di;
+      float t1r = amcr + bmdi, t1i = amci - bmdr;
+      float t2r = apcr - bpdr, t2i = apci - bpdi;
+      float t3r = amcr - bmdi, t3i = amci + bmdr;
+      long o0 = q + s * 4 * p;
+      yr[o0] = apcr + bpdr;
+      yi[o0] = apci + bpdi;
+      yr[o0 + s] = c1r * t1r - c1i * t1i;
+      yi[o0 + s] = c1r * t1i + c1i * t1r;
+      yr[o0 + 2 * s] = c2r * t2r - c2i * t2i;
+      yi[o0 + 2 * s] = c2r * t2i + c2i * t2r;
+      yr[o0 + 3 * s] = c3r * t3r - c3i * t3i;
+      yi[o0 + 3 * s] = c3r * t3i + c3i * t3r;
+    }
+  }
+}
+
+// final radix-2 butterflies (stage size 2) for stride s
+static void fftRadix2(long s, const float *xr, const float *xi, float *yr, float *yi)
+{
+  long q = 0;
+#ifdef SMILE_FFT_SSE
+  for (; q + 4 <= s; q += 4) {
+    __m128 ar = _mm_loadu_ps(xr + q),     ai = _mm_loadu_ps(xi + q);
+    __m128 br = _mm_loadu_ps(xr + q + s), bi = _mm_loadu_ps(xi + q + s);
+    _mm_storeu_ps(yr + q, _mm_add_ps(ar, br));
+    _mm_storeu_ps(yi + q, _mm_add_ps(ai, bi));
+    _mm_storeu_ps(yr + q + s, _mm_sub_ps(ar, br));
+    _mm_storeu_ps(yi + q + s, _mm_sub_ps(ai, bi));
+  }
+#endif
+  for (; q < s; q++) {
+    float ar = xr[q], ai = xi[q], br = xr[q + s], bi = xi[q + s];
+    yr[q] = ar + br;
+    yi[q] = ai + bi;
+    yr[q + s] = ar - br;
+    yi[q + s] = ai - bi;
+  }
+}
+
+void cSmileFft::cfft(float *zr, float *zi, float *tr, float *ti, float **outR, float **outI) const
+{
+  float *xr = zr, *xi = zi, *yr = tr, *yi = ti;
+  const float *tw = stageTw.data();
+  long n = M, s = 1;
+  for (int st = 0; st < nStages4; st++) {
+    long m = n / 4;
+    fftRadix4(m, s, xr, xi, yr, yi, tw, tw + m, tw + 2 * m, tw + 3 * m, tw + 4 * m, tw + 5 * m);
+    tw += 6 * m;
+    std::swap(xr, yr);
+    std::swap(xi, yi);
+    n = m;
+    s *= 4;
+  }
+  if (radix2) {
+    fftRadix2(s, xr, xi, yr, yi);
+    std::swap(xr, yr);
+    std::swap(xi, yi);
+  }
+  *outR = xr;
+  *outI = xi;
+}
+
+/**** real FFT ****/
+
+// work area for the complex FFT, per thread since plans are shared
+static thread_local std::vector<float> fftWork;
+
+void cSmileFft::rdft(int isgn, float *a) const
+{
+  if (engine == SMILE_FFT_ENGINE_FFTSG) {
+    if (N >= 4) {
+      ::rdft((int)N, isgn, a, const_cast<int *>(ip.data()), const_cast<float *>(w.data()));
+    } else {
+      // fftsg would re-initialise its tables on every call for N = 2
+      float x = a[0] - a[1];
+      if (isgn >= 0) {
+        a[0] += a[1];
+        a[1] = x;
+      } else {
+        a[1] = 0.5f * x;
+        a[0] -= a[1];
+      }
+    }
+    return;
+  }
+  if ((long)fftWork.size() < 4 * M) fftWork.resize(4 * M);
+  float *zr = fftWork.data(), *zi = zr + M, *tr = zi + M, *ti = tr + M;
+  float *yr, *yi;
+  const float *wc = splitCos.data(), *ws = splitSin.data();
+  long k = 1;
+
+  if (isgn >= 0) {
+    // z[m] = a[2m] + i*a[2m+1]
+    long j = 0;
+#ifdef SMILE_FFT_SSE
+    for (; j + 4 <= M; j += 4) {
+      __m128 v0 = _mm_loadu_ps(a + 2 * j), v1 = _mm_loadu_ps(a + 2 * j + 4);
+      _mm_storeu_ps(zr + j, _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(zi + j, _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+#endif
+    for (; j < M; j++) {
+      zr[j] = a[2 * j];
+      zi[j] = a[2 * j + 1];
+    }
+    cfft(zr, zi, tr, ti, &yr, &yi);
+
+    // split step: X[k] = E[k] + exp(-2*pi*i*k/N)*O[k] with E[k] = (Z[k] + conj(Z[M-k]))/2,
+    // O[k] = -i*(Z[k] - conj(Z[M-k]))/2, output R[k] = Re(X[k]), I[k] = -Im(X[k])
+    a[0] = yr[0] + yi[0];
+    a[1] = yr[0] - yi[0];
+#ifdef SMILE_FFT_SSE
+    const __m128 half = _mm_set1_ps(0.5f), signMask = _mm_set1_ps(-0.0f);
+    for (; k + 4 <= M / 2; k += 4) {
+      __m128 ar = _mm_loadu_ps(yr + k), ai = _mm_loadu_ps(yi + k);
+      __m128 br = _mm_shuffle_ps(_mm_loadu_ps(yr + M - k - 3), _mm_loadu_ps(yr + M - k - 3), _MM_SHUFFLE(0, 1, 2, 3));
+      __m128 bi = _mm_shuffle_ps(_mm_loadu_ps(yi + M - k - 3), _mm_loadu_ps(yi + M - k - 3), _MM_SHUFFLE(0, 1, 2, 3));
+      __m128 er = _mm_mul_ps(half, _mm_add_ps(ar, br)), ei = _mm_mul_ps(half, _mm_sub_ps(ai, bi));
+      __m128 or_ = _mm_mul_ps(half, _mm_add_ps(ai, bi)), oi = _mm_mul_ps(half, _mm_sub_ps(br, ar));
+      __m128 c = _mm_loadu_ps(wc + k), s = _mm_loadu_ps(ws + k);
+      __m128 tR = _mm_add_ps(_mm_mul_ps(c, or_), _mm_mul_ps(s, oi));
+      __m128 tI = _mm_sub_ps(_mm_mul_ps(c, oi), _mm_mul_ps(s, or_));
+      __m128 xr = _mm_add_ps(er, tR), xi = _mm_xor_ps(signMask, _mm_add_ps(ei, tI));
+      _mm_storeu_ps(a + 2 * k, _mm_unpacklo_ps(xr, xi));
+      _mm_storeu_ps(a + 2 * k + 4, _mm_unpackhi_ps(xr, xi));
+      __m128 x2r = _mm_sub_ps(er, tR), x2i = _mm_sub_ps(ei, tI);
+      x2r = _mm_shuffle_ps(x2r, x2r, _MM_SHUFFLE(0, 1, 2, 3));
+      x2i = _mm_shuffle_ps(x2i, x2i, _MM_SHUFFLE(0, 1, 2, 3));
+      _mm_storeu_ps(a + 2 * (M - k - 3), _mm_unpacklo_ps(x2r, x2i));
+      _mm_storeu_ps(a + 2 * (M - k - 3) + 4, _mm_unpackhi_ps(x2r, x2i));
+    }
+#endif
+    for (; k <= M / 2; k++) {
+      float ar = yr[k], ai = yi[k], br = yr[M - k], bi = yi[M - k];
+      float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);
+      float or_ = 0.5f * (ai + bi), oi = 0.5f * (br - ar);
+      float tR = wc[k] * or_ + ws[k] * oi;
+      float tI = wc[k] * oi - ws[k] * or_;
+      a[2 * k] = er + tR;
+      a[2 * k + 1] = -(ei + tI);
+      a[2 * (M - k)] = er - tR;
+      a[2 * (M - k) + 1] = ei - tI;
+    }
+  } else {
+    // inverse split step: Z[k] = E[k] + i*O[k] with E[k] = (X[k] + conj(X[M-k]))/2,
+    // O[k] = exp(2*pi*i*k/N)*(X[k] - conj(X[M-k]))/2
+    // the inverse complex FFT is computed as forward FFT with real and imaginary parts swapped,
+    // thus Im(Z) is stored in zr and Re(Z) in zi
+    zr[0] = 0.5f * (a[0] - a[1]);
+    zi[0] = 0.5f * (a[0] + a[1]);
+#ifdef SMILE_FFT_SSE
+    const __m128 half = _mm_set1_ps(0.5f), signMask = _mm_set1_ps(-0.0f);
+    for (; k + 4 <= M / 2; k += 4) {
+      __m128 v0 = _mm_loadu_ps(a + 2 * k), v1 = _mm_loadu_ps(a + 2 * k + 4);
+      __m128 pr = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+      __m128 pi = _mm_xor_ps(signMask, _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1)));
+      __m128 u0 = _mm_loadu_ps(a + 2 * (M - k - 3)), u1 = _mm_loadu_ps(a + 2 * (M - k - 3) + 4);
+      __m128 qr = _mm_shuffle_ps(u0, u1, _MM_SHUFFLE(2, 0, 2, 0));
+      __m128 qi = _mm_xor_ps(signMask, _mm_shuffle_ps(u0, u1, _MM_SHUFFLE(3, 1, 3, 1)));
+      qr = _mm_shuffle_ps(qr, qr, _MM_SHUFFLE(0, 1, 2, 3));
+      qi = _mm_shuffle_ps(qi, qi, _MM_SHUFFLE(0, 1, 2, 3));
+      __m128 er = _mm_mul_ps(half, _mm_add_ps(pr, qr)), ei = _mm_mul_ps(half, _mm_sub_ps(pi, qi));
+      __m128 fr = _mm_mul_ps(half, _mm_sub_ps(pr, qr)), fi = _mm_mul_ps(half, _mm_add_ps(pi, qi));
+      __m128 c = _mm_loadu_ps(wc + k), s = _mm_loadu_ps(ws + k);
+      __m128 or_ = _mm_sub_ps(_mm_mul_ps(c, fr), _mm_mul_ps(s, fi));
+      __m128 oi = _mm_add_ps(_mm_mul_ps(c, fi), _mm_mul_ps(s, fr));
+      _mm_storeu_ps(zi + k, _mm_sub_ps(er, oi));
+      _mm_storeu_ps(zr + k, _mm_add_ps(ei, or_));
+      __m128 z2r = _mm_add_ps(er, oi), z2i = _mm_sub_ps(or_, ei);
+      _mm_storeu_ps(zi + M - k - 3, _mm_shuffle_ps(z2r, z2r, _MM_SHUFFLE(0, 1, 2, 3)));
+      _mm_storeu_ps(zr + M - k - 3, _mm_shuffle_ps(z2i, z2i, _MM_SHUFFLE(0, 1, 2, 3)));
+    }
+#endif
+    for (; k <= M / 2; k++) {
+      float pr = a[2 * k], pi = -a[2 * k + 1], qr = a[2 * (M - k)], qi = -a[2 * (M - k) + 1];
+      float er = 0.5f * (pr + qr), ei = 0.5f * (pi - qi);
+      float fr = 0.5f * (pr - qr), fi = 0.5f * (pi + qi);
+      float or_ = wc[k] * fr - ws[k] * fi;
+      float oi = wc[k] * fi + ws[k] * fr;
+      zi[k] = er - oi;
+      zr[k] = ei + or_;
+      zi[M - k] = er + oi;
+      zr[M - k] = or_ - ei;
+    }
+    cfft(zr, zi, tr, ti, &yr, &yi);
+
+    // x[2m] = Re(z[m]) (stored in yi), x[2m+1] = Im(z[m]) (stored in yr)
+    long j = 0;
+#ifdef SMILE_FFT_SSE
+    for (; j + 4 <= M; j += 4) {
+      __m128 re = _mm_loadu_ps(yi + j), im = _mm_loadu_ps(yr + j);
+      _mm_storeu_ps(a + 2 * j, _mm_unpacklo_ps(re, im));
+      _mm_storeu_ps(a + 2 * j + 4, _mm_unpackhi_ps(re, im));
+    }
+#endif
+    for (; j < M; j++) {
+      a[2 * j] = yi[j];
+      a[2 * j + 1] = yr[j];
+    }
+  }
+}
+
+/**** batched real FFT ****/
+
+#ifdef SMILE_FFT_SSE
+
+// The batched transforms process 4 frames at a time: every complex value of the FFT is a vector holding
+// the value of the 4 frames, thus the butterflies are the same as in the scalar code with all values
+// replaced by vectors and the twiddle factors broadcast to all lanes. The arithmetic is exactly the same
+// as in rdft(), so the results are identical.
+
+// radix-4 butterflies for stride s on vectors of 4 frames
+static void fftRadix4Lanes(long m, long s, const __m128 *xr, const __m128 *xi, __m128 *yr, __m128 *yi,
+    const float *w1r, const float *w1i, const float *w2r, const float *w2i, const float *w3r, const float *w3i)
+{
+  for (long p = 0; p < m; p++) {
+    __m128 c1r = _mm_set1_ps(w1r[p]), c1i = _mm_set1_ps(w1i[p]);
+    __m128 c2r = _mm_set1_ps(w2r[p]), c2i = _mm_set1_ps(w2i[p]);
+    __m128 c3r = _mm_set1_ps(w3r[p]), c3i = _mm_set1_ps(w3i[p]);
+    const __m128 *xar = xr + s * p, *xai = xi + s * p;
+    __m128 *yar = yr + s * 4 * p, *yai = yi + s * 4 * p;
+    for (long q = 0; q < s; q++) {
+      __m128 ar = xar[q],             ai = xai[q];
+      __m128 br = xar[q + s * m],     bi = xai[q + s * m];
+      __m128 cr = xar[q + 2 * s * m], ci = xai[q + 2 * s * m];
+      __m128 dr = xar[q + 3 * s * m], di = xai[q + 3 * s * m];
+      __m128 apcr = _mm_add_ps(ar, cr), apci = _mm_add_ps(ai, ci);
+      __m128 amcr = _mm_sub_ps(ar, cr), amci = _mm_sub_ps(ai, ci);
+      __m128 bpdr = _mm_add_ps(br, dr), bpdi = _mm_add_ps(bi, di);
+      __m128 bmdr = _mm_sub_ps(br, dr), bmdi = _mm_sub_ps(bi, di);
+      __m128 t1r = _mm_add_ps(amcr, bmdi), t1i = _mm_sub_ps(amci, bmdr);
+      __m128 t2r = _mm_sub_ps(apcr, bpdr), t2i = _mm_sub_ps(apci, bpdi);
+      __m128 t3r = _mm_sub_ps(amcr, bmdi), t3i = _mm_add_ps(amci, bmdr);
+      yar[q] = _mm_add_ps(apcr, bpdr);
+      yai[q] = _mm_add_ps(apci, bpdi);
+      yar[q + s] = _mm_sub_ps(_mm_mul_ps(c1r, t1r), _mm_mul_ps(c1i, t1i));
+      yai[q + s] = _mm_add_ps(_mm_mul_ps(c1r, t1i), _mm_mul_ps(c1i, t1r));
+      yar[q + 2 * s] = _mm_sub_ps(_mm_mul_ps(c2r, t2r), _mm_mul_ps(c2i, t2i));
+      yai[q + 2 * s] = _mm_add_ps(_mm_mul_ps(c2r, t2i), _mm_mul_ps(c2i, t2r));
+      yar[q + 3 * s] = _mm_sub_ps(_mm_mul_ps(c3r, t3r), _mm_mul_ps(c3i, t3i));
+      yai[q + 3 * s] = _mm_add_ps(_mm_mul_ps(c3r, t3i), _mm_mul_ps(c3i, t3r));
+    }
+  }
+}
+
+// final radix-2 butterflies (stage size 2) for stride s on vectors of 4 frames
+static void fftRadix2Lanes(long s, const __m128 *xr, const __m128 *xi, __m128 *yr, __m128 *yi)
+{
+  for (long q = 0; q < s; q++) {
+    __m128 ar = xr[q], ai = xi[q], br = xr[q + s], bi = xi[q + s];
+    yr[q] = _mm_add_ps(ar, br);
+    yi[q] = _mm_add_ps(ai, bi);
+    yr[q + s] = _mm_sub_ps(ar, br);
+    yi[q + s] = _mm_sub_ps(ai, bi);
+  }
+}
+
+// complex FFT of 4 frames (see cfft), returns pointers to the result in *outR and *outI
+static void cfftLanes(long M, int nStages4, bool radix2, const float *tw,
+    __m128 *zr, __m128 *zi, __m128 *tr, __m128 *ti, __m128 **outR, __m128 **outI)
+{
+  __m128 *xr = zr, *xi = zi, *yr = tr, *yi = ti;
+  long n = M, s = 1;
+  for (int st = 0; st < nStages4; st++) {
+    long m = n / 4;
+    fftRadix4Lanes(m, s, xr, xi, yr, yi, tw, tw + m, tw + 2 * m, tw + 3 * m, tw + 4 * m, tw + 5 * m);
+    tw += 6 * m;
+    std::swap(xr, yr);
+    std::swap(xi, yi);
+    n = m;
+    s *= 4;
+  }
+  if (radix2) {
+    fftRadix2Lanes(s, xr, xi, yr, yi);
+    std::swap(xr, yr);
+    std::swap(xi, yi);
+  }
+  *outR = xr;
+  *outI = xi;
+}
+
+// work area for the batched transforms (4 arrays of M vectors, plus room for 16 byte alignment), per thread
+static thread_local std::vector<float> fftBatchWork;
+
+// maximum FFT size for which frames are transformed in lanes: for larger sizes the working set of
+// 4 frames no longer fits into the L2 cache, and rdft (which is vectorised over the butterflies) is faster
+#define SMILE_FFT_BATCH_MAXN 1024
+
+#endif // SMILE_FFT_SSE
+
+void cSmileFft::rdftBatch(int isgn, float *a, long stride, long nFrames) const
+{
+  long f = 0;
+#ifdef SMILE_FFT_SSE
+  if (engine == SMILE_FFT_ENGINE_RADIX4 && N >= 4 && N <= SMILE_FFT_BATCH_MAXN) {
+    if ((long)fftBatchWork.size() < 16 * M + 3) fftBatchWork.resize(16 * M + 3);
+    __m128 *zr = (__m128 *)(((uintptr_t)fftBatchWork.data() + 15) & ~(uintptr_t)15);
+    __m128 *zi = zr + M, *tr = zi + M, *ti = tr + M;
+    __m128 *yr, *yi;
+    const float *wc = splitCos.data(), *ws = splitSin.data();
+    const __m128 half = _mm_set1_ps(0.5f), signMask = _mm_set1_ps(-0.0f);
+
+    for (; f + 4 <= nFrames; f += 4) {
+      float *a0 = a + f * stride, *a1 = a0 + stride, *a2 = a1 + stride, *a3 = a2 + stride;
+      if (isgn >= 0) {
+        // z[m] = a[2m] + i*a[2m+1], transposed to one frame per lane
+        for (long j = 0; j < M; j += 2) {
+          __m128 r0 = _mm_loadu_ps(a0 + 2 * j), r1 = _mm_loadu_ps(a1 + 2 * j);
+          __m128 r2 = _mm_loadu_ps(a2 + 2 * j), r3 = _mm_loadu_ps(a3 + 2 * j);
+          _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+          zr[j] = r0; zi[j] = r1; zr[j + 1] = r2; zi[j + 1] = r3;
+        }
+        cfftLanes(M, nStages4, radix2, stageTw.data(), zr, zi, tr, ti, &yr, &yi);
+
+        // split step (see rdft), the output in rdft format is written to the work vectors not holding y
+        __m128 *o = (yr == zr) ? tr : zr;
+        o[0] = _mm_add_ps(yr[0], yi[0]);
+        o[1] = _mm_sub_ps(yr[0], yi[0]);
+        for (long k = 1; k <= M / 2; k++) {
+          __m128 ar = yr[k], ai = yi[k], br = yr[M - k], bi = yi[M - k];
+          __m128 er = _mm_mul_ps(half, _mm_add_ps(ar, br)), ei = _mm_mul_ps(half, _mm_sub_ps(ai, bi));
+          __m128 or_ = _mm_mul_ps(half, _mm_add_ps(ai, bi)), oi = _mm_mul_ps(half, _mm_sub_ps(br, ar));
+          __m128 c = _mm_set1_ps(wc[k]), s = _mm_set1_ps(ws[k]);
+          __m128 tR = _mm_add_ps(_mm_mul_ps(c, or_), _mm_mul_ps(s, oi));
+          __m128 tI = _mm_sub_ps(_mm_mul_ps(c, oi), _mm_mul_ps(s, or_));
+          o[2 * k] = _mm_add_ps(er, tR);
+          o[2 * k + 1] = _mm_xor_ps(signMask, _mm_add_ps(ei, tI));
+          o[2 * (M - k)] = _mm_sub_ps(er, tR);
+          o[2 * (M - k) + 1] = _mm_sub_ps(ei, tI);
+        }
+        // transpose back to one frame per row
+        for (long i = 0; i < N; i += 4) {
+          __m128 r0 = o[i], r1 = o[i + 1], r2 = o[i + 2], r3 = o[i + 3];
+          _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+          _mm_storeu_ps(a0 + i, r0); _mm_storeu_ps(a1 + i, r1);
+          _mm_storeu_ps(a2 + i, r2); _mm_storeu_ps(a3 + i, r3);
+        }
+      } else {
+        // input in rdft format, transposed to one frame per lane
+        __m128 *o = tr;
+        for (long i = 0; i < N; i += 4) {
+          __m128 r0 = _mm_loadu_ps(a0 + i), r1 = _mm_loadu_ps(a1 + i);
+          __m128 r2 = _mm_loadu_ps(a2 + i), r3 = _mm_loadu_ps(a3 + i);
+          _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+          o[i] = r0; o[i + 1] = r1; o[i + 2] = r2; o[i + 3] = r3;
+        }
+        // inverse split step (see rdft), Im(Z) is stored in zr and Re(Z) in zi
+        zr[0] = _mm_mul_ps(half, _mm_sub_ps(o[0], o[1]));
+        zi[0] = _mm_mul_ps(half, _mm_add_ps(o[0], o[1]));
+        for (long k = 1; k <= M / 2; k++) {
+          __m128 pr = o[2 * k], pi = _mm_xor_ps(signMask, o[2 * k + 1]);
+          __m128 qr = o[2 * (M - k)], qi = _mm_xor_ps(signMask, o[2 * (M - k) + 1]);
+          __m128 er = _mm_mul_ps(half, _mm_add_ps(pr, qr)), ei = _mm_mul_ps(half, _mm_sub_ps(pi, qi));
+          __m128 fr = _mm_mul_ps(half, _mm_sub_ps(pr, qr)), fi = _mm_mul_ps(half, _mm_add_ps(pi, qi));
+          __m128 c = _mm_set1_ps(wc[k]), s = _mm_set1_ps(ws[k]);
+          __m128 or_ = _mm_sub_ps(_mm_mul_ps(c, fr), _mm_mul_ps(s, fi));
+          __m128 oi = _mm_add_ps(_mm_mul_ps(c, fi), _mm_mul_ps(s, fr));
+          zi[k] = _mm_sub_ps(er, oi);
+          zr[k] = _mm_add_ps(ei, or_);
+          zi[M - k] = _mm_add_ps(er, oi);
+          zr[M - k] = _mm_sub_ps(or_, ei);
+        }
+        cfftLanes(M, nStages4, radix2, stageTw.data(), zr, zi, tr, ti, &yr, &yi);
+
+        // x[2m] = Re(z[m]) (stored in yi), x[2m+1] = Im(z[m]) (stored in yr)
+        for (long j = 0; j < M; j += 2) {
+          __m128 r0 = yi[j], r1 = yr[j], r2 = yi[j + 1], r3 = yr[j + 1];
+          _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+          _mm_storeu_ps(a0 + 2 * j, r0); _mm_storeu_ps(a1 + 2 * j, r1);
+          _mm_storeu_ps(a2 + 2 * j, r2); _mm_storeu_ps(a3 + 2 * j, r3);
+        }
+      }
+    }
+  }
+#endif
+  // remaining frames (or all frames with the fftsg engine or without SSE)
+  for (; f < nFrames; f++) {
+    rdft(isgn, a + f * stride);
+  }
+}
@@ -0,0 +1,296 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*  openSMILE component:
+
+fused spectral front-end: framer + per frame pre-emphasis + window function + FFT + magnitude
+
+*/
+
+
+#include <dspcore/spectrumFramer.hpp>
+#include <dspcore/fftmagphase.hpp>
+#include <math.h>
+
+#define MODULE "cSpectrumFramer"
+
+
+SMILECOMPONENT_STATICS(cSpectrumFramer)
+
+SMILECOMPONENT_REGCOMP(cSpectrumFramer)
+{
+  SMILECOMPONENT_REGCOMP_INIT
+
+  scname = COMPONENT_NAME_CSPECTRUMFRAMER;
+  sdescription = COMPONENT_DESCRIPTION_CSPECTRUMFRAMER;
+
+  // we inherit cFramer configType and extend it:
+  SMILECOMPONENT_INHERIT_CONFIGTYPE("cFramer")
+
+  SMILECOMPONENT_IFNOTREGAGAIN(
+    // pre-emphasis (see cVectorPreemphasis)
+    ct->setField("k","The pre-emphasis coefficient k in y[n] = x[n] - k*x[n-1], applied to each frame as by cVectorPreemphasis. 0 disables the pre-emphasis (default).",0.0);
+    ct->setField("f","The pre-emphasis frequency f in Hz : k = exp( -2*pi * f/samplingFreq. ) (this option will override k)",0,0,0);
+    ct->setField("de","1 = perform de- instead of pre-emphasis",0);
+    // window function (see cWindower)
+    ct->setField("winFunc","Window function:\n   Hann [Han],\n   Hamming [Ham],\n   Rectangular [Rec],\n   Gauss [Gau],\n   Sine / Cosine [Sin],\n   Triangular [Tri],\n   Bartlett [Bar],\n   Bartlett-Hann [BaH],\n   Blackmann [Bla],\n   Blackmann-Harris [BlH],\n   Lanczos [Lac]", "Han");
+    ct->setField("gain","Scaling factor by which window function (which is by default normalised to max. 1) should be multiplied by",1.0);
+    ct->setField("offset","Offset which will be added to the samples after multiplying with the window function",0.0);
+    ct->setField("xshift", "Specifies a shift of the window center to the left (negative) or right (positive) as percentage of the window length. Allowed range is from -100% to +100%.", 0.0);
+    ct->setField("sigma","Standard deviation for the Gaussian window relative to half the window length. I.e. at N/2 - (N/2 * sigma) the window amplitude will be 0.5.", 0.4);
+    ct->setField("alpha0","alpha0 for Blackmann(-Harris) / Bartlett-Hann windows (optional!)",0.0,0,0);
+    ct->setField("alpha1","alpha1 for Blackmann(-Harris) / Bartlett-Hann windows (optional!)",0.0,0,0);
+    ct->setField("alpha2","alpha2 for Blackmann(-Harris) / Bartlett-Hann windows (optional!)",0.0,0,0);
+    ct->setField("alpha3","alpha3 for Blackmann-Harris window (optional!)",0.0,0,0);
+    ct->setField("alpha","alpha for the Blackmann window",0.16);
+    ct->setField("fade", "Fade percentage (0 - 0.5) for fading edges to 0 with a half raised cosine function (0 = no fade, default)", 0.0);
+    ct->setField("squareRoot","1 = use square root of 'winFunc' as actual window function (e.g. to get a root raised cosine window).",0);
+    // FFT (see cTransformFFT)
+    ct->setField("zeroPadSymmetric", "1 = zero pad symmetric (when zero padding to next power of 2), i.e. center frame and pad left and right with zeros.", 1);
+    // magnitude (see cFFTmagphase)
+    ct->setField("normalise","1/0 = yes/no: normalise FFT magnitudes to input window length, to obtain spectral densities.",0);
+    ct->setField("power","1/0 = yes/no: square FFT magnitudes to obtain power spectrum.",0);
+    ct->setField("dBpsd","1/0 = yes/no: output logarithmic (dB SPL) power spectral density instead of linear magnitude spectrum (you should use a Hann window for analysis in this case). Setting this option also sets/implies 'normalise=1' and 'power=1'",0);
+    ct->setField("dBpnorm","Value for dB power normalisation when 'dBpsd=1' (in dB SPL). Default is according to MPEG-1, psy I model.",90.302);
+    ct->setField("mindBp", "Minimum dB power value for flooring when using dBpsd. (mindBp >= dBpnorm - 120.0) will be enforced, so mindBp might be higher than set here, depending on dBpnorm parameter.", -102.0);
+  )
+
+  SMILECOMPONENT_MAKEINFO(cSpectrumFramer);
+}
+
+SMILECOMPONENT_CREATE(cSpectrumFramer)
+
+//-----
+
+cSpectrumFramer::cSpectrumFramer(const char *_name) :
+  cFramer(_name),
+  k_(0.0), f_(-1.0), preemphasis_(0), de_(0),
+  win_(NULL), winOffset_(0.0),
+  zeroPadSymmetric_(1),
+  normalise_(0), power_(0), dBpsd_(0),
+  dBpnorm_(0.0), mindBp_(0.0),
+  fftN_(0), nBins_(0), frameSizeSecOut_(0.0),
+  fft_(NULL), frame_(NULL)
+{
+  memset(&winConf_, 0, sizeof(winConf_));
+}
+
+void cSpectrumFramer::myFetchConfig()
+{
+  cFramer::myFetchConfig();
+
+  k_ = (FLOAT_DMEM)getDouble("k");
+  if (isSet("f")) {
+    f_ = getDouble("f");
+    SMILE_IDBG(2,"using preemphasis frequency f=%f Hz instead of k",f_);
+  } else {
+    f_ = -1.0;
+    if ((k_<0.0)||(k_>1.0)) {
+      SMILE_IERR(1,"k must be in the range [0;1]! Setting k=0.0 !");
+      k_ = 0.0;
+    }
+  }
+  de_ = getInt("de");
+
+  // window function parameters, defaults as in cWindower
+  const char *winF = getStr("winFunc");
+  winConf_.winFunc = winFuncToInt(winF);
+  if (winConf_.winFunc == WINF_UNKNOWN) {
+    SMILE_IERR(1,"unkown window function '%s' specified in config file! setting window function to 'rectangular' (none)!",winF);
+    winConf_.winFunc = WINF_RECTANGLE;
+  }
+  winConf_.offset = getDouble("offset");
+  winConf_.gain = getDouble("gain");
+  winConf_.sigma = getDouble("sigma");
+  if (winConf_.winFunc == WINF_BLACKMAN) {
+    if (isSet("alpha0") && isSet("alpha1") && isSet("alpha2")) {
+      winConf_.alpha0 = getDouble("alpha0");
+      winConf_.alpha1 = getDouble("alpha1");
+      winConf_.alpha2 = getDouble("alpha2");
+    } else {
+      winConf_.alpha = getDouble("alpha");
+      winConf_.alpha0 = (1.0-winConf_.alpha)*0.5;
+      winConf_.alpha1 = 0.5;
+      winConf_.alpha2 = winConf_.alpha*0.5;
+    }
+  }
+  if (winConf_.winFunc == WINF_BLACKHARR) {
+    winConf_.alpha0 = isSet("alpha0") ? getDouble("alpha0") : 0.35875;
+    winConf_.alpha1 = isSet("alpha1") ? getDouble("alpha1") : 0.48829;
+    winConf_.alpha2 = isSet("alpha2") ? getDouble("alpha2") : 0.14128;
+    winConf_.alpha3 = isSet("alpha3") ? getDouble("alpha3") : 0.01168;
+  }
+  if (winConf_.winFunc == WINF_BARTHANN) {
+    winConf_.alpha0 = isSet("alpha0") ? getDouble("alpha0") : 0.62;
+    winConf_.alpha1 = isSet("alpha1") ? getDouble("alpha1") : 0.48;
+    winConf_.alpha2 = isSet("alpha2") ? getDouble("alpha2") : 0.38;
+  }
+  winConf_.xshift = getDouble("xshift");
+  winConf_.fade = getDouble("fade");
+  if (winConf_.fade > 0.5) {
+    winConf_.fade = 0.5;
+    SMILE_IWRN(1, "'fade' option cannot be > 0.5. Setting to max. value 0.5.");
+  }
+  if (winConf_.fade < 0) {
+    winConf_.fade = 0.0;
+    SMILE_IWRN(1, "'fade' option cannot be < 0.0. Setting to min. value 0.0 (no fade).");
+  }
+  winConf_.squareRoot = getInt("squareRoot");
+  winOffset_ = (FLOAT_DMEM)winConf_.offset;
+
+  zeroPadSymmetric_ = getInt("zeroPadSymmetric");
+
+  power_ = getInt("power");
+  normalise_ = getInt("normalise");
+  dBpsd_ = getInt("dBpsd");
+  if (dBpsd_) { normalise_ = 1; }
+  dBpnorm_ = (FLOAT_DMEM)getDouble("dBpnorm");
+  mindBp_ = (FLOAT_DMEM)getDouble("mindBp");
+  if (mindBp_ - dBpnorm_ < -120.0) {
+    mindBp_ = -120 + dBpnorm_;
+    SMILE_IMSG(3, "mindBp = %f", mindBp_);
+  }
+}
+
+int cSpectrumFramer::configureWriter(sDmLevelConfig &c)
+{
+  int ret = cFramer::configureWriter(c);
+  if (!ret) return ret;
+  if (frameSizeFrames <= 0) {
+    COMP_ERR("only frameMode = fixed (with a frame size > 0) is supported by this component");
+  }
+
+  // the FFT size is the frame size rounded up to the next power of 2 (as in cTransformFFT)
+  fftN_ = frameSizeFrames;
+  if (!smileMath_isPowerOf2(fftN_)) {
+    fftN_ = smileMath_ceilToNextPowOf2(fftN_);
+    c.lastFrameSizeSec = c.frameSizeSec;
+    c.frameSizeSec *= (double)fftN_ / (double)frameSizeFrames;
+  }
+  if (fftN_ < 4) fftN_ = 4;
+  nBins_ = fftN_/2 + 1;
+  frameSizeSecOut_ = c.frameSizeSec;
+  fft_ = cSmileFft::getPlan(fftN_, getFftEngine());
+
+  winConf_.frameSizeFrames = frameSizeFrames;
+  double *w = cWindower::computeWinFunc(&winConf_);
+  if (w == NULL) COMP_ERR("failed to compute the window function");
+  if (win_ != NULL) free(win_);
+  win_ = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*frameSizeFrames);
+  for (long i = 0; i < frameSizeFrames; i++) {
+    win_[i] = (FLOAT_DMEM)w[i];
+  }
+  free(w);
+
+  if (frame_ != NULL) free(frame_);
+  frame_ = (FLOAT_DMEM *)calloc(1, sizeof(FLOAT_DMEM)*fftN_);
+
+  if (f_ >= 0.0) {
+    double _T = getBasePeriod();
+    k_ = (FLOAT_DMEM)exp( -2.0*M_PI * f_ * _T );
+    SMILE_IDBG(2,"computed k from f (%f Hz) : k = %f  (samplingRate = %f Hz)",f_,k_,1.0/_T);
+  }
+  // k = 0 gives the identity, so the pre-emphasis can be skipped
+  preemphasis_ = (k_ != 0.0);
+  return ret;
+}
+
+int cSpectrumFramer::getMultiplier()
+{
+  return (int)nBins_;
+}
+
+int cSpectrumFramer::setupNamesForElement(int idxi, const char*name, long nEl)
+{
+  int dtype = DATATYPE_SPECTRUM_BINS_MAG;
+  if (dBpsd_) {
+    addNameAppendFieldAuto(name, "fftMag_dBsplPSD", nBins_);
+    dtype = DATATYPE_SPECTRUM_BINS_DBPSD;
+  } else if (power_ && !normalise_) {
+    addNameAppendFieldAuto(name, "fftMag_PowSpec", nBins_);
+    dtype = DATATYPE_SPECTRUM_BINS_POWSPEC;
+  } else if (power_ && normalise_) {
+    addNameAppendFieldAuto(name, "fftMag_PowSpecDens", nBins_);
+    dtype = DATATYPE_SPECTRUM_BINS_POWSPECDENS;
+  } else if (normalise_ && !power_) {
+    addNameAppendFieldAuto(name, "fftMag_SpecDens", nBins_);
+    dtype = DATATYPE_SPECTRUM_BINS_SPECDENS;
+  } else {
+    addNameAppendFieldAuto(name, "fftMag", nBins_);
+  }
+  // frequency axis information (frequency in Hz of each bin, see cTransformFFT::generateSpectralVectorInfo)
+  double *inf = (double*)calloc(1, sizeof(double)*nBins_);
+  if (frameSizeSecOut_ > 0.0) {
+    double F0 = (double)(1.0) / (double)frameSizeSecOut_;
+    for (long i = 0; i < nBins_; i++) {
+      inf[i] = F0*(double)i;
+    }
+  }
+  writer_->setFieldInfo(-1, dtype, inf, nBins_*sizeof(double));
+  return nBins_;
+}
+
+// idxi is index of input element
+// row is the input row (frameSizeFrames samples, fewer for an incomplete last frame, which is zero padded)
+// y is the output vector (part) for the input row
+int cSpectrumFramer::doProcess(int idxi, cMatrix *row, FLOAT_DMEM*y)
+{
+  long N = frameSizeFrames;
+  long nT = MIN(row->nT, N);
+  const FLOAT_DMEM *x = row->data;
+  long pad = zeroPadSymmetric_ ? (fftN_ - N) / 2 : 0;
+  FLOAT_DMEM *dst = frame_ + pad;
+  long n;
+
+  // pre-emphasis and window function in one pass, with the same operations as
+  // cVectorPreemphasis followed by cWindower on the zero padded frame
+  if (preemphasis_) {
+    FLOAT_DMEM prev = 0.0, cur;
+    FLOAT_DMEM sgn = de_ ? (FLOAT_DMEM)-1.0 : (FLOAT_DMEM)1.0;
+    FLOAT_DMEM k = sgn * k_;
+    if (nT > 0) {
+      prev = x[0];
+      dst[0] = ((1-k_) * prev) * win_[0] + winOffset_;
+    } else {
+      dst[0] = ((1-k_) * (FLOAT_DMEM)0.0) * win_[0] + winOffset_;
+    }
+    for (n=1; n<nT; n++) {
+      cur = x[n];
+      dst[n] = (cur - k * prev) * win_[n] + winOffset_;
+      prev = cur;
+    }
+    for (n=MAX(nT,1); n<N; n++) {
+      dst[n] = ((FLOAT_DMEM)0.0 - k * prev) * win_[n] + winOffset_;
+      prev = 0.0;
+    }
+  } else {
+    for (n=0; n<nT; n++) {
+      dst[n] = x[n] * win_[n] + winOffset_;
+    }
+    for (n=nT; n<N; n++) {
+      dst[n] = (FLOAT_DMEM)0.0 * win_[n] + winOffset_;
+    }
+  }
+  // zero padding to the FFT size
+  for (n=0; n<pad; n++) {
+    frame_[n] = 0.0;
+  }
+  for (n=pad+N; n<fftN_; n++) {
+    frame_[n] = 0.0;
+  }
+
+  fft_->rdft(1, frame_);
+  cFFTmagphase::computeMagnitude(frame_, y, fftN_, normalise_, power_, dBpsd_, dBpnorm_, mindBp_);
+  return nBins_;
+}
+
+cSpectrumFramer::~cSpectrumFramer()
+{
+  if (win_ != NULL) free(win_);
+  if (frame_ != NULL) free(frame_);
+}
@@ -33,6 +33,7 @@ SMILECOMPONENT_REGCOMP(cTransformFFT)
   SMILECOMPONENT_IFNOTREGAGAIN(
     ct->setField("inverse", "1 = perform inverse real FFT", 0);
     ct->setField("zeroPadSymmetric", "1 = zero pad symmetric (when zero padding to next power of 2), i.e. center frame and pad left and right with zeros. New since version 2.3: this is the default, but should not affect FFT magnitudes at all, only phase.", 1);
+    ct->setField("batchFrames", "Maximum number of frames to transform together in one tick. All frames available in the input level (up to this number) are read as one matrix, transformed with a batched FFT (4 frames at a time with SSE), and written as one matrix. The output is identical to transforming one frame per tick (batchFrames = 1). In the default frame-by-frame processing usually only one new frame is available per tick. For offline processing, set 'blocksize' to the number of frames to wait for before transforming them as one block (this adds latency of blocksize frames). Batching is only used if the input is processed as a single field (one input field or processArrayFields=0).", 64);
   )
   SMILECOMPONENT_MAKEINFO(cTransformFFT);
 }
@@ -43,11 +44,10 @@ SMILECOMPONENT_CREATE(cTransformFFT)
 
 cTransformFFT::cTransformFFT(const char *_name) :
   cVectorProcessor(_name),
-  ip_(NULL),
-  w_(NULL),
-  xconv_(NULL),
+  fft_(NULL),
   newFsSet_(0),
-  frameSizeSecOut_(0.0)
+  frameSizeSecOut_(0.0),
+  batchFrames_(1)
 { }
 
 void cTransformFFT::myFetchConfig()
@@ -61,6 +61,9 @@ void cTransformFFT::myFetchConfig()
     inverse_ = 1; // sign of exponent
   }
   zeroPadSymmetric_ = getInt("zeroPadSymmetric");
+  batchFrames_ = getInt("batchFrames");
+  if (batchFrames_ < 1) batchFrames_ = 1;
+  SMILE_IDBG(2, "batchFrames = %ld", batchFrames_);
 }
 
 int cTransformFFT::configureWriter(sDmLevelConfig &c)
@@ -136,87 +139,75 @@ int cTransformFFT::setupNamesForField(int i, const char*name, long nEl)
   return ret;
 }
 
-int cTransformFFT::myFinaliseInstance()
+void cTransformFFT::prepareFrame(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst)
 {
-  int ret = cVectorProcessor::myFinaliseInstance();
-  
-  if (ret) {
-    //?? to support re-configure once it is implemented in component manager ??
-    if (ip_ != NULL) {
-      multiConfFree(ip_);
-      ip_=NULL;
-    }
-    if (w_ != NULL) {
-      multiConfFree(w_);
-      w_ = NULL;
-    }
-    if (xconv_ != NULL) {
-      multiConfFree(xconv_);
-      xconv_ = NULL;
-    }
-    ip_ = (int**)multiConfAlloc(); 
-    w_ = (FLOAT_TYPE_FFT**)multiConfAlloc();
-    xconv_ = (FLOAT_TYPE_FFT**)multiConfAlloc();
-  }
-  return ret;
-}
-
-// a derived class should override this method, in order to implement the actual processing
-int cTransformFFT::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi) // idxi=input field index
-{
-  idxi = getFconf(idxi);
-  FLOAT_TYPE_FFT *x = xconv_[idxi];
-  FLOAT_TYPE_FFT *w_l = w_[idxi];
-  int *ip_l = ip_[idxi];
-  if (x == NULL) {
-    x = (FLOAT_TYPE_FFT *)malloc(sizeof(FLOAT_TYPE_FFT) * Ndst);
-    xconv_[idxi] = x;
-  }
   if (inverse_ == 1) {
     // this is the forward transform (inverse is the exponent factor..)
     if (zeroPadSymmetric_) {
-      int padlen2 = (Ndst - Nsrc) / 2;
-      for (int i = 0; i < padlen2; i++) {  // zeropadding first half
-        x[i] = 0;
+      long padlen2 = (Ndst - Nsrc) / 2;
+      for (long i = 0; i < padlen2; i++) {  // zeropadding first half
+        dst[i] = 0;
       }
-      for (int i = 0; i < Nsrc; i++) {
-        x[i + padlen2] = (FLOAT_TYPE_FFT)src[i];
+      for (long i = 0; i < Nsrc; i++) {
+        dst[i + padlen2] = src[i];
       }
-      for (int i = Nsrc + padlen2; i < Ndst; i++) {  // zeropadding second half
-        x[i] = 0;
+      for (long i = Nsrc + padlen2; i < Ndst; i++) {  // zeropadding second half
+        dst[i] = 0;
       }
     } else {
-      for (int i = 0; i < Nsrc; i++) {
-        x[i] = (FLOAT_TYPE_FFT)src[i];
+      for (long i = 0; i < Nsrc; i++) {
+        dst[i] = src[i];
       }
-      for (int i = Nsrc; i < Ndst; i++) {  // zeropadding second half
-        x[i] = 0;
+      for (long i = Nsrc; i < Ndst; i++) {  // zeropadding second half
+        dst[i] = 0;
       }
     }
   } else {
-    for (int i = 0; i < Nsrc; i++) {
-      x[i] = (FLOAT_TYPE_FFT)src[i];
+    for (long i = 0; i < Nsrc; i++) {
+      dst[i] = src[i];
     }
   }
-  if (ip_l == NULL) {
-    ip_l = (int *)calloc(1, sizeof(int) * (3 + (size_t)ceil(sqrt((float)Ndst))));
-    ip_[idxi] = ip_l;
+}
+
+// batched processing: transforms all available input frames (up to batchFrames_) in one tick,
+// with blocksizeR > 1 it waits until a full block of frames is available (see cVectorProcessor::tickBatched)
+eTickResult cTransformFFT::myTick(long long t)
+{
+  return tickBatched(t, MAX(batchFrames_, blocksizeR_));
+}
+
+int cTransformFFT::processVectorBatch(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, long nFrames)
+{
+  for (long f = 0; f < nFrames; f++) {
+    prepareFrame(src + f * Nsrc, dst + f * Ndst, Nsrc, Ndst);
   }
-  if (w_l == NULL) {
-    w_l = (FLOAT_TYPE_FFT *)calloc(1, sizeof(FLOAT_TYPE_FFT) * (Ndst / 2 + 1));
-    w_[idxi] = w_l;
+  if (fft_ == NULL || fft_->getN() != Ndst) {
+    fft_ = cSmileFft::getPlan(Ndst, getFftEngine());
+  }
+  fft_->rdftBatch(inverse_, dst, Ndst, nFrames);
+  if (inverse_ == -1) {
+    FLOAT_DMEM norm = (FLOAT_DMEM)2.0 / (FLOAT_DMEM)Ndst;
+    for (long i = 0; i < Ndst * nFrames; i++) {
+      dst[i] *= norm;
+    }
+  }
+  return 1;
+}
+
+// a derived class should override this method, in order to implement the actual processing
+int cTransformFFT::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi) // idxi=input field index
+{
+  // the FFT is computed in place in the output vector
+  prepareFrame(src, dst, Nsrc, Ndst);
+  if (fft_ == NULL || fft_->getN() != Ndst) {
+    fft_ = cSmileFft::getPlan(Ndst, getFftEngine());
   }
-    //w_l = (FLOAT_TYPE_FFT *)calloc(1,sizeof(FLOAT_TYPE_FFT)*((Ndst*5)/4+2));
   // perform real FFT
-  rdft((int)Ndst, inverse_, x, ip_l, w_l);
+  fft_->rdft(inverse_, dst);
   if (inverse_==-1) {
     FLOAT_DMEM norm = (FLOAT_DMEM)2.0 / (FLOAT_DMEM)Ndst;
     for (int i = 0; i < Ndst; i++) {
-      dst[i] = ((FLOAT_DMEM)x[i])*norm;
-    }
-  } else {
-    for (int i = 0; i < Ndst; i++) {
-      dst[i] = (FLOAT_DMEM)x[i];
+      dst[i] *= norm;
     }
   }
   return 1;
@@ -224,10 +215,4 @@ int cTransformFFT::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Ns
 
 cTransformFFT::~cTransformFFT()
 {
-  if (ip_ != NULL)
-    multiConfFree(ip_);
-  if (w_ != NULL)
-    multiConfFree(w_);
-  if (xconv_ != NULL)
-    multiConfFree(xconv_);
 }
@@ -138,6 +138,8 @@ struct sWindowerConfigParsed * cWindower::getWindowerConfigParsed()
   c->alpha1 = alpha1;
   c->alpha2 = alpha2;
   c->alpha3 = alpha3;
+  c->fade = fade;
+  c->xshift = xshift;
   c->win = win;
   c->frameSizeFrames = frameSizeFrames;
   return c;
@@ -159,46 +161,56 @@ int cWindower::myFinaliseInstance()
 void cWindower::precomputeWinFunc()
 {
   if (!isConfigured()) return;
-  long i;
   if (win != NULL) free(win);
-  switch(winFunc) {
+  win = NULL;
+  struct sWindowerConfigParsed *c = getWindowerConfigParsed();
+  win = computeWinFunc(c);
+  free(c);
+}
+
+double * cWindower::computeWinFunc(const struct sWindowerConfigParsed *c)
+{
+  long i;
+  long frameSizeFrames = c->frameSizeFrames;
+  double *win;
+  switch(c->winFunc) {
     case WINF_RECTANGLE: win = smileDsp_winRec(frameSizeFrames); break;
     case WINF_HANNING:   win = smileDsp_winHan(frameSizeFrames); break;
     case WINF_HAMMING:   win = smileDsp_winHam(frameSizeFrames); break;
     case WINF_TRIANGLE:  win = smileDsp_winTri(frameSizeFrames); break;
     case WINF_BARTLETT:  win = smileDsp_winBar(frameSizeFrames); break;
     case WINF_SINE:      win = smileDsp_winSin(frameSizeFrames); break;
-    case WINF_GAUSS:     win = smileDsp_winGau(frameSizeFrames,sigma); break;
-    case WINF_BLACKMAN:  win = smileDsp_winBla(frameSizeFrames,alpha0,alpha1,alpha2); break;
-    case WINF_BLACKHARR: win = smileDsp_winBlH(frameSizeFrames,alpha0,alpha1,alpha2,alpha3); break;
-    case WINF_BARTHANN:  win = smileDsp_winBaH(frameSizeFrames,alpha0,alpha1,alpha2); break;
+    case WINF_GAUSS:     win = smileDsp_winGau(frameSizeFrames,c->sigma); break;
+    case WINF_BLACKMAN:  win = smileDsp_winBla(frameSizeFrames,c->alpha0,c->alpha1,c->alpha2); break;
+    case WINF_BLACKHARR: win = smileDsp_winBlH(frameSizeFrames,c->alpha0,c->alpha1,c->alpha2,c->alpha3); break;
+    case WINF_BARTHANN:  win = smileDsp_winBaH(frameSizeFrames,c->alpha0,c->alpha1,c->alpha2); break;
     case WINF_LANCZOS:   win = smileDsp_winLac(frameSizeFrames); break;
-    default: SMILE_IERR(1,"unknown window function ID (%i) !",winFunc); win=NULL;
+    default: SMILE_ERR(1,"unknown window function ID (%i) !",c->winFunc); return NULL;
   }
-  if ((win != NULL)&&(squareRoot)) {
+  if (c->squareRoot) {
     for (i=0; i<frameSizeFrames; i++) {
       if (win[i] >= 0.0) win[i] = sqrt(win[i]);
       else {
-        SMILE_IERR(1,"window function '%s' apparently has negative values (%f) (bug?), taking the square root of this function is not possible, please correct your config! (at current, the square root of all non-negative values is computed and negative values are converted to zeros)",getStr("winFunc"),win[i]);
+        SMILE_ERR(1,"window function %i apparently has negative values (%f) (bug?), taking the square root of this function is not possible, please correct your config! (at current, the square root of all non-negative values is computed and negative values are converted to zeros)",c->winFunc,win[i]);
         win[i] = 0.0;
       }
     }
   }
-  if ((win != NULL) && (fade > 0.0)) {
-    long fadeSize = (long)((double)frameSizeFrames * fade);
+  if (c->fade > 0.0) {
+    long fadeSize = (long)((double)frameSizeFrames * c->fade);
     for (i=0; i<fadeSize; i++) {
       double a = -0.5 * (cos(M_PI * (double)i / (double)fadeSize) - 1.0);
       win[i] *= a;
       win[frameSizeFrames - i - 1] *= a;
     }
   }
-  if ((win != NULL)&&(gain!=1.0)) { // apply gain
+  if (c->gain!=1.0) { // apply gain
     for (i=0; i<frameSizeFrames; i++) {
-      win[i] *= gain;
+      win[i] *= c->gain;
     }
   }
   // apply xshift
-  long shiftAbs = (long)((double)frameSizeFrames * xshift);
+  long shiftAbs = (long)((double)frameSizeFrames * c->xshift);
   if (shiftAbs < 0) {  // shift left
     shiftAbs *= -1;
     for(i = shiftAbs; i < frameSizeFrames; i++) {
@@ -215,6 +227,7 @@ void cWindower::precomputeWinFunc()
       win[i] = 0.0;
     }
   }
+  return win;
 }
 
 // a derived class should override this method, in order to implement the actual processing
@@ -14,6 +14,14 @@ a single statistical functional or the like....
 
 
 #include <functionals/functionalComponent.hpp>
+#include <math.h>
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FUNCTIONALS_SSE2
+#endif
 
 #define MODULE "cFunctionalComponent"
 
@@ -104,6 +112,225 @@ long cFunctionalComponent::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted, FLOAT_D
   return 0;
 }
 
+#ifdef FUNCTIONALS_SSE2
+static inline double sumPd(__m128d a, __m128d b)
+{
+  double t[2];
+  _mm_storeu_pd(t, _mm_add_pd(a, b));
+  return t[0] + t[1];
+}
+#endif
+
+// all sums are accumulated in double precision, with SSE2 4 values at a time
+void cFunctionalComponent::computeRowStats(const FLOAT_DMEM *x, long N, int flags, sFunctionalRowStats *stats)
+{
+  long i = 0;
+  if (N <= 0) {
+    memset(stats, 0, sizeof(sFunctionalRowStats));
+    return;
+  }
+  FLOAT_DMEM min = x[0], max = x[0];
+  double sumPos = 0.0, sumNeg = 0.0, sumSqPos = 0.0, sumSqNeg = 0.0;
+  long nPos = 0, nNeg = 0, nNaN = 0;
+#ifdef FUNCTIONALS_SSE2
+  if (N >= 4) {
+    const __m128 zero = _mm_setzero_ps();
+    __m128 vmin = _mm_loadu_ps(x), vmax = vmin;
+    __m128d sp0 = _mm_setzero_pd(), sp1 = sp0, sn0 = sp0, sn1 = sp0;
+    __m128d qp0 = sp0, qp1 = sp0, qn0 = sp0, qn1 = sp0;
+    __m128i cp = _mm_setzero_si128(), cn = cp, cu = cp;
+    for ( ; i + 4 <= N; i += 4) {
+      __m128 v = _mm_loadu_ps(x + i);
+      vmin = _mm_min_ps(vmin, v);
+      vmax = _mm_max_ps(vmax, v);
+      __m128 mp = _mm_cmpgt_ps(v, zero);
+      __m128 mn = _mm_cmplt_ps(v, zero);
+      cp = _mm_sub_epi32(cp, _mm_castps_si128(mp));
+      cn = _mm_sub_epi32(cn, _mm_castps_si128(mn));
+      cu = _mm_sub_epi32(cu, _mm_castps_si128(_mm_cmpunord_ps(v, v)));
+      __m128 vp = _mm_and_ps(v, mp);
+      __m128 vn = _mm_and_ps(v, mn);
+      __m128d p0 = _mm_cvtps_pd(vp), p1 = _mm_cvtps_pd(_mm_movehl_ps(vp, vp));
+      __m128d n0 = _mm_cvtps_pd(vn), n1 = _mm_cvtps_pd(_mm_movehl_ps(vn, vn));
+      sp0 = _mm_add_pd(sp0, p0); sp1 = _mm_add_pd(sp1, p1);
+      sn0 = _mm_add_pd(sn0, n0); sn1 = _mm_add_pd(sn1, n1);
+      qp0 = _mm_add_pd(qp0, _mm_mul_pd(p0, p0)); qp1 = _mm_add_pd(qp1, _mm_mul_pd(p1, p1));
+      qn0 = _mm_add_pd(qn0, _mm_mul_pd(n0, n0)); qn1 = _mm_add_pd(qn1, _mm_mul_pd(n1, n1));
+    }
+    vmin = _mm_min_ps(vmin, _mm_movehl_ps(vmin, vmin));
+    vmin = _mm_min_ss(vmin, _mm_shuffle_ps(vmin, vmin, 1));
+    min = _mm_cvtss_f32(vmin);
+    vmax = _mm_max_ps(vmax, _mm_movehl_ps(vmax, vmax));
+    vmax = _mm_max_ss(vmax, _mm_shuffle_ps(vmax, vmax, 1));
+    max = _mm_cvtss_f32(vmax);
+    sumPos = sumPd(sp0, sp1);
+    sumNeg = sumPd(sn0, sn1);
+    sumSqPos = sumPd(qp0, qp1);
+    sumSqNeg = sumPd(qn0, qn1);
+    int c[4];
+    _mm_storeu_si128((__m128i*)c, cp);
+    nPos = (long)c[0] + c[1] + c[2] + c[3];
+    _mm_storeu_si128((__m128i*)c, cn);
+    nNeg = (long)c[0] + c[1] + c[2] + c[3];
+    _mm_storeu_si128((__m128i*)c, cu);
+    nNaN = (long)c[0] + c[1] + c[2] + c[3];
+  }
+#endif
+  for ( ; i < N; i++) {
+    FLOAT_DMEM v = x[i];
+    if (v < min) min = v;
+    if (v > max) max = v;
+    if (v > 0.0) {
+      sumPos += (double)v;
+      sumSqPos += (double)v * (double)v;
+      nPos++;
+    } else if (v < 0.0) {
+      sumNeg += (double)v;
+      sumSqNeg += (double)v * (double)v;
+      nNeg++;
+    } else if (v != v) {
+      nNaN++;
+    }
+  }
+  double sum = sumPos + sumNeg;
+  if (nNaN > 0) {
+    // NaN values are handled as by a sequential scan of the row: they are skipped by the min/max
+    // search unless the first value is NaN (the SSE min/max returns NaN for a NaN in the row), and
+    // they propagate into the mean, the moments, the time-weighted sums and the sum of logarithms
+    min = max = x[0];
+    for (i = 1; i < N; i++) {
+      if (x[i] < min) min = x[i];
+      if (x[i] > max) max = x[i];
+    }
+    sum = std::numeric_limits<double>::quiet_NaN();
+  }
+  stats->min = min;
+  stats->max = max;
+  stats->mean = sum / (double)N;
+  stats->sumPos = sumPos;
+  stats->sumNeg = sumNeg;
+  stats->sumSqPos = sumSqPos;
+  stats->sumSqNeg = sumSqNeg;
+  stats->nPos = nPos;
+  stats->nNeg = nNeg;
+  stats->nNaN = nNaN;
+
+  stats->minPos = stats->maxPos = -1;
+  if (flags & FUNCTSTATS_EXTREMEPOS) {
+    for (i = 0; i < N && (stats->minPos < 0 || stats->maxPos < 0); i++) {
+      if (x[i] == max && stats->maxPos < 0) stats->maxPos = i;
+      if (x[i] == min && stats->minPos < 0) stats->minPos = i;
+    }
+  }
+
+  stats->m2 = stats->m3 = stats->m4 = 0.0;
+  if (flags & FUNCTSTATS_MOMENTS) {
+    // central moments around the mean as passed to the functionals (FLOAT_DMEM)
+    double u = (double)(FLOAT_DMEM)stats->mean;
+    double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+    i = 0;
+#ifdef FUNCTIONALS_SSE2
+    const __m128d vu = _mm_set1_pd(u);
+    __m128d a2 = _mm_setzero_pd(), b2 = a2, a3 = a2, b3 = a2, a4 = a2, b4 = a2;
+    for ( ; i + 4 <= N; i += 4) {
+      __m128 v = _mm_loadu_ps(x + i);
+      __m128d d0 = _mm_sub_pd(_mm_cvtps_pd(v), vu);
+      __m128d d1 = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(v, v)), vu);
+      __m128d e0 = _mm_mul_pd(d0, d0), e1 = _mm_mul_pd(d1, d1);
+      a2 = _mm_add_pd(a2, e0); b2 = _mm_add_pd(b2, e1);
+      e0 = _mm_mul_pd(e0, d0); e1 = _mm_mul_pd(e1, d1);
+      a3 = _mm_add_pd(a3, e0); b3 = _mm_add_pd(b3, e1);
+      a4 = _mm_add_pd(a4, _mm_mul_pd(e0, d0)); b4 = _mm_add_pd(b4, _mm_mul_pd(e1, d1));
+    }
+    m2 = sumPd(a2, b2);
+    m3 = sumPd(a3, b3);
+    m4 = sumPd(a4, b4);
+#endif
+    for ( ; i < N; i++) {
+      double d = (double)x[i] - u;
+      double d2 = d * d;
+      m2 += d2;
+      d2 *= d;
+      m3 += d2;
+      m4 += d2 * d;
+    }
+    stats->m2 = m2;
+    stats->m3 = m3;
+    stats->m4 = m4;
+  }
+
+  stats->sumTX = stats->sumT2X = stats->sumTAbsX = 0.0;
+  if (flags & FUNCTSTATS_TIMESUMS) {
+    double s1 = 0.0, s2 = 0.0, sa = 0.0;
+    i = 0;
+#ifdef FUNCTIONALS_SSE2
+    const __m128d absMask = _mm_castsi128_pd(_mm_set_epi32(0x7fffffff, -1, 0x7fffffff, -1));
+    const __m128d four = _mm_set1_pd(4.0);
+    __m128d t0 = _mm_set_pd(1.0, 0.0), t1 = _mm_set_pd(3.0, 2.0);
+    __m128d a1 = _mm_setzero_pd(), b1 = a1, a2 = a1, b2 = a1, aa = a1, ba = a1;
+    for ( ; i + 4 <= N; i += 4) {
+      __m128 v = _mm_loadu_ps(x + i);
+      __m128d v0 = _mm_cvtps_pd(v), v1 = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+      __m128d tv0 = _mm_mul_pd(t0, v0), tv1 = _mm_mul_pd(t1, v1);
+      a1 = _mm_add_pd(a1, tv0); b1 = _mm_add_pd(b1, tv1);
+      a2 = _mm_add_pd(a2, _mm_mul_pd(tv0, t0)); b2 = _mm_add_pd(b2, _mm_mul_pd(tv1, t1));
+      aa = _mm_add_pd(aa, _mm_and_pd(tv0, absMask)); ba = _mm_add_pd(ba, _mm_and_pd(tv1, absMask));
+      t0 = _mm_add_pd(t0, four);
+      t1 = _mm_add_pd(t1, four);
+    }
+    s1 = sumPd(a1, b1);
+    s2 = sumPd(a2, b2);
+    sa = sumPd(aa, ba);
+#endif
+    for ( ; i < N; i++) {
+      double tv = (double)x[i] * (double)i;
+      s1 += tv;
+      s2 += tv * (double)i;
+      sa += fabs(tv);
+    }
+    stats->sumTX = s1;
+    stats->sumT2X = s2;
+    stats->sumTAbsX = sa;
+  }
+
+  stats->sumLogAbs = 0.0;
+  if (flags & FUNCTSTATS_LOGSUM) {
+    double sl = 0.0;
+    for (i = 0; i < N; i++) {
+      if (x[i] != 0.0) {
+        sl += log(fabs((double)x[i]));
+      }
+    }
+    stats->sumLogAbs = sl;
+  }
+  stats->sketch = NULL;
+}
+
+// selects the ranks r[a..b] in x[lo..hi]: after placing the middle rank with introselect,
+// the smaller ranks lie in the left and the larger ranks in the right partition
+static void selectRanksRange(FLOAT_DMEM *x, long lo, long hi, const long *r, int a, int b)
+{
+  while (a <= b && lo < hi) {
+    int m = (a + b) / 2;
+    std::nth_element(x + lo, x + r[m], x + hi + 1);
+    if (m - a < b - m) {
+      selectRanksRange(x, lo, r[m] - 1, r, a, m - 1);
+      lo = r[m] + 1; a = m + 1;
+    } else {
+      selectRanksRange(x, r[m] + 1, hi, r, m + 1, b);
+      hi = r[m] - 1; b = m - 1;
+    }
+  }
+}
+
+void cFunctionalComponent::selectRanks(FLOAT_DMEM *x, long N, long *ranks, int nRanks)
+{
+  if (N <= 1 || nRanks <= 0) return;
+  std::sort(ranks, ranks + nRanks);
+  int n = (int)(std::unique(ranks, ranks + nRanks) - ranks);
+  selectRanksRange(x, 0, N - 1, ranks, 0, n - 1);
+}
+
 cFunctionalComponent::~cFunctionalComponent()
 {
   if (enab!=NULL) free(enab);
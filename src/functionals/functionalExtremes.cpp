@@ -91,18 +91,20 @@ void cFunctionalExtremes::myFetchConfig()
 
 long cFunctionalExtremes::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted, FLOAT_DMEM min, FLOAT_DMEM max, FLOAT_DMEM mean, FLOAT_DMEM *out, long Nin, long Nout)
 {
-  int i;
+  sFunctionalRowStats stats;
+  computeRowStats(in, Nin, getRequireStats(), &stats);
+  return process(in, inSorted, &stats, out, Nin, Nout);
+}
+
+long cFunctionalExtremes::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted, const sFunctionalRowStats *stats, FLOAT_DMEM *out, long Nin, long Nout)
+{
   if ((Nin>0)&&(out!=NULL)) {
-    long minpos=-1, maxpos=-1;
-    
-    for (i=0; i<Nin; i++) {
-      if ((*in == max)&&(maxpos==-1)) { maxpos=i; }
-      if ((*in == min)&&(minpos==-1)) { minpos=i; }
-      in++;
-    }
-
-    FLOAT_DMEM maxposD = (FLOAT_DMEM)maxpos;
-    FLOAT_DMEM minposD = (FLOAT_DMEM)minpos;
+    FLOAT_DMEM min = stats->min;
+    FLOAT_DMEM max = stats->max;
+    FLOAT_DMEM mean = (FLOAT_DMEM)stats->mean;
+
+    FLOAT_DMEM maxposD = (FLOAT_DMEM)stats->maxPos;
+    FLOAT_DMEM minposD = (FLOAT_DMEM)stats->minPos;
 
     // normalise max/min pos ...
     if (timeNorm==TIMENORM_SEGMENT) {
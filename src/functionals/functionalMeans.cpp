@@ -116,85 +116,63 @@ void cFunctionalMeans::myFetchConfig()
 
 long cFunctionalMeans::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted, FLOAT_DMEM min, FLOAT_DMEM max, FLOAT_DMEM mean, FLOAT_DMEM *out, long Nin, long Nout)
 {
-  int i;
-  if ((Nin>0)&&(out!=NULL)) {
+  sFunctionalRowStats stats;
+  computeRowStats(in, Nin, getRequireStats(), &stats);
+  return process(in, inSorted, &stats, out, Nin, Nout);
+}
 
-    double tmp=(double)*in;
-    double fa = fabs(tmp);
-
-    double absmean = fa;
-    double qmean = tmp*tmp;
-    long nnz;
-
-    double nzamean;
-    double nzabsmean;
-    double nzqmean;
-    double nzgmean;
-    double posamean=0.0, negamean=0.0;
-    double posqmean=0.0, negqmean=0.0;
-    long nPos=0,nNeg=0;
-
-    if (tmp!=0.0) {
-      nzamean = tmp;
-      nzabsmean = fa;
-      nzqmean = tmp*tmp;
-      nzgmean = log(fa);
-      nnz=1;
-      if (tmp > 0) {
-        posamean += tmp;
-        posqmean += tmp*tmp;
-        nPos++;
-      } else {
-        negamean += tmp;
-        negqmean += tmp*tmp;
-        nNeg++;
-      }
-    } else {
-      nzamean = 0.0;
-      nzabsmean = 0.0;
-      nzqmean = 0.0;
-      nzgmean = 0.0;
-      nnz=0;
-    }
-    for (i=1; i<Nin; i++) {
-      in++;
-      tmp=(double)*in;
-      fa = fabs(tmp);
-      //      amean += tmp;
-      absmean += fa;
-      if (tmp > 0) {
-        posamean += tmp;
-        nPos++;
-      }
-      if (tmp < 0) {
-        negamean += tmp;
+int cFunctionalMeans::getRequireStats()
+{
+  // the geometric mean requires the sum of the logarithms
+  if (enab[FUNCT_NZGMEAN] || enab[FUNCT_FLATNESS])
+    return FUNCTSTATS_LOGSUM;
+  return 0;
+}
+
+long cFunctionalMeans::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted, const sFunctionalRowStats *stats, FLOAT_DMEM *out, long Nin, long Nout)
+{
+  if ((Nin>0)&&(out!=NULL)) {
+    // all means except the geometric mean are derived from the sums of the
+    // positive and the negative values in the row statistics
+    FLOAT_DMEM mean = (FLOAT_DMEM)stats->mean;
+    double sum = stats->sumPos + stats->sumNeg;
+    double abssum = stats->sumPos - stats->sumNeg;
+    double qsum = stats->sumSqPos + stats->sumSqNeg;
+    long nPos = stats->nPos;
+    long nNeg = stats->nNeg;
+    long nnz = nPos + nNeg + stats->nNaN;  // NaN values are non-zero
+
+    double tmp = (double)Nin;
+    double absmean = abssum / tmp;
+    double qmean = qsum / tmp;
+
+    double nzamean = 0.0;
+    double nzabsmean = 0.0;
+    double nzqmean = 0.0;
+    double nzgmean = 0.0;
+    double posamean = stats->sumPos, negamean = stats->sumNeg;
+    double posqmean = stats->sumSqPos, negqmean = stats->sumSqNeg;
+
+    if (stats->nNaN > 0) {
+      // NaN values propagate into the absolute, quadratic and non-zero means, and into
+      // the negative means if the first value is NaN (it is counted as negative)
+      sum = abssum = qsum = stats->mean;
+      absmean = qmean = stats->mean;
+      if (in != NULL && in[0] != in[0]) {
+        negamean = negqmean = stats->mean;
         nNeg++;
       }
-      double _tmp = tmp;
-      if (tmp!=0.0) {
-        nzamean += tmp;
-        nzabsmean += fa;
-        nzgmean += log(fa);
-        tmp *= tmp;
-        nzqmean += tmp;
-        nnz++;
-        if (_tmp > 0) posqmean += tmp;
-        if (_tmp < 0) negqmean += tmp;
-        qmean += tmp;
-      }
     }
-    tmp = (double)Nin;
-    //    amean = amean / tmp;
-    absmean = absmean / tmp;
-    qmean = qmean / tmp;
 
     if (nnz>0) {
       tmp = (double)nnz;
-      nzamean = nzamean / tmp;
-      nzabsmean = nzabsmean / tmp;
-      nzqmean = nzqmean / tmp;
-      nzgmean /= tmp; //pow( 1.0/nzgmean, 1.0/tmp );
-      nzgmean = exp(nzgmean);
+      nzamean = sum / tmp;
+      nzabsmean = abssum / tmp;
+      nzqmean = qsum / tmp;
+      if (enab[FUNCT_NZGMEAN] || enab[FUNCT_FLATNESS]) {
+        nzgmean = stats->sumLogAbs / tmp; //pow( 1.0/nzgmean, 1.0/tmp );
+        nzgmean = exp(nzgmean);
+      }
     }
     if (nPos > 0) {
       posamean /= (double)nPos;
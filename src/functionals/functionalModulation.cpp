@@ -88,9 +88,9 @@ SMILECOMPONENT_CREATE(cFunctionalModulation)
 
 /////////////////////////////////////////////////////////
 cSmileUtilWindowedMagnitudeSpectrum::cSmileUtilWindowedMagnitudeSpectrum(
-    long Nin, int winFuncId):
-      fftWork_(NULL), winFunc_(NULL), winFuncId_(winFuncId),
-      ip_(NULL), w_(NULL), Nin_(Nin), Nfft_(0)
+    long Nin, int winFuncId, int fftEngine):
+      fftWork_(NULL), winFunc_(NULL), winFuncId_(winFuncId), fftEngine_(fftEngine),
+      fft_(NULL), Nin_(Nin), Nfft_(0)
 {
   if (Nin > 0) {
     allocateFFTworkspace(Nin);
@@ -110,14 +110,6 @@ void cSmileUtilWindowedMagnitudeSpectrum::freeFFTworkspace()
     free(fftWork_);
     fftWork_ = NULL;
   }
-  if (w_ != NULL) {
-    free(w_);
-    w_ = NULL;
-  }
-  if (ip_ != NULL) {
-    free(ip_);
-    ip_ = NULL;
-  }
 }
 
 void cSmileUtilWindowedMagnitudeSpectrum::freeWinFunc()
@@ -170,9 +162,8 @@ void cSmileUtilWindowedMagnitudeSpectrum::allocateFFTworkspace(long Nin)
   // allocate work areas
   Nfft_ = N;
   Nin_ = Nin;
-  ip_ = (int *)calloc(1, sizeof(int) * (N+2));
-  w_ = (FLOAT_TYPE_FFT *)calloc(1, sizeof(FLOAT_TYPE_FFT) * ((N*5)/4+2));
-  fftWork_ = (FLOAT_TYPE_FFT*)malloc(sizeof(FLOAT_TYPE_FFT) * N);
+  fft_ = cSmileFft::getPlan(N, fftEngine_);
+  fftWork_ = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM) * N);
 }
 
 // copies data to work area,
@@ -206,13 +197,13 @@ void cSmileUtilWindowedMagnitudeSpectrum::copyInputAndZeropad(
   }
   // zero pad
   if (Nfft_ > Nin) {
-    bzero(fftWork_ + Nin, sizeof(FLOAT_TYPE_FFT) * (Nfft_ - Nin));
+    bzero(fftWork_ + Nin, sizeof(FLOAT_DMEM) * (Nfft_ - Nin));
   }
 }
 
 void cSmileUtilWindowedMagnitudeSpectrum::doFFT()
 {
-  rdft((int)Nfft_, 1, fftWork_, ip_, w_);
+  fft_->rdft(1, fftWork_);
 }
 
 void cSmileUtilWindowedMagnitudeSpectrum::computeMagnitudes()
@@ -231,19 +222,17 @@ const FLOAT_DMEM * cSmileUtilWindowedMagnitudeSpectrum::getMagnitudes(
   copyInputAndZeropad(in, Nin, allowWinSmaller);
   doFFT();
   computeMagnitudes();
-// TODO: convert fftWork to right pointer type upon return!!!!
-// This is a temp hack to make the compiler happy, but it breaks the compontnt!!
-  return (FLOAT_DMEM*)fftWork_;
+  return fftWork_;
 }
 
 /////////////////////////////////////////////////////////
 cSmileUtilMappedMagnitudeSpectrum::cSmileUtilMappedMagnitudeSpectrum(long Nin,
-    long Nout, int winFuncId, double minFreq, double maxFreq, double T):
+    long Nout, int winFuncId, double minFreq, double maxFreq, double T, int fftEngine):
   modSpec_(NULL), Nout_(Nout), minFreq_(minFreq), maxFreq_(maxFreq),
   Nmag_(0), splineWork_(NULL), splineDerivs_(NULL), splineCache(NULL),
   splintCache(NULL), magFreq_(NULL), T_(T)
 {
-  fft_ = new cSmileUtilWindowedMagnitudeSpectrum(Nin, winFuncId);
+  fft_ = new cSmileUtilWindowedMagnitudeSpectrum(Nin, winFuncId, fftEngine);
   modSpec_ = (FLOAT_DMEM*)calloc(1, sizeof(FLOAT_DMEM) * Nout);
 }
 
@@ -506,7 +495,7 @@ long cFunctionalModulation::process(FLOAT_DMEM *in,
     }
     //fprintf(stderr, "XXX allocate with N = %ld\n", N);
     mappedSpec_ = new cSmileUtilMappedMagnitudeSpectrum(N, modSpecNumBins_,
-        winFuncId_, modSpecMinFreq_, modSpecMaxFreq_, T);
+        winFuncId_, modSpecMinFreq_, modSpecMaxFreq_, T, getFftEngine());
   }
   if (avgModSpec_ == NULL) {
     avgModSpec_ = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM) * modSpecNumBins_);
@@ -90,23 +90,22 @@ long cFunctionalMoments::process(FLOAT_DMEM *in,
     FLOAT_DMEM *inSorted, FLOAT_DMEM min, FLOAT_DMEM max,
     FLOAT_DMEM mean, FLOAT_DMEM *out, long Nin, long Nout)
 {
-  int i;
+  sFunctionalRowStats stats;
+  computeRowStats(in, Nin, getRequireStats(), &stats);
+  return process(in, inSorted, &stats, out, Nin, Nout);
+}
+
+long cFunctionalMoments::process(FLOAT_DMEM *in,
+    FLOAT_DMEM *inSorted, const sFunctionalRowStats *stats,
+    FLOAT_DMEM *out, long Nin, long Nout)
+{
   if ((Nin>0)&&(out!=NULL)) {
-    double m2 = 0.0;
-    double m3 = 0.0;
-    double m4 = 0.0;
+    // central moment sums (around the mean) from the row statistics
+    double m2 = stats->m2;
+    double m3 = stats->m3;
+    double m4 = stats->m4;
     double Nind = (double)Nin;
-    double tmp, tmp2;
-    FLOAT_DMEM *in0=in;
-    double meanD = (double)mean;
-    for (i=0; i<Nin; i++) {
-      tmp = ((double)*(in++) - meanD);
-      tmp2 = tmp * tmp;
-      m2 += tmp2;
-      tmp2 *= tmp;
-      m3 += tmp2;
-      m4 += tmp2*tmp;
-    }
+    FLOAT_DMEM mean = (FLOAT_DMEM)stats->mean;
     m2 /= Nind;  // variance
 
     int n=0;
@@ -66,6 +66,8 @@ SMILECOMPONENT_REGCOMP(cFunctionalPercentiles)
     ct->setField("pctlquotient","Array that specifies which inter percentile quotients to compute. A quotient is specified as 'n1-n2' (where n1 and n2 are the indicies of the percentiles as they appear in the percentile[] array, starting at 0 with the index of the first percentile). The quotient is computed as n1/n2.","0-1",ARRAY_TYPE);
 //    ct->setField("quickAlgo","do not sort input, use Dejan's quick estimation method instead",0);
     ct->setField("interp","If set to 1, percentile values will be linearly interpolated, instead of being rounded to the nearest index in the sorted array",1);
+    ct->setField("sketch","1 = compute approximate percentiles from a quantile sketch with bounded memory when the input of cFunctionals is streamed (frameMode = full with incremental = 1), instead of storing and sorting the whole segment. The exact percentiles are computed if the input is not streamed.",0);
+    ct->setField("sketchError","Maximum error of the approximate percentiles (option 'sketch') as a fraction of the number of input frames, i.e. the returned value lies (with high probability) between the exact (p-sketchError) and (p+sketchError) percentiles. The memory required by the sketch grows with about 1/sketchError, but not with the length of the input.",0.01);
      // TOOD: implement quotients!
   )
   
@@ -84,6 +86,7 @@ cFunctionalPercentiles::cFunctionalPercentiles(const char *name) :
   tmpstr(NULL),
   quickAlgo(0),
   interp(0),
+  sketch(0), sketchError(0.0),
   varFctIdx(0)
 {}
 
@@ -91,6 +94,12 @@ void cFunctionalPercentiles::myFetchConfig()
 {
 //  quickAlgo = getInt("quickAlgo");
   interp = getInt("interp");
+  sketch = getInt("sketch");
+  sketchError = getDouble("sketchError");
+  if (sketch && (sketchError <= 0.0 || sketchError >= 0.5)) {
+    SMILE_IERR(1,"sketchError must be in the range ]0..0.5[ (got %f), using 0.01",sketchError);
+    sketchError = 0.01;
+  }
 
   enab[FUNCT_QUART1] = enab[FUNCT_QUART2] = enab[FUNCT_QUART3] = 0;
   if (getInt("quartile1")) enab[FUNCT_QUART1] = 1;
@@ -294,7 +303,7 @@ long cFunctionalPercentiles::getPctlIdx(double p, long N)
 }
 
 // get linearly interpolated percentile
-FLOAT_DMEM cFunctionalPercentiles::getInterpPctl(double p, FLOAT_DMEM *sorted, long N)
+FLOAT_DMEM cFunctionalPercentiles::getInterpPctl(double p, const FLOAT_DMEM *sorted, const cFunctionalQuantileSketch *sk, long N)
 {
   double idx = p*(double)(N-1);
   long i1,i2;
@@ -308,19 +317,60 @@ FLOAT_DMEM cFunctionalPercentiles::getInterpPctl(double p, FLOAT_DMEM *sorted, l
     double w1,w2;
     w1 = idx-(double)i1;
     w2 = (double)i2 - idx;
-    return sorted[i1]*(FLOAT_DMEM)w2 + sorted[i2]*(FLOAT_DMEM)w1;
+    return getSortedValue(sorted,sk,i1)*(FLOAT_DMEM)w2 + getSortedValue(sorted,sk,i2)*(FLOAT_DMEM)w1;
   } else {
-    return sorted[i1];
+    return getSortedValue(sorted,sk,i1);
+  }
+}
+
+// indices in the sorted array read by getPctlIdx / getInterpPctl for percentile p
+int cFunctionalPercentiles::getPctlRanks(double p, long N, long *ranks)
+{
+  if (interp) {
+    double idx = p*(double)(N-1);
+    long i1=(long)floor(idx);
+    long i2=(long)ceil(idx);
+    if (i1<0) i1=0;
+    if (i2<0) i2=0;
+    if (i1>=N) i1=N-1;
+    if (i2>=N) i2=N-1;
+    ranks[0] = i1;
+    ranks[1] = i2;
+    return 2;
+  }
+  ranks[0] = getPctlIdx(p,N);
+  return 1;
+}
+
+int cFunctionalPercentiles::getMaxSelectRanks()
+{
+  return 2*(3+nPctl);
+}
+
+// the indices in the sorted array read by process() for the enabled outputs
+int cFunctionalPercentiles::getSelectRanks(long N, long *ranks)
+{
+  int nRanks = 0;
+  if (enab[FUNCT_QUART1]||enab[FUNCT_QUART2]||enab[FUNCT_QUART3]||
+      enab[FUNCT_IQR12]||enab[FUNCT_IQR23]||enab[FUNCT_IQR13]) {
+    nRanks += getPctlRanks(0.25,N,ranks+nRanks);
+    nRanks += getPctlRanks(0.50,N,ranks+nRanks);
+    nRanks += getPctlRanks(0.75,N,ranks+nRanks);
   }
+  if ((enab[FUNCT_PERCENTILE])||(enab[FUNCT_PCTLRANGE])||(enab[FUNCT_PCTLQUOT])) {
+    int i;
+    for (i=0; i<nPctl; i++) {
+      nRanks += getPctlRanks(pctl[i],N,ranks+nRanks);
+    }
+  }
+  return nRanks;
 }
 
 long cFunctionalPercentiles::process(FLOAT_DMEM *in,
     FLOAT_DMEM *inSorted, FLOAT_DMEM *out, long Nin, long Nout)
 {
-  long i;
   if ((Nin>0)&&(out!=NULL)) {
     int n=0;
-    FLOAT_DMEM q1, q2, q3;
 
     if (quickAlgo) {
       // Not yet implemented....
@@ -359,62 +409,84 @@ long cFunctionalPercentiles::process(FLOAT_DMEM *in,
       free(bins);
       */
     } else {
-      long minpos=0, maxpos=0;
       if (inSorted == NULL) {
         SMILE_IERR(1,"expected sorted input, however got NULL!");
       }
-      // quartiles:
-      if (interp) {
-        q1 = getInterpPctl(0.25,inSorted,Nin);
-        q2 = getInterpPctl(0.50,inSorted,Nin);
-        q3 = getInterpPctl(0.75,inSorted,Nin);
-      } else {
-        q1 = inSorted[getPctlIdx(0.25,Nin)];
-        q2 = inSorted[getPctlIdx(0.50,Nin)];
-        q3 = inSorted[getPctlIdx(0.75,Nin)];
+      n = processSorted(inSorted, NULL, out, Nin);
+    }
+
+    return n;
+  }
+  return 0;
+}
+
+// quartiles, percentiles and ranges from the sorted input or from the quantile sketch sk
+long cFunctionalPercentiles::processSorted(const FLOAT_DMEM *sorted,
+    const cFunctionalQuantileSketch *sk, FLOAT_DMEM *out, long Nin)
+{
+  long i;
+  int n=0;
+  FLOAT_DMEM q1, q2, q3;
+  // quartiles:
+  if (interp) {
+    q1 = getInterpPctl(0.25,sorted,sk,Nin);
+    q2 = getInterpPctl(0.50,sorted,sk,Nin);
+    q3 = getInterpPctl(0.75,sorted,sk,Nin);
+  } else {
+    q1 = getSortedValue(sorted,sk,getPctlIdx(0.25,Nin));
+    q2 = getSortedValue(sorted,sk,getPctlIdx(0.50,Nin));
+    q3 = getSortedValue(sorted,sk,getPctlIdx(0.75,Nin));
+  }
+  if (enab[FUNCT_QUART1]) out[n++]=q1;
+  if (enab[FUNCT_QUART2]) out[n++]=q2;
+  if (enab[FUNCT_QUART3]) out[n++]=q3;
+  if (enab[FUNCT_IQR12]) out[n++]=q2-q1;
+  if (enab[FUNCT_IQR23]) out[n++]=q3-q2;
+  if (enab[FUNCT_IQR13]) out[n++]=q3-q1;
+
+  // percentiles
+  if ((enab[FUNCT_PERCENTILE])||(enab[FUNCT_PCTLRANGE])||(enab[FUNCT_PCTLQUOT])) {
+    int n0 = n; // start of percentiles array (used later for computation of pctlranges)
+    if (interp) {
+      for (i=0; i<nPctl; i++) {
+        out[n++] = getInterpPctl(pctl[i],sorted,sk,Nin);
       }
-      if (enab[FUNCT_QUART1]) out[n++]=q1;
-      if (enab[FUNCT_QUART2]) out[n++]=q2;
-      if (enab[FUNCT_QUART3]) out[n++]=q3;
-      if (enab[FUNCT_IQR12]) out[n++]=q2-q1;
-      if (enab[FUNCT_IQR23]) out[n++]=q3-q2;
-      if (enab[FUNCT_IQR13]) out[n++]=q3-q1;
-
-      // percentiles
-      if ((enab[FUNCT_PERCENTILE])||(enab[FUNCT_PCTLRANGE])||(enab[FUNCT_PCTLQUOT])) {
-        int n0 = n; // start of percentiles array (used later for computation of pctlranges)
-        if (interp) {
-          for (i=0; i<nPctl; i++) {
-            out[n++] = getInterpPctl(pctl[i],inSorted,Nin);
-          }
+    } else {
+      for (i=0; i<nPctl; i++) {
+        out[n++] = getSortedValue(sorted,sk,getPctlIdx(pctl[i],Nin));
+      }
+    }
+    if (enab[FUNCT_PCTLRANGE]) {
+      for (i=0; i<nPctlRange; i++) {
+        if ((pctlr1[i]>=0)&&(pctlr2[i]>=0)) {
+          out[n++] = fabs(out[n0+pctlr2[i]] - out[n0+pctlr1[i]]);
+        } else { out[n++] = 0.0; }
+      }
+    }
+    if (enab[FUNCT_PCTLRANGE]) {
+      for (i = 0; i < nPctlQuot; i++) {
+        if ((pctlq1[i] >= 0) && (pctlq2[i] >= 0) && (out[n0+pctlq1[i]] != 0.0)) {
+          out[n++] = smileMath_ratioLimit(out[n0+pctlq1[i]] / out[n0+pctlq2[i]],
+              50.0, 100.0);
         } else {
-          for (i=0; i<nPctl; i++) {
-            out[n++] = inSorted[getPctlIdx(pctl[i],Nin)];
-          }
-        }
-        if (enab[FUNCT_PCTLRANGE]) {
-          for (i=0; i<nPctlRange; i++) {
-            if ((pctlr1[i]>=0)&&(pctlr2[i]>=0)) {
-              out[n++] = fabs(out[n0+pctlr2[i]] - out[n0+pctlr1[i]]);
-            } else { out[n++] = 0.0; }
-          }
-        }
-        if (enab[FUNCT_PCTLRANGE]) {
-          for (i = 0; i < nPctlQuot; i++) {
-            if ((pctlq1[i] >= 0) && (pctlq2[i] >= 0) && (out[n0+pctlq1[i]] != 0.0)) {
-              out[n++] = smileMath_ratioLimit(out[n0+pctlq1[i]] / out[n0+pctlq2[i]],
-                  50.0, 100.0);
-            } else {
-              out[n++] = 0.0;
-            }
-          }
+          out[n++] = 0.0;
         }
       }
     }
+  }
+  return n;
+}
 
-    return n;
+long cFunctionalPercentiles::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted,
+    const sFunctionalRowStats *stats, FLOAT_DMEM *out, long Nin, long Nout)
+{
+  if ((inSorted == NULL)&&(stats->sketch != NULL)) {
+    if ((Nin>0)&&(out!=NULL)) {
+      return processSorted(NULL, stats->sketch, out, Nin);
+    }
+    return 0;
   }
-  return 0;
+  return process(in, inSorted, out, Nin, Nout);
 }
 
 cFunctionalPercentiles::~cFunctionalPercentiles()
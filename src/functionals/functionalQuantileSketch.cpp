@@ -0,0 +1,139 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*  openSMILE component:
+
+KLL quantile sketch (Karnin, Lang, Liberty 2016) of a stream of values with bounded memory,
+used for approximate percentiles of streamed input (see cFunctionalPercentiles option 'sketch')
+
+*/
+
+
+#include <functionals/functionalQuantileSketch.hpp>
+#include <algorithm>
+#include <math.h>
+
+#define MODULE "cFunctionalQuantileSketch"
+
+// capacity ratio of two adjacent levels and minimum capacity of a level
+#define SKETCH_LEVEL_RATIO  (2.0/3.0)
+#define SKETCH_MIN_CAPACITY 8
+#define SKETCH_SEED         0x9e3779b9u
+
+
+cFunctionalQuantileSketch::cFunctionalQuantileSketch(double eps) :
+  k(getK(eps)), n(0), size(0), rng(SKETCH_SEED)
+{
+  compactors.resize(1);
+}
+
+// empirical rank error of the KLL sketch with level ratio 2/3: eps = 1.854 / k^0.9326
+int cFunctionalQuantileSketch::getK(double eps)
+{
+  if (eps <= 0.0) return 65535;
+  double k = ceil(pow(1.854 / eps, 1.0 / 0.9326));
+  if (k < SKETCH_MIN_CAPACITY) return SKETCH_MIN_CAPACITY;
+  if (k > 65535.0) return 65535;
+  return (int)k;
+}
+
+// the top level has capacity k, each level below 2/3 of the level above
+long cFunctionalQuantileSketch::levelCapacity(int h) const
+{
+  int depth = (int)compactors.size() - 1 - h;
+  long c = (long)ceil((double)k * pow(SKETCH_LEVEL_RATIO, depth));
+  return (c < SKETCH_MIN_CAPACITY) ? SKETCH_MIN_CAPACITY : c;
+}
+
+long cFunctionalQuantileSketch::totalCapacity() const
+{
+  long c = 0;
+  for (int h = 0; h < (int)compactors.size(); h++) {
+    c += levelCapacity(h);
+  }
+  return c;
+}
+
+void cFunctionalQuantileSketch::add(FLOAT_DMEM x)
+{
+  compactors[0].push_back(x);
+  n++;
+  size++;
+  if (size >= totalCapacity()) {
+    compress();
+  }
+}
+
+// compacts the lowest level which is full: every other item of the sorted level (starting at a
+// random offset) moves up with twice the weight, the others are dropped
+void cFunctionalQuantileSketch::compress()
+{
+  for (int h = 0; h < (int)compactors.size(); h++) {
+    if ((long)compactors[h].size() < levelCapacity(h)) continue;
+    if (h + 1 == (int)compactors.size()) {
+      compactors.emplace_back();
+    }
+    std::vector<FLOAT_DMEM> &lvl = compactors[h];
+    std::vector<FLOAT_DMEM> &up = compactors[h + 1];
+    std::sort(lvl.begin(), lvl.end());
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    // with an odd number of items the smallest one stays in this level
+    size_t i0 = lvl.size() & 1;
+    size_t i;
+    for (i = i0 + (rng & 1); i < lvl.size(); i += 2) {
+      up.push_back(lvl[i]);
+    }
+    size_t nKeep = i0;
+    size -= (long)(lvl.size() - nKeep) - (long)((lvl.size() - i0) / 2);
+    lvl.resize(nKeep);
+    return;
+  }
+}
+
+void cFunctionalQuantileSketch::clear()
+{
+  compactors.clear();
+  compactors.resize(1);
+  sortedItems.clear();
+  cumWeight.clear();
+  n = 0;
+  size = 0;
+  rng = SKETCH_SEED;
+}
+
+void cFunctionalQuantileSketch::prepare()
+{
+  std::vector<std::pair<FLOAT_DMEM, long>> items;
+  items.reserve(size);
+  for (int h = 0; h < (int)compactors.size(); h++) {
+    for (FLOAT_DMEM x : compactors[h]) {
+      items.push_back(std::make_pair(x, 1L << h));
+    }
+  }
+  std::sort(items.begin(), items.end(),
+      [](const std::pair<FLOAT_DMEM, long> &a, const std::pair<FLOAT_DMEM, long> &b) { return a.first < b.first; });
+  sortedItems.resize(items.size());
+  cumWeight.resize(items.size());
+  long w = 0;
+  for (size_t i = 0; i < items.size(); i++) {
+    w += items[i].second;
+    sortedItems[i] = items[i].first;
+    cumWeight[i] = w;
+  }
+}
+
+// the first item whose cumulative weight exceeds r, the total weight of all items is n
+FLOAT_DMEM cFunctionalQuantileSketch::getRank(long r) const
+{
+  if (sortedItems.empty()) return 0.0;
+  size_t i = std::upper_bound(cumWeight.begin(), cumWeight.end(), r) - cumWeight.begin();
+  if (i >= sortedItems.size()) i = sortedItems.size() - 1;
+  return sortedItems[i];
+}
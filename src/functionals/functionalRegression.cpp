@@ -139,14 +139,32 @@ void cFunctionalRegression::myFetchConfig()
   cFunctionalComponent::myFetchConfig();
 }
 
+// the absolute regression errors cannot be derived from the row statistics
+int cFunctionalRegression::isIncremental()
+{
+  return !enab[FUNCT_LINREGERRA] && !enab[FUNCT_QREGERRA];
+}
+
 long cFunctionalRegression::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted,
     FLOAT_DMEM min, FLOAT_DMEM max, FLOAT_DMEM mean,
     FLOAT_DMEM *out, long Nin, long Nout)
+{
+  sFunctionalRowStats stats;
+  computeRowStats(in, Nin, getRequireStats(), &stats);
+  return process(in, inSorted, &stats, out, Nin, Nout);
+}
+
+long cFunctionalRegression::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted,
+    const sFunctionalRowStats *stats,
+    FLOAT_DMEM *out, long Nin, long Nout)
 {
   if ((Nin>0)&&(out!=NULL)) {
     //compute centroid
-    FLOAT_DMEM *iE = in + Nin;
+    FLOAT_DMEM *iE = (in != NULL) ? in + Nin : NULL;
     FLOAT_DMEM *i0 = in;
+    FLOAT_DMEM min = stats->min;
+    FLOAT_DMEM max = stats->max;
+    FLOAT_DMEM mean = (FLOAT_DMEM)stats->mean;
     double Nind = (double)Nin;
     double range = max-min;
     double rangeInv;
@@ -157,37 +175,14 @@ long cFunctionalRegression::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted,
       rangeInv = 1.0/range;
     }
 
-    double num = 0.0;
-    double numAbs = 0.0;
-    double num2 = 0.0;
-    double num2Abs = 0.0;
-    double tmp = 0.0;
+    // time weighted sums (sum of i*x and i^2*x for i=0..N-1) from the row statistics
+    double num = stats->sumTX;
+    double num2 = stats->sumT2X;
+    double numAbs = stats->sumTAbsX;
+    double asumAbs = stats->sumPos - stats->sumNeg;
+    if (stats->nNaN > 0) asumAbs = stats->mean;  // NaN values propagate into the sum
     double ii = 0.0;
-    double asumAbs = 0.0;
     double asum = mean * Nind;
-    if (centroidUseAbsValues_) {
-      while (in<iE) {
-        asumAbs += (double)fabs(*(in));
-        tmp = (double)(fabs(*(in))) * ii;
-        numAbs += tmp;
-        tmp *= ii;
-  //      ii += 1.0;
-        num2Abs += tmp;
-        tmp = (double)(*(in++)) * ii;
-        num += tmp;
-        tmp *= ii;
-        ii += 1.0;
-        num2 += tmp;
-      }
-    } else {
-      while (in<iE) {
-        tmp = (double)(*(in++)) * ii;
-        num += tmp;
-        tmp *= ii;
-        ii += 1.0;
-        num2 += tmp;
-      }
-    }
 
     double centroid;
     if (centroidUseAbsValues_) {
@@ -271,20 +266,33 @@ long cFunctionalRegression::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted,
       }
 //    printf("nind:%f  S1=%f,  S2=%f  S3=%f  S4=%f  num2=%f  num=%f  asum=%f t=%f\n",Nind,S1,S2,S3,S4,num2,num,asum,t);
     } else {
-      m = 0; t=c=*in;
+      m = 0;
+      if (in != NULL) t=c=*in;
+      else t=c=mean;
       a = 0.0; b=0.0;
+      S1 = S2 = S3 = S4 = 0.0;
     }
     
-    // linear regression error:
-    ii=0.0; double e;
-    while (in<iE) {
-      e = (double)(*(in++)) - (m*ii + t);
-      if (normInputs) e *= rangeInv;
-      lea += fabs(e);
-      ii += 1.0;
-      leq += e*e;
+    if (in != NULL) {
+      // linear regression error:
+      ii=0.0; double e;
+      while (in<iE) {
+        e = (double)(*(in++)) - (m*ii + t);
+        if (normInputs) e *= rangeInv;
+        lea += fabs(e);
+        ii += 1.0;
+        leq += e*e;
+      }
+      in=i0;
+    } else {
+      // incremental mode (no input values): the quadratic error is expanded into the
+      // row sums, the absolute error is not available (see isIncremental)
+      double qsum = stats->sumSqPos + stats->sumSqNeg;
+      double sum = stats->sumPos + stats->sumNeg;
+      leq = qsum - 2.0*m*num - 2.0*t*sum + m*m*S2 + 2.0*m*t*S1 + Nind*t*t;
+      if (leq < 0.0) leq = 0.0;
+      if (normInputs) leq *= rangeInv*rangeInv;
     }
-    in=i0;
 
     double rs=0.0, ls=0.0;
     double x0=0.0, y0=0.0;
@@ -294,15 +302,25 @@ long cFunctionalRegression::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted,
 
     // quadratic regresssion error:
     if (enQreg) {
-      ii=0.0; double e;
-      while (in<iE) {
-        e = (double)(*(in++)) - (a*ii*ii + b*ii + c);
-        if (normInputs) e *= rangeInv;
-        qea += fabs(e);
-        ii += 1.0;
-        qeq += e*e;
+      if (in != NULL) {
+        ii=0.0; double e;
+        while (in<iE) {
+          e = (double)(*(in++)) - (a*ii*ii + b*ii + c);
+          if (normInputs) e *= rangeInv;
+          qea += fabs(e);
+          ii += 1.0;
+          qeq += e*e;
+        }
+        in=i0;
+      } else {
+        // S3 is the sum of i^3 (= S1^2)
+        double qsum = stats->sumSqPos + stats->sumSqNeg;
+        double sum = stats->sumPos + stats->sumNeg;
+        qeq = qsum - 2.0*a*num2 - 2.0*b*num - 2.0*c*sum + a*a*S4 + b*b*S2 + Nind*c*c
+            + 2.0*a*b*S3 + 2.0*a*c*S2 + 2.0*b*c*S1;
+        if (qeq < 0.0) qeq = 0.0;
+        if (normInputs) qeq *= rangeInv*rangeInv;
       }
-      in=i0;
 
       // parabola vertex (x coordinate clipped to range -Nind + Nind!)  // TODO: why -Nind?
       x0 = b/(-2.0*a);
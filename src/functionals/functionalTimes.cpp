@@ -199,17 +199,17 @@ const char* cFunctionalTimes::getValueName(long i)
 }
 
 
-FLOAT_DMEM cFunctionalTimes::getPctlMin(FLOAT_DMEM *sorted, long N)
+long cFunctionalTimes::getPctlMinIdx(long N)
 {
   long idx = (long)round(pctlRangeMargin_ * (FLOAT_DMEM)(N - 1));
   if (idx < 0)
     idx = 0;
   if (idx >= N)
     idx = N - 1;
-  return sorted[idx];
+  return idx;
 }
 
-FLOAT_DMEM cFunctionalTimes::getPctlMax(FLOAT_DMEM *sorted, long N)
+long cFunctionalTimes::getPctlMaxIdx(long N)
 {
   long idx = (long)round(((FLOAT_DMEM)1.0 
     - pctlRangeMargin_) * (FLOAT_DMEM)(N - 1));
@@ -217,7 +217,26 @@ FLOAT_DMEM cFunctionalTimes::getPctlMax(FLOAT_DMEM *sorted, long N)
     idx = 0;
   if (idx >= N)
     idx = N - 1;
-  return sorted[idx];
+  return idx;
+}
+
+FLOAT_DMEM cFunctionalTimes::getPctlMin(FLOAT_DMEM *sorted, long N)
+{
+  return sorted[getPctlMinIdx(N)];
+}
+
+FLOAT_DMEM cFunctionalTimes::getPctlMax(FLOAT_DMEM *sorted, long N)
+{
+  return sorted[getPctlMaxIdx(N)];
+}
+
+int cFunctionalTimes::getSelectRanks(long N, long *ranks)
+{
+  if (!useRobustPercentileRange_)
+    return 0;
+  ranks[0] = getPctlMinIdx(N);
+  ranks[1] = getPctlMaxIdx(N);
+  return 2;
 }
 
 long cFunctionalTimes::process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted,  FLOAT_DMEM min,
@@ -0,0 +1,396 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*  openSMILE component:
+
+running statistics of one input row over a sliding window of fixed length,
+used by cFunctionals to process overlapping windows incrementally, and of all
+frames of a segment which is streamed through without storing it (frameMode = full)
+
+*/
+
+
+#include <functionals/functionalWindowState.hpp>
+#include <algorithm>
+#include <limits>
+#include <math.h>
+
+#define MODULE "cFunctionalWindowState"
+
+
+void sFunctionalRunningSums::clear(double _ref)
+{
+  sumPos = sumNeg = sumSqPos = sumSqNeg = 0.0;
+  nPos = nNeg = nNaN = 0;
+  sumLogAbs = 0.0;
+  ref = (_ref == _ref) ? _ref : 0.0;
+  p1 = p2 = p3 = p4 = 0.0;
+  sTX = sT2X = sTAbsX = 0.0;
+}
+
+void sFunctionalRunningSums::add(FLOAT_DMEM x, double t, double sign, int flags)
+{
+  if (x != x) {
+    // NaN values are only counted, so that the sums are valid again when they have left the window
+    nNaN += (long)sign;
+    return;
+  }
+  double v = (double)x;
+  double vp = (x > 0.0) ? v : 0.0;
+  double vn = (x < 0.0) ? v : 0.0;
+  sumPos += sign * vp;
+  sumSqPos += sign * vp * vp;
+  sumNeg += sign * vn;
+  sumSqNeg += sign * vn * vn;
+  nPos += (x > 0.0) ? (long)sign : 0;
+  nNeg += (x < 0.0) ? (long)sign : 0;
+  if ((flags & FUNCTSTATS_LOGSUM) && x != 0.0) {
+    sumLogAbs += sign * log(fabs(v));
+  }
+  if (flags & FUNCTSTATS_MOMENTS) {
+    double d = v - ref;
+    double d2 = d * d;
+    p1 += sign * d;
+    p2 += sign * d2;
+    p3 += sign * d2 * d;
+    p4 += sign * d2 * d2;
+  }
+  if (flags & FUNCTSTATS_TIMESUMS) {
+    double tv = t * v;
+    sTX += sign * tv;
+    sT2X += sign * tv * t;
+    sTAbsX += sign * fabs(tv);
+  }
+}
+
+void sFunctionalRunningSums::getStats(sFunctionalRowStats *stats, long N, double T0, int flags) const
+{
+  double Nd = (double)N;
+  // the sums of values which have all left the window are exactly zero
+  double sp = (nPos > 0) ? sumPos : 0.0;
+  double sn = (nNeg > 0) ? sumNeg : 0.0;
+  stats->sumPos = sp;
+  stats->sumNeg = sn;
+  stats->sumSqPos = (nPos > 0) ? sumSqPos : 0.0;
+  stats->sumSqNeg = (nNeg > 0) ? sumSqNeg : 0.0;
+  stats->nPos = nPos;
+  stats->nNeg = nNeg;
+  stats->mean = (sp + sn) / Nd;
+
+  stats->m2 = stats->m3 = stats->m4 = 0.0;
+  if ((flags & FUNCTSTATS_MOMENTS) && stats->min != stats->max) {
+    // central moments around (FLOAT_DMEM)mean from the sums of the powers of (x - ref)
+    double d = (double)(FLOAT_DMEM)stats->mean - ref;
+    double d2 = d * d;
+    double m2 = p2 - 2.0 * d * p1 + Nd * d2;
+    double m3 = p3 - 3.0 * d * p2 + 3.0 * d2 * p1 - Nd * d2 * d;
+    double m4 = p4 - 4.0 * d * p3 + 6.0 * d2 * p2 - 4.0 * d2 * d * p1 + Nd * d2 * d2;
+    stats->m2 = (m2 > 0.0) ? m2 : 0.0;
+    stats->m3 = m3;
+    stats->m4 = (m4 > 0.0) ? m4 : 0.0;
+  }
+
+  stats->sumTX = stats->sumT2X = stats->sumTAbsX = 0.0;
+  if (flags & FUNCTSTATS_TIMESUMS) {
+    // shift the time origin to the first value
+    double sum = sp + sn;
+    stats->sumTX = sTX - T0 * sum;
+    stats->sumT2X = sT2X - 2.0 * T0 * sTX + T0 * T0 * sum;
+    stats->sumTAbsX = sTAbsX - T0 * (sp - sn);
+  }
+
+  stats->sumLogAbs = 0.0;
+  if ((flags & FUNCTSTATS_LOGSUM) && nPos + nNeg > 0) {
+    stats->sumLogAbs = sumLogAbs;
+  }
+
+  stats->nNaN = nNaN;
+  if (nNaN > 0) {
+    // NaN values propagate as in cFunctionalComponent::computeRowStats
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    stats->mean = nan;
+    if (flags & FUNCTSTATS_MOMENTS) stats->m2 = stats->m3 = stats->m4 = nan;
+    if (flags & FUNCTSTATS_TIMESUMS) stats->sumTX = stats->sumT2X = stats->sumTAbsX = nan;
+    if (flags & FUNCTSTATS_LOGSUM) stats->sumLogAbs = nan;
+  }
+  stats->sketch = NULL;
+}
+
+
+cFunctionalWindowState::cFunctionalWindowState(long _cap, int _flags, int _withRanks) :
+  cap(_cap), flags(_flags), withRanks(_withRanks),
+  ring(NULL), start(0), end(0), startSlot(0),
+  minQ(NULL), maxQ(NULL), minV(NULL), maxV(NULL),
+  ranks(NULL), ranksTmp(NULL), ranksAdd(NULL)
+{
+  if (cap < 1) cap = 1;
+  ring = (FLOAT_DMEM *)calloc(1, sizeof(FLOAT_DMEM) * cap);
+  minQ = (long *)malloc(sizeof(long) * cap);
+  maxQ = (long *)malloc(sizeof(long) * cap);
+  minV = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM) * cap);
+  maxV = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM) * cap);
+  if (ring == NULL || minQ == NULL || maxQ == NULL || minV == NULL || maxV == NULL) OUT_OF_MEMORY;
+  if (withRanks) {
+    ranks = (sRankEntry *)malloc(sizeof(sRankEntry) * cap);
+    ranksTmp = (sRankEntry *)malloc(sizeof(sRankEntry) * cap);
+    ranksAdd = (sRankEntry *)malloc(sizeof(sRankEntry) * cap);
+    if (ranks == NULL || ranksTmp == NULL || ranksAdd == NULL) OUT_OF_MEMORY;
+  }
+  clear();
+}
+
+// negative values: invert all bits, positive values: set the sign bit
+cFunctionalWindowState::sortKey cFunctionalWindowState::toKey(FLOAT_DMEM x)
+{
+  const sortKey sign = (sortKey)1 << (sizeof(sortKey) * 8 - 1);
+  sortKey u;
+  memcpy(&u, &x, sizeof(u));
+  return (u & sign) ? ~u : (u | sign);
+}
+
+FLOAT_DMEM cFunctionalWindowState::fromKey(sortKey k)
+{
+  const sortKey sign = (sortKey)1 << (sizeof(sortKey) * 8 - 1);
+  sortKey u = (k & sign) ? (k & ~sign) : ~k;
+  FLOAT_DMEM x;
+  memcpy(&x, &u, sizeof(x));
+  return x;
+}
+
+void cFunctionalWindowState::clear()
+{
+  start = end = startSlot = 0;
+  sums.clear(0.0);
+  tOrigin = 0;
+  minHead = minN = maxHead = maxN = 0;
+}
+
+// re-computes the running sums from the values in the window, this bounds the rounding
+// errors accumulated by adding and removing values, and the magnitude of the time weights
+void cFunctionalWindowState::resync()
+{
+  long v, i;
+  double s = 0.0;
+  long n = 0;
+  for (v = start, i = startSlot; v < end; v++) {
+    if (ring[i] == ring[i]) { s += (double)ring[i]; n++; }
+    if (++i == cap) i = 0;
+  }
+  sums.clear((n > 0) ? (double)(FLOAT_DMEM)(s / (double)n) : 0.0);
+  tOrigin = start;
+  for (v = start, i = startSlot; v < end; v++) {
+    sums.add(ring[i], (double)(v - tOrigin), 1.0, flags);
+    if (++i == cap) i = 0;
+  }
+}
+
+void cFunctionalWindowState::add(long vIdx, long slot, FLOAT_DMEM x)
+{
+  long b;
+  ring[slot] = x;
+  sums.add(x, (double)(vIdx - tOrigin), 1.0, flags);
+  // the queues hold the candidates for the maximum (minimum) of the current and all later
+  // windows in order of vIdx, the front is the first maximum (minimum) of the window;
+  // NaN values are never the maximum (minimum) of a sequential scan, unless they are
+  // the first value of the window (see getStats)
+  if (x != x) return;
+  while (maxN > 0) {
+    b = maxHead + maxN - 1;
+    if (b >= cap) b -= cap;
+    if (!(maxV[b] < x)) break;
+    maxN--;
+  }
+  b = maxHead + maxN;
+  if (b >= cap) b -= cap;
+  maxQ[b] = vIdx;
+  maxV[b] = x;
+  maxN++;
+  while (minN > 0) {
+    b = minHead + minN - 1;
+    if (b >= cap) b -= cap;
+    if (!(minV[b] > x)) break;
+    minN--;
+  }
+  b = minHead + minN;
+  if (b >= cap) b -= cap;
+  minQ[b] = vIdx;
+  minV[b] = x;
+  minN++;
+}
+
+// removes the oldest value (vIdx == start) from the window
+void cFunctionalWindowState::remove(long vIdx, long slot)
+{
+  sums.add(ring[slot], (double)(vIdx - tOrigin), -1.0, flags);
+  if (maxN > 0 && maxQ[maxHead] == vIdx) {
+    if (++maxHead == cap) maxHead = 0;
+    maxN--;
+  }
+  if (minN > 0 && minQ[minHead] == vIdx) {
+    if (++minHead == cap) minHead = 0;
+    minN--;
+  }
+}
+
+// ranks holds the nOld values of the previous window, ranksAdd the nAdd new values
+void cFunctionalWindowState::mergeRanks(long nOld, long nAdd)
+{
+  long i, k = 0, o = 0;
+  std::sort(ranksAdd, ranksAdd + nAdd,
+      [](const sRankEntry &a, const sRankEntry &b) { return a.key < b.key; });
+  for (i = 0; i < nOld; i++) {
+    if (ranks[i].vIdx < start) continue;
+    while (k < nAdd && ranksAdd[k].key < ranks[i].key) {
+      ranksTmp[o++] = ranksAdd[k++];
+    }
+    ranksTmp[o++] = ranks[i];
+  }
+  while (k < nAdd) {
+    ranksTmp[o++] = ranksAdd[k++];
+  }
+  sRankEntry *tmp = ranks;
+  ranks = ranksTmp;
+  ranksTmp = tmp;
+}
+
+void cFunctionalWindowState::update(const FLOAT_DMEM *x, long stride, long N, long vIdx)
+{
+  if (N > cap) {
+    SMILE_ERR(1, "window of %ld frames is longer than the window state (%ld frames)", N, cap);
+    N = cap;
+  }
+  long nOld = end - start, nAdd = 0;
+  int rebuild = (nOld == 0) || (vIdx < start) || (vIdx >= end) || (vIdx + N < end);
+  if (rebuild) {
+    clear();
+    nOld = 0;
+    start = end = tOrigin = vIdx;
+    startSlot = vIdx % cap;
+  } else {
+    while (start < vIdx) {
+      remove(start, startSlot);
+      start++;
+      if (++startSlot == cap) startSlot = 0;
+    }
+  }
+  long v;
+  long slot = startSlot + (end - start);
+  if (slot >= cap) slot -= cap;
+  for (v = end; v < vIdx + N; v++) {
+    FLOAT_DMEM xv = x[(v - vIdx) * stride];
+    if (withRanks) {
+      ranksAdd[nAdd].key = toKey(xv);
+      ranksAdd[nAdd++].vIdx = v;
+    }
+    add(v, slot, xv);
+    if (++slot == cap) slot = 0;
+  }
+  end = vIdx + N;
+  if (withRanks) {
+    mergeRanks(nOld, nAdd);
+  }
+  if (rebuild || start - tOrigin >= 4 * cap) {
+    resync();
+  }
+}
+
+void cFunctionalWindowState::getStats(sFunctionalRowStats *stats) const
+{
+  stats->minPos = stats->maxPos = -1;
+  if (ring[startSlot] != ring[startSlot] || minN == 0) {
+    // a sequential scan starting with NaN finds NaN as minimum and maximum, and no positions
+    stats->min = stats->max = ring[startSlot];
+  } else {
+    stats->min = minV[minHead];
+    stats->max = maxV[maxHead];
+  }
+  if ((flags & FUNCTSTATS_EXTREMEPOS) && stats->min == stats->min) {
+    stats->minPos = minQ[minHead] - start;
+    stats->maxPos = maxQ[maxHead] - start;
+  }
+  sums.getStats(stats, end - start, (double)(start - tOrigin), flags);
+}
+
+void cFunctionalWindowState::getSorted(FLOAT_DMEM *out) const
+{
+  long r;
+  for (r = 0; r < end - start; r++) {
+    out[r] = fromKey(ranks[r].key);
+  }
+}
+
+cFunctionalWindowState::~cFunctionalWindowState()
+{
+  if (ring != NULL) free(ring);
+  if (minQ != NULL) free(minQ);
+  if (maxQ != NULL) free(maxQ);
+  if (minV != NULL) free(minV);
+  if (maxV != NULL) free(maxV);
+  if (ranks != NULL) free(ranks);
+  if (ranksTmp != NULL) free(ranksTmp);
+  if (ranksAdd != NULL) free(ranksAdd);
+}
+
+
+cFunctionalStreamState::cFunctionalStreamState(int _flags, double sketchError) :
+  flags(_flags), sketch(NULL)
+{
+  if (sketchError > 0.0) {
+    sketch = new cFunctionalQuantileSketch(sketchError);
+  }
+  clear();
+}
+
+void cFunctionalStreamState::add(const FLOAT_DMEM *x, long stride, long N)
+{
+  long i;
+  if (N <= 0) return;
+  if (n == 0) {
+    // the first value is the reference for the sums of the powers of (x - ref)
+    sums.clear((double)x[0]);
+    min = max = x[0];
+    minPos = maxPos = 0;
+  }
+  for (i = 0; i < N; i++, n++) {
+    FLOAT_DMEM xv = x[i * stride];
+    if (xv < min) { min = xv; minPos = n; }
+    if (xv > max) { max = xv; maxPos = n; }
+    sums.add(xv, (double)n, 1.0, flags);
+    if (sketch != NULL) sketch->add(xv);
+  }
+}
+
+void cFunctionalStreamState::getStats(sFunctionalRowStats *stats)
+{
+  stats->min = min;
+  stats->max = max;
+  stats->minPos = stats->maxPos = -1;
+  if (flags & FUNCTSTATS_EXTREMEPOS) {
+    stats->minPos = minPos;
+    stats->maxPos = maxPos;
+  }
+  sums.getStats(stats, n, 0.0, flags);
+  if (sketch != NULL) {
+    sketch->prepare();
+    stats->sketch = sketch;
+  }
+}
+
+void cFunctionalStreamState::clear()
+{
+  n = 0;
+  min = max = 0.0;
+  minPos = maxPos = 0;
+  sums.clear(0.0);
+  if (sketch != NULL) sketch->clear();
+}
+
+cFunctionalStreamState::~cFunctionalStreamState()
+{
+  if (sketch != NULL) delete sketch;
+}
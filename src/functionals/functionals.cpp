@@ -18,6 +18,7 @@ functionals meta-component
 #include <functionals/functionals.hpp>
 
 #include <algorithm>
+#include <thread>
 #include <math.h>
 
 #define MODULE "cFunctionals"
@@ -92,6 +93,7 @@ SMILECOMPONENT_REGCOMP(cFunctionals)
     ct->setField("functNameAppend","Specifies a string prefix to append to the functional name (which is appended to the input feature name)",(const char*)NULL);
     ct->setField("masterTimeNorm","This option specifies how all components should normalise times, if they generate output values related to durations. You can change the 'norm' parameter of individual functional components to overwrite this master value. You can choose one of the following normalisation methods: \n   'segment' (or: 'turn') : normalise to the range 0..1, the result indicates relative turn length )\n   'second'  (absolute time in seconds) \n   'frame' (absolute time in number of frames of input level)","segment");
     ct->setField("preserveFields", "If set to 1, preserves the field structure (and metadata, TODO!), of the input vector structure. If set to 0 (default) the output will only have fields with a single element.", 0);
+    ct->setField("nThreads", "Number of threads which compute the functionals of the input elements of a window in parallel (1 = single thread (default), 0 = one thread per CPU core). Each thread uses its own instances of the functional objects, the output is identical to single thread processing. All cFunctionals components share one pool of worker threads, whose size is the largest nThreads of all components, so the number of threads does not grow with the number of components; components that process a window at the same time (with nThreads > 1 in the componentInstances section) share the threads of the pool.", 1);
 
   SMILECOMPONENT_IFNOTREGAGAIN_END
 
@@ -111,7 +113,22 @@ cFunctionals::cFunctionals(const char *_name) :
   functObj(NULL),
   nFunctTpAlloc(0),
   nFunctTp(0),
+  requireSorted(0),
+  requireStats(0),
+  maxRanks(0),
+  allIncremental(1),
+  requireSequential(0),
+  streamable(0),
+  sketchError(0.0),
   nonZeroFuncts(0),
+  nThreads(1),
+  nThreadData(0),
+  threadData(NULL),
+  threadPool(NULL),
+  matrixBuf(NULL),
+  matrixBufSize(0),
+  winState(NULL),
+  streamState(NULL),
   functNameAppend(NULL),
   timeNorm(TIMENORM_UNDEFINED)
 {
@@ -130,6 +147,9 @@ int cFunctionals::myConfigureInstance()
   nonZeroFuncts = getInt("nonZeroFuncts");
   SMILE_IDBG(2,"nonZeroFuncts = %i \n",nonZeroFuncts);
 
+  nThreads = getInt("nThreads");
+  if (nThreads < 0) nThreads = 1;
+
   if (getInt("preserveFields")) {
     wholeMatrixMode = 1;
     processFieldsInMatrixMode = 1;
@@ -182,6 +202,12 @@ int cFunctionals::myConfigureInstance()
   nFunctionalsEnabled = getArraySize("functionalsEnabled");
   nFunctValues = 0;
   requireSorted = 0;
+  requireStats = 0;
+  maxRanks = 0;
+  allIncremental = 1;
+  requireSequential = 0;
+  sketchError = 0.0;
+  int allSketch = 1;  // all functionals which select order statistics accept approximate ones
   for (i=0; i<nFunctionalsEnabled; i++) {
     const char *fname = getStr_f(myvprint("functionalsEnabled[%i]",i));
     char *tpname = myvprint("cFunctional%s",fname);
@@ -196,14 +222,18 @@ int cFunctionals::myConfigureInstance()
     if (j<nFunctTp) {
       // and create corresponding component instances...
         SMILE_IDBG(3,"creating Functional object 'cFunctional%s'.",fname);
-        char *_tmp = myvprint("%s.%s",getInstName(),fname);
-        cFunctionalComponent * tmp = (cFunctionalComponent *)(_compman->createComponent)(_tmp,tpname);
-        free(_tmp);
-        if (tmp==NULL) OUT_OF_MEMORY;
-        tmp->setComponentEnvironment(_compman, -1, this);
-        tmp->setTimeNorm(timeNorm);
+        cFunctionalComponent * tmp = createFunctional(i);
         functN[i] = tmp->getNoutputValues();
         requireSorted += tmp->getRequireSorted();
+        requireStats |= tmp->getRequireStats();
+        maxRanks += tmp->getMaxSelectRanks();
+        if (!tmp->isIncremental()) allIncremental = 0;
+        if (tmp->getRequireSequential()) requireSequential = 1;
+        if (tmp->getMaxSelectRanks() > 0) {
+          double e = tmp->getSketchError();
+          if (e <= 0.0) allSketch = 0;
+          else if ((sketchError == 0.0)||(e < sketchError)) sketchError = e;
+        }
         nFunctValues += functN[i];
         functObj[i] = tmp;
         //functTp[i]  = strdup(fname);
@@ -220,10 +250,84 @@ int cFunctionals::myConfigureInstance()
   if (requireSorted) { 
     SMILE_IDBG(2,"%i Functional components require sorted data.",requireSorted);
   }
+  if (maxRanks > 0) {
+    SMILE_IDBG(2,"Functional components select up to %i order statistics.",maxRanks);
+  }
+  streamable = (nonZeroFuncts == 0) && allIncremental && !requireSorted && allSketch;
 
   return ret;
 }
 
+// creates the object of functional i of the functionalsEnabled array
+cFunctionalComponent * cFunctionals::createFunctional(int i)
+{
+  cComponentManager *_compman = getCompMan();
+  const char *fname = functTp[functI[i]];
+  char *tpname = myvprint("cFunctional%s",fname);
+  char *_tmp = myvprint("%s.%s",getInstName(),fname);
+  cFunctionalComponent * tmp = (cFunctionalComponent *)(_compman->createComponent)(_tmp,tpname);
+  free(_tmp);
+  free(tpname);
+  if (tmp==NULL) OUT_OF_MEMORY;
+  tmp->setComponentEnvironment(_compman, -1, this);
+  tmp->setTimeNorm(timeNorm);
+  return tmp;
+}
+
+int cFunctionals::dataProcessorCustomFinalise()
+{
+  int ret = cWinToVecProcessor::dataProcessorCustomFinalise();
+  if (ret) setupThreads();
+  return ret;
+}
+
+// thread 0 (the tick thread) uses the functional objects created in myConfigureInstance,
+// the other threads get their own instances, as the functional objects keep scratch buffers
+void cFunctionals::setupThreads()
+{
+  int i, t;
+  int n = nThreads;
+  if (n == 0) n = (int)std::thread::hardware_concurrency();
+  if (n > getNi()) n = (int)getNi();
+  if (n < 1) n = 1;
+  if (n > 1 && requireSequential) {
+    SMILE_IWRN(2,"the results of the enabled functionals depend on the order of the input rows (e.g. Peaks2.noClearPeakList or posDbgOutp), ignoring nThreads = %i",n);
+    n = 1;
+  }
+  if (n > 1) {
+    // all instances share the threads of one pool (if it could not create all threads, it has less)
+    threadPool = cSmileThreadPool::acquireShared(n);
+    if (n > threadPool->getNthreads()) n = threadPool->getNthreads();
+    if (n <= 1) {
+      cSmileThreadPool::releaseShared();
+      threadPool = NULL;
+      n = 1;
+    }
+  }
+  nThreadData = n;
+  threadData = (sFunctionalsThreadData *)calloc(1, sizeof(sFunctionalsThreadData) * n);
+  if (threadData == NULL) OUT_OF_MEMORY;
+  for (t=0; t<n; t++) {
+    sFunctionalsThreadData *td = threadData + t;
+    if (t == 0) {
+      td->functObj = functObj;
+    } else {
+      td->functObj = (cFunctionalComponent **)calloc(1, sizeof(cFunctionalComponent *) * nFunctionalsEnabled);
+      if (td->functObj == NULL) OUT_OF_MEMORY;
+      for (i=0; i<nFunctionalsEnabled; i++) {
+        if (functObj[i] != NULL) td->functObj[i] = createFunctional(i);
+      }
+    }
+    if (maxRanks > 0) {
+      td->rankBuf = (long *)malloc(sizeof(long) * maxRanks);
+      if (td->rankBuf == NULL) OUT_OF_MEMORY;
+    }
+  }
+  if (n > 1) {
+    SMILE_IMSG(3,"computing the functionals of %ld input elements on %i threads",getNi(),n);
+  }
+}
+
 // We need setupNamesForField if in wholeMatrixMode with ProcessFieldsInMatrixMode
 
 int cFunctionals::setupNamesForElement(int idxi, const char*name, long nEl)
@@ -281,19 +385,34 @@ int cFunctionals::getMultiplier()
   return nFunctValues;
 }
 
-int cFunctionals::doProcessMatrix(int idx, cMatrix *rows, FLOAT_DMEM *y, long nOut)
+int cFunctionals::doProcessMatrix(int idx, const cMatrix *rows, FLOAT_DMEM *y, long nOut)
 {
   // call doProcess for each row...
-  cMatrix *tmpRow = NULL;
-  FLOAT_DMEM *tmpY = (FLOAT_DMEM *)calloc(1, sizeof(FLOAT_DMEM) * nOut);
-  FLOAT_DMEM *curY = tmpY;
   long nFuncts = 0;
   if (rows != NULL) {
-    for (int i = 0; i < rows->N; i++) {
-      tmpRow = rows->getRow(i, tmpRow);
-      long Mu = doProcess(i, tmpRow, curY);
-      curY += Mu;
-      if (nFuncts == 0) nFuncts = Mu;
+    long nBuf = MAX(nOut, rows->N * nFunctValues);
+    if (nBuf > matrixBufSize) {
+      if (matrixBuf != NULL) free(matrixBuf);
+      matrixBuf = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM) * nBuf);
+      if (matrixBuf == NULL) OUT_OF_MEMORY;
+      matrixBufSize = nBuf;
+    }
+    FLOAT_DMEM *tmpY = matrixBuf;
+    if (threadPool != NULL && rows->nT > 0) {
+      processRowsParallel(rows, 0, 0, tmpY);
+      nFuncts = nFunctValues;
+    } else {
+      cMatrix *tmpRow = NULL;
+      FLOAT_DMEM *curY = tmpY;
+      for (int i = 0; i < rows->N; i++) {
+        tmpRow = rows->getRow(i, tmpRow);
+        long Mu = doProcess(i, tmpRow, curY);
+        curY += Mu;
+        if (nFuncts == 0) nFuncts = Mu;
+      }
+      if (tmpRow != NULL) {
+        delete tmpRow;
+      }
     }
     // re-order output vector
     for (int j = 0; j < nFuncts; j++) {
@@ -306,10 +425,6 @@ int cFunctionals::doProcessMatrix(int idx, cMatrix *rows, FLOAT_DMEM *y, long nO
   if (rows->N * nFuncts != nOut) {
     SMILE_IERR(2, "something is wrong in doProcessMatrix in cFunctionals. expected # outputs %i vs. real num outputs %i (%i * %i)", nOut, rows->N * nFuncts, rows->N, nFuncts);
   }
-  free(tmpY);
-  if (tmpRow != NULL) {
-    delete tmpRow;
-  }
   return rows->N * nFuncts;
 }
 
@@ -328,71 +443,246 @@ int cFunctionals::doProcess(int idxi, cMatrix *row, FLOAT_DMEM*y)
   }
   SMILE_IDBG(4, "cFunctionals::doProcess (nT = %ld) idxi %i\n", row->nT, idxi);
 
-  long i; int ok=0; long NN=row->nT;
-  FLOAT_DMEM * unsorted = row->data;
+  processRow(threadData, row->data, row->nT, y);
+  return nFunctValues;
+}
+
+// idxi is index of input element
+// win is the whole input window, which starts at frame vIdx of the input level,
+// the statistics are updated from the state of the previous window of this element
+int cFunctionals::doProcessIncremental(int idxi, const cMatrix *win, long vIdx, FLOAT_DMEM *y)
+{
+  if (win->nT <= 0) {
+    SMILE_IWRN(2,"not processing input row of size <= 0 !");
+    return 0;
+  }
+  allocWinState();
+  processRowIncremental(threadData, idxi, win, vIdx, y);
+  return nFunctValues;
+}
+
+// processes all rows of the window on the thread pool (if nThreads > 1)
+int cFunctionals::doProcessRows(const cMatrix *mat, long vIdx, int incr, FLOAT_DMEM *x)
+{
+  if (threadPool == NULL || mat->nT <= 0) return 0;
+  processRowsParallel(mat, vIdx, incr, x);
+  return 1;
+}
+
+// adds the frames of input element idxi to its state (frameMode = full with option 'incremental')
+int cFunctionals::doProcessStream(int idxi, const cMatrix *frames, long vIdx)
+{
+  if (frames->nT <= 0) return 0;
+  if (streamState == NULL) {
+    streamState = (cFunctionalStreamState **)calloc(1, sizeof(cFunctionalStreamState *) * getNi());
+    if (streamState == NULL) OUT_OF_MEMORY;
+  }
+  if (streamState[idxi] == NULL) {
+    streamState[idxi] = new cFunctionalStreamState(requireStats, (maxRanks > 0) ? sketchError : 0.0);
+  }
+  streamState[idxi]->add(frames->data + idxi, frames->N, frames->nT);
+  return 1;
+}
+
+// computes the functionals of all frames of input element idxi streamed since the last flush
+int cFunctionals::doFlush(int idxi, FLOAT_DMEM *y)
+{
+  if (streamState == NULL || streamState[idxi] == NULL) return 0;
+  cFunctionalStreamState *state = streamState[idxi];
+  long NN = state->getN();
+  if (NN <= 0) return 0;
+  sFunctionalRowStats stats;
+  state->getStats(&stats);
+  processFunctionals(threadData, NULL, NULL, &stats, y, NN);
+  state->clear();
+  return nFunctValues;
+}
+
+void cFunctionals::processRowsParallel(const cMatrix *mat, long vIdx, int incr, FLOAT_DMEM *y)
+{
+  if (incr) allocWinState();
+  // each row writes only to its own part of y (and its own window state), the scratch
+  // buffers and functional objects belong to the thread
+  threadPool->parallelFor(mat->N, [&](int t, long i) {
+    sFunctionalsThreadData *td = threadData + t;
+    FLOAT_DMEM *yi = y + i * nFunctValues;
+    if (incr) {
+      processRowIncremental(td, (int)i, mat, vIdx, yi);
+    } else {
+      long k, NN = mat->nT;
+      allocBuffers(td, NN);
+      const FLOAT_DMEM *df = mat->data + i;
+      for (k=0; k<NN; k++) {
+        td->rowBuf[k] = *df;
+        df += mat->N;
+      }
+      processRow(td, td->rowBuf, NN, yi);
+    }
+  }, nThreadData);
+}
+
+void cFunctionals::processRow(sFunctionalsThreadData *td, FLOAT_DMEM *data, long NN, FLOAT_DMEM *y)
+{
+  long i; long N = NN;
+  FLOAT_DMEM * unsorted = data;
   FLOAT_DMEM * sorted=NULL;
-  
+
+  allocBuffers(td, N);
+
   if (nonZeroFuncts) {
     NN = 0;
-    unsorted = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*row->nT);
+    unsorted = td->nonZeroBuf;
     if (nonZeroFuncts == 2) {
-      for (i=0; i<row->nT; i++) {
-        if (row->data[i] > 0.0) unsorted[NN++] = row->data[i];
+      for (i=0; i<N; i++) {
+        if (data[i] > 0.0) unsorted[NN++] = data[i];
       }
     } else {
-      for (i=0; i<row->nT; i++) {
-        if (row->data[i] != 0.0) unsorted[NN++] = row->data[i];
+      for (i=0; i<N; i++) {
+        if (data[i] != 0.0) unsorted[NN++] = data[i];
       }
     }
   }
 
-  if (requireSorted) {
-    sorted = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*NN);
+  // min, max, mean and the sums required by the enabled functionals are
+  // computed once here in a single pass over the row and shared by all functionals
+  sFunctionalRowStats stats;
+  cFunctionalComponent::computeRowStats(unsorted, NN, requireStats, &stats);
+
+  // functionals which only need a few order statistics (percentiles) select them in a
+  // copy of the row, unless the row is sorted anyway: long rows are cheaper to radix sort
+  if (requireSorted || maxRanks > 0) {
+    sorted = td->sortedBuf;
     memcpy(sorted, unsorted, sizeof(FLOAT_DMEM) * NN);
-    std::sort(sorted, sorted + NN);
-  }
-
-  // find max and min value, also compute arithmetic mean
-  // these 3 values are required by a lot of functionals, so we do it here..
-  FLOAT_DMEM *x=unsorted;
-  FLOAT_DMEM min=*x,max=*x;
-  double mean=*x;
-  FLOAT_DMEM *xE = unsorted+NN;
-  while (++x<xE) {
-    if (*x<min) min=*x;
-    if (*x>max) max=*x;
-    mean += (double)*x;
-  } mean /= (double)NN;
-  
+    if (NN >= FUNCTIONALS_RADIXSORT_MIN) {
+      smileUtil_radixSort_FLOATDMEM(sorted, NN, td->radixBuf);
+    } else if (requireSorted) {
+      std::sort(sorted, sorted + NN);
+    } else {
+      cFunctionalComponent::selectRanks(sorted, NN, td->rankBuf, getSelectRanks(td, NN));
+    }
+  }
+
+  processFunctionals(td, unsorted, sorted, &stats, y, NN);
+}
+
+void cFunctionals::processRowIncremental(sFunctionalsThreadData *td, int idxi, const cMatrix *win,
+    long vIdx, FLOAT_DMEM *y)
+{
+  long i; long NN = win->nT;
+  allocBuffers(td, NN);
+
+  if (winState[idxi] == NULL) {
+    winState[idxi] = new cFunctionalWindowState(frameSizeFrames, requireStats,
+        (requireSorted || maxRanks > 0));
+  }
+  cFunctionalWindowState *state = winState[idxi];
+  state->update(win->data + idxi, win->N, NN, vIdx);
+
+  sFunctionalRowStats stats;
+  state->getStats(&stats);
+
+  // the row is only copied for functionals which need the input values
+  FLOAT_DMEM * unsorted = NULL;
+  if (!allIncremental) {
+    unsorted = td->rowBuf;
+    const FLOAT_DMEM *df = win->data + idxi;
+    for (i=0; i<NN; i++) {
+      unsorted[i] = *df;
+      df += win->N;
+    }
+  }
+
+  // the order statistics are read from the sorted window of the window state
+  FLOAT_DMEM * sorted = NULL;
+  if (requireSorted) {
+    sorted = td->sortedBuf;
+    state->getSorted(sorted);
+  } else if (maxRanks > 0) {
+    sorted = td->sortedBuf;
+    int nRanks = getSelectRanks(td, NN);
+    for (i=0; i<nRanks; i++) {
+      sorted[td->rankBuf[i]] = state->getRank(td->rankBuf[i]);
+    }
+  }
+
+  processFunctionals(td, unsorted, sorted, &stats, y, NN);
+}
+
+void cFunctionals::allocBuffers(sFunctionalsThreadData *td, long N)
+{
+  if (N > td->bufSize) {
+    if (td->rowBuf != NULL) free(td->rowBuf);
+    if (td->sortedBuf != NULL) free(td->sortedBuf);
+    if (td->nonZeroBuf != NULL) free(td->nonZeroBuf);
+    if (td->radixBuf != NULL) free(td->radixBuf);
+    td->rowBuf = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*N);
+    td->sortedBuf = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*N);
+    td->nonZeroBuf = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*N);
+    td->radixBuf = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*N);
+    if (td->rowBuf == NULL || td->sortedBuf == NULL || td->nonZeroBuf == NULL || td->radixBuf == NULL) OUT_OF_MEMORY;
+    td->bufSize = N;
+  }
+}
+
+void cFunctionals::allocWinState()
+{
+  if (winState == NULL) {
+    winState = (cFunctionalWindowState **)calloc(1, sizeof(cFunctionalWindowState *) * getNi());
+    if (winState == NULL) OUT_OF_MEMORY;
+  }
+}
+
+int cFunctionals::getSelectRanks(sFunctionalsThreadData *td, long N)
+{
+  int i, nRanks = 0;
+  for (i=0; i<nFunctionalsEnabled; i++) {
+    if (td->functObj[i] != NULL) {
+      nRanks += td->functObj[i]->getSelectRanks(N, td->rankBuf + nRanks);
+    }
+  }
+  return nRanks;
+}
+
+void cFunctionals::processFunctionals(sFunctionalsThreadData *td, FLOAT_DMEM *unsorted,
+    FLOAT_DMEM *sorted, const sFunctionalRowStats *stats, FLOAT_DMEM *y, long NN)
+{
+  int i;
   FLOAT_DMEM *curY = y;
+  cFunctionalComponent **fo = td->functObj;
   for (i=0; i<nFunctionalsEnabled; i++) {
-    if (functObj[i] != NULL) {
-      functObj[i]->setInputPeriod(getInputPeriod());
+    if (fo[i] != NULL) {
+      fo[i]->setInputPeriod(getInputPeriod());
       int ret;
-      ret = functObj[i]->process( unsorted, sorted, min, max, (FLOAT_DMEM)mean, curY, NN, functN[i] );
+      ret = fo[i]->process( unsorted, sorted, stats, curY, NN, functN[i] );
       if (ret < functN[i]) {
         int j;
         for (j=ret; j<functN[i]; j++) curY[j] = 0.0;
       }
-      if (ret>0) ok++;
   	  curY += functN[i];
     }
   }
-
-  if (requireSorted) {
-    free(sorted);
-  }
-  if (nonZeroFuncts) {
-    free(unsorted);
-  }
-  
-  return nFunctValues;
-
 }
 
 cFunctionals::~cFunctionals()
 {
-  int i;
+  int i, t;
+  if (threadPool != NULL) cSmileThreadPool::releaseShared();
+  if (threadData != NULL) {
+    for (t=0; t<nThreadData; t++) {
+      sFunctionalsThreadData *td = threadData + t;
+      if (t > 0 && td->functObj != NULL) {
+        for (i=0; i<nFunctionalsEnabled; i++)
+          if (td->functObj[i] != NULL) delete(td->functObj[i]);
+        free(td->functObj);
+      }
+      if (td->rowBuf != NULL) free(td->rowBuf);
+      if (td->sortedBuf != NULL) free(td->sortedBuf);
+      if (td->nonZeroBuf != NULL) free(td->nonZeroBuf);
+      if (td->radixBuf != NULL) free(td->radixBuf);
+      if (td->rankBuf != NULL) free(td->rankBuf);
+    }
+    free(threadData);
+  }
   if (functTp != NULL) {
     for (i=0; i<nFunctTpAlloc; i++)
       if (functTp[i] != NULL) free(functTp[i]);
@@ -406,6 +696,17 @@ cFunctionals::~cFunctionals()
       if (functObj[i] != NULL) delete(functObj[i]);
     free(functObj);
   }
+  if (matrixBuf != NULL) free(matrixBuf);
+  if (winState != NULL) {
+    for (i=0; i<getNi(); i++)
+      if (winState[i] != NULL) delete winState[i];
+    free(winState);
+  }
+  if (streamState != NULL) {
+    for (i=0; i<getNi(); i++)
+      if (streamState[i] != NULL) delete streamState[i];
+    free(streamState);
+  }
 }
 
 ////  to implement in a cFunctionalXXXX object:
@@ -61,6 +61,7 @@ class cCommandlineParser {
     int argc;
     const char **argv;
     std::vector<sCmdlineOpt> options;
+    std::vector<sCmdlineOpt> savedOptions;  // option values saved by saveValues()
 
     sCmdlineOpt &addOpt(const char *name, char abbr, const char *description, eCmdlineOptType type, bool argMandatory, bool isMandatory);
     sCmdlineOpt *findOpt(const char *name); // returns pointer to option with the specified name or NULL if not found
@@ -79,6 +80,15 @@ class cCommandlineParser {
     int parse(bool ignoreDuplicates=false, bool ignoreUnknown=true); // return value: 0 on normal parse, -1 if usage was requested with '-h' 
                                                                      // (in this case the application should terminate after parse() has finished)
 
+    // replaces the arguments to parse on the next call of parse(), argv must remain valid as long as the parser is used
+    // (argv[0] is the program name and is not parsed)
+    void setArgs(int argc, const char **argv);
+
+    // saves the current option values, restoreValues() resets all options to the saved values and marks them as not set,
+    // so that a following parse() of new arguments may override them (used for processing multiple inputs in one run)
+    void saveValues();
+    void restoreValues();
+
     bool getBoolean(const char *name) const;
     int getInt(const char *name) const;
     double getDouble(const char *name) const;
@@ -29,6 +29,7 @@
 #include <other/vectorConcat.hpp>
 #include <dspcore/windower.hpp>
 #include <dspcore/framer.hpp>
+#include <dspcore/spectrumFramer.hpp>
 #include <other/vectorOperation.hpp>
 #include <other/vectorBinaryOperation.hpp>
 #include <other/valbasedSelector.hpp>
@@ -122,6 +123,7 @@
 #include <lldcore/intensity.hpp>
 #include <lldcore/melspec.hpp>
 #include <lldcore/mfcc.hpp>
+#include <lldcore/melMfcc.hpp>
 #include <lldcore/plp.hpp>
 #include <lldcore/spectral.hpp>
 #include <lldcore/pitchBase.hpp>
@@ -200,6 +202,7 @@ const registerFunction componentlist[] = {
   cVectorConcat::registerComponent,
   cFramer::registerComponent,
   cWindower::registerComponent,
+  cSpectrumFramer::registerComponent,
   cVectorOperation::registerComponent,
   cVectorBinaryOperation::registerComponent,
   cValbasedSelector::registerComponent,
@@ -308,6 +311,7 @@ const registerFunction componentlist[] = {
   cIntensity::registerComponent,
   cMelspec::registerComponent,
   cMfcc::registerComponent,
+  cMelMfcc::registerComponent,
   cPlp::registerComponent,
   cSpectral::registerComponent,
   cPitchBase::registerComponent,
@@ -12,7 +12,12 @@
 #include <core/smileCommon.hpp>
 #include <core/smileComponent.hpp>
 #include <core/smileThread.hpp>
+#include <core/componentScheduler.hpp>
 #include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
 
 // this is the name of the configuration instance in the config file the component manager will search for:
 #define CM_CONF_INST  "componentInstances"
@@ -35,21 +40,6 @@ extern const registerFunction componentlist[];
 #define MAX_FIN_ITER  4
 
 
-// openSMILE component runner thread status:
-#define THREAD_ACTIVE   0
-#define THREAD_WAIT_A   1
-#define THREAD_WAIT_B   2
-#define THREAD_END      3
-#define THREAD_INACTIVE 4
-
-typedef struct {
-  cComponentManager *obj;
-  long long maxtick;
-  int threadId;
-  int status;
-} sThreadData;
-
-
 class cComponentManager {
 protected:
   int printPlugins;
@@ -93,19 +83,41 @@ public:
   void setEOI() {
     EOI++;
     EOIcondition = 1;
+    wakeupAllComponents();
   }
   void unsetEOI() {
     EOIcondition = 0;
+    wakeupAllComponents();
   }
 
+  // event-driven ticking: wake up all components, i.e. tick every component in the next tick
+  void wakeupAllComponents();
+
+  // grows the full, automatically sized levels of all data memories (dmemAutoSize), returns the number of levels grown
+  int growFullDmLevels();
+
+  // profiling: sample the level statistics of all data memories after a tick, and write the
+  // profiling report (per component and per level statistics) and the trace at the end of processing
+  void sampleDmLevelProfiles();
+  void writeProfilingReport(const char *filename, long long nTicks, double wallTime);
+  void writeProfilingTrace(const char *filename, std::chrono::steady_clock::time_point start);
+
   // check for EOIcondition
   int isEOI() { return EOIcondition; }
+  // query if data memory levels with a single writer should use lock-free ring buffers
+  int getLockFreeLevels() const { return lockFreeLevels; }
+  // query if data memory level buffers should be allocated from one arena (optionally backed by huge pages)
+  int getDmemArena() const { return dmemArena; }
+  int getDmemHugePages() const { return dmemHugePages; }
+  // query if the buffer sizes of data memory ring-buffer levels should be determined automatically
+  int getDmemAutoSize() const { return dmemAutoSize; }
+  // query the FFT engine to use for all FFTs (SMILE_FFT_ENGINE_* in smileFft.hpp)
+  int getFftEngine() const { return fftEngine; }
+  // query if run-time profiling statistics are collected
+  int getProfiling() const { return profiling; }
   // get the EOI counter
   int getEOIcounter() { return EOI; }
 
-  long long tickLoopA(long long maxtick, int threadId, sThreadData *_data);
-  void controlLoopA(void);
-
   long componentOnEmptyTickloop(long long threadId, long long tickNr);
   // call all components to process one time step ('tick')
   // out parameter nRun indicates how many components performed work during this tick,
@@ -115,7 +127,8 @@ public:
   // this function calls tick() until 0 components run successfully, returns total number of ticks
   long long runSingleThreaded(long long maxtick=-1);
 
-  // still a bit todo, basically same as runSingleThreaded with multiple threads, total number of ticks not yet fully supported!!
+  // same as runSingleThreaded, but ticks independent components in parallel on nThreads threads
+  // (or falls back to runSingleThreaded if nThreads == 1), returns total number of ticks
   long long runMultiThreaded(long long maxtick=-1);
 
   int addComponent(const char *_instname, const char *_type, const char *_ci=NULL, int _threadId=-1);  // create + register
@@ -156,8 +169,9 @@ public:
   double getSmileTime();
 
   void resetInstances(void);  // delete all component instances and reset componentManger to state before createInstances
-  void waitForAllThreads(int threadID);
-  void waitForController(int threadID, int stage);
+
+  // find the component that owns the (sub-)component instance _instname (e.g. 'comp' for 'comp.reader')
+  int findOwnerComponentInstance(const char *_instname) const;
 
   /* pause tick loop:
 how=0  :  resume tick loop
@@ -197,6 +211,12 @@ private:
 
   int printLevelStats;
   int profiling;
+  const char *profilingReport, *profilingTrace;  // file names of the profiling report (JSON) and trace (Chrome trace events), or NULL
+  int eventDriven;
+  int lockFreeLevels;
+  int dmemArena, dmemHugePages, dmemAutoSize;
+  int fftEngine;  // SMILE_FFT_ENGINE_*
+  long long nTicksDispatched, nTicksSkipped;  // statistics of event-driven ticking (component ticks called/skipped)
   int printFinalLevelStates;
 
   std::chrono::time_point<std::chrono::steady_clock> startTime;
@@ -233,24 +253,33 @@ private:
   smileCond     dataAvailableCond;
 
   smileMutex    messageMtx;
-  smileMutex    waitEndMtx;
-  smileCond     waitEndCond;
-  smileCond     waitControllerCond;
-  int waitEndCnt;
-
-  // multi thread sync variables:
-  smileMutex    syncCondMtx;
   smileMutex    abortMtx;
-  smileCond     syncCond;
-  smileCond     controlCond;
-  int nWaiting, nProbe, nActive;
-  int runStatus, compRunFlag, probeFlag, controllerPresent; // communication flags between controller thread and component runner threads
-  int *runFlag;
-  int globalRunState;
-  int abortRequest, endOfLoop;
+  int abortRequest;
+
+  // scheduler for multi-threaded ticking (only exists while runMultiThreaded is running)
+  std::unique_ptr<cComponentScheduler> scheduler;
 
   int getNextComponentId();
 
+  // collects the data memory levels each component reads from and writes to (as "dataMemoryName.levelName")
+  void getComponentLevelAccess(std::vector<std::set<std::string>> &rdLevels, std::vector<std::set<std::string>> &wrLevels) const;
+
+  // collects the components each component may send component messages to (see createScheduler)
+  void getComponentMessagePeers(std::vector<std::set<int>> &recipients);
+
+  // automatic level sizing (dmemAutoSize): sets the reader lag of every level from the latencies of the
+  // processing chains (see cDataMemoryLevel::setReaderLag), call before finalising the data memories
+  void setDmLevelReaderLags();
+
+  // creates the scheduler with the dependencies between all components that are ticked
+  void createScheduler(int nWorkers);
+
+  // tells the data memory levels which components to wake up when data is written to or read from them
+  void setupEventDrivenTicking();
+
+  // the tick loop used by runSingleThreaded and runMultiThreaded
+  long long runTickLoop(long long maxtick);
+
   void printExecDebug(int threadId); // prints debug output when the execDebug option is enabled in the config
   
   // Pause the current tick loop (by either sleeping or polling, specified via tickLoopPaused variable) 
@@ -0,0 +1,129 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*
+   dependency-aware scheduler for multi-threaded ticking of components
+
+   The component manager describes the components to tick as tasks of a
+   directed acyclic graph. An edge a->b means that component b may only be
+   ticked after component a has finished its tick. The component manager adds
+   an edge for every pair of components that access a common data memory level
+   where at least one of the two writes to the level, and for every component
+   and the recipients of its component messages, in the order of the
+   component indices. Thus, every level sees exactly the same sequence of
+   read and write operations and every component receives its messages at the
+   same point as in the single-threaded tick loop, which makes the output of
+   multi-threaded processing identical to single-threaded processing.
+
+   Tasks that are ready are executed by a pool of worker threads with one
+   task deque per worker. Workers take tasks from the back of their own deque
+   and steal from the front of the deques of other workers if they run out of
+   work. The thread calling tick() acts as worker 0.
+
+   With event-driven ticking, a task only ticks its component if the component
+   has been woken up (see cSmileComponent::tickIfAwake). The decision is made
+   when the task is executed, i.e. after all its predecessors have finished,
+   exactly as in the single-threaded tick loop.
+ */
+
+
+#ifndef __COMPONENT_SCHEDULER_HPP
+#define __COMPONENT_SCHEDULER_HPP
+
+#include <core/smileCommon.hpp>
+#include <core/smileComponent.hpp>
+#include <core/smileThread.hpp>
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <vector>
+
+class cComponentScheduler;
+
+struct sSchedulerWorker {
+  cComponentScheduler *obj;
+  int id;
+  smileThread thread;
+  smileMutex queueMtx;        // protects queue
+  std::deque<int> queue;      // indices of tasks that are ready to run
+  smileCond wakeCond;         // signaled when new tasks are available for a sleeping worker
+  std::atomic<bool> sleeping;
+};
+
+class cComponentScheduler {
+  private:
+    cSmileLogger *logger;
+    int nWorkers;
+    bool started;
+    bool eventDriven;
+
+    struct sSchedulerTask {
+      cSmileComponent *component;
+      std::vector<int> successors; // tasks depending on this task
+      int nPredecessors;           // number of tasks this task depends on
+      eTickResult result;          // tick result of the current tick
+    };
+    std::vector<sSchedulerTask> tasks;
+    std::unique_ptr<std::atomic<int>[]> pending;  // per task: number of predecessors not finished yet in the current tick
+    std::vector<std::unique_ptr<sSchedulerWorker>> workers;
+
+    std::atomic<int> remaining;   // number of tasks not finished yet in the current tick
+    std::atomic<int> nQueued;     // total number of tasks in all worker queues
+    std::atomic<long> nSkipped;   // number of tasks not ticked in the current tick (event-driven ticking)
+    std::atomic<bool> stopFlag;
+
+    // parameters of the current tick, passed on to cSmileComponent::tick
+    long long curTickNr;
+    int curEOIcondition;
+    long curLastNrun;
+
+    // first exception thrown by a component during the current tick, rethrown by tick()
+    smileMutex errorMtx;
+    std::exception_ptr error;
+    std::atomic<bool> failed;
+
+    void pushTask(int workerId, int task);
+    int popTask(int workerId);
+    int stealTask(int workerId);
+    void executeTask(int workerId, int task);
+    void wakeSleepingWorker();
+
+    // runs tasks in worker 0 (the thread calling tick()) until all tasks of the current tick have finished
+    void runTick();
+
+  public:
+    // nWorkers: total number of threads including the thread calling tick()
+    // eventDriven: only tick components which were woken up (see cSmileComponent::tickIfAwake)
+    cComponentScheduler(cSmileLogger *_logger, int _nWorkers, bool _eventDriven=false);
+
+    // adds a component as a new task and returns the task index
+    int addTask(cSmileComponent *c);
+
+    // adds a dependency: task 'after' must not run before task 'before' has finished
+    void addDependency(int before, int after);
+
+    // starts the worker threads, no more tasks or dependencies may be added afterwards
+    void start();
+
+    // ticks all components once and counts the tick results (see cComponentManager::tick)
+    void tick(long long tickNr, int EOIcondition, long lastNrun, long tickResultCounts[NUM_TICK_RESULTS]);
+
+    // main loop of worker threads 1..nWorkers-1
+    void workerLoop(int workerId);
+
+    int getNworkers() const { return nWorkers; }
+    int getNtasks() const { return (int)tasks.size(); }
+
+    // number of components which were not ticked during the last tick (event-driven ticking)
+    long getLastNskipped() const { return nSkipped.load(); }
+
+    ~cComponentScheduler();
+};
+
+#endif // __COMPONENT_SCHEDULER_HPP
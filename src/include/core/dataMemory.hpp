@@ -34,6 +34,14 @@ class cDataMemory : public cSmileComponent {
     std::vector<sDmLevelRWRequest> rrq;  // read requests of component instances to levels
     std::vector<sDmLevelRWRequest> wrq;  // write requests of component instances to levels
 
+    // contiguous memory block holding the buffers of all levels of fixed size (see cDataMemoryLevel::finaliseLevel)
+    char *arena;
+    size_t arenaSize;
+    bool arenaMapped;   // arena was allocated with mmap (huge pages)
+
+    void allocArena(size_t size, bool hugePages);
+    void freeArena();
+
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
 
@@ -70,6 +78,10 @@ class cDataMemory : public cSmileComponent {
     // get number of levels
     int getNlevels() const { return levels.size(); }
 
+    // get registered read/write requests (used by the component manager to determine dependencies between components)
+    const std::vector<sDmLevelRWRequest> & getReadRequests() const { return rrq; }
+    const std::vector<sDmLevelRWRequest> & getWriteRequests() const { return wrq; }
+
     /**** functions which will be forwarded to the corresponding level *****/
 
     /* check if level is ready for reading, get level config (WITHOUT NAMES!) and update blocksizeReader */
@@ -95,11 +107,14 @@ class cDataMemory : public cSmileComponent {
     /* check if a read will succeed */
     int checkRead(int _level, long vIdx, int special=-1, int rdId=-1, long len=1, int *result=NULL);
 
-    // the memory pointed to by the return value must be freed via delete() by the calling code!!
-    // TODO: optimise this... don't allocate a new frame everytime something is returned!! maybe provide an option
-    //       for passing a buffer frame or so...
-    cVector * getFrame(int _level, long vIdx, int special=-1, int rdId=-1, int *result=NULL);
-    cMatrix * getMatrix(int _level, long vIdx, long vIdxEnd, int special=-1, int rdId=-1, int *result=NULL);
+    // if vec/mat is NULL, the memory pointed to by the return value must be freed via delete() by the calling code!!
+    // otherwise, the data is read into the given object, which is returned (see cDataMemoryLevel::getFrame)
+    cVector * getFrame(int _level, long vIdx, int special=-1, int rdId=-1, int *result=NULL, cVector *vec=NULL);
+    cMatrix * getMatrix(int _level, long vIdx, long vIdxEnd, int special=-1, int rdId=-1, int *result=NULL, cMatrix *mat=NULL);
+
+    // zero-copy reads into a caller-owned view object (see cDataMemoryLevel::getFrameView / getMatrixView)
+    const cVector * getFrameView(int _level, long vIdx, cVector *view, int special=-1, int rdId=-1, int *result=NULL);
+    const cMatrix * getMatrixView(int _level, long vIdx, long vIdxEnd, cMatrix *view, int special=-1, int rdId=-1, int *result=NULL);
 
     // set current read index to current write index to prevent hangs, if the readers do not read data sequentially, or if the readers skip data
     void catchupCurR(int _level, int rdId=-1, long _curR=-1 /* if >= 0, value that curR[rdId] will be set to! */ );
@@ -112,6 +127,7 @@ class cDataMemory : public cSmileComponent {
     long getMaxR(int _level) const;  // maximum readable index (index where data was written to) or -1 if level is empty
     long getMinR(int _level) const;  // minimum readable index or -1 if level is empty (relevant only for ringbuffers, otherwise it will always return -1 or 0)
     long getNreaders(int _level) const;  // number of registered readers
+    long long getFramesWritten(int _level) const;  // number of frames written (profiling only, see sampleLevelProfiles)
 
     int namesAreSet(int _level) const;
     void fixateLevel(int _level);
@@ -125,14 +141,30 @@ class cDataMemory : public cSmileComponent {
  	  void setArrNameOffset(int _level, int arrNameOffset);
     void setFrameSizeSec(int _level, double fss);
     void setBlocksizeWriter(int _level, long _bsw);
+    void setAsyncWriter(int _level);
+    void setReaderLag(int _level, long lag);
+    void setWakeupComponents(int _level, const std::vector<cSmileComponent *> &readers, cSmileComponent *writer);
 
     /* print an overview over registered levels and their configuration */
     void printDmLevelStats(int detail=1);
 
+    // total number of bytes allocated for the level buffers, and the part of it allocated in the arena
+    size_t getBufferSize() const;
+    size_t getArenaSize() const { return arenaSize; }
+
+    // grows all automatically sized levels which are full (see cDataMemoryLevel::growIfFull),
+    // returns the number of levels grown
+    int growFullLevels();
+
+    // profiling: collect the fill level and reader lag statistics of all levels (called after every tick),
+    // and export the statistics of all levels as JSON array
+    void sampleLevelProfiles();
+    rapidjson::Value exportLevelProfiles(rapidjson::MemoryPoolAllocator<> &allocator) const;
+
     long secToVidx(int _level, double sec) const; // returns a vIdx
     double vIdxToSec(int _level, long vIdx) const; // returns a time in seconds as double
     
-    virtual ~cDataMemory() {}
+    virtual ~cDataMemory();
 };
 
 
@@ -155,7 +187,7 @@ Log message fields:
 -DATA
 */
 
-void datamemoryLogger(const char *name, const char*dir, long cnt, long vIdx0, long vIdx, long rIdx, long nT, int special, long curR, long curW, long EOI, int nReaders, long *curRr, cVector *vec);
-void datamemoryLogger(const char *name, long vIdx0, long vIdx, long rIdx, long nT, int special, long curR, long curW, long EOI, int nReaders, long *curRr, cMatrix *mat);
+void datamemoryLogger(const char *name, const char*dir, long cnt, long vIdx0, long vIdx, long rIdx, long nT, int special, long curR, long curW, long EOI, int nReaders, const std::atomic<long> *curRr, cVector *vec);
+void datamemoryLogger(const char *name, long vIdx0, long vIdx, long rIdx, long nT, int special, long curR, long curW, long EOI, int nReaders, const std::atomic<long> *curRr, cMatrix *mat);
 
 #endif // __DATA_MEMORY_HPP
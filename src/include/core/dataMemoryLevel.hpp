@@ -13,9 +13,12 @@
 #include <core/smileComponent.hpp>
 #include <core/smileThread.hpp>
 #include <math.h>
+#include <atomic>
 #include <initializer_list>
+#include <limits>
 #include <memory>
 #include <string>
+#include <vector>
 
 // temporal frame ID
 #define DMEM_IDX_ABS    -1    // no special index
@@ -29,6 +32,17 @@
 
 #define LOOKAHEAD_ALLOC  20
 
+// alignment (in bytes) of level buffers allocated in the data memory arena (cache line size, sufficient for SIMD loads)
+#define DMEM_ARENA_ALIGN  64
+// round a size in bytes up to a multiple of DMEM_ARENA_ALIGN
+#define DMEM_ARENA_ROUND(x)  ((((size_t)(x)) + DMEM_ARENA_ALIGN - 1) & ~((size_t)DMEM_ARENA_ALIGN - 1))
+
+// minimum size (in bytes) of the frame data of one buffer segment of a growable non-ring-buffer level
+#define DMEM_SEGMENT_MIN_SIZE  65536
+
+// number of bins of the level fill histogram collected for profiling (see cDataMemoryLevel::enableProfiling)
+#define DMEM_FILL_HIST_BINS  10
+
 /***** frame field dataType definitions *********/
 
 #define DATATYPE_UNKNOWN                    0
@@ -53,6 +67,14 @@
 #define DATATYPE_MIXED_LLD                  0x1000  // mixed low-level descriptors (e.g. pitch, etc.)
 #define DATATYPE_FUNCTIONALS                0x2000  // functionals of lld, etc.
 
+/**** allocation statistics *********
+   number of heap allocations of data memory objects (data and tmeta arrays of
+   cVector/cMatrix objects, cVectorMeta objects), shown in the profiling summary
+ **************************************/
+
+void dmemCountAllocation();
+long long dmemGetAllocationCount();
+
 /**** field meta information *********
    meta information for one field
  **************************************/
@@ -152,6 +174,18 @@ class TimeMetaInfo { public:
 class cVector {
   protected:
     int tmetaAlien;                      // indicates that tmeta is a pointer to a struct allocated elsewhere
+    int dataAlien;                       // indicates that data points to memory allocated elsewhere (e.g. a view into a data memory level)
+    // own buffers of this object: they are kept (and reused) while data/tmeta point to memory allocated elsewhere
+    // and are only reallocated if a larger size is required, thus a vector or matrix which is reused for reading
+    // frames of constant size does not allocate memory after the first read
+    FLOAT_DMEM *dataOwn;
+    long nDataAlloc;                     // number of elements allocated in dataOwn
+    TimeMetaInfo *tmetaOwn;
+    long nTmetaAlloc;                    // number of structs allocated in tmetaOwn
+
+    // let data/tmeta point to the own buffers, after making sure they can hold (at least) n elements
+    void useOwnData(long n, bool zero=true);
+    void useOwnTimeMeta(long n);
   
   public:
     long N;                              // number of elements
@@ -171,6 +205,15 @@ class cVector {
     void setTimeMeta(TimeMetaInfo *xtmeta);
     void copyTimeMeta(const TimeMetaInfo *xtmeta);
 
+    // let data (and tmeta, if xtmeta is not NULL) point to memory allocated elsewhere, which will not be freed by this object
+    // if xtmeta is NULL, an own tmeta struct will be allocated (if not present) which the caller must fill
+    void borrowData(FLOAT_DMEM *_data, long lN, TimeMetaInfo *xtmeta);
+    // query if data points to memory allocated elsewhere
+    int isBorrowed() const { return dataAlien; }
+    // make sure the vector owns its data and tmeta (1 element) and has lN elements, the data is not initialised!
+    // (reallocates only if the new size exceeds the allocated size)
+    void allocData(long lN);
+
     virtual ~cVector();
 };
 
@@ -212,8 +255,16 @@ public:
   void copyTimeMeta(const TimeMetaInfo *_tmeta, long _nT=-1);
   // convert a matrix tmeta to a vector tmeta spanning the whole matrix by adjusting size, period, etc.
   void squashTimeMeta(double period=-1.0);
-  
-  ~cMatrix();
+  // same as squashTimeMeta, but stores the result in *tm and leaves this matrix unchanged
+  void getSquashedTimeMeta(TimeMetaInfo *tm, double period=-1.0) const;
+
+  // let data (and tmeta, if _tmeta is not NULL) point to lnT frames of lN elements allocated elsewhere
+  // (see cVector::borrowData), if _tmeta is NULL, an own tmeta array of lnT elements is allocated (if required),
+  // unless noTimeMeta is set
+  void borrowData(FLOAT_DMEM *_data, long lN, long lnT, TimeMetaInfo *_tmeta, bool noTimeMeta=false);
+  // make sure the matrix owns its data and tmeta arrays and has the size lN x lnT, the data is not initialised!
+  // (reallocates only if the new size exceeds the allocated size)
+  void allocData(long lN, long lnT);
 };
 
 /******* dataMemory level class ************/
@@ -295,23 +346,112 @@ class cDataMemoryLevel {
 
     /* level buffer and buffer status */
     cMatrix *data;          // level buffer
-    long curW,curR;         // current write pos, current read pos    (min (read) over all readers / max (write))
-    long *curRr;            // current current read pos for each registered reader
+    std::atomic<long> curW,curR;  // current write pos, current read pos    (min (read) over all readers / max (write))
+    std::atomic<long> *curRr;     // current current read pos for each registered reader
+    std::atomic<long> *pinRr;     // lock-free mode: frame index each reader is currently reading from (LONG_MAX: none), one slot per registered reader plus one for unregistered readers
+    std::atomic<long> curWres;    // lock-free mode: write index after the write in progress (== curW if no write is in progress)
     int nReaders;           // number of registered readers (all registered readers will be "waited" for! if you don't want that, don't register your reader)
     long minRAtLastGrowth;  // minimum read index (minR) at the time of the last level growth (only valid for growable ring-buffer levels)
 
-    /* timing information for every frame in the buffer */ /* ISN'T THIS IN *data ?? */
+    /* timing information for every frame in the buffer (data itself has no tmeta) */
     TimeMetaInfo  *tmeta;
+    bool inArena;           // data and tmeta are placed in the arena of the cDataMemory, which frees the memory
+
+    /* segmented storage of growable non-ring-buffer levels (growDyn = 1, isRb = 0):
+       the buffer consists of segments of segT frames, which are appended when the level grows,
+       so existing frames are never copied or moved. data and tmeta are not used for these levels. */
+    std::vector<FLOAT_DMEM *> segData;
+    std::vector<TimeMetaInfo *> segTmeta;
+    long segT;              // number of frames per segment, 0 if the level is stored in data and tmeta
+
+    // pointer to the frame data / time meta information of the frame at rIdx
+    FLOAT_DMEM * frameData(long rIdx) const {
+      if (segT == 0) return data->data + rIdx*lcfg.N;
+      return segData[rIdx / segT] + (rIdx % segT) * lcfg.N;
+    }
+    TimeMetaInfo * frameTmeta(long rIdx) const {
+      if (segT == 0) return tmeta + rIdx;
+      return segTmeta[rIdx / segT] + rIdx % segT;
+    }
+    // number of frames stored contiguously in the level buffer, starting at rIdx
+    long nContiguous(long rIdx) const {
+      if (segT == 0) return lcfg.nT - rIdx;
+      return segT - rIdx % segT;
+    }
+
+    // append segments until the level holds at least newSize frames
+    int addSegments(long newSize);
+    void freeSegments();
+
+    /* profiling statistics (see enableProfiling) */
+    bool profiling;
+    std::atomic<long long> nFramesWritten, nFramesRead;
+    long maxReaderLag;      // maximum number of frames written, but not read yet by the slowest reader
+    long long fillHist[DMEM_FILL_HIST_BINS];  // number of samples by fill level (in steps of nT/DMEM_FILL_HIST_BINS frames)
+
+    void countWrite(long n) { if (profiling) nFramesWritten.fetch_add(n, std::memory_order_relaxed); }
+    void countRead(long n) { if (profiling) nFramesRead.fetch_add(n, std::memory_order_relaxed); }
+
+    /* automatic buffer sizing (see setAutoSize) */
+    bool autoSize;
+    long nTconfig;          // buffer size (frames) requested by the level configuration
+    bool configFinalised;   // finaliseConfig has been called, the buffer size is fixed
+    long readerLag;         // additional frames required by lagging readers (see setReaderLag)
 
     int EOI;
     int EOIcondition;
 
+    /* lock-free single-writer mode (see enableLockFree):
+       the mutexes are not used, the single writer publishes curW with release semantics after writing
+       the data, and each registered reader publishes only its own read index curRr[rdId] after
+       reading the data. curR then only holds a lower bound for all readers' read indices, which is
+       raised by catchupCurR and unregistered readers.
+       Readers may also read frames before their read index (e.g. the history of a window), thus each
+       reader additionally pins the first frame it reads (pinRr) until it has copied the data. The
+       writer announces the end of a write in curWres before checking the pins, and the reader
+       checks curWres after pinning: either the writer sees the pin and does not write, or the
+       reader sees the announced write and does not read the frames it overwrites.
+       Unregistered readers share one pin and are serialized by RWstatMtx. */
+    bool lockFree;
+
+    // the level is written asynchronously to the ticks (see setAsyncWriter)
+    bool asyncWriter;
+
+    /* components to wake up (event-driven ticking) when data was written to this level (the readers)
+       or read from this level (the writer, which might wait for free space) */
+    std::vector<cSmileComponent *> wakeOnWrite;
+    cSmileComponent *wakeOnRead;
+
+    void wakeupReaders() const;
+    void wakeupWriter() const;
+
     /* check current read indicies of all registered readers for this level and update global (minimal) read index curRm
        also update single reader's read index if they have fallen behind the global read index for whatever reason. */
     void checkCurRr();
 
-    /* resize the level to a bigger size (used by growDyn option) */
+    /* lock-free mode: get the read index of reader rdId (or the minimum over all readers, if rdId=-1),
+       i.e. the index before which data may be overwritten by the writer */
+    long getReadIdxLF(int rdId=-1) const;
+
+    /* lock-free mode: publish the new read index of reader rdId (or the global read index, if rdId=-1)
+       after the data has been read */
+    void commitReadIdxLF(int rdId, long newCurR);
+
+    /* lock-free mode: pin frame vIdx for reader rdId before reading it and return the announced write index (curWres),
+       frames before curWres-nT must not be read. *w is updated to the current write index. */
+    long pinFrameLF(int rdId, long vIdx, long *w);
+    void unpinFrameLF(int rdId) { pinRr[pinSlotLF(rdId)].store((std::numeric_limits<long>::max)(), std::memory_order_release); }
+    // index of the pin of reader rdId, unregistered readers share the last pin
+    int pinSlotLF(int rdId) const { return ((rdId >= 0)&&(rdId < nReaders)) ? rdId : nReaders; }
+    // lowest frame index pinned by any reader
+    long getLowestPinLF() const;
+
+    /* resize the level to a bigger size (used by growDyn option),
+       segmented levels are grown by whole segments to at least newSize */
     int growLevel(long newSize);
+
+    // free (arena: destroy) the tmeta array
+    void freeTmeta();
     
     // validate write index and, if applicable, increase curW write counter
     long validateIdxW(long *vIdx, int special=-1);
@@ -327,12 +467,23 @@ class cDataMemoryLevel {
     // TODO: error codes
     long validateIdxRangeR(long actualVidx, long *vIdx, long vIdxEnd, int special=-1, int rdId=-1, int noUpd=0, int *padEnd=NULL);
 
+    // lock-free versions of validateIdxRangeW / validateIdxR / validateIdxRangeR:
+    // the pointers are not updated, instead the new write index (*newCurW) or read index (*newCurR, -1 if
+    // unchanged) is returned, and must be published after the data was written / read
+    long validateIdxRangeWLF(long *vIdx, long vIdxEnd, int special, long *newCurW);
+    long validateIdxRLF(long *vIdx, int special, int rdId, long *newCurR);
+    long validateIdxRangeRLF(long actualVidx, long *vIdx, long vIdxEnd, int special, int rdId, long *newCurR, int *padEnd=NULL);
+
     // write frame data from *_data to level's data matrix at pos rIdx
     void frameWr(long rIdx, const FLOAT_DMEM *_data);
 
     // write frame data from level's data matrix at pos rIdx to *_data
     void frameRd(long rIdx, FLOAT_DMEM *_data) const;
 
+    // copy the frames of a validated matrix read (see validateIdxRangeR) from the level's data matrix to *mat,
+    // including padding at the beginning (vIdxold < 0) and the end (padEnd > 0) of the data
+    void matrixRd(long rIdx, long vIdxold, long vIdx, long vIdxEnd, int special, int padEnd, cMatrix *mat) const;
+
     void setTimeMeta(long rIdx, long vIdx, const TimeMetaInfo *tm);
     void getTimeMeta(long rIdx, long vIdx, TimeMetaInfo *tm) const;
 
@@ -365,6 +516,18 @@ class cDataMemoryLevel {
     // set parent dataMemory object
     void setParent(cDataMemory * __parent) { _parent = __parent; }
 
+    // the writer of this level writes from a thread other than the tick of the writing component
+    // (e.g. an audio callback or the caller of the external source API), see getFrameView / getMatrixView
+    void setAsyncWriter() { asyncWriter = true; }
+    bool hasAsyncWriter() const { return asyncWriter; }
+
+    // set the components to wake up for event-driven ticking when data was written to this level (readers)
+    // or read from this level (writer)
+    void setWakeupComponents(const std::vector<cSmileComponent *> &readers, cSmileComponent *writer) {
+      wakeOnWrite = readers;
+      wakeOnRead = writer;
+    }
+
     // adds a field to this level, _N is the number of elements in an array field, set to 0 or 1 for scalar field
     // arrNameOffset: start index for creating array element names
     int addField(const char *lname, int lN, int arrNameOffset=0);
@@ -385,11 +548,59 @@ class cDataMemoryLevel {
     // allocate config for the readers and initialize it with standard values
     void allocReaders();
 
+    // switch a finalised level with a single writer to lock-free mode (no mutexes, only atomic read
+    // and write indices). This is only possible for ring buffers of fixed size (growDyn=0) which do not
+    // overwrite unread data (noHang != 2), since the writer must never move the readers' indices.
+    // returns 1 if the level is in lock-free mode after the call, 0 otherwise
+    int enableLockFree();
+
+    // query if the level is in lock-free single-writer mode
+    int isLockFree() const { return lockFree; }
+
     // configure level (check buffersize and config)
     int configureLevel();   
 
+    // adjust the buffer size to the reader and writer blocksizes (first step of finaliseLevel),
+    // the size is computed only once, later calls do nothing
+    void finaliseConfig();
+
+    // automatic buffer sizing: instead of the configured size, finaliseConfig sizes ring-buffer levels
+    // to the minimum size required by the reader and writer blocksizes plus the reader lag (see setReaderLag),
+    // call before finaliseLevel.
+    void setAutoSize(bool enable) { autoSize = enable; }
+    int isAutoSized() const { return autoSize; }
+
+    // automatic buffer sizing: number of frames a reader of this level may lag behind the writer in addition to
+    // the blocksizes, because it waits for data from other levels (see cComponentManager::setDmLevelReaderLags)
+    void setReaderLag(long lag) { if (lag > readerLag) readerLag = lag; }
+
+    // automatically sized levels with locks only: doubles the buffer size, if the level has no space left for
+    // the next write of the writer. Lock-free levels are not grown, as they may be written by an asynchronous
+    // writer at any time. Must not be called while components are ticking.
+    // returns 1 if the level was grown, 0 otherwise
+    int growIfFull();
+
+    // profiling: count the frames written to and read from this level, and collect the fill level
+    // and reader lag statistics with sampleProfile (called by the component manager after every tick)
+    void enableProfiling() { profiling = true; }
+    void sampleProfile();
+    long long getFramesWritten() const { return nFramesWritten.load(); }
+    long long getFramesRead() const { return nFramesRead.load(); }
+    long getMaxReaderLag() const { return maxReaderLag; }
+    const long long * getFillHistogram() const { return fillHist; }
+    rapidjson::Value exportProfile(rapidjson::MemoryPoolAllocator<> &allocator) const;
+
+    // number of bytes required for the level buffers (data and tmeta) in an arena, call after finaliseConfig
+    // returns 0 for levels which cannot be placed in an arena (growDyn levels)
+    size_t getArenaSize() const;
+
     // finalize config and allocate data memory
-    int finaliseLevel();   
+    // if arenaMem is not NULL, the buffers are placed in the getArenaSize() bytes at arenaMem (which must be
+    // aligned to DMEM_ARENA_ALIGN bytes and stay valid for the lifetime of the level) instead of the heap
+    int finaliseLevel(char *arenaMem=NULL);
+
+    // number of bytes allocated for the level buffers
+    size_t getBufferSize() const;
 
     // find a field by its full name in a finalised level
     // *arrIdx (if not NULL) will be set to the array index of the requested element, if it is in an array field
@@ -412,8 +623,23 @@ class cDataMemoryLevel {
     // for getFrame, *result (if not NULL) will contain a result code indicating success or reason of failure (left or right buffer margin exceeded, etc.)
     // for getMatrix, *result (if not NULL) will contain a result code indicating success or failure (but not the reason of failure)
     // rdId is the id of the current reader (or -1 for an unregistered or global reader)
-    cVector * getFrame(long vIdx, int special=-1, int rdId=-1, int *result=NULL);  
-    cMatrix * getMatrix(long vIdx, long vIdxEnd, int special=-1, int rdId=-1, int *result=NULL);  
+    // if vec/mat is not NULL, the data is read into this object (which is resized if required) and the object is returned,
+    // otherwise a new object is allocated which must be freed by the caller
+    cVector * getFrame(long vIdx, int special=-1, int rdId=-1, int *result=NULL, cVector *vec=NULL);  
+    cMatrix * getMatrix(long vIdx, long vIdxEnd, int special=-1, int rdId=-1, int *result=NULL, cMatrix *mat=NULL);  
+
+    /* zero-copy versions of getFrame and getMatrix: the caller passes a view object which it owns and reuses for all reads.
+       If the requested frames are stored contiguously in the level buffer, the view will point directly to the data and
+       time meta data in the level buffer (frames are stored with a stride of N elements), otherwise (if the ring buffer wraps
+       around or padding is required) the data is copied to the view's own buffer.
+       Levels with an asynchronous writer (see setAsyncWriter) are always copied, as the writer may overwrite the frames
+       while the view is used.
+       Returns view on success and NULL if the frames cannot be read (same conditions as getFrame / getMatrix).
+       The returned data must not be modified and is only valid until the writer of this level writes again. A component
+       writing in its tick never runs concurrently with the readers of its level (see cComponentScheduler), thus the view
+       is valid until the end of the current tick of the reading component and must not be used after it. */
+    const cVector * getFrameView(long vIdx, cVector *view, int special=-1, int rdId=-1, int *result=NULL);
+    const cMatrix * getMatrixView(long vIdx, long vIdxEnd, cMatrix *view, int special=-1, int rdId=-1, int *result=NULL);
 
     /* check if a read of length "len" at vIdx or "special" will succeed for reader rdId */
     // *result (if not NULL) will contain a result code indicating success or reason of failure (left or right buffer margin exceeded, etc.)
@@ -44,6 +44,9 @@ class cDataReader : public cSmileComponent {
     cVector *V_;
     // temporary matrix...
     cMatrix *m;
+    // views into the data memory for zero-copy reads (see getFrameView / getMatrixView)
+    cVector *vView_;
+    cMatrix *mView_;
 
     /* reader parameters for sequential matrix reading */
     long stepM, lengthM;  /* parameters in frames */
@@ -62,6 +65,12 @@ class cDataReader : public cSmileComponent {
     FrameMetaInfo *myfmeta;
     sDmLevelConfig *myLcfg; //??
 
+    /* common part of getNextMatrix and getNextMatrixView: determines the *length of the next matrix to read,
+       returns 0 if no matrix can be read, 1 if the full input is read, 2 for regular sequential reading */
+    int nextMatrixLength(int readToEnd, long *length);
+    /* updates the read index after a (successful or failed) read of the next matrix */
+    void nextMatrixRead(int mode, long length, const cMatrix *ret);
+
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
 
@@ -93,6 +102,16 @@ class cDataReader : public cSmileComponent {
     cVector * getNextFrame(int privateVec=0, int *result=NULL);
     cMatrix * getNextMatrix(int privateVec=0, int readToEnd=0, int special=-1);  // readToEnd == 1 will read all remaining input, even if stepM was not set to 0 or the current read pointer is no longer at vIdx 0
 
+    // zero-copy versions of getFrame, getMatrix, getNextFrame, getNextMatrix:
+    // the returned object is a read-only view directly into the data memory level if the frames are stored contiguously
+    // in the level buffer (otherwise, and when reading from multiple levels, the data is copied).
+    // The returned object is owned by the reader and is only valid until the next call of the same method
+    // or the end of the current tick of the calling component. It must not be modified or freed!
+    const cVector * getFrameView(long vIdx, int special=-1, int *result=NULL);
+    const cMatrix * getMatrixView(long vIdx, long length, int special=-1);
+    const cVector * getNextFrameView(int *result=NULL);
+    const cMatrix * getNextMatrixView(int readToEnd=0, int special=-1);
+
     void catchupCurR(long _curR=-1); // set curR in dataMemory to curW or to user defined value (for all input levels)
 
     /* set matrix reading parameters in FRAMES */
@@ -196,6 +215,10 @@ class cDataReader : public cSmileComponent {
     const sDmLevelConfig * getConfig() { return myLcfg; }
 
     long getMinR();
+    // maximum index that is readable in all input levels, or -1 if a level is empty
+    // (getMaxR()+1-getCurR() is the number of frames available after the current read index,
+    //  getNAvail() counts from the read index of the level, which for matrix reads is only the start index + 1)
+    long getMaxR();
 
     long getNFree();
     long getNAvail();
@@ -116,6 +116,9 @@ class cDataWriter : public cSmileComponent {
 
     void setFrameSizeSec(double _fss) { dm->setFrameSizeSec(level,_fss); }
     void setBlocksize(long _bsw) { dm->setBlocksizeWriter(level,_bsw); }
+    // data is written from a thread other than the tick of the component (e.g. an audio callback),
+    // readers then do not get views into the level buffer (see cDataMemoryLevel::getFrameView)
+    void setAsyncWriter() { dm->setAsyncWriter(level); }
 
     // number of elements (arrays expaned = frameSize)
     int getLevelN() { return cfg.N; }
@@ -13,8 +13,10 @@
 #include <core/smileThread.hpp>
 #include <core/configManager.hpp>
 #include <smileutil/JsonClasses.hpp>
+#include <atomic>
 #include <chrono>
 #include <string>
+#include <vector>
 
 #define COMPONENT_DESCRIPTION_XXXX  "example description"
 #define COMPONENT_NAME_XXXX         "exampleName"
@@ -298,6 +300,14 @@ constexpr int NUM_TICK_RESULTS = 6;
 // returns string representation of an eTickResult value
 const char *tickResultStr(eTickResult res);
 
+// one tick of a component in which it performed work, recorded for the profiling trace (see cSmileComponent::setProfiling)
+struct sProfileTickEvent {
+  long long tick;      // tick number
+  std::chrono::steady_clock::time_point start;
+  double duration;     // wall time of the tick in seconds
+  int thread;          // index of the thread which ran the tick (see cSmileComponent::getProfileThreadId)
+};
+
 
 class cSmileComponent {
   private:
@@ -317,14 +327,22 @@ class cSmileComponent {
     char *cfname_;  // name of config instance associated with this component instance
 
     // variables used for component profiling
-    int doProfile_, printProfile_;
+    int doProfile_, printProfile_, traceProfile_;
     double profileCur_, profileSum_; // exec. time of last tick, exec time total
-    std::chrono::time_point<std::chrono::high_resolution_clock> startTime_;
-	  std::chrono::time_point<std::chrono::high_resolution_clock> endTime_;
+    double profileCpuStart_, profileCpuSum_;  // thread CPU time at the start of the tick, CPU time total
+    long long profileTicks_[NUM_TICK_RESULTS];  // number of ticks by tick result
+    long long profileSkipped_;  // number of ticks skipped by event-driven ticking
+    std::vector<sProfileTickEvent> profileTrace_;  // ticks in which work was performed (if traceProfile_ is set)
+    std::chrono::time_point<std::chrono::steady_clock> startTime_;
+	  std::chrono::time_point<std::chrono::steady_clock> endTime_;
 
     eTickResult lastTickResult_;  // return value of last call of myTick
     long lastNrun_;   // the number of nRun in the last tick loop iteration
 
+    // event-driven ticking: set if the component might be able to perform work in the next tick
+    std::atomic<bool> awake_;
+    bool alwaysAwake_;  // component cannot be woken up by data memory events (e.g. data sources), it is always ticked
+
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
 
@@ -542,6 +560,9 @@ class cSmileComponent {
     // Gets the smile time from the component manager (time since start of the system).
     double getSmileTime() const;
 
+    // Gets the FFT engine to use for cSmileFft::getPlan from the component manager (cComponentManager.fftEngine).
+    int getFftEngine() const;
+
     // Returns 1 if we are in an end-of-input condition.
     int isEOI() const { 
       return EOIcondition_;
@@ -684,11 +705,45 @@ class cSmileComponent {
     eTickResult getLastTickResult() const {
       return lastTickResult_;
     }
+
+    // Wakes up the component for event-driven ticking, i.e. it will be ticked in the next tick
+    // (or in the current tick if it has not been ticked yet). This is called by the data memory
+    // levels when data was written to an input level or read from an output level of the
+    // component, and by the component manager for component messages and EOI changes.
+    void wakeup() {
+      awake_.store(true, std::memory_order_release);
+    }
+
+    // Marks the component as always awake (e.g. for sources which wait for external data).
+    void setAlwaysAwake(bool alwaysAwake) {
+      alwaysAwake_ = alwaysAwake;
+      if (alwaysAwake) wakeup();
+    }
+
+    // Event-driven version of tick(): ticks the component only if it was woken up since its
+    // last tick. Components which performed work or wait for external data stay awake.
+    // If the component is not ticked, *skipped is set to true and the result of the last tick
+    // is returned (a component which was not woken up cannot behave differently than in its last tick).
+    eTickResult tickIfAwake(long long t, int EOIcond, long _lastNrun, bool *skipped) {
+      if (!awake_.exchange(false, std::memory_order_acq_rel)) {
+        *skipped = true;
+        if (doProfile_) profileSkipped_++;
+        return lastTickResult_;
+      }
+      *skipped = false;
+      eTickResult res = tick(t, EOIcond, _lastNrun);
+      if (alwaysAwake_ || res == TICK_SUCCESS || res == TICK_EXT_SOURCE_NOT_AVAIL || res == TICK_EXT_DEST_NO_SPACE) {
+        wakeup();
+      }
+      return res;
+    }
     
     // Configures profiling (measuring of the time spent in each tick).
-    void setProfiling(int enable=1, int print=0) {
+    // If trace is set, the start time and duration of every tick in which the component performed work is recorded.
+    void setProfiling(int enable=1, int print=0, int trace=0) {
       doProfile_ = enable;
       printProfile_ = print;
+      traceProfile_ = trace;
     }
 
     // Starts time measurement (called at the beginning of the tick).
@@ -709,6 +764,21 @@ class cSmileComponent {
       else return profileSum_;
     }
 
+    // Gets the accumulated CPU time in seconds of the threads running tick() of this component.
+    double getProfileCpuTime() const { return profileCpuSum_; }
+
+    // Gets the number of profiled ticks which returned the tick result res.
+    long long getProfileTickCount(eTickResult res) const { return profileTicks_[res]; }
+
+    // Gets the number of ticks skipped by event-driven ticking while profiling was enabled.
+    long long getProfileSkippedTicks() const { return profileSkipped_; }
+
+    // Gets the ticks recorded for the profiling trace (see setProfiling).
+    const std::vector<sProfileTickEvent> & getProfileTrace() const { return profileTrace_; }
+
+    // Gets a small index (0, 1, ...) identifying the calling thread in profiling traces.
+    static int getProfileThreadId();
+
     // Gets the component instance name.
     const char *getInstName() const {
       return iname_;
@@ -0,0 +1,103 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*
+   pool of worker threads for data-parallel loops within components
+
+   parallelFor(n, func, maxThreads) calls func(threadId, i) for all i = 0..n-1 and
+   returns when all calls have finished. The thread calling parallelFor acts as
+   thread 0, threadId is always smaller than maxThreads. The indices are handed
+   out in blocks from a shared counter, so the assignment of indices to threads
+   differs between runs: func must only write to data owned by index i or by
+   thread threadId to produce deterministic results.
+
+   Components share one process-wide pool (acquireShared, releaseShared), whose
+   size is the largest number of threads requested, so the number of worker
+   threads does not grow with the number of components. Loops started at the same
+   time by different threads are processed together: each worker runs blocks of
+   one loop at a time, and the calling threads work on their own loop.
+ */
+
+
+#ifndef __SMILE_THREAD_POOL_HPP
+#define __SMILE_THREAD_POOL_HPP
+
+#include <core/smileCommon.hpp>
+#include <core/smileLogger.hpp>
+#include <core/smileThread.hpp>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class cSmileThreadPool;
+
+struct sThreadPoolWorker {
+  cSmileThreadPool *obj;
+  int id;
+  smileThread thread;
+  smileCond wakeCond;  // signaled when a new loop starts or the pool is destroyed
+};
+
+// state of one parallelFor call
+struct sThreadPoolLoop {
+  const std::function<void(int, long)> *func;
+  long n, block;
+  int maxThreads;
+  cSmileLogger *logger;    // logger of the calling thread, used by the workers
+  std::atomic<long> next;  // next index to hand out
+  int nActive;             // number of workers running blocks of this loop (guarded by the pool mutex)
+  int finished;            // the calling thread waits for the workers (guarded by the pool mutex)
+  smileCond doneCond;      // signaled by the last worker which leaves a finished loop
+  // first exception thrown by func, rethrown by parallelFor()
+  std::exception_ptr error;
+  std::atomic<bool> failed;
+};
+
+class cSmileThreadPool {
+  private:
+    std::atomic<int> nThreads;
+    smileMutex mtx;  // guards workers, loops and the loop counters nActive and finished
+    std::vector<std::unique_ptr<sThreadPoolWorker>> workers;  // threads 1..nThreads-1
+    std::vector<sThreadPoolLoop *> loops;  // loops which still have indices to hand out
+    std::atomic<bool> stopFlag;
+
+    // processes blocks of indices of a loop until all are handed out
+    void runLoop(sThreadPoolLoop *loop, int threadId);
+    // returns a loop with indices left which may use thread threadId, or NULL
+    sThreadPoolLoop * takeLoop(int threadId);
+    void leaveLoop(sThreadPoolLoop *loop);
+
+  public:
+    // nThreads: total number of threads including the thread calling parallelFor()
+    cSmileThreadPool(int _nThreads);
+
+    // the process-wide pool with at least nThreads threads (0 = one per CPU core), the pool is
+    // created by the first call and grows if later calls request more threads, each call must
+    // be matched by a call of releaseShared()
+    static cSmileThreadPool * acquireShared(int nThreads);
+    // destroys the process-wide pool when it is no longer used
+    static void releaseShared();
+
+    // adds worker threads until the pool has nThreads threads
+    void addThreads(int nThreads);
+
+    // calls func(threadId, i) for i = 0..n-1 on up to maxThreads threads of the pool
+    // (maxThreads <= 0: all threads)
+    void parallelFor(long n, const std::function<void(int threadId, long i)> &func, int maxThreads=0);
+
+    // main loop of the threads 1..nThreads-1
+    void workerLoop(sThreadPoolWorker *w);
+
+    int getNthreads() const { return nThreads.load(); }
+
+    ~cSmileThreadPool();
+};
+
+#endif // __SMILE_THREAD_POOL_HPP
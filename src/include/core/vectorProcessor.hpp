@@ -31,6 +31,7 @@ class cVectorProcessor : public cDataProcessor {
     long *fNi, *fNo;
     long fieldLength_;
     cVector * vecO;
+    cMatrix * matO;   // output frames of batched processing (see tickBatched)
     FLOAT_DMEM *bufTransposeInput_;
     FLOAT_DMEM *bufTransposeOutput_;
     int includeSingleElementFields;
@@ -95,7 +96,7 @@ class cVectorProcessor : public cDataProcessor {
 
     /* cVectorProcessor::myTick calls customVecProcess at the beginning, giving the vector processor a
        chance to access and process the raw vector data.  */
-    virtual int customVecProcess(cVector *vecIn, cVector* vecOut) {
+    virtual int customVecProcess(const cVector *vecIn, cVector* vecOut) {
       if (vecIn == NULL) {
         // do flushing here if no new input
         // ...
@@ -127,6 +128,21 @@ class cVectorProcessor : public cDataProcessor {
        you should also use these functions for components that collect data/statistics over the
        full input, instead of doing incremental processing */
     virtual int flushVector(FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi);
+
+    /* batched processing of several frames with a single call: src holds nFrames input vectors of
+       Nsrc elements each, one after the other, and dst receives nFrames output vectors of Ndst elements.
+       This is only called by tickBatched, and only if the input is processed as a single field (idxi = 0).
+       Return 1 if the frames were processed, 0 if batched processing is not supported (default). */
+    virtual int processVectorBatch(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, long nFrames) {
+      return 0;
+    }
+
+    /* myTick variant for components implementing processVectorBatch: reads all available input frames
+       (up to maxFrames) as one matrix, processes them with one call of processVectorBatch, and writes them
+       with a single matrix write. If blocksizeR > 1, it waits until a full block of frames is available
+       (or the end of input is reached). Falls back to cVectorProcessor::myTick (one frame per tick)
+       if less than 2 frames can be processed or the input has more than one field. */
+    eTickResult tickBatched(long long t, long maxFrames);
     
   public:
     SMILECOMPONENT_STATIC_DECL
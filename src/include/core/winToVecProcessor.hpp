@@ -38,6 +38,13 @@ class cWinToVecProcessor : public cDataProcessor {
     int   fsfGiven;   // flag that indicates whether frameSizeFrame, etc. was specified directly (to override frameSize in seconds)
     int   fstfGiven;   // flag that indicates whether frameStepFrame, etc. was specified directly (to override frameStep in seconds)
     int   noPostEOIprocessing;
+    int   incremental;     // 'incremental' option
+    int   useIncremental;  // incremental processing is enabled and possible with the frame configuration
+    int   useStreaming;    // frameMode = full: the input is passed to doProcessStream as it arrives
+    int   streamStarted;   // frames of the current segment have been passed to doProcessStream
+    int   streamFlushed;   // the streamed input has been flushed at the end of the input
+    TimeMetaInfo streamFirst;  // time meta info of the first frame of the streamed segment
+    double streamEnd;          // end time of the last frame of the streamed segment
     int   nIntervals;  // number of intervals for frameMode = list
     double *ivSec; //interleaved array : start/end in seconds (frameList, frameMode = list)
     long *ivFrames; //interleaved array : start/end in frames (vIdx) (frameList, frameMode = list)
@@ -121,8 +128,26 @@ class cWinToVecProcessor : public cDataProcessor {
     virtual int configureWriter(sDmLevelConfig &c) override;
     virtual int setupNamesForElement(int idxi, const char*name, long nEl);
     //virtual int setupNamesForField(int idxi, const char*name, long nEl) override;
-    virtual int doProcessMatrix(int i, cMatrix *in, FLOAT_DMEM *out, long nOut);
+    virtual int doProcessMatrix(int i, const cMatrix *in, FLOAT_DMEM *out, long nOut);
     virtual int doProcess(int i, cMatrix *row, FLOAT_DMEM*x);
+    // components which can update their results for overlapping windows (frameMode = fixed,
+    // frameStep < frameSize) from the previous window return 1 here and implement
+    // doProcessIncremental, which is then called instead of doProcess if the option 'incremental' is set
+    virtual int supportsIncremental() { return 0; }
+    // processes row i of the window win, which starts at frame vIdx of the input level
+    virtual int doProcessIncremental(int i, const cMatrix *win, long vIdx, FLOAT_DMEM *x);
+    // processes all rows of the window mat (starting at frame vIdx of the input level, incr is 1
+    // if doProcessIncremental would be called for the rows) and writes Mult values per row to x;
+    // returns 1 if the rows were processed, or 0 (default) to call doProcess (doProcessIncremental)
+    // for each row. Components can override this to process the rows in parallel.
+    virtual int doProcessRows(const cMatrix *mat, long vIdx, int incr, FLOAT_DMEM *x) { return 0; }
+    // components which can accumulate their results for the full input (frameMode = full) frame by
+    // frame return 1 here and implement doProcessStream, which is then called with the new frames
+    // of each row as they arrive if the option 'incremental' is set, so the input level does not
+    // need to hold the whole input; the results are returned by doFlush at the end of the input
+    virtual int supportsStreaming() { return 0; }
+    // adds the frames (starting at frame vIdx of the input level) of row i to the results
+    virtual int doProcessStream(int i, const cMatrix *frames, long vIdx) { return 0; }
     virtual int doFlush(int i, FLOAT_DMEM*x);
 
     virtual int processComponentMessage(cComponentMessage *_msg) override;
@@ -20,7 +20,7 @@ simple preemphasis : x(t) = x(t) - k*x(t-1)
 #include <core/dataProcessor.hpp>
 
 #define BUILD_COMPONENT_SmileResample
-#define COMPONENT_DESCRIPTION_CSMILERESAMPLE "This component implements a spectral domain resampling component. Input frames are transferred to the spectral domain, then the spectra are shifted, and a modified DFT is performed to synthesize samples at the new rate."
+#define COMPONENT_DESCRIPTION_CSMILERESAMPLE "This component implements a spectral domain resampling component. Input frames are transferred to the spectral domain, then the spectra are shifted, and a modified DFT is performed to synthesize samples at the new rate. Alternatively (polyphase = 1), the input is resampled in the time domain with a polyphase windowed-sinc FIR filter for a rational resampling ratio L/M (e.g. 160/441 for 44.1 kHz to 16 kHz)."
 #define COMPONENT_NAME_CSMILERESAMPLE "cSmileResample"
 
 
@@ -41,7 +41,22 @@ class cSmileResample : public cDataProcessor {
     sResampleWork *resampleWork;
     long Ni;
 
+    // polyphase FIR resampling
+    int polyphase;
+    int zeroCrossings, maxPhases;
+    double cutoff, kaiserBeta;
+    long firL, firM;        // output rate = input rate * firL / firM
+    long firH;              // half filter length in input samples (filter has 2*firH taps per phase)
+    FLOAT_DMEM *fir;        // firL phases of 2*firH taps each
+    FLOAT_DMEM *pbuf;       // input history, pbufCap frames per channel (channel-major)
+    long pbufCap, pbufStart, pbufN;  // buffer capacity, absolute index of first buffered input frame, number of frames
+    long inIdx, phase;      // next output sample is at input position inIdx + phase/firL
+    long totalIn;           // number of input frames at the end of input (-1 while input is not complete)
+    cMatrix *matout;
+
     int getOutput(FLOAT_DMEM *cur, FLOAT_DMEM *last, long N, FLOAT_DMEM *out, long Nout);
+    void computePolyphaseFilter(double sr);
+    eTickResult polyphaseTick(long long t);
 
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
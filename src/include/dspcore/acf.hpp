@@ -18,7 +18,7 @@ Autocorrelation Function (ACF)
 
 #include <core/smileCommon.hpp>
 #include <core/vectorProcessor.hpp>
-#include <dspcore/fftXg.h>
+#include <dspcore/smileFft.hpp>
 #include <math.h>
 
 #define COMPONENT_DESCRIPTION_CACF "This component computes the autocorrelation function (ACF) by squaring a magnitude spectrum and applying an inverse Fast Fourier Transform. This component must read from a level containing *only* FFT magnitudes in a single field. Use the 'cTransformFFT' and 'cFFTmagphase' components to compute the magnitude spectrum from PCM frames. Computation of the Cepstrum is also supported (this applies a log() function to the magnitude spectra)."
@@ -33,10 +33,9 @@ class cAcf : public cVectorProcessor {
     int expBeforeAbs;
     int cosLifterCepstrum;
     int usePower, cepstrum, inverse;
-    FLOAT_TYPE_FFT **data;
-    FLOAT_TYPE_FFT **w;
+    FLOAT_DMEM **data;
     FLOAT_DMEM **winFunc;
-    int **ip;
+    const cSmileFft *fft;   // shared FFT plan for the current FFT size
 
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
@@ -47,6 +47,11 @@ class cFFTmagphase : public cVectorProcessor {
     
     cFFTmagphase(const char *_name);
 
+    // computes the magnitude spectrum (Nsrc/2+1 bins) from the complex FFT output in src (Nsrc values in rdft format),
+    // normalise, power and dBpsd select the scaling as the options of this component with the same names
+    static void computeMagnitude(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, int normalise, int power,
+        int dBpsd, FLOAT_DMEM dBpnorm, FLOAT_DMEM mindBp);
+
     virtual ~cFFTmagphase();
 };
 
@@ -0,0 +1,109 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*
+   shared FFT engine for real-valued FFTs of power-of-2 sizes
+
+   Plans hold all twiddle tables for one FFT size and engine and are shared
+   by all components (and threads) using that size. They are created on the
+   first call of cSmileFft::getPlan and kept until the program exits.
+
+   Two engines are available, selected by cComponentManager.fftEngine:
+     SMILE_FFT_ENGINE_FFTSG  (default): rdft() of the fftsg library (see
+        fftXg.h), with the tables initialised when the plan is created.
+        The results are identical to those of the per-component fftsg
+        tables used by earlier versions.
+     SMILE_FFT_ENGINE_RADIX4: the SSE radix-4 kernels described below,
+        about twice as fast as fftsg.
+
+   The transform has the same interface and data format as rdft() of the
+   fft4g/fftsg library (see fftXg.h), so it can be used as a drop-in
+   replacement:
+     forward (isgn=1):  a[2k] = R[k] = sum_j x[j]*cos(2*pi*j*k/n),
+                        a[2k+1] = I[k] = sum_j x[j]*sin(2*pi*j*k/n), 0<k<n/2
+                        a[0] = R[0], a[1] = R[n/2]
+     inverse (isgn=-1): input in the above format, output is the inverse
+                        transform scaled by n/2 (the same as rdft)
+
+   Internally, a real FFT of size n is computed as a complex FFT of size n/2
+   on the even/odd samples as real/imaginary parts, followed by a split step.
+   The complex FFT uses Stockham autosort radix-4 stages (and one radix-2
+   stage if log2(n/2) is odd) on separate real/imaginary arrays, using SSE
+   for 4 butterflies at a time where available. rdftBatch transforms several
+   frames together, interleaved so that each SSE lane carries a different
+   frame, which also vectorises the small stages and the split step.
+
+   The results of the radix-4 engine differ from rdft only by float
+   rounding: the maximum absolute error relative to the largest output
+   magnitude is below 1e-6 for the sizes used in the standard configs (64
+   to 4096 points), about the same as the error of rdft itself compared to
+   a DFT computed in double precision. Ill-conditioned features (e.g. LPC
+   coefficients of contours, formant bandwidths, values near zero) can
+   amplify this to differences of several percent, therefore it is not the
+   default.
+ */
+
+
+#ifndef __SMILE_FFT_HPP
+#define __SMILE_FFT_HPP
+
+#include <core/smileCommon.hpp>
+#include <vector>
+
+#define SMILE_FFT_ENGINE_FFTSG   0  // rdft() of the fftsg library (default)
+#define SMILE_FFT_ENGINE_RADIX4  1  // SSE radix-4 kernels
+
+class cSmileFft {
+  private:
+    long N;    // size of the real FFT
+    long M;    // size of the complex FFT (N/2)
+    int engine;  // SMILE_FFT_ENGINE_*
+
+    // bit reversal and cos/sin tables of the fftsg engine, initialised by the constructor,
+    // rdft() only reads them afterwards
+    std::vector<int> ip;
+    std::vector<float> w;
+
+    // twiddle factors of the radix-4 stages (w^p, w^2p and w^3p with w = exp(-2*pi*i/n) for stage size n),
+    // stored as consecutive blocks of M/4 values: w1r, w1i, w2r, w2i, w3r, w3i per stage
+    std::vector<float> stageTw;
+    int nStages4;     // number of radix-4 stages
+    bool radix2;      // one final radix-2 stage
+
+    // twiddle factors of the real split step: cos(2*pi*k/N), sin(2*pi*k/N) for k=0..M/2
+    std::vector<float> splitCos, splitSin;
+
+    cSmileFft(long N, int engine);
+
+    // complex FFT (exp(-i) convention) of zr/zi, using tr/ti as work area,
+    // returns the real part of the result in *outR and the imaginary part in *outI (pointing to z or t)
+    void cfft(float *zr, float *zi, float *tr, float *ti, float **outR, float **outI) const;
+
+  public:
+    // returns the shared plan for real FFTs of size N (power of 2, >= 2) computed by the given engine (SMILE_FFT_ENGINE_*)
+    static const cSmileFft * getPlan(long N, int engine);
+
+    // returns the engine id for an engine name ("fftsg" or "radix4"), or -1 if the name is unknown
+    static int getEngineByName(const char *name);
+
+    long getN() const { return N; }
+    int getEngine() const { return engine; }
+
+    // in-place real FFT of a[0..N-1], see the description at the top of this file for the data format
+    // isgn = 1: forward transform, isgn = -1: inverse transform
+    // this method is thread-safe
+    void rdft(int isgn, float *a) const;
+
+    // in-place real FFTs of nFrames frames, frame i is stored at a[i*stride .. i*stride+N-1]
+    // radix-4 engine with SSE: 4 frames are transformed at a time with one frame per vector lane (for N <= 1024),
+    // the results are identical to calling rdft for each frame
+    // this method is thread-safe
+    void rdftBatch(int isgn, float *a, long stride, long nFrames) const;
+};
+
+#endif // __SMILE_FFT_HPP
@@ -0,0 +1,70 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*  openSMILE component:
+
+fused spectral front-end: framer + per frame pre-emphasis + window function + FFT + magnitude
+(same output as the chain cFramer -> cVectorPreemphasis -> cWindower -> cTransformFFT -> cFFTmagphase)
+
+*/
+
+
+#ifndef __CSPECTRUMFRAMER_HPP
+#define __CSPECTRUMFRAMER_HPP
+
+#include <core/smileCommon.hpp>
+#include <dspcore/framer.hpp>
+#include <dspcore/smileFft.hpp>
+#include <dspcore/windower.hpp>
+
+#define COMPONENT_DESCRIPTION_CSPECTRUMFRAMER "This component creates frames from a single dimensional input stream (like cFramer), applies pre-emphasis per frame (like cVectorPreemphasis) and a window function (like cWindower), and computes the FFT magnitude or power spectrum of each frame (like cTransformFFT followed by cFFTmagphase). The output is identical to the output of this chain of components, but each frame is processed in a single pass without the intermediate data memory levels. Only frameMode = fixed is supported."
+#define COMPONENT_NAME_CSPECTRUMFRAMER "cSpectrumFramer"
+
+class cSpectrumFramer : public cFramer {
+  private:
+    // pre-emphasis
+    FLOAT_DMEM k_;
+    double f_;
+    int preemphasis_, de_;
+    // window function
+    struct sWindowerConfigParsed winConf_;
+    FLOAT_DMEM *win_;       // window function of frameSizeFrames values
+    FLOAT_DMEM winOffset_;
+    // FFT and magnitude
+    int zeroPadSymmetric_;
+    int normalise_, power_, dBpsd_;
+    FLOAT_DMEM dBpnorm_, mindBp_;
+
+    long fftN_;             // FFT size (frame size rounded up to the next power of 2)
+    long nBins_;            // number of output bins per input element (fftN_/2+1)
+    double frameSizeSecOut_;
+    const cSmileFft *fft_;
+    FLOAT_DMEM *frame_;     // work buffer of fftN_ values
+
+  protected:
+    SMILECOMPONENT_STATIC_DECL_PR
+
+    virtual void myFetchConfig() override;
+
+    virtual int getMultiplier() override;
+    virtual int configureWriter(sDmLevelConfig &c) override;
+    virtual int setupNamesForElement(int idxi, const char*name, long nEl) override;
+    virtual int doProcess(int i, cMatrix *row, FLOAT_DMEM*x) override;
+
+  public:
+    SMILECOMPONENT_STATIC_DECL
+
+    cSpectrumFramer(const char *_name);
+
+    virtual ~cSpectrumFramer();
+};
+
+
+
+
+#endif // __CSPECTRUMFRAMER_HPP
@@ -19,7 +19,7 @@ output: complex values of fft or real signal values (for iFFT)
 
 #include <core/smileCommon.hpp>
 #include <core/vectorProcessor.hpp>
-#include <dspcore/fftXg.h>
+#include <dspcore/smileFft.hpp>
 
 #define COMPONENT_DESCRIPTION_CTRANSFORMFFT "This component performs an FFT on a sequence of real values (one frame), the output is the complex domain result of the transform. Use the cFFTmagphase component to compute magnitudes and phases from the complex output."
 #define COMPONENT_NAME_CTRANSFORMFFT "cTransformFFT"
@@ -27,12 +27,14 @@ output: complex values of fft or real signal values (for iFFT)
 class cTransformFFT : public cVectorProcessor {
   private:
     int inverse_;
-    int **ip_;
-    FLOAT_TYPE_FFT **w_;
-    FLOAT_TYPE_FFT **xconv_;
+    const cSmileFft *fft_;   // shared FFT plan for the current frame size
     int newFsSet_;
     double frameSizeSecOut_;
     int zeroPadSymmetric_;
+    long batchFrames_;       // maximum number of frames transformed together in one tick
+
+    // copies (and zero pads) the input frame src to dst, in which the FFT is then computed in place
+    void prepareFrame(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst);
 
     // generate "frequency axis information", i.e. the frequency in Hz for each spectral bin
     // which is to be saved as meta-data in the dataMemory level field (FrameMetaInfo->FieldMetaInfo->info)
@@ -44,11 +46,13 @@ class cTransformFFT : public cVectorProcessor {
     SMILECOMPONENT_STATIC_DECL_PR
 
     virtual void myFetchConfig() override;
-    virtual int myFinaliseInstance() override;
+
+    virtual eTickResult myTick(long long t) override;
 
     virtual int configureWriter(sDmLevelConfig &c) override;
     virtual int setupNamesForField(int i, const char*name, long nEl) override;
     virtual int processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi) override;
+    virtual int processVectorBatch(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, long nFrames) override;
 
 
   public:
@@ -30,6 +30,7 @@ struct sWindowerConfigParsed
   int squareRoot;
   double offset, gain;
   double sigma, alpha, alpha0, alpha1, alpha2, alpha3;
+  double fade, xshift;
   double * win;
   long frameSizeFrames;
 };
@@ -67,6 +68,10 @@ class cWindower : public cVectorProcessor {
     // return the parsed windower config. If this function is called after the component was finalised, the *win variable will point to the precomputed window.
     struct sWindowerConfigParsed * getWindowerConfigParsed();
 
+    // compute the window function of length c->frameSizeFrames described by c (winFunc, squareRoot, fade, gain
+    // and xshift, c->win and c->offset are not used), the returned array must be freed by the caller
+    static double * computeWinFunc(const struct sWindowerConfigParsed *c);
+
     virtual ~cWindower();
 };
 
@@ -41,6 +41,35 @@ a single statistical functional or the like....
 #define NORM_SAMPLES  3
 
 
+// optional quantities in sFunctionalRowStats (see cFunctionalComponent::getRequireStats)
+#define FUNCTSTATS_EXTREMEPOS  1   // minPos, maxPos
+#define FUNCTSTATS_MOMENTS     2   // m2, m3, m4
+#define FUNCTSTATS_TIMESUMS    4   // sumTX, sumT2X, sumTAbsX
+#define FUNCTSTATS_LOGSUM      8   // sumLogAbs
+
+class cFunctionalQuantileSketch;
+
+// statistics of an input row, computed once by cFunctionals and shared by all functionals of the row
+struct sFunctionalRowStats {
+  FLOAT_DMEM min, max;         // minimum and maximum value
+  double mean;                 // arithmetic mean
+  double sumPos, sumNeg;       // sums of the positive and the negative values
+  double sumSqPos, sumSqNeg;   // sums of the squares of the positive and the negative values
+  long nPos, nNeg;             // number of positive and negative values
+  long nNaN;                   // number of NaN values (not included in the sums above; if > 0, the mean
+                               // and the optional sums are NaN, as if all values had been summed)
+  // FUNCTSTATS_EXTREMEPOS:
+  long minPos, maxPos;         // index of the first minimum and maximum
+  // FUNCTSTATS_MOMENTS:
+  double m2, m3, m4;           // sums of the 2nd, 3rd and 4th power of the differences to (FLOAT_DMEM)mean
+  // FUNCTSTATS_TIMESUMS:
+  double sumTX, sumT2X, sumTAbsX;  // sums of t*x, t^2*x and t*|x| (t = 0..N-1)
+  // FUNCTSTATS_LOGSUM:
+  double sumLogAbs;            // sum of log(|x|) over all non-zero values
+  // approximate order statistics of a streamed row (see getSketchError), NULL otherwise
+  const cFunctionalQuantileSketch *sketch;
+};
+
 class cFunctionalComponent : public cSmileComponent {
   private:
     double T;
@@ -84,11 +113,42 @@ class cFunctionalComponent : public cSmileComponent {
       return process(in,inSorted,out,Nin,Nout);
     }
 
+    // inputs: as above, and the statistics of the input row (the optional quantities selected by
+    // getRequireStats are only valid if this functional requested them)
+    virtual long process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted, const sFunctionalRowStats *stats,
+        FLOAT_DMEM *out, long Nin, long Nout)
+    {
+      return process(in,inSorted,stats->min,stats->max,(FLOAT_DMEM)stats->mean,out,Nin,Nout);
+    }
+    // computes the statistics of N values in x, including the optional quantities selected by flags
+    static void computeRowStats(const FLOAT_DMEM *x, long N, int flags, sFunctionalRowStats *stats);
+    // partially orders the N values in x so that x[ranks[i]] equals the value at index ranks[i] of
+    // the sorted array for all nRanks ranks (multiple selection); ranks is sorted in place
+    static void selectRanks(FLOAT_DMEM *x, long N, long *ranks, int nRanks);
+
     virtual void setFieldMetaData(cDataWriter *writer, const FrameMetaInfo *fmeta, int idxi, long nEl);
     virtual long getNoutputValues() { return nEnab; }
     virtual long getNumberOfElements(long j) { return 1; }
     virtual const char* getValueName(long i);
     virtual int getRequireSorted() { return 0; }
+    // functionals which only need some order statistics of the input (instead of getRequireSorted)
+    // return the maximum number of them and the indices in the sorted array for N inputs, these
+    // elements of inSorted are then valid (without sorting the whole row, see selectRanks)
+    virtual int getMaxSelectRanks() { return 0; }
+    virtual int getSelectRanks(long N, long *ranks) { return 0; }
+    // optional quantities of sFunctionalRowStats used by this functional (FUNCTSTATS_XXX flags)
+    virtual int getRequireStats() { return 0; }
+    // 1 if process() only uses the row statistics and the selected order statistics, but not the
+    // input values (in is then NULL), so that cFunctionals can update them incrementally for
+    // overlapping windows (see cWinToVecProcessor option 'incremental')
+    virtual int isIncremental() { return 0; }
+    // 1 if the results for a row depend on the rows processed before by this object (e.g.
+    // compatibility options which keep state), cFunctionals then processes all rows in one thread
+    virtual int getRequireSequential() { return 0; }
+    // rank error of the approximate order statistics accepted by this functional instead of the
+    // selected ranks, 0 if exact order statistics are required; with all functionals accepting
+    // them, cFunctionals can stream the input in frameMode = full (stats->sketch is then set)
+    virtual double getSketchError() { return 0.0; }
 
     virtual ~cFunctionalComponent();
 };
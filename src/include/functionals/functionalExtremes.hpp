@@ -38,9 +38,12 @@ class cFunctionalExtremes : public cFunctionalComponent {
     cFunctionalExtremes(const char *_name);
     // inputs: sorted and unsorted array of values, out: pointer to space in output array, You may not return MORE than Nout elements, please return as return value the number of actually computed elements (usually Nout)
     virtual long process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted, FLOAT_DMEM min, FLOAT_DMEM max, FLOAT_DMEM mean, FLOAT_DMEM *out, long Nin, long Nout) override;
+    virtual long process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted, const sFunctionalRowStats *stats, FLOAT_DMEM *out, long Nin, long Nout) override;
 
     virtual long getNoutputValues() override { return nEnab; }
     virtual int getRequireSorted() override { return 0; }
+    virtual int getRequireStats() override { return FUNCTSTATS_EXTREMEPOS; }
+    virtual int isIncremental() override { return 1; }
 
     virtual ~cFunctionalExtremes();
 };
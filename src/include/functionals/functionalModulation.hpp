@@ -19,6 +19,7 @@ number of segments based on delta thresholding
 #include <core/smileCommon.hpp>
 #include <core/dataMemory.hpp>
 #include <functionals/functionalComponent.hpp>
+#include <dspcore/smileFft.hpp>
 #include <smileutil/smileUtil.h>
 #include <smileutil/smileUtilSpline.h>
 
@@ -27,11 +28,11 @@ number of segments based on delta thresholding
 
 class cSmileUtilWindowedMagnitudeSpectrum {
 private:
-  FLOAT_TYPE_FFT * fftWork_;  // fft work area (size Nfft)
-  int * ip_;
-  FLOAT_TYPE_FFT * w_;
+  FLOAT_DMEM * fftWork_;  // fft work area (size Nfft)
+  const cSmileFft * fft_;  // shared FFT plan for size Nfft
   FLOAT_DMEM * winFunc_;
   int winFuncId_;
+  int fftEngine_;  // FFT engine of the plan (SMILE_FFT_ENGINE_*)
   long Nfft_;  // number of samples to perform FFT on (after zero-padding)
   long Nin_;  // number of inputs (for window function)
 
@@ -47,14 +48,14 @@ protected:
 public:
   cSmileUtilWindowedMagnitudeSpectrum():
     fftWork_(NULL),
-    ip_(NULL), w_(NULL),
-    winFunc_(NULL), winFuncId_(0),
+    fft_(NULL),
+    winFunc_(NULL), winFuncId_(0), fftEngine_(SMILE_FFT_ENGINE_FFTSG),
     Nin_(0), Nfft_(0) {}
 
   long getNin() {
     return Nin_;
   }
-  cSmileUtilWindowedMagnitudeSpectrum(long Nin, int winFuncId);
+  cSmileUtilWindowedMagnitudeSpectrum(long Nin, int winFuncId, int fftEngine);
   ~cSmileUtilWindowedMagnitudeSpectrum();
 
   // T is the period of one input sample
@@ -102,7 +103,8 @@ public:
       long Nout,      // number of modulation spectrum bins
       int winFuncId,  // window function numeric ID (see smileutil)
       double minFreq, double maxFreq, // min/max frequency of modulation spectrum
-      double T        // T is the sample/frame period  (to be able to map FFT bins to frequencies)
+      double T,       // T is the sample/frame period  (to be able to map FFT bins to frequencies)
+      int fftEngine   // FFT engine (SMILE_FFT_ENGINE_*)
       );
   ~cSmileUtilMappedMagnitudeSpectrum();
 
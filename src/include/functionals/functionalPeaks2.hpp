@@ -95,6 +95,7 @@ class cFunctionalPeaks2 : public cFunctionalComponent {
 
     virtual long getNoutputValues() override { return nEnab; }
     virtual int getRequireSorted() override { return 0; }
+    virtual int getRequireSequential() override { return (noClearPeakList == 1) || (posDbgOutp != NULL); }
 
     virtual ~cFunctionalPeaks2();
 };
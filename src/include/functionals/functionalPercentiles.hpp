@@ -19,6 +19,7 @@ functionals: percentiles and quartiles, and inter-percentile/quartile ranges
 #include <core/smileCommon.hpp>
 #include <core/dataMemory.hpp>
 #include <functionals/functionalComponent.hpp>
+#include <functionals/functionalQuantileSketch.hpp>
 
 #define COMPONENT_DESCRIPTION_CFUNCTIONALPERCENTILES "  percentile values and inter-percentile ranges (including quartiles, etc.). This component sorts the input array and then chooses the value at the index closest to p*buffer_len for the p-th percentile (p=0..1)."
 #define COMPONENT_NAME_CFUNCTIONALPERCENTILES "cFunctionalPercentiles"
@@ -31,10 +32,18 @@ class cFunctionalPercentiles : public cFunctionalComponent {
     int *pctlq1, *pctlq2;
     char *tmpstr;
     int quickAlgo, interp;
+    int sketch;
+    double sketchError;
     long varFctIdx;
 
+    // value at index i of the sorted input, read from the sorted array or from the quantile sketch
+    FLOAT_DMEM getSortedValue(const FLOAT_DMEM *sorted, const cFunctionalQuantileSketch *sk, long i) {
+      return (sk != NULL) ? sk->getRank(i) : sorted[i];
+    }
     long getPctlIdx(double p, long N);
-    FLOAT_DMEM getInterpPctl(double p, FLOAT_DMEM *sorted, long N);
+    FLOAT_DMEM getInterpPctl(double p, const FLOAT_DMEM *sorted, const cFunctionalQuantileSketch *sk, long N);
+    int getPctlRanks(double p, long N, long *ranks);
+    long processSorted(const FLOAT_DMEM *sorted, const cFunctionalQuantileSketch *sk, FLOAT_DMEM *out, long Nin);
     
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
@@ -46,10 +55,16 @@ class cFunctionalPercentiles : public cFunctionalComponent {
     cFunctionalPercentiles(const char *name);
     // inputs: sorted and unsorted array of values, out: pointer to space in output array, You may not return MORE than Nout elements, please return as return value the number of actually computed elements (usually Nout)
     virtual long process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted, FLOAT_DMEM *out, long Nin, long Nout) override;
+    // uses the approximate order statistics in stats->sketch if the input is streamed
+    virtual long process(FLOAT_DMEM *in, FLOAT_DMEM *inSorted, const sFunctionalRowStats *stats, FLOAT_DMEM *out, long Nin, long Nout) override;
 
     //virtual long getNoutputValues() override { return nEnab; }
     virtual const char* getValueName(long i) override;
-    virtual int getRequireSorted() override { if (quickAlgo) return 0; else return 1; }
+    virtual int getRequireSorted() override { return 0; }
+    virtual int getMaxSelectRanks() override;
+    virtual int getSelectRanks(long N, long *ranks) override;
+    virtual int isIncremental() override { return 1; }
+    virtual double getSketchError() override { return sketch ? sketchError : 0.0; }
 
     virtual ~cFunctionalPercentiles();
 };
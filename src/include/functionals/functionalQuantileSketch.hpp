@@ -0,0 +1,57 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*  openSMILE component:
+
+KLL quantile sketch (Karnin, Lang, Liberty 2016) of a stream of values with bounded memory,
+used for approximate percentiles of streamed input (see cFunctionalPercentiles option 'sketch')
+
+*/
+
+
+#ifndef __CFUNCTIONALQUANTILESKETCH_HPP
+#define __CFUNCTIONALQUANTILESKETCH_HPP
+
+#include <core/smileCommon.hpp>
+#include <stdint.h>
+#include <vector>
+
+class cFunctionalQuantileSketch {
+  private:
+    int k;      // capacity of the top level
+    long n;     // number of values added
+    long size;  // number of items stored in all levels
+    // compactors[h] holds the items of level h, each of which represents 2^h input values
+    std::vector<std::vector<FLOAT_DMEM>> compactors;
+    uint32_t rng;  // xorshift state for the compaction offsets, seeded identically for all sketches
+    // items of all levels in ascending order with their cumulative weights (see prepare())
+    std::vector<FLOAT_DMEM> sortedItems;
+    std::vector<long> cumWeight;
+
+    long levelCapacity(int h) const;
+    long totalCapacity() const;
+    void compress();
+
+  public:
+    // eps: bound of the rank error as a fraction of the number of values
+    cFunctionalQuantileSketch(double eps);
+
+    // the level capacity k which gives a rank error of about eps
+    static int getK(double eps);
+
+    void add(FLOAT_DMEM x);
+    void clear();
+    long getN() const { return n; }
+
+    // sorts the items, must be called after the last add() and before getRank()
+    void prepare();
+    // approximate value at index r (0..getN()-1) of the sorted input
+    FLOAT_DMEM getRank(long r) const;
+};
+
+#endif // __CFUNCTIONALQUANTILESKETCH_HPP
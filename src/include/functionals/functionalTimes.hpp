@@ -35,6 +35,8 @@ class cFunctionalTimes : public cFunctionalComponent {
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
     virtual void myFetchConfig() override;
+    long getPctlMinIdx(long N);
+    long getPctlMaxIdx(long N);
     FLOAT_DMEM getPctlMin(FLOAT_DMEM *sorted, long N);
     FLOAT_DMEM getPctlMax(FLOAT_DMEM *sorted, long N);
 
@@ -47,11 +49,13 @@ class cFunctionalTimes : public cFunctionalComponent {
 
     //virtual long getNoutputValues() override { return nEnab; }
     virtual const char* getValueName(long i) override;
-    virtual int getRequireSorted() override {
+    virtual int getRequireSorted() override { return 0; }
+    virtual int getMaxSelectRanks() override {
       if (useRobustPercentileRange_)
-        return 1;
+        return 2;
       return 0;
     }
+    virtual int getSelectRanks(long N, long *ranks) override;
 
     virtual ~cFunctionalTimes();
 };
@@ -0,0 +1,128 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*  openSMILE component:
+
+running statistics of one input row over a sliding window of fixed length,
+used by cFunctionals to process overlapping windows incrementally, and of all
+frames of a segment which is streamed through without storing it (frameMode = full)
+
+*/
+
+
+#ifndef __CFUNCTIONALWINDOWSTATE_HPP
+#define __CFUNCTIONALWINDOWSTATE_HPP
+
+#include <core/smileCommon.hpp>
+#include <functionals/functionalComponent.hpp>
+#include <functionals/functionalQuantileSketch.hpp>
+#include <stdint.h>
+
+// running sums of the values of a row from which the quantities of sFunctionalRowStats are derived
+struct sFunctionalRunningSums {
+  double sumPos, sumNeg, sumSqPos, sumSqNeg;
+  long nPos, nNeg;
+  long nNaN;                   // number of NaN values, which are not included in the sums
+  double sumLogAbs;
+  double ref, p1, p2, p3, p4;  // sums of the powers of (x - ref)
+  double sTX, sT2X, sTAbsX;    // time weighted sums
+
+  void clear(double _ref);
+  // adds (sign = 1) or removes (sign = -1) value x at time t, flags: FUNCTSTATS_XXX flags
+  void add(FLOAT_DMEM x, double t, double sign, int flags);
+  // sets all quantities of stats except the extreme values and their positions, which must be
+  // set before, for N values, T0 is the time of the first value
+  void getStats(sFunctionalRowStats *stats, long N, double T0, int flags) const;
+};
+
+class cFunctionalWindowState {
+  private:
+    // unsigned integers with the same order as the FLOAT_DMEM values (total order, also for NaN)
+#if FLOAT_DMEM_NUM == FLOAT_DMEM_FLOAT
+    typedef uint32_t sortKey;
+#else
+    typedef uint64_t sortKey;
+#endif
+
+    long cap;         // window length
+    int flags;        // FUNCTSTATS_XXX flags of the optional quantities to maintain
+    int withRanks;    // maintain the sorted window
+    FLOAT_DMEM *ring; // the value of frame vIdx is stored in ring[vIdx % cap]
+    long start, end;  // vIdx range [start,end) of the current window
+    long startSlot;   // start % cap
+
+    // running sums with t = vIdx - tOrigin, re-computed from the ring when the window has moved
+    // by four times its length
+    sFunctionalRunningSums sums;
+    long tOrigin;
+
+    // monotonic queues (ring buffers of vIdx and value) for the minimum and the maximum
+    long *minQ, *maxQ;
+    FLOAT_DMEM *minV, *maxV;
+    long minHead, minN, maxHead, maxN;
+
+    struct sRankEntry {
+      sortKey key;
+      long vIdx;
+    };
+    // the window values in ascending order, in an update the expired values are dropped and
+    // the sorted new values are merged in a single pass
+    sRankEntry *ranks, *ranksTmp, *ranksAdd;
+
+    static sortKey toKey(FLOAT_DMEM x);
+    static FLOAT_DMEM fromKey(sortKey k);
+    void clear();
+    void resync();
+    void add(long vIdx, long slot, FLOAT_DMEM x);
+    void remove(long vIdx, long slot);
+    void mergeRanks(long nOld, long nAdd);
+
+  public:
+    // cap: window length in frames, flags: FUNCTSTATS_XXX flags, withRanks: 1 to support getRank()
+    cFunctionalWindowState(long cap, int flags, int withRanks);
+
+    // moves the window to the N values at x[0], x[stride], ... which are frames vIdx .. vIdx+N-1,
+    // the frames which are in both windows are not read again (they must not have changed),
+    // the state is rebuilt if the windows do not overlap
+    void update(const FLOAT_DMEM *x, long stride, long N, long vIdx);
+    // statistics of the current window (as computed by cFunctionalComponent::computeRowStats)
+    void getStats(sFunctionalRowStats *stats) const;
+    // value at index r of the sorted window (requires withRanks)
+    FLOAT_DMEM getRank(long r) const { return fromKey(ranks[r].key); }
+    // sorted window (requires withRanks)
+    void getSorted(FLOAT_DMEM *out) const;
+
+    ~cFunctionalWindowState();
+};
+
+class cFunctionalStreamState {
+  private:
+    int flags;        // FUNCTSTATS_XXX flags of the optional quantities to maintain
+    long n;           // number of values added
+    FLOAT_DMEM min, max;
+    long minPos, maxPos;
+    // running sums with t = index of the value, ref = first value
+    sFunctionalRunningSums sums;
+    cFunctionalQuantileSketch *sketch;
+
+  public:
+    // flags: FUNCTSTATS_XXX flags, sketchError: rank error of the quantile sketch (0: no sketch)
+    cFunctionalStreamState(int flags, double sketchError);
+
+    // appends the N values at x[0], x[stride], ...
+    void add(const FLOAT_DMEM *x, long stride, long N);
+    long getN() const { return n; }
+    // statistics of all values added (stats->sketch is set if the sketch is enabled)
+    void getStats(sFunctionalRowStats *stats);
+    // starts a new segment
+    void clear();
+
+    ~cFunctionalStreamState();
+};
+
+#endif // __CFUNCTIONALWINDOWSTATE_HPP
@@ -21,12 +21,29 @@ passes unsorted row data array AND (if required) sorted row data array to functi
 #include <core/smileCommon.hpp>
 #include <core/winToVecProcessor.hpp>
 #include <functionals/functionalComponent.hpp>
+#include <functionals/functionalWindowState.hpp>
+#include <core/smileThreadPool.hpp>
 
 #define BUILD_COMPONENT_Functionals
 #define COMPONENT_DESCRIPTION_CFUNCTIONALS "computes functionals from input frames, this component uses various cFunctionalXXXX sub-components, which implement the actual functionality"
 #define COMPONENT_NAME_CFUNCTIONALS "cFunctionals"
 #define COMPONENT_NAME_CFUNCTIONALS_LENGTH 12
 
+// rows of at least this length are sorted with a radix sort instead of std::sort, also if the
+// functionals only need to select some order statistics
+#define FUNCTIONALS_RADIXSORT_MIN 2048
+
+// functional objects and scratch buffers of one thread (see option nThreads)
+struct sFunctionalsThreadData {
+  cFunctionalComponent **functObj;  // the functional objects used by this thread
+  FLOAT_DMEM *rowBuf;      // copy of the input row
+  FLOAT_DMEM *sortedBuf;   // sorted (or partially ordered) input values
+  FLOAT_DMEM *nonZeroBuf;  // non-zero input values
+  FLOAT_DMEM *radixBuf;    // workspace of the radix sort
+  long bufSize;
+  long *rankBuf;           // indices of the selected order statistics
+};
+
 class cFunctionals : public cWinToVecProcessor {
   private:
     int nFunctTp, nFunctTpAlloc;  // number of cFunctionalXXXX types found
@@ -36,10 +53,42 @@ class cFunctionals : public cWinToVecProcessor {
     int *functN;   // number of output values of each functional object
     cFunctionalComponent **functObj;
     int requireSorted;
+    int requireStats;  // FUNCTSTATS_xxx flags of the row statistics required by the functional objects
+    int maxRanks;      // maximum number of order statistics selected by the functional objects
+    int allIncremental;  // none of the functional objects needs the input values (see isIncremental)
+    int requireSequential;  // a functional object depends on the rows processed before
+    int streamable;      // the full input can be streamed (see supportsStreaming)
+    double sketchError;  // rank error of the quantile sketch of streamed rows (see getSketchError)
     int nonZeroFuncts;
+    int nThreads;  // 'nThreads' option
+    int nThreadData;
+    sFunctionalsThreadData *threadData;  // scratch buffers re-used for all rows, per thread
+    cSmileThreadPool *threadPool;        // the shared pool, NULL if the rows are processed in the tick thread only
+    FLOAT_DMEM *matrixBuf;   // output of all rows in doProcessMatrix
+    long matrixBufSize;
+    cFunctionalWindowState **winState;  // state of each input element for incremental processing
+    cFunctionalStreamState **streamState;  // state of each input element for streamed full input
     const char * functNameAppend;
     int timeNorm;
 
+    cFunctionalComponent * createFunctional(int i);
+    void setupThreads();
+    void allocBuffers(sFunctionalsThreadData *td, long N);
+    void allocWinState();
+    // collects the order statistics required by all functional objects for N inputs in td->rankBuf
+    int getSelectRanks(sFunctionalsThreadData *td, long N);
+    // computes the functionals of the NN values in data (may be modified) / of row idxi of the
+    // window win (incremental processing)
+    void processRow(sFunctionalsThreadData *td, FLOAT_DMEM *data, long NN, FLOAT_DMEM *y);
+    void processRowIncremental(sFunctionalsThreadData *td, int idxi, const cMatrix *win, long vIdx,
+        FLOAT_DMEM *y);
+    // computes the functionals of all rows of mat on the threads of the pool, the nFunctValues
+    // outputs of row i are written to y + i*nFunctValues
+    void processRowsParallel(const cMatrix *mat, long vIdx, int incr, FLOAT_DMEM *y);
+    // calls all functional objects for one row
+    void processFunctionals(sFunctionalsThreadData *td, FLOAT_DMEM *unsorted, FLOAT_DMEM *sorted,
+        const sFunctionalRowStats *stats, FLOAT_DMEM *y, long NN);
+
   protected:
     int nFunctionalsEnabled;
     int nFunctValues;  // size of output vector
@@ -48,6 +97,7 @@ class cFunctionals : public cWinToVecProcessor {
 
 //    virtual void myFetchConfig() override;
     virtual int myConfigureInstance() override;
+    virtual int dataProcessorCustomFinalise() override;
 
     //virtual int myFinaliseInstance() override;
     //virtual eTickResult myTick(long long t) override;
@@ -56,7 +106,15 @@ class cFunctionals : public cWinToVecProcessor {
     //virtual int configureWriter(const sDmLevelConfig *c) override;
     virtual int setupNamesForElement(int idxi, const char*name, long nEl) override;
     virtual int doProcess(int i, cMatrix *row, FLOAT_DMEM*x) override;
-    virtual int doProcessMatrix(int i, cMatrix *in, FLOAT_DMEM *out, long nOut) override;
+    virtual int doProcessMatrix(int i, const cMatrix *in, FLOAT_DMEM *out, long nOut) override;
+    virtual int supportsIncremental() override { return (nonZeroFuncts == 0); }
+    virtual int doProcessIncremental(int i, const cMatrix *win, long vIdx, FLOAT_DMEM *x) override;
+    virtual int doProcessRows(const cMatrix *mat, long vIdx, int incr, FLOAT_DMEM *x) override;
+    // the full input is streamed if no functional needs the stored input values (order statistics
+    // are then approximated with a quantile sketch, if all functionals which need them accept this)
+    virtual int supportsStreaming() override { return streamable; }
+    virtual int doProcessStream(int i, const cMatrix *frames, long vIdx) override;
+    virtual int doFlush(int i, FLOAT_DMEM *x) override;
 
   public:
     SMILECOMPONENT_STATIC_DECL
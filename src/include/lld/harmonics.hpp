@@ -18,6 +18,7 @@ statistics of F0 harmonics
 
 #include <core/smileCommon.hpp>
 #include <core/vectorProcessor.hpp>
+#include <dspcore/smileFft.hpp>
 
 #define BUILD_COMPONENT_Harmonics
 #define COMPONENT_DESCRIPTION_CHARMONICS "This component computes statistics of F0 harmonics. It requires an F0 (Hertz) input field and a linear frequency axis magnitude spectrum as input."
@@ -80,9 +81,8 @@ class cHarmonics : public cVectorProcessor {
 
     FLOAT_DMEM logRelValueFloorUnvoiced_;
     sF0Harmonic *harmonics_;
-    FLOAT_TYPE_FFT *w_;
-    int * ip_;
-    FLOAT_TYPE_FFT *acfdata_;
+    const cSmileFft *fft_;   // shared FFT plan for the acf computation
+    FLOAT_DMEM *acfdata_;
     FLOAT_DMEM *acf_;
 
     bool haveFormantDifference_;
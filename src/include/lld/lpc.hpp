@@ -20,7 +20,7 @@ LPC, compute LPC coefficients from wave data (PCM) frames
 #include <core/smileCommon.hpp>
 #include <core/vectorProcessor.hpp>
 
-#include <dspcore/fftXg.h>
+#include <dspcore/smileFft.hpp>
 
 #define BUILD_COMPONENT_Lpc
 #define COMPONENT_DESCRIPTION_CLPC "This component computes linear predictive coding (LPC) coefficients from PCM frames. Burg's algorithm and the standard ACF/Durbin based method are implemented for LPC coefficient computation. The output of LPC filter coefficients, reflection coefficients, residual signal, and LP spectrum is supported."
@@ -48,10 +48,8 @@ class cLpc : public cVectorProcessor {
     FLOAT_DMEM forwardLPspecFloor;
     FLOAT_DMEM *latB;
     FLOAT_DMEM lastGain;
-    FLOAT_TYPE_FFT *lSpec;
-
-    int *_ip;
-    FLOAT_TYPE_FFT *_w;
+    FLOAT_DMEM *lSpec;
+    const cSmileFft *fft;   // shared FFT plan for the lp spectrum
 
     FLOAT_DMEM *acf;
     FLOAT_DMEM *lpCoeff, *lastLpCoeff, *refCoeff;
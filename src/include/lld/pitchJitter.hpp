@@ -19,6 +19,7 @@ example for dataProcessor descendant
 #include <core/smileCommon.hpp>
 #include <smileutil/smileUtil.h>
 #include <core/dataProcessor.hpp>
+#include <dspcore/smileFft.hpp>
 
 #define BUILD_COMPONENT_PitchJitter
 #define COMPONENT_DESCRIPTION_CPITCHJITTER "This component computes Voice Quality parameters Jitter (pitch period deviations) and Shimmer (pitch period amplitude deviations). It requires the raw PCM frames and the corresponding fundamental frequency (F0) as inputs."
@@ -64,7 +65,19 @@ class cPitchJitter : public cDataProcessor {
 
     FLOAT_DMEM lgHNRfloor;
 
-    double crossCorr(FLOAT_DMEM *x, long Nx, FLOAT_DMEM *y, long Ny);
+    // period cross correlation:
+    int fftCrossCorr_;
+    double *ccBuf_;          // cross correlation for each candidate period length
+    long ccBufN_;
+    double *sumX_, *sumXX_;  // running sums of the wave samples and their squares (sumX_[i] = x[0]+..+x[i-1])
+    long sumN_;
+    const cSmileFft *fft_;
+    FLOAT_DMEM *fftU_, *fftV_;  // FFT work buffers
+    long fftBufN_;
+
+    double crossCorr(const FLOAT_DMEM *x, long Nx, const FLOAT_DMEM *y, long Ny);
+    void computeRunningSums(const FLOAT_DMEM *x, long N);
+    void crossCorrPeriods(const FLOAT_DMEM *x, long start, long T0minF, long T0maxF, double *cc);
     FLOAT_DMEM amplitudeDiff(FLOAT_DMEM *x, long Nx, FLOAT_DMEM *y, long Ny,
         double *maxI0, double *maxI1, FLOAT_DMEM *_A0, FLOAT_DMEM *_A1);
     FLOAT_DMEM rmsAmplitudeDiff(FLOAT_DMEM *x, long Nx, FLOAT_DMEM *y, long Ny,
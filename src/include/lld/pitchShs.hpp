@@ -37,7 +37,17 @@ class cPitchShs : public cPitchBase {
     FLOAT_DMEM compressionFactor;
     double base;
     double lfCut_;
+    long lfCutBin_;
     int shsSpectrumOutput;
+    long batchFrames_;
+
+    // sub-harmonic sampling tables (computed in setupNewNames):
+    long nShs_;              // number of sub-harmonics added to the spectrum (nHarmonics-1)
+    long *shsShift_;         // shift (in bins of the log spectrum) of sub-harmonic h = 2..nHarmonics
+    FLOAT_DMEM *shsWeight_;  // weight (compressionFactor^(h-1)) of sub-harmonic h = 2..nHarmonics
+
+    void subharmonicSummation(const FLOAT_DMEM *in, FLOAT_DMEM *ss, long N);
+    int addPeakCandidate(long i, FLOAT_DMEM *f0cand, FLOAT_DMEM *candScore, long nCandidates, int nCand);
 
     void addNameAppendFieldShs(const char*base, const char*append, int N, int arrNameOffset);
     int cloneInputFieldInfoShs(int sourceFidx, int targetFidx, int force);
@@ -60,6 +70,9 @@ class cPitchShs : public cPitchBase {
     virtual int pitchDetect(FLOAT_DMEM * inData, long N_, double _fsSec, double baseT, FLOAT_DMEM *f0cand, FLOAT_DMEM *candVoice, FLOAT_DMEM *candScore, long nCandidates) override;
     virtual int addCustomOutputs(FLOAT_DMEM *dstCur, long NdstLeft) override;
 
+    virtual int processVectorBatch(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, long nFrames) override;
+    virtual eTickResult myTick(long long t) override;
+
   public:
     SMILECOMPONENT_STATIC_DECL
     
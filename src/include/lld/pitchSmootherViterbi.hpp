@@ -28,27 +28,45 @@ class cSmileViterbi
 private:
   /* Memory: buflen input data (candidates&scores and (from inp: voicingC1, F0raw, voicingClip)) in ring buffer, NOT full matrix type of full input vector)
    *
-   * Memory: n best paths:
-   *   n x buflen matrix
+   * Memory: back-pointers instead of n best paths:
+   *   buflen x n ring of the best predecessor state of each state at each time step
+   *   buflen x n ring of the number of successors of each state on the current best paths (survivor reference counts)
    *   n dim array for current costs
-   * previous paths will always have to be copied at each step: attention! don't overwrite paths still needed by other nodes!? (-> double buffering with 2 matricies?)
+   * the best path into a state is obtained by tracing back the back-pointers, so no paths are copied at each step.
+   * all paths have merged at a time step when only one state at this time step is on any of the current best paths.
    */
   long wrIdx, rdIdx;
   long buflen; /* length of viterbi workspace / input buffer */
+  long lookahead; /* maximum number of frames an undecided frame may lag behind the newest frame (<= buflen-1) */
   int nStates; /* number of pitch candidates and scores supplied in input vector */
+  double beam; /* beam width for pruning of previous states by path cost, 0 = no pruning */
+  int pruning; /* 1 = call pruneTransition() for each transition */
 
   int frameSize;
   FLOAT_DMEM * buf; /* pointer to (2 * nCandidates + 3) x buflen  array of FLOAT_DMEM (inputs) */
   FLOAT_DMEM * prev; /* pointer to last frame for quick referencing */
 
-  int pathBuf; /* index of current path buffer (double buffering) */
   long pathIdx; /* index of current position in path buffer */
   long convIdx; /* index where paths merge, will be -1 for no convergence at all */
-  int * paths[2]; /* pointers to two  nCandidates x buflen matricies to hold best paths */
+  int * backPtr; /* buflen x nStates ring of back-pointers: best predecessor of state s at time n is backPtr[(n%buflen)*nStates+s] */
+  int * refCount; /* buflen x nStates ring: number of states at the next time step with this state as best predecessor */
+  int * nAlive; /* ring of size buflen: number of states at each time step which are on one of the current best paths */
   int * bestPath; /* converged (or forced/flushed) best path */
   double * pathCosts; /* array with current path costs, size: nCandidates */
   double * pathCostsNew; /* workspace array for path cost updates, size: nCandidates */
-  double * pathCostsTemp; /* workspace array for path cost updates, size: nCandidates */
+
+  /* statistics */
+  long nFrames; /* number of frames added */
+  long nDecided; /* number of frames decided (converged, forced or flushed) */
+  long nForced; /* number of forced decisions */
+  long latencySum, latencyMax; /* delay (in frames) between adding a frame and the decision on its state */
+  long long nTransitions; /* number of transition costs evaluated */
+
+  /* trace back the path through state s at time 'from' and decide all undecided frames up to time n <= from */
+  void decidePath(int s, long from, long n);
+
+  /* remove the state s at time n from the current best paths, and its predecessors which are no longer on any path */
+  void releaseState(int s, long n);
 
 protected:
   /***** user definable re-factoring hooks *****/
@@ -63,6 +81,13 @@ protected:
      return 0.0;
    }
 
+   /* return 1 if the transition between state i (current frame) and state j (previous frame) should not be considered,
+    * only called after enablePruning(1) */
+   virtual int pruneTransition(int i, int j, FLOAT_DMEM * previousFrame, FLOAT_DMEM * currentFrame)
+   {
+     return 0;
+   }
+
    virtual FLOAT_DMEM getStateValueFromFrame(int i, FLOAT_DMEM *frame)
    {
      return frame[i];
@@ -71,22 +96,39 @@ protected:
    /*****************************/
 
    int getnStates() { return nStates; }
+   void enablePruning(int enable) { pruning = enable; }
 
 public:
   cSmileViterbi(int _nStates, long _buflen, int _frameSize) :
-    nStates(_nStates), buflen(_buflen), frameSize(_frameSize), wrIdx(0), rdIdx(0), prev(NULL), convIdx(-1)
+    nStates(_nStates), buflen(_buflen), frameSize(_frameSize), wrIdx(0), rdIdx(0), prev(NULL), convIdx(-1),
+    lookahead(_buflen-1), beam(0.0), pruning(0),
+    nFrames(0), nDecided(0), nForced(0), latencySum(0), latencyMax(0), nTransitions(0)
   {
     /* allocate memory for buffer */
     buf = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*(frameSize)*buflen);
-    paths[0] = (int *)malloc(sizeof(int)*nStates*buflen);
-    paths[1] = (int *)malloc(sizeof(int)*nStates*buflen);
-    bestPath = (int *)malloc(sizeof(int)*nStates*buflen);
-    pathIdx = 0; pathBuf = 0;
+    backPtr = (int *)calloc(1,sizeof(int)*nStates*buflen);
+    refCount = (int *)calloc(1,sizeof(int)*nStates*buflen);
+    nAlive = (int *)calloc(1,sizeof(int)*buflen);
+    bestPath = (int *)malloc(sizeof(int)*buflen);
+    pathIdx = 0;
     pathCosts = (double *)calloc(1,sizeof(double)*nStates);
     pathCostsNew = (double *)calloc(1,sizeof(double)*nStates);
-    pathCostsTemp = (double *)calloc(1,sizeof(double)*nStates);
   }
 
+  /* set the maximum lookahead in frames, i.e. the maximum delay between adding a frame and the decision on its state.
+   * If the paths have not merged within this delay, the state on the currently best path is chosen.
+   * 0 (or a value >= buflen) selects the maximum of buflen-1 frames */
+  void setMaxLookahead(long _lookahead) {
+    if (_lookahead <= 0 || _lookahead > buflen-1) lookahead = buflen-1;
+    else lookahead = _lookahead;
+  }
+  long getMaxLookahead() { return lookahead; }
+
+  /* set the beam width: previous states with a path cost greater than the lowest path cost plus the beam width are
+   * not considered as predecessors. 0 disables beam pruning.
+   * The previous state with the lowest path cost is never pruned (neither by the beam nor by pruneTransition()). */
+  void setBeam(double _beam) { beam = _beam; }
+
   /* add a new data frame (size: frameSize), and compute updated path costs and best paths (perform one step of the incremental viterbi algorithm)
    * returns >0 if new output frames are available (return val = number of output frames available)
    * returns 0 if no output frames are available
@@ -114,10 +156,8 @@ public:
     }
 
     /* update best path */
-    for (i=convIdx+1; i<pathIdx; i++) {
-      convIdx++;
-      int x = paths[pathBuf][minState*buflen + (convIdx)%buflen];
-      bestPath[convIdx%buflen] = x;
+    if (pathIdx-1 > convIdx) {
+      decidePath(minState, pathIdx-1, pathIdx-1);
     }
 
     // TODO: put proper value here...
@@ -130,24 +170,29 @@ public:
     convIdx=-1;
     wrIdx=0;
     rdIdx=0;
-    pathBuf = 0;
   }
 
+  /* statistics for debug output */
+  long getNFrames() { return nFrames; }
+  long getNDecided() { return nDecided; }
+  long getNForced() { return nForced; }
+  long getLatencyMax() { return latencyMax; }
+  double getLatencyMean() { return nDecided > 0 ? (double)latencySum / (double)nDecided : 0.0; }
+  double getTransitionsPerFrame() { return nFrames > 0 ? (double)nTransitions / (double)nFrames : 0.0; }
+
   /* return next output value, optionally returns a pointer to the full input frame
    * !this pointer is only valid until the next call to any function in this class!
    *  */
   FLOAT_DMEM getNextOutputFrame(FLOAT_DMEM ** frame, int *avail, int *state);
 
-
-
   ~cSmileViterbi() {
     if (buf != NULL) free(buf);
-    if (paths[0] != NULL) free(paths[0]);
-    if (paths[1] != NULL) free(paths[1]);
+    if (backPtr != NULL) free(backPtr);
+    if (refCount != NULL) free(refCount);
+    if (nAlive != NULL) free(nAlive);
     if (pathCosts != NULL) free(pathCosts);
     if (bestPath != NULL) free(bestPath);
     if (pathCostsNew != NULL) free(pathCostsNew);
-    if (pathCostsTemp != NULL) free(pathCostsTemp);
   }
 
 };
@@ -161,6 +206,7 @@ private:
   FLOAT_DMEM voiceThresh;
   double wLocal, wTvv, wTvvd, wTvuv, wTuu, wThr, wRange;
   double lastChange;
+  double maxJump; /* maximum ratio f1/f0 or f0/f1 of a voiced-voiced transition, 0 = no limit */
 
 protected:
 
@@ -268,6 +314,17 @@ protected:
 
   }
 
+  /* prune voiced-voiced transitions outside of the octave jump band */
+  virtual int pruneTransition(int i, int j, FLOAT_DMEM * previousFrame, FLOAT_DMEM * currentFrame)
+  {
+    if (maxJump > 0.0 && i < getnStates()-1 && j < getnStates()-1) {
+      FLOAT_DMEM f0 = previousFrame[j*2];
+      FLOAT_DMEM f1 = currentFrame[i*2];
+      if (f0 > 0 && f1 > 0 && ((double)f1 > maxJump * (double)f0 || (double)f0 > maxJump * (double)f1)) return 1;
+    }
+    return 0;
+  }
+
   virtual FLOAT_DMEM getStateValueFromFrame(int i, FLOAT_DMEM *frame)
   {
     if (i<getnStates()-1)
@@ -281,10 +338,18 @@ public:
   cSmileViterbiPitchSmooth(int _nCandidates, long _buflen, int _frameSize, FLOAT_DMEM thresh=0.5) :
      cSmileViterbi(_nCandidates+1, _buflen, _frameSize),
      wLocal(2.0), wTvv(20.0), wTvvd(0.0), wTvuv(10.0), wTuu(0.0), wThr(5.0), wRange(5.0),
-     voiceThresh(thresh), lastChange(1.0)
+     voiceThresh(thresh), lastChange(1.0), maxJump(0.0)
    {
    }
 
+   /* set the maximum F0 jump (in octaves) between two voiced frames, transitions with larger jumps are not considered.
+    * 0 disables the pruning. */
+   void setMaxOctaveJump(double octaves) {
+     if (octaves > 0.0) maxJump = pow(2.0, octaves);
+     else maxJump = 0.0;
+     enablePruning(maxJump > 0.0);
+   }
+
    /* set the viterbi pitch and voicing scaling weights. Defaults are:
     * wLocal(2.0), wTvv(20.0), wTvuv(10.0), wTuu(0.0), wThr(5.0)
     */
@@ -325,6 +390,8 @@ class cPitchSmootherViterbi : public cDataProcessor {
     int *F0rawI, *voicingClipI, *voicingC1I;
 
     double wLocal, wTvv, wTvvd, wTvuv, wTuu, wThr, wRange;
+    double maxOctaveJump, beam;
+    long maxLookahead;
 
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
@@ -37,11 +37,15 @@ class cTonefilt : public cDataProcessor {
     FLOAT_DMEM *tmpFrame;
 
     double **corrS, **corrC;
-    double *decayF;
+    double *decayF, *gainF;    // decay coefficient and input gain (1 - decay) of each note
     double *freq;
+    double *rotC, *rotS;       // cos and sin of the phase increment per input sample of each note
+    double *phC, *phS;         // cos and sin of the phase of each note at the current sample
+    double *xBuf;              // input samples of the current block
+    long xBufN;
     long * pos;
 
-    void doFilter(int i, cMatrix *row, FLOAT_DMEM*x);
+    void doFilter(int i, const FLOAT_DMEM *x, long nT, long stride, FLOAT_DMEM *y);
     
   protected:
     SMILECOMPONENT_STATIC_DECL_PR
@@ -0,0 +1,58 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*  openSMILE component:
+
+computes MFCC directly from an FFT magnitude spectrum (cMelspec and cMfcc in one component)
+
+*/
+
+
+#ifndef __CMELMFCC_HPP
+#define __CMELMFCC_HPP
+
+#include <core/smileCommon.hpp>
+#include <lldcore/melspec.hpp>
+#include <lldcore/mfcc.hpp>
+
+#define COMPONENT_DESCRIPTION_CMELMFCC "This component computes Mel-frequency cepstral coefficients (MFCC) directly from an FFT magnitude spectrum. It combines cMelspec and cMfcc: the Mel filterbank (all cMelspec options except 'inverse'), the log, and the DCT with cepstral liftering (the cMfcc options) are applied in one pass over each frame, without the intermediate Mel spectrum level. The output is identical to the output of cMelspec followed by cMfcc. The option 'htkcompatible' applies to both parts (HTK sample scaling of the Mel spectrum, and 0-th coefficient last with melfloor = 1 for the MFCC)."
+#define COMPONENT_NAME_CMELMFCC "cMelMfcc"
+
+class cMelMfcc : public cMelspec {
+  private:
+    int firstMfcc_, lastMfcc_, nMfcc_;
+    FLOAT_DMEM melfloor_;
+    FLOAT_DMEM cepLifter_;
+    int doLog_;
+    FLOAT_DMEM *costable_, *sintable_;   // DCT base functions and liftering weights (see cMfcc::computeDctTables)
+    FLOAT_DMEM *bands_;    // Mel spectra of the frames being processed
+    long bandsN_;          // number of frames bands_ can hold
+    FLOAT_DMEM *work_;     // log Mel spectrum of the current frame
+
+  protected:
+    SMILECOMPONENT_STATIC_DECL_PR
+
+    virtual void myFetchConfig() override;
+
+    virtual void setBandInfo(double *info, long infoSize) override;
+    virtual int setupNamesForField(int i, const char*name, long nEl) override;
+    virtual int processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi) override;
+    virtual int processVectorBatch(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, long nFrames) override;
+
+  public:
+    SMILECOMPONENT_STATIC_DECL
+
+    cMelMfcc(const char *_name);
+
+    virtual ~cMelMfcc();
+};
+
+
+
+
+#endif // __CMELMFCC_HPP
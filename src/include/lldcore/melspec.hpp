@@ -33,17 +33,27 @@ Mel-frequency spectrum
 
 #define TWELFTH_ROOT_OF_2  1.1224620483093729814335330496787
 
+// filterbank as banded sparse matrix (one per field configuration, allocated as a single memory block):
+// band m covers the input bins start[m] .. start[m]+len[m]-1 with the weights w[offset[m] .. offset[m]+len[m]-1].
+// The first nCompl[m] bins of a band contribute x - x*w (the rising slope of the standard Mel filterbank,
+// which is stored as the complement of the falling slope of the previous band), the others x*w.
+struct sMelFilterbank {
+  long nBands;
+  long *start, *nCompl, *len, *offset;
+  FLOAT_DMEM *w;
+};
+
 
 class cMelspec : public cVectorProcessor {
   private:
     int hfcc_;
-    int inverse_;
-    int nBands_;
-    int htkcompatible_;
     int usePower_;
     FLOAT_DMEM **filterCoeffs_;
     FLOAT_DMEM **filterCfs_;
     long **chanMap_;
+    sMelFilterbank **fbank_;
+    long batchFrames_;
+    FLOAT_DMEM *batchBuf_;     // input bins of 4 frames interleaved, for the SSE filterbank
     long bs_;
     FLOAT_DMEM lofreq_, hifreq_;
     long *nLoF_, *nHiF_;
@@ -122,14 +132,29 @@ class cMelspec : public cVectorProcessor {
     }
 
     int computeFilters( long blocksize, double frameSizeSec, int idxc );
+    // converts the filters computed by computeFilters to the sparse representation in fbank_[idxc]
+    void buildSparseFilterbank( long blocksize, int idxc );
     
   protected:
+    int inverse_;
+    int nBands_;
+    int htkcompatible_;
+
     SMILECOMPONENT_STATIC_DECL_PR
 
+    // sets the frequency axis info (centre frequencies of the bands) of the output field, called by computeFilters
+    virtual void setBandInfo(double *info, long infoSize);
+
+    // computes the (forward) band spectrum of one frame src (Nsrc bins) with the filterbank of field configuration idxc
+    void applyFilterbank(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, int idxc);
+    // the same for nFrames frames (stored one after the other), 4 frames at a time with SSE (identical results)
+    void applyFilterbankBatch(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, long nFrames, int idxc);
+    long getBatchFrames() { return batchFrames_; }
+
     virtual void myFetchConfig() override;
     //virtual int myConfigureInstance() override;
     //virtual int myFinaliseInstance() override;
-    //virtual eTickResult myTick(long long t) override;
+    virtual eTickResult myTick(long long t) override;
 
     //virtual int configureWriter(const sDmLevelConfig *c) override;
     virtual int dataProcessorCustomFinalise() override;
@@ -137,6 +162,7 @@ class cMelspec : public cVectorProcessor {
     virtual void configureField(int idxi, long myN, long _nOut) override;
     virtual int setupNamesForField(int i, const char*name, long nEl) override;
     virtual int processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi) override;
+    virtual int processVectorBatch(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, long nFrames) override;
 
   public:
     SMILECOMPONENT_STATIC_DECL
@@ -34,6 +34,8 @@ class cMfcc : public cVectorProcessor {
     FLOAT_DMEM melfloor;
     FLOAT_DMEM cepLifter;
     int doLog_;
+    FLOAT_DMEM *work_;   // log mel spectrum of the current frame
+    long workN_;
     
     int initTables( long blocksize, int idxc );
     
@@ -55,6 +57,16 @@ class cMfcc : public cVectorProcessor {
     
     cMfcc(const char *_name);
 
+    // computes the DCT base functions (nMfcc x blocksize values) and the cepstral liftering weights (nMfcc values)
+    // for the coefficients firstMfcc..lastMfcc of a mel spectrum with blocksize bands
+    static void computeDctTables(FLOAT_DMEM *costable, FLOAT_DMEM *sintable, long blocksize,
+        int firstMfcc, int lastMfcc, FLOAT_DMEM cepLifter);
+    // computes the MFCC firstMfcc..lastMfcc of the mel spectrum src (Nsrc bands) with tables from computeDctTables,
+    // work must hold Nsrc values
+    static void computeMfcc(const FLOAT_DMEM *src, FLOAT_DMEM *dst, FLOAT_DMEM *work, long Nsrc,
+        const FLOAT_DMEM *costable, const FLOAT_DMEM *sintable, int firstMfcc, int lastMfcc,
+        int doLog, FLOAT_DMEM melfloor, int htkcompatible);
+
     virtual ~cMfcc();
 };
 
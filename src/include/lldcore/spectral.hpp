@@ -22,6 +22,22 @@ computes spectral features such as flux, roll-off, centroid, etc.
 #define COMPONENT_DESCRIPTION_CSPECTRAL "This component computes spectral features such as flux, roll-off, centroid, and user defined band energies (rectangular summation of FFT magnitudes), etc."
 #define COMPONENT_NAME_CSPECTRAL "cSpectral"
 
+// tables precomputed from the frequency axis of one input field (see cSpectral::prepareTables)
+struct sSpectralTables {
+  long Nsrc;                  // number of input bins the tables were computed for
+  long *bandIL, *bandIR;      // first and last bin of each band
+  double *bandWL, *bandWR;    // weights of the first and last bin of each band
+  long *slopeIL, *slopeIR;    // first and last bin of each slope band
+  double *slopeWL, *slopeWR;  // weights of the first and last bin of each slope band
+  double *slopeSf, *slopeS2f; // sum of frequencies and squared frequencies of each slope band
+  double *slopeNind;          // number of points (fractional) of each slope band
+  double slopeSfAll, slopeS2fAll; // the same for the spectral slope over the full range
+  double *centroidFrq;        // bin frequencies for centroid and slope (specRangeLowerBin..specRangeUpperBin)
+  double *momentFrq;          // bin frequencies for the moments (specRangeLowerBin..specRangeUpperBin)
+  double *fluxFrq;            // bin frequencies for the flux centroid (specRangeLowerBin..specRangeUpperBin)
+  double *ratioFrq;           // bin frequencies for alpha ratio and hammarberg index (0..Nsrc-1)
+};
+
 class cSpectral : public cVectorProcessor {
   private:
     int frqScale;
@@ -40,10 +56,6 @@ class cSpectral : public cVectorProcessor {
     int maxPos, minPos;
     long *bandsL, *bandsH; // frequencies
     long *slopesL, *slopesH; // frequencies    
-    double *bandsLi, *bandsHi; // indicies (fft bins), real values
-    double *wghtLi, *wghtHi; // indicies (fft bins), real values
-    double *slopeBandsLi, *slopeBandsHi; // indicies (fft bins), real values
-    double *slopeWghtLi, *slopeWghtHi; // indicies (fft bins), real values
     double *rollOff;
     double fsSec;
     const double *frq;
@@ -59,7 +71,15 @@ class cSpectral : public cVectorProcessor {
 
     double *sharpnessWeights;
 
+    // tables of each input field (see prepareTables), and the number of bins the work buffers are allocated for
+    sSpectralTables **fieldTables;
+    long workNsrc;
+    // work buffers for the magnitude, power and log spectrum and the cumulative power spectrum
+    FLOAT_DMEM *specM, *specP, *specL;
+    double *cumP;
+
     void setRequireLorPspec();
+    const sSpectralTables * prepareTables(long Nsrc, int idxi);
     
     int isBandValid(long start, long end)
     {
@@ -68,6 +68,10 @@ void smileUtil_quickSort_FLOATDMEM(FLOAT_DMEM *arr, long nEl);
 /* Reverse the order in an array of elements, i.e. swap first and last element, etc. */
 void smileUtil_reverseOrder_FLOATDMEM(FLOAT_DMEM *arr, long nEl);
 
+/* Radix sort for a FLOAT_DMEM array with nEl elements (ascending order), faster than quicksort
+   for long arrays (> ~2000 elements). workspace: array of nEl elements or NULL */
+void smileUtil_radixSort_FLOATDMEM(FLOAT_DMEM *arr, long nEl, FLOAT_DMEM *workspace);
+
 
 /*******************************************************************************************
  ***********************=====   Filter functions   ===== **************************************
@@ -229,9 +233,17 @@ long smileMath_floorToNextPowOf2(long x);
 /* compute log to base 2 */
 double smileMath_log2(double x);
 
+/* Computes the dot product of two vectors, the products are accumulated in double precision
+ * (uses SSE2 if available) */
+double smileMath_dotProduct(const FLOAT_DMEM * x, const FLOAT_DMEM * y, long N);
+
 /* Computes Pearson cross correlation between two vectors */
 FLOAT_DMEM smileMath_crossCorrelation(const FLOAT_DMEM * x, long Nx, const FLOAT_DMEM * y, long Ny);
 
+/* Computes Pearson cross correlation of two vectors of length N from the sums
+ * xy = sum x*y, sx = sum x, sy = sum y, xx = sum x*x, yy = sum y*y */
+double smileMath_crossCorrelationFromSums(double xy, double sx, double sy, double xx, double yy, long N);
+
 /***** vector math *******/
 
 /* computes cosine distance between two vectors,
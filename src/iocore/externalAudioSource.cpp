@@ -111,6 +111,8 @@ int cExternalAudioSource::configureWriter(sDmLevelConfig &c)
 int cExternalAudioSource::setupNewNames(long nEl)
 {
   writer_->addField(fieldName_, channels_);
+  // writeData is called from the thread of the API caller
+  writer_->setAsyncWriter();
   namesAreSet_ = 1;
   return 1;
 }
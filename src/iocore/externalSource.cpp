@@ -76,6 +76,8 @@ int cExternalSource::setupNewNames(long nEl)
       vectorSize_ += size;
     }
   }
+  // writeData is called from the thread of the API caller
+  writer_->setAsyncWriter();
   namesAreSet_ = 1;
   return vectorSize_;
 }
@@ -74,7 +74,7 @@ cHarmonics::cHarmonics(const char *_name) :
   cVectorProcessor(_name),
   f0ElementName_(NULL), magSpecFieldName_(NULL), idxF0(-1), fsSec(-1.0),
   frq_(NULL), nFrq_(0), harmonics_(NULL),
-  w_(NULL), ip_(NULL), acfdata_(NULL), acf_(NULL), cnt_(0),
+  fft_(NULL), acfdata_(NULL), acf_(NULL), cnt_(0),
   harmonicDifferences_(NULL), haveFormantDifference_(false),
   logRelValueFloorUnvoiced_(-201.0),
   formantAmplitudes_(0)
@@ -597,31 +597,28 @@ int cHarmonics::computeAcf(const FLOAT_DMEM *magSpec, FLOAT_DMEM *acf, long nBin
   }
   // data preparation for inverse fft:
   if (acfdata_ == NULL) {
-    acfdata_ = (FLOAT_TYPE_FFT*)malloc(sizeof(FLOAT_TYPE_FFT)*N);
+    acfdata_ = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*N);
   }
-  if (ip_ == NULL) {
-    ip_ = (int *)calloc(1,sizeof(int)*(N+2));
-  }
-  if (w_ == NULL) {
-    w_ = (FLOAT_TYPE_FFT *)calloc(1,sizeof(FLOAT_TYPE_FFT)*(N*5)/4+2);
+  if (fft_ == NULL || fft_->getN() != N) {
+    fft_ = cSmileFft::getPlan(N, getFftEngine());
   }
   if (squareInput) {
-    acfdata_[0] = (FLOAT_TYPE_FFT)(magSpec[0] * magSpec[0]);
-    acfdata_[1] = (FLOAT_TYPE_FFT)(magSpec[nBins-1] * magSpec[nBins-1]);
+    acfdata_[0] = magSpec[0] * magSpec[0];
+    acfdata_[1] = magSpec[nBins-1] * magSpec[nBins-1];
     for (int i = 2; i < N-1; i += 2) {
-      acfdata_[i] = (FLOAT_TYPE_FFT)(magSpec[i>>1] * magSpec[i>>1]);
+      acfdata_[i] = magSpec[i>>1] * magSpec[i>>1];
       acfdata_[i+1] = 0.0;
     }
   } else {
-    acfdata_[0] = (FLOAT_TYPE_FFT)(magSpec[0]);
-    acfdata_[1] = (FLOAT_TYPE_FFT)(magSpec[nBins-1]);
+    acfdata_[0] = magSpec[0];
+    acfdata_[1] = magSpec[nBins-1];
     for (int i = 2; i < N-1; i += 2) {
-      acfdata_[i] = (FLOAT_TYPE_FFT)(magSpec[i>>1]);
+      acfdata_[i] = magSpec[i>>1];
       acfdata_[i+1] = 0.0;
     }
   }
   // inverse fft
-  rdft(N, -1, acfdata_, ip_, w_);
+  fft_->rdft(-1, acfdata_);
   // data output
   for (int i = 0; (i < N) && (i < nBins); i++) {
     acf[i] = (FLOAT_DMEM)fabs(acfdata_[i]) / (FLOAT_DMEM)nBins;
@@ -1050,12 +1047,6 @@ cHarmonics::~cHarmonics()
   if (harmonics_ != NULL) {
     free(harmonics_);
   }
-  if (w_ != NULL) {
-    free(w_);
-  }
-  if (ip_ != NULL) {
-    free(ip_);
-  }
   if (acfdata_ != NULL) {
     free(acfdata_);
   }
@@ -58,7 +58,7 @@ cLpc::cLpc(const char *_name) :
   saveRefCoeff(0), acf(NULL),
   lpCoeff(NULL), lastLpCoeff(NULL), refCoeff(NULL),
   gbb(NULL), gb2(NULL), gaa(NULL),
-  lSpec(NULL), _ip(NULL), _w(NULL), latB(NULL)
+  lSpec(NULL), fft(NULL), latB(NULL)
 {
 
 }
@@ -106,6 +106,12 @@ void cLpc::myFetchConfig()
   lpSpecDeltaF = getDouble("lpSpecDeltaF");
   SMILE_IDBG(2,"lpSpecDeltaF = %f",lpSpecDeltaF); 
   lpSpecBins = getInt("lpSpecBins");
+  if (lpSpectrum && !smileMath_isPowerOf2(lpSpecBins * 2)) {
+    // the lp spectrum is computed with an fft of size lpSpecBins*2
+    long n = smileMath_ceilToNextPowOf2(lpSpecBins * 2) / 2;
+    SMILE_IWRN(1,"lpSpecBins = %i, but lpSpecBins*2 must be a power of 2, using lpSpecBins = %ld", lpSpecBins, n);
+    lpSpecBins = (int)n;
+  }
   SMILE_IDBG(2,"lpSpecBins = %i",lpSpecBins); 
 
   latB = (FLOAT_DMEM*)calloc(1,sizeof(FLOAT_DMEM)*p);
@@ -230,7 +236,7 @@ int cLpc::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long
     */
      // config parameters: lpSpecDeltaF & lpSpecBins (N or -1 for = nLpc)
     //double fftN = (1.0/T) / lpSpecDeltaF;
-    if (lSpec == NULL) lSpec = (FLOAT_TYPE_FFT*)malloc(sizeof(FLOAT_TYPE_FFT) * lpSpecBins * 2);
+    if (lSpec == NULL) lSpec = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM) * lpSpecBins * 2);
 
     // create padded vector
     for (i=0; i<lpSpecBins*2; i++) {
@@ -238,14 +244,13 @@ int cLpc::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long
     }
     lSpec[0] = 1.0;
     for (i=1; i<=p; i++) {
-      lSpec[i] = (FLOAT_TYPE_FFT)lpCoeff[i-1];
+      lSpec[i] = lpCoeff[i-1];
     }
 
     // transform
-    if (_ip==NULL) _ip = (int *)calloc(1,sizeof(int)*(lpSpecBins*2+2));
-    if (_w==NULL) _w = (FLOAT_TYPE_FFT *)calloc(1,sizeof(FLOAT_TYPE_FFT)*(lpSpecBins*2*5)/4+2);
+    if (fft == NULL) fft = cSmileFft::getPlan(lpSpecBins*2, getFftEngine());
     //perform FFT
-    rdft(lpSpecBins*2, 1, lSpec, _ip, _w);
+    fft->rdft(1, lSpec);
 
     // compute magnitude
     int n=0;
@@ -305,7 +310,5 @@ cLpc::~cLpc()
   if (gbb != NULL) free(gbb);
   if (gb2 != NULL) free(gb2);
   if (gaa != NULL) free(gaa);
-  if (_ip!=NULL) free(_ip);
-  if (_w!=NULL) free(_w);
 }
 
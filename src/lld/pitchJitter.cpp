@@ -45,6 +45,7 @@ if (ct->setField("exWriter", "dataMemory writer for pcm voice excitation signal"
     //ct->setField("F0dmLevel","data memory level to read f0 estimate from","pitch");
     ct->setField("F0field","The name of the field in 'F0reader.dmLevel' containing the F0 estimate (in Hz) (usually F0final or F0raw) - full name, exact match!","F0final");
     ct->setField("searchRangeRel","The relative search range for period deviations (Jitter): maxT0, minT0 = (1.0 +/- searchRangeRel)*T0",0.10);
+    ct->setField("fftCrossCorr", "1 = compute the cross correlation of consecutive periods for all candidate period lengths with an FFT where this needs fewer operations than the direct computation, i.e. for long periods and large search ranges (e.g. sampling rates of 44.1 kHz and above with searchRangeRel >= 0.25). The results differ from the direct computation by the float rounding of the FFT. Has no effect with useBrokenJitterThresh = 1.", 0);
     ct->setField("minNumPeriods", "Minimum number of F0 periods to compute jitter/shimmer over. The frame size must be large enough to hold that number of periods for the extraction to be stable!", 2);
     ct->setField("minCC", "Cross correlation threshold below which the periods will be rejected.", 0.5);
     ct->setField("jitterLocal","1 = enable computation of F0 jitter (period length variations). jitterLocal = the average absolute difference between consecutive periods, divided by the average period length of all periods in the frame",0);
@@ -91,7 +92,9 @@ cPitchJitter::cPitchJitter(const char *_name) :
     Nout(0), lastJitterLocal(0.0), lastJitterDDP(0.0), lastShimmerLocal(0.0),
     lastJitterLocal_b(0.0), lastJitterDDP_b(0.0), lastShimmerLocal_b(0.0),
     filehandle(NULL), threshCC_(0.5), minNumPeriods(2),
-    useBrokenJitterThresh_(1)
+    useBrokenJitterThresh_(1), fftCrossCorr_(0),
+    ccBuf_(NULL), ccBufN_(0), sumX_(NULL), sumXX_(NULL), sumN_(0),
+    fft_(NULL), fftU_(NULL), fftV_(NULL), fftBufN_(0)
 {
   char *tmp = myvprint("%s.F0reader",getInstName());
   F0reader = (cDataReader *)(cDataReader::create(tmp));
@@ -114,6 +117,9 @@ void cPitchJitter::myFetchConfig()
   searchRangeRel = getDouble("searchRangeRel");
   SMILE_IDBG(2,"searchRangeRel = %f",searchRangeRel);
 
+  fftCrossCorr_ = getInt("fftCrossCorr");
+  SMILE_IDBG(2,"fftCrossCorr = %i",fftCrossCorr_);
+
   onlyVoiced = getInt("onlyVoiced");
   SMILE_IDBG(2,"onlyVoiced = %i",onlyVoiced);
 
@@ -337,7 +343,9 @@ int cPitchJitter::myFinaliseInstance()
   return ret;
 }
 
-double cPitchJitter::crossCorr(FLOAT_DMEM * x, long Nx, FLOAT_DMEM * y, long Ny)
+// mean-centred two-pass cross correlation of x and y, used with useBrokenJitterThresh = 1
+// (the threshold is then the smallest cc seen so far, so cc must be reproduced bit-exactly)
+double cPitchJitter::crossCorr(const FLOAT_DMEM * x, long Nx, const FLOAT_DMEM * y, long Ny)
 {
   long N = MIN(Nx,Ny);
   long i;
@@ -353,69 +361,109 @@ double cPitchJitter::crossCorr(FLOAT_DMEM * x, long Nx, FLOAT_DMEM * y, long Ny)
   mx /= (double)N;
   my /= (double)N;
   for (i=0; i<N; i++) {
-/*
-// TODO: low-pass filter in here...
-// x[i] is symm moving avg of +- 5 samples?
-double x_avg = 0.0;
-double x_n = 0;
-double y_avg = 0.0;
-for (int j = 0; j < 6; j++) {
-  if (i - j > 0) {
-    x_avg += x[i - j];
-    y_avg += y[i - j];
-    x_n += 1.0;
-  }
-  if (i + j < N && j != 0) {
-    x_avg += x[i - j];
-    y_avg += y[i - j];
-    x_n += 1.0;
-  }
-}
-if (x_n > 0.0) {
-  x_avg /= x_n;
-  y_avg /= x_n;
-}
-    cc += (x_avg-mx)*(y_avg-my);
-    nx += (x_avg-mx)*(x_avg-mx);
-    ny += (y_avg-my)*(y_avg-my);*/
     cc += (x[i]-mx)*(y[i]-my);
     nx += (x[i]-mx)*(x[i]-mx);
     ny += (y[i]-my)*(y[i]-my);
   }
-  /*
-  FLOAT_DMEM tmpX[4];
-  FLOAT_DMEM tmpY[4];
-  FLOAT_DMEM tmp2[4];
-  int j;
-  for (i=0; i<N; i+=4) {
-    tmpX[0] = x[i+0]-mx;
-    tmpX[1] = x[i+1]-mx;
-    tmpX[2] = x[i+2]-mx;
-    tmpX[3] = x[i+3]-mx;
-    tmpY[0] = y[i+0]-my;
-    tmpY[1] = y[i+1]-my;
-    tmpY[2] = y[i+2]-my;
-    tmpY[3] = y[i+3]-my;
-    tmp2[0] = tmpX[0]*tmpY[0];
-    tmp2[1] = tmpX[1]*tmpY[1];
-    tmp2[2] = tmpX[2]*tmpY[2];
-    tmp2[3] = tmpX[3]*tmpY[3];
-    cc += tmp2[0] + tmp2[1] + tmp2[2] + tmp2[3];
-    tmp2[0] = (x[i+0]-mx) * tmpX[0];
-    tmp2[1] = (x[i+1]-mx) * tmpX[1];
-    tmp2[2] = (x[i+2]-mx) * tmpX[2];
-    tmp2[3] = (x[i+3]-mx) * tmpX[3];
-    nx += tmp2[0] + tmp2[1] + tmp2[2] + tmp2[3];
-    tmp2[0] = (y[i+0]-mx) * tmpY[0];
-    tmp2[1] = (y[i+1]-mx) * tmpY[1];
-    tmp2[2] = (y[i+2]-mx) * tmpY[2];
-    tmp2[3] = (y[i+3]-mx) * tmpY[3];
-    ny += tmp2[0] + tmp2[1] + tmp2[2] + tmp2[3];
-  }*/
   cc /= sqrt(nx)*sqrt(ny);
   return cc;
 }
 
+// computes the running sums of x[0..N-1] and x[0..N-1]^2 used by crossCorrPeriods
+void cPitchJitter::computeRunningSums(const FLOAT_DMEM *x, long N)
+{
+  if (N+1 > sumN_) {
+    sumX_ = (double *)realloc(sumX_, sizeof(double)*(N+1));
+    sumXX_ = (double *)realloc(sumXX_, sizeof(double)*(N+1));
+    if (sumX_ == NULL || sumXX_ == NULL) OUT_OF_MEMORY;
+    sumN_ = N+1;
+  }
+  double s = 0.0, ss = 0.0;
+  sumX_[0] = 0.0; sumXX_[0] = 0.0;
+  for (long i=0; i<N; i++) {
+    s += x[i];
+    ss += (double)x[i] * (double)x[i];
+    sumX_[i+1] = s;
+    sumXX_[i+1] = ss;
+  }
+}
+
+// computes the normalised cross correlation cc[L-T0minF] of the period x[start..start+L-1]
+// with the following period x[start+L..start+2L-1], for all period lengths L = T0minF..T0maxF
+// (computeRunningSums must have been called for x before)
+// The means and energies of the periods are taken from the running sums. The products of the two
+// periods are either summed directly, or, with fftCrossCorr = 1, the sums over the first T0minF
+// samples of all periods are computed at once as the cross correlation of x[start..start+T0minF-1]
+// with x[start+T0minF..start+T0minF+T0maxF-1] via FFT, and only the remaining L-T0minF products
+// are summed directly.
+// With useBrokenJitterThresh = 1 the periods are correlated with crossCorr, as in earlier versions.
+void cPitchJitter::crossCorrPeriods(const FLOAT_DMEM *x, long start, long T0minF, long T0maxF, double *cc)
+{
+  const FLOAT_DMEM *xs = x + start;
+  long L;
+  if (useBrokenJitterThresh_) {
+    for (L = T0minF; L <= T0maxF; L++) {
+      cc[L-T0minF] = crossCorr(xs, L, xs + L, L);
+    }
+    return;
+  }
+  const double *sx = sumX_ + start;
+  const double *sxx = sumXX_ + start;
+  long nL = T0maxF - T0minF + 1;
+
+  int useFft = 0;
+  long N = 0;
+  if (fftCrossCorr_ && T0minF > 0) {
+    N = smileMath_ceilToNextPowOf2(T0maxF);
+    if (N < 4) N = 4;
+    // rough operation counts: products summed directly vs. 3 FFTs plus the remaining products
+    double costDirect = (double)nL * (double)(T0minF + T0maxF) / 2.0;
+    double costFft = 3.0 * (double)N * smileMath_log2((double)N) + (double)nL * (double)nL / 2.0;
+    useFft = (costFft < costDirect);
+  }
+
+  if (useFft) {
+    if (fft_ == NULL || fft_->getN() != N) {
+      fft_ = cSmileFft::getPlan(N, getFftEngine());
+    }
+    if (N > fftBufN_) {
+      fftU_ = (FLOAT_DMEM *)realloc(fftU_, sizeof(FLOAT_DMEM)*N);
+      fftV_ = (FLOAT_DMEM *)realloc(fftV_, sizeof(FLOAT_DMEM)*N);
+      if (fftU_ == NULL || fftV_ == NULL) OUT_OF_MEMORY;
+      fftBufN_ = N;
+    }
+    memcpy(fftU_, xs, sizeof(FLOAT_DMEM)*T0minF);
+    memset(fftU_ + T0minF, 0, sizeof(FLOAT_DMEM)*(N - T0minF));
+    memcpy(fftV_, xs + T0minF, sizeof(FLOAT_DMEM)*T0maxF);
+    memset(fftV_ + T0maxF, 0, sizeof(FLOAT_DMEM)*(N - T0maxF));
+    fft_->rdft(1, fftU_);
+    fft_->rdft(1, fftV_);
+    // conj(U)*V (in the sign convention of rdft), the inverse gives sum_i u[i]*v[i+k]
+    fftV_[0] *= fftU_[0];
+    fftV_[1] *= fftU_[1];
+    for (long k=2; k<N; k+=2) {
+      FLOAT_DMEM re = fftU_[k]*fftV_[k] + fftU_[k+1]*fftV_[k+1];
+      FLOAT_DMEM im = fftU_[k]*fftV_[k+1] - fftU_[k+1]*fftV_[k];
+      fftV_[k] = re;
+      fftV_[k+1] = im;
+    }
+    fft_->rdft(-1, fftV_);
+    double scale = 2.0 / (double)N;
+    for (L = T0minF; L <= T0maxF; L++) {
+      double xy = (double)fftV_[L-T0minF] * scale
+        + smileMath_dotProduct(xs + T0minF, xs + L + T0minF, L - T0minF);
+      cc[L-T0minF] = smileMath_crossCorrelationFromSums(xy, sx[L] - sx[0], sx[2*L] - sx[L],
+          sxx[L] - sxx[0], sxx[2*L] - sxx[L], L);
+    }
+  } else {
+    for (L = T0minF; L <= T0maxF; L++) {
+      double xy = smileMath_dotProduct(xs, xs + L, L);
+      cc[L-T0minF] = smileMath_crossCorrelationFromSums(xy, sx[L] - sx[0], sx[2*L] - sx[L],
+          sxx[L] - sxx[0], sxx[2*L] - sxx[L], L);
+    }
+  }
+}
+
 // get difference of peak amplitude in the two given frames
 // save interpolated index of max peak in first frame in *maxI0 if != NULL
 // save interpolated index of max peak in second frame in *maxI1 if != NULL
@@ -711,7 +759,15 @@ eTickResult cPitchJitter::myTick(long long t)
     FLOAT_DMEM * avgPeriodWf = (FLOAT_DMEM*)calloc(1,sizeof(FLOAT_DMEM) * (T0f+1));
 
     //// waveform matching  (TODO: sync to amplitude max.)
-    double *cc = (double*)calloc(1,sizeof(double)*((int)(T0maxF-T0minF)+1));
+    if (T0maxF-T0minF+1 > ccBufN_) {
+      ccBuf_ = (double *)realloc(ccBuf_, sizeof(double)*(T0maxF-T0minF+1));
+      if (ccBuf_ == NULL) OUT_OF_MEMORY;
+      ccBufN_ = T0maxF-T0minF+1;
+    }
+    double *cc = ccBuf_;
+    if (!useBrokenJitterThresh_) {
+      computeRunningSums(mat->data, mat->nT);
+    }
 
     long os = start;
     long pp = 0;
@@ -724,14 +780,10 @@ eTickResult cPitchJitter::myTick(long long t)
     //while (( start< mat->nT - 2*T0maxF ) && (start < toRead)) {
     //while (( start < toRead0 - T0maxF - 1 ) && (start < toRead - 2 * T0maxF - 1)) {
     while ((start < mat->nT - 2 * T0maxF - 1)) {
-      long _Tf;
-      for (_Tf = T0minF; _Tf <= T0maxF; _Tf++) {
-        long mid = start+_Tf;
-        cc[_Tf-T0minF] = crossCorr(mat->data+start,_Tf,mat->data+mid,_Tf);
+      crossCorrPeriods(mat->data, start, T0minF, T0maxF, cc);
 // FIXME: cross correlation with previous and next period, then average to get better estimate for current period length?
 // FIXME: re-evaluate period length and position after band-pass comb filtering (phase shift??) and peak detection for boundaries!
 // FIXME: sync correlation to max amplitude boundaries once found  (via lastMis variable..)
-      }
 
       // peak picking
       double max=cc[T0f-T0minF];
@@ -902,7 +954,6 @@ eTickResult cPitchJitter::myTick(long long t)
     // update end pointer
     lastMis = toRead0 - lastPeriod; // - start;
 
-    free(cc);
     free(periodBuffer);
     free(avgPeriodWf);
 
@@ -1210,5 +1261,10 @@ cPitchJitter::~cPitchJitter()
   if (filehandle != NULL) {
     fclose(filehandle);
   }
+  if (ccBuf_ != NULL) free(ccBuf_);
+  if (sumX_ != NULL) free(sumX_);
+  if (sumXX_ != NULL) free(sumXX_);
+  if (fftU_ != NULL) free(fftU_);
+  if (fftV_ != NULL) free(fftV_);
 }
 
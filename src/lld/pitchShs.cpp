@@ -17,6 +17,11 @@ Input log2 scale spectrum
 #include <lld/pitchShs.hpp>
 #include <utility>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define PITCHSHS_SSE
+#endif
+
 #define MODULE "cPitchShs"
 
 
@@ -60,6 +65,7 @@ SMILECOMPONENT_REGCOMP(cPitchShs)
     ct->setField("greedyPeakAlgo","1 = use new algorithm to return all maximum score candidates regardless of their order. The old algorithm added new candidates only if they were higher scored as the first one. Enabling this seems to require different viterbi parameters for smoothing though, so use with caution! Default behaviour is 'off' so that we remain backwards-compatible.",0);
     ct->setField("shsSpectrumOutput", "If set to 1, then the sub-harmonic summation spectra frames will be written to the level specified by shsWriter.dmLevel.", 0);
     ct->setField("lfCut", "> 0 = remove low frequency information up to given frequency from input spectrum by zeroing all bins below.", 0);
+    ct->setField("batchFrames", "Maximum number of frames to process together in one tick. All frames available in the input level (up to this number) are read as one matrix and the results are written with a single matrix write. The output is identical to processing one frame per tick (batchFrames = 1). For offline processing, set 'blocksize' to the number of frames to wait for before processing them as one block. Not used if shsSpectrumOutput = 1.", 1);
   )
 
   // The configType gets automatically registered with the config manger by the SMILECOMPONENT_IFNOTREGAGAIN macro
@@ -74,7 +80,9 @@ SMILECOMPONENT_CREATE(cPitchShs)
 
 cPitchShs::cPitchShs(const char *_name) :
   cPitchBase(_name),
-    SS(NULL), Fmap(NULL), shsWriter_(NULL), shsVector_(NULL)
+    SS(NULL), Fmap(NULL), lfCutBin_(-1), batchFrames_(1),
+    nShs_(0), shsShift_(NULL), shsWeight_(NULL),
+    shsWriter_(NULL), shsVector_(NULL)
 {
   char *tmp = myvprint("%s.shsWriter", getInstName());
   shsWriter_ = (cDataWriter *)(cDataWriter::create(tmp));
@@ -100,6 +108,8 @@ void cPitchShs::myFetchConfig()
 
   shsSpectrumOutput = getInt("shsSpectrumOutput");
   lfCut_ = getDouble("lfCut");
+  batchFrames_ = getInt("batchFrames");
+  if (batchFrames_ < 1) batchFrames_ = 1;
 }
 
 void cPitchShs::mySetEnvironment()
@@ -203,6 +213,24 @@ int cPitchShs::setupNewNames(long nEl)
   // allocate array for sum spectrum
   SS = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*nInput_);
 
+  // sub-harmonic h is shifted down by log2(h) octaves and weighted with compressionFactor^(h-1)
+  nShs_ = nHarmonics > 1 ? nHarmonics - 1 : 0;
+  shsShift_ = (long *)malloc(sizeof(long)*(nShs_+1));
+  shsWeight_ = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*(nShs_+1));
+  if (shsShift_ == NULL || shsWeight_ == NULL) OUT_OF_MEMORY;
+  FLOAT_DMEM _scale = compressionFactor;
+  for (long h = 0; h < nShs_; h++) {
+    shsShift_[h] = (long)floor((double)nPointsPerOctave * smileMath_log2(h+2));
+    shsWeight_[h] = _scale;
+    _scale *= compressionFactor;
+  }
+
+  if (lfCut_ > 0.0) {
+    lfCutBin_ = (long)((ceil(log(lfCut_)/log(base)) - Fmint)/Fstept);
+    if (lfCutBin_ >= nInput_) lfCutBin_ = nInput_ - 1;
+    SMILE_IMSG(2, "lfCut: <= bin %ld from %ld", lfCutBin_, nInput_);
+  }
+
   if (shsSpectrumOutput != 0) {
     int N = reader_->getLevelNf();
     int i;
@@ -225,36 +253,14 @@ int cPitchShs::pitchDetect(FLOAT_DMEM * inData, long N, double fsSec,
   long i,j;
   if (nOctaves == 0.0) return -1;
   
-	/* remove lower frequencies */
-  if (lfCut_ > 0.0) {
-    int bin = (int)((ceil(log(lfCut_)/log(base)) - Fmint)/Fstept);
-    SMILE_IMSG(2, "lfCut: <= bin %i from %i", bin, N);
-    for (i = 0; i <= bin; i++) {
-      inData[i] = 0.0;
-    }
-  }
-
-  for (j=0; j < N; j++) {
-    SS[j] = inData[j];
+  /* remove lower frequencies */
+  for (i = 0; i <= lfCutBin_; i++) {
+    inData[i] = 0.0;
   }
 
   /* subharmonic summation; shift spectra by octaves and add */
+  subharmonicSummation(inData, SS, N);
 
-
-
-  FLOAT_DMEM _scale = compressionFactor;
-  
-  for (i=2; i < nHarmonics+1; i++) {
-    long shift = (long)floor ((double)nPointsPerOctave * smileMath_log2(i));
-    for (j=shift; j < N; j++) {
-      SS[j-shift] += inData[j] * _scale;
-    }
-    _scale *= compressionFactor;
-  }
-  for (j=0; j < N; j++) {
-    SS[j] /= (FLOAT_DMEM)nHarmonics;  // Is this needed?
-    if (SS[j] < 0) SS[j] = 0.0;
-  }
   // TODO : support output of SHS spectrum here for vis and debug
   if (shsSpectrumOutput != 0) {
     if (shsVector_ == NULL) {
@@ -265,57 +271,38 @@ int cPitchShs::pitchDetect(FLOAT_DMEM * inData, long N, double fsSec,
     shsWriter_->setNextFrame(shsVector_);
   }
 
-  // peak candidate picking & computation of SS vector mean
+  // peak candidate picking (the peaks are located with SSE for 4 bins at a time, skipping peaks
+  // which are not higher than the score a new candidate needs, see addPeakCandidate)
   candScore[0] = 0.0;
-  double ssMean = (double)SS[0];
-  for (i=1; i<N-1; i++) {
-    if (greedyPeakAlgo) { // use new (correct?) max. score peak detector
-
-
-      if ( (SS[i-1] < SS[i]) && (SS[i] > SS[i+1]) ) { // <- peak detection
-          //    && ((SS[i] > _candScore[0])||(_candScore[0]==0.0)) ) { // is max. peak or first peak?
-
-        // add candidate at first free spot or behind another higher scored one...
-        for (j=0; j<nCandidates; j++) {
-          if (candScore[j]==0.0 || candScore[j]<SS[i]) {
-            // move remaining candidates downwards..
-            int jj;
-            for (jj=nCandidates-1; jj>j; jj--) {
-              candScore[jj] = candScore[jj-1];
-              f0cand[jj] = f0cand[jj-1];
-            }
-            // add this one...
-            f0cand[j] = (FLOAT_DMEM)i;
-            candScore[j] = SS[i];
-            if (nCand<nCandidates) nCand++;
-            break; // leave the for loop after adding candidate to array
-          }
-        }
-
-      }
+  i = 1;
+#ifdef PITCHSHS_SSE
+  for (; i + 4 < N; i += 4) {
+    __m128 c = _mm_loadu_ps(SS + i);
+    FLOAT_DMEM minScore = 0.0;
+    if (greedyPeakAlgo) {
+      if (nCand == nCandidates) minScore = candScore[nCandidates-1];
     } else {
-
-      if ( (SS[i-1] < SS[i]) && (SS[i] > SS[i+1])
-              && ((SS[i] > candScore[0])||(candScore[0]==0.0)) ) { // is max. peak or first peak?
-
-
-  // TODO:!! this algorithm might only add one candidate, if the first one added is the maximum score candidate. This will degrade performance of following viterbi smoothing!
-  // CLEAN SOLUTION: find all peaks, then sort by score, and output to "nCandidates"
-  // old algo:
-        // shift candScores and f0cand (=indicies)
-        for (j=nCandidates-1; j>0; j--) {
-          candScore[j] = candScore[j-1];
-          f0cand[j] = f0cand[j-1];
-        }
-        f0cand[0] = (FLOAT_DMEM)i;
-        candScore[0] = SS[i];
-        if (nCand<nCandidates) nCand++;
-      }
-
+      minScore = candScore[0];
+    }
+    int mask = _mm_movemask_ps(_mm_and_ps(_mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(SS + i - 1), c),
+        _mm_cmpgt_ps(c, _mm_loadu_ps(SS + i + 1))), _mm_cmpgt_ps(c, _mm_set1_ps(minScore))));
+    for (j = 0; mask != 0; j++, mask >>= 1) {
+      if (mask & 1) nCand = addPeakCandidate(i + j, f0cand, candScore, nCandidates, nCand);
+    }
+  }
+#endif
+  for (; i<N-1; i++) {
+    if ( (SS[i-1] < SS[i]) && (SS[i] > SS[i+1]) ) { // <- peak detection
+      nCand = addPeakCandidate(i, f0cand, candScore, nCandidates, nCand);
     }
+  }
+
+  // computation of SS vector mean
+  double ssMean = (double)SS[0];
+  for (i=1; i<N; i++) {
     ssMean += (double)SS[i];
   }
-  ssMean = (ssMean+(double)SS[i])/(double)N;
+  ssMean /= (double)N;
 
   // convert peak candidate frequencies and compute voicing prob.
   for (i=0; i<nCand; i++) {
@@ -358,6 +345,124 @@ int cPitchShs::pitchDetect(FLOAT_DMEM * inData, long N, double fsSec,
   return nCand;
 }
 
+// adds the peak at bin i of the SHS spectrum to the candidates (sorted by score with greedyPeakAlgo = 1),
+// returns the new number of candidates
+// As the SHS spectrum is >= 0, all peaks are > 0 and the scores of the candidates are only 0 for unused
+// candidates. A peak is therefore only added if it is higher than the last candidate's score (if all
+// candidates are used, greedyPeakAlgo = 1) or the first candidate's score (greedyPeakAlgo = 0).
+int cPitchShs::addPeakCandidate(long i, FLOAT_DMEM *f0cand, FLOAT_DMEM *candScore, long nCandidates, int nCand)
+{
+  long j;
+  if (greedyPeakAlgo) { // use new (correct?) max. score peak detector
+    // add candidate at first free spot or behind another higher scored one...
+    for (j=0; j<nCandidates; j++) {
+      if (candScore[j]==0.0 || candScore[j]<SS[i]) {
+        // move remaining candidates downwards..
+        int jj;
+        for (jj=nCandidates-1; jj>j; jj--) {
+          candScore[jj] = candScore[jj-1];
+          f0cand[jj] = f0cand[jj-1];
+        }
+        // add this one...
+        f0cand[j] = (FLOAT_DMEM)i;
+        candScore[j] = SS[i];
+        if (nCand<nCandidates) nCand++;
+        break; // leave the for loop after adding candidate to array
+      }
+    }
+  } else if ((SS[i] > candScore[0])||(candScore[0]==0.0)) { // is max. peak or first peak?
+  // TODO:!! this algorithm might only add one candidate, if the first one added is the maximum score candidate. This will degrade performance of following viterbi smoothing!
+  // CLEAN SOLUTION: find all peaks, then sort by score, and output to "nCandidates"
+  // old algo:
+    // shift candScores and f0cand (=indicies)
+    for (j=nCandidates-1; j>0; j--) {
+      candScore[j] = candScore[j-1];
+      f0cand[j] = f0cand[j-1];
+    }
+    f0cand[0] = (FLOAT_DMEM)i;
+    candScore[0] = SS[i];
+    if (nCand<nCandidates) nCand++;
+  }
+  return nCand;
+}
+
+// ss[j] = max(0, (in[j] + sum_h in[j+shift_h]*weight_h) / nHarmonics) for all candidates j
+// The sub-harmonics are added in the order of h for each candidate (as the loop over all candidates per
+// sub-harmonic in earlier versions did), so the result does not depend on the SIMD width. With SSE,
+// 16 candidates are processed at a time in 4 independent vector accumulators.
+void cPitchShs::subharmonicSummation(const FLOAT_DMEM *in, FLOAT_DMEM *ss, long N)
+{
+  long j = 0;
+  long h, k;
+#ifdef PITCHSHS_SSE
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 nH = _mm_set1_ps((FLOAT_DMEM)nHarmonics);
+  for (long B = 16; B >= 4; B -= 12) {
+    for (; j + B <= N; j += B) {
+      // sub-harmonics which are available for all B candidates
+      if (B == 16) {
+        __m128 a0 = _mm_loadu_ps(in + j);
+        __m128 a1 = _mm_loadu_ps(in + j + 4);
+        __m128 a2 = _mm_loadu_ps(in + j + 8);
+        __m128 a3 = _mm_loadu_ps(in + j + 12);
+        for (h = 0; h < nShs_ && j + 15 + shsShift_[h] < N; h++) {
+          const FLOAT_DMEM *x = in + j + shsShift_[h];
+          __m128 w = _mm_set1_ps(shsWeight_[h]);
+          a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(x), w));
+          a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(x + 4), w));
+          a2 = _mm_add_ps(a2, _mm_mul_ps(_mm_loadu_ps(x + 8), w));
+          a3 = _mm_add_ps(a3, _mm_mul_ps(_mm_loadu_ps(x + 12), w));
+        }
+        _mm_storeu_ps(ss + j, a0);
+        _mm_storeu_ps(ss + j + 4, a1);
+        _mm_storeu_ps(ss + j + 8, a2);
+        _mm_storeu_ps(ss + j + 12, a3);
+      } else {
+        __m128 a0 = _mm_loadu_ps(in + j);
+        for (h = 0; h < nShs_ && j + 3 + shsShift_[h] < N; h++) {
+          a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(in + j + shsShift_[h]), _mm_set1_ps(shsWeight_[h])));
+        }
+        _mm_storeu_ps(ss + j, a0);
+      }
+      // remaining sub-harmonics, only available for some of the candidates
+      for (; h < nShs_ && j + shsShift_[h] < N; h++) {
+        for (k = j; k < j + B && k + shsShift_[h] < N; k++) {
+          ss[k] += in[k + shsShift_[h]] * shsWeight_[h];
+        }
+      }
+      // max(0, x) keeps -0.0 and NaN (like the comparison below)
+      for (k = j; k < j + B; k += 4) {
+        _mm_storeu_ps(ss + k, _mm_max_ps(zero, _mm_div_ps(_mm_loadu_ps(ss + k), nH)));
+      }
+    }
+  }
+#endif
+  for (; j < N; j++) {
+    FLOAT_DMEM sum = in[j];
+    for (h = 0; h < nShs_ && j + shsShift_[h] < N; h++) {
+      sum += in[j + shsShift_[h]] * shsWeight_[h];
+    }
+    sum /= (FLOAT_DMEM)nHarmonics;  // Is this needed?
+    if (sum < 0) sum = 0.0;
+    ss[j] = sum;
+  }
+}
+
+eTickResult cPitchShs::myTick(long long t)
+{
+  if (shsSpectrumOutput) return cVectorProcessor::myTick(t);
+  return tickBatched(t, MAX(batchFrames_, blocksizeR_));
+}
+
+int cPitchShs::processVectorBatch(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, long nFrames)
+{
+  if (shsSpectrumOutput) return 0;
+  for (long f = 0; f < nFrames; f++) {
+    if (!processVector(src + f*Nsrc, dst + f*Ndst, Nsrc, Ndst, 0)) return 0;
+  }
+  return 1;
+}
+
 int cPitchShs::addCustomOutputs(FLOAT_DMEM *dstCur, long NdstLeft)
 {
   // to be implemented by child class
@@ -371,6 +476,8 @@ cPitchShs::~cPitchShs()
 {
   if (SS != NULL) free(SS);
   if (Fmap != NULL) free(Fmap);
+  if (shsShift_ != NULL) free(shsShift_);
+  if (shsWeight_ != NULL) free(shsWeight_);
   if (shsVector_ != NULL) delete(shsVector_);
   if (shsWriter_ != NULL) delete(shsWriter_);
 }
@@ -40,6 +40,9 @@ SMILECOMPONENT_REGCOMP(cPitchSmootherViterbi)
 
   SMILECOMPONENT_IFNOTREGAGAIN(
    ct->setField("bufferLength","The length of the delay buffer in (input) frames. This is the amount of data that will be used for the Viterbi smoothing, and it is also the lag which the output is behind the input. The input level buffer must be at least bufferLength+1 in size!.",30);
+   ct->setField("maxLookahead","The maximum number of frames the output may lag behind the input (maximum delay of the decision on the F0 of a frame). If the Viterbi paths have not merged within this number of frames, the F0 on the currently best path is output. Use this for live processing with bounded latency. 0 = bufferLength-1 (the maximum).",0);
+   ct->setField("maxOctaveJump","If > 0, only voiced-voiced transitions with an F0 change of at most this number of octaves are considered in the Viterbi search (pruning of implausible octave jumps). 0 = consider all transitions.",0.0);
+   ct->setField("beam","If > 0, only previous states with a path cost of at most the lowest path cost plus this value are considered in the Viterbi search (beam pruning). 0 = consider all previous states.",0.0);
 
    // new data
    ct->setField("F0final","1 = Enable output of final (corrected and smoothed) F0 -- linear scale", 1);
@@ -76,6 +79,35 @@ SMILECOMPONENT_CREATE(cPitchSmootherViterbi)
 
 //-----
 
+void cSmileViterbi::decidePath(int s, long from, long n)
+{
+  long k;
+  for (k=from; k>n; k--) {
+    s = backPtr[(k%buflen)*nStates + s];
+  }
+  for (k=n; k>convIdx; k--) {
+    bestPath[k%buflen] = s;
+    long lag = pathIdx-1 - k;
+    latencySum += lag;
+    if (lag > latencyMax) latencyMax = lag;
+    if (k > convIdx+1) s = backPtr[(k%buflen)*nStates + s];
+  }
+  nDecided += n - convIdx;
+  convIdx = n;
+}
+
+void cSmileViterbi::releaseState(int s, long n)
+{
+  /* states at or before the last decided frame are no longer tracked */
+  while (n > convIdx) {
+    nAlive[n%buflen]--;
+    if (n-1 <= convIdx) break;
+    s = backPtr[(n%buflen)*nStates + s];
+    n--;
+    if (--refCount[(n%buflen)*nStates + s] > 0) break;
+  }
+}
+
 long cSmileViterbi::addFrame(FLOAT_DMEM *frame)
 {
   int i,j;
@@ -86,6 +118,7 @@ long cSmileViterbi::addFrame(FLOAT_DMEM *frame)
     FLOAT_DMEM * b = buf+((wrIdx%buflen)*frameSize);
     memcpy(b,frame,sizeof(FLOAT_DMEM)*frameSize);
     wrIdx++;
+    nFrames++;
     FLOAT_DMEM * a = prev; prev = b;
 
     /* perform one step viterbi */
@@ -95,52 +128,78 @@ long cSmileViterbi::addFrame(FLOAT_DMEM *frame)
       /* trellis initialisation (no transp from previous states) */
       for (i=0; i<nStates; i++) {
         pathCosts[i] = localCost(i,frame);
-        paths[pathBuf][i*buflen] = i;
+        backPtr[i] = i;
+        refCount[i] = 0;
       }
+      nAlive[0] = nStates;
     } else {
       /* trellis updates */
-      int pathBufNew = (pathBuf+1)%2;
-//printf("XX Cost: ");
+      int * bp = backPtr + (pathIdx%buflen)*nStates;
+
+      /* best previous state, and limit for beam pruning */
+      int bestState = 0;
+      for (j=1; j<nStates; j++) {
+        if (pathCosts[j] < pathCosts[bestState]) bestState = j;
+      }
+      double beamLimit = pathCosts[bestState] + beam;
+
       for (i=0; i<nStates; i++) {
         /*  update all the state probabilities for the current timestep */
 
         /* find best path into current state */
-        int minState = 0;
-        double minCost;
-        minCost = pathCostsTemp[0] = transitionCost(i, 0, a, b) + pathCosts[0];
-        for (j=1; j<nStates; j++) {
-          pathCostsTemp[j] = transitionCost(i, j, a, b) + pathCosts[j];
-          if (pathCostsTemp[j] < minCost) {
+        int minState = -1;
+        double minCost = 0.0;
+        for (j=0; j<nStates; j++) {
+          /* the best previous path is never pruned, so all paths can merge into it */
+          if (j != bestState) {
+            if (beam > 0.0 && pathCosts[j] > beamLimit) continue;
+            if (pruning && pruneTransition(i, j, a, b)) continue;
+          }
+          double c = transitionCost(i, j, a, b) + pathCosts[j];
+          nTransitions++;
+          if (minState < 0 || c < minCost) {
             minState = j;
-            minCost = pathCostsTemp[j];
+            minCost = c;
           }
         }
 
         /* update new cost */
         pathCostsNew[i] = minCost + localCost(i,frame);
-//printf("%f ",pathCostsNew[i]);
-        /* copy and update path */
-        memcpy(paths[pathBufNew] + i*buflen, paths[pathBuf] + minState*buflen, buflen*sizeof(int));
-        paths[pathBufNew][i*buflen + pathIdx%buflen] = i;
+        /* store back-pointer */
+        bp[i] = minState;
       }
-//printf("\n");
 
       /* copy new costs to pathCosts */
       double * tmp = pathCosts;
       pathCosts = pathCostsNew;
       pathCostsNew = tmp;
 
-      /* swap path buffers */
-      pathBuf = pathBufNew;
+      /* update the survivor counts: states of the previous frame which are not the predecessor of any current state
+         (and their predecessors which are left without successors) are no longer on any path */
+      int * rc = refCount + (pathIdx%buflen)*nStates;
+      int * rcPrev = refCount + ((pathIdx-1)%buflen)*nStates;
+      for (i=0; i<nStates; i++) {
+        rc[i] = 0;
+        rcPrev[bp[i]]++;
+      }
+      nAlive[pathIdx%buflen] = nStates;
+      if (pathIdx-1 > convIdx) {
+        for (j=0; j<nStates; j++) {
+          if (rcPrev[j] == 0) releaseState(j, pathIdx-1);
+        }
+      }
     }
 
     pathIdx++;
-    if (pathIdx-convIdx > buflen) { /* > ok here, since convIdx starts at -1 */
+    if (pathIdx-1-convIdx > lookahead) { /* convIdx starts at -1 */
       /*
        *  forced decision for the first (oldest) element in the path, based upon best final path
        *
        */
-      SMILE_MSG(4,"cSmileViterbi: Forced viterbi trellis flush. If you get this message often, increase the 'bufferLength' option.\n");
+      if (lookahead == buflen-1) {
+        SMILE_MSG(4,"cSmileViterbi: Forced viterbi trellis flush. If you get this message often, increase the 'bufferLength' option.\n");
+      }
+      nForced++;
 
       /* find current path with minimal cost */
       int minState = 0;
@@ -150,30 +209,22 @@ long cSmileViterbi::addFrame(FLOAT_DMEM *frame)
         }
       }
 
-      convIdx++;
-      int x = paths[pathBuf][minState*buflen + (convIdx)%buflen];
-      bestPath[convIdx%buflen] = x;
+      decidePath(minState, pathIdx-1, convIdx+1);
 
     } else {
       /* find point where all paths merge */
-      long n;
-      for (n=convIdx+1; n<pathIdx; n++) {
-        int x = paths[pathBuf][n%buflen];
-        int match = 1;
-        for (i=1; i<nStates; i++) {
-          if (x != paths[pathBuf][i*buflen+n%buflen]) {
-            match = 0;
-            break;
-          }
-        }
-        if (!match) { break; }
-        else {
-          convIdx++;
-          bestPath[convIdx%buflen] = x;
+      while (convIdx+1 < pathIdx && nAlive[(convIdx+1)%buflen] == 1) {
+        const int * rc = refCount + ((convIdx+1)%buflen)*nStates;
+        for (i=0; i<nStates-1; i++) {
+          if (rc[i] > 0) break;
         }
-        // TODO: shouldn't we choose the best path here and not the first??
+        bestPath[(convIdx+1)%buflen] = i;
+        long lag = pathIdx-1 - (convIdx+1);
+        latencySum += lag;
+        if (lag > latencyMax) latencyMax = lag;
+        nDecided++;
+        convIdx++;
       }
-
     }
 
     return getNAvail();
@@ -225,7 +276,7 @@ FLOAT_DMEM cSmileViterbi::getNextOutputFrame(FLOAT_DMEM ** frame=NULL, int *avai
 
 cPitchSmootherViterbi::cPitchSmootherViterbi(const char *_name) :
   cDataProcessor(_name), viterbi(NULL), framePtr(NULL), vecO(NULL), buflen(0), outpVecSize(0),
-  nInputLevels(1), lastValidf0(0.0), reader2(NULL)
+  nInputLevels(1), lastValidf0(0.0), reader2(NULL), maxOctaveJump(0.0), beam(0.0), maxLookahead(0)
 {
   char *tmp = myvprint("%s.reader2",getInstName());
   reader2 = (cDataReader *)(cDataReader::create(tmp));
@@ -243,7 +294,18 @@ void cPitchSmootherViterbi::myFetchConfig() {
 
   buflen = getInt("bufferLength");
   // note, that it is "polite" to output the loaded parameters at debug level 2:
-  SMILE_IDBG(2,"bufferLength = %f",buflen);
+  SMILE_IDBG(2,"bufferLength = %ld",buflen);
+  maxLookahead = getInt("maxLookahead");
+  if (maxLookahead < 0) maxLookahead = 0;
+  if (maxLookahead > buflen-1) {
+    SMILE_IWRN(2,"maxLookahead (%ld) must be smaller than bufferLength (%ld), setting it to %ld", maxLookahead, buflen, buflen-1);
+    maxLookahead = buflen-1;
+  }
+  SMILE_IDBG(2,"maxLookahead = %ld",maxLookahead);
+  maxOctaveJump = getDouble("maxOctaveJump");
+  SMILE_IDBG(2,"maxOctaveJump = %f",maxOctaveJump);
+  beam = getDouble("beam");
+  SMILE_IDBG(2,"beam = %f",beam);
 
   F0final = getInt("F0final");
   SMILE_IDBG(2,"F0final = %i",F0final);
@@ -442,6 +504,9 @@ int cPitchSmootherViterbi::myFinaliseInstance()
     voiceThresh = voicingCutoff[0];
     viterbi = new cSmileViterbiPitchSmooth(nCandidates[0], buflen, nCandidates[0]*2 + 4, voiceThresh);
     viterbi->setWeights(wLocal, wTvv, wTvvd, wTvuv, wThr, wRange, wTuu);
+    viterbi->setMaxLookahead(maxLookahead);
+    viterbi->setMaxOctaveJump(maxOctaveJump);
+    viterbi->setBeam(beam);
     framePtr = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM) * (nCandidates[0] * 2 + 4) );
   }
   return ret;
@@ -461,6 +526,13 @@ eTickResult cPitchSmootherViterbi::myTick(long long t)
     /* flush trellis on EOI */
     viterbi->flushTrellis();
     avail = viterbi->getNAvail();
+    if (avail > 0) {
+      double T = reader_->getLevelT();
+      SMILE_IDBG(2,"%ld frames, %ld forced decisions, latency mean %.2f frames (%.3f s) max %ld frames (%.3f s), %.1f transitions per frame (of %i)",
+        viterbi->getNFrames(), viterbi->getNForced(), viterbi->getLatencyMean(), viterbi->getLatencyMean()*T,
+        viterbi->getLatencyMax(), (double)viterbi->getLatencyMax()*T, viterbi->getTransitionsPerFrame(),
+        (int)((nCandidates[0]+1)*(nCandidates[0]+1)));
+    }
   } else {
     // get next frame from dataMemory
     cVector *vec = reader_->getNextFrame();
@@ -18,6 +18,11 @@ on-line semi-tone filter bank
 #include <lld/tonefilt.hpp>
 //#include <math.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define TONEFILT_SSE2
+#endif
+
 #define MODULE "cTonefilt"
 
 
@@ -57,7 +62,9 @@ cTonefilt::cTonefilt(const char *_name) :
   freq(NULL),
   pos(NULL),
   corrC(NULL), corrS(NULL),
-  decayF(NULL)
+  decayF(NULL), gainF(NULL),
+  rotC(NULL), rotS(NULL), phC(NULL), phS(NULL),
+  xBuf(NULL), xBufN(0)
 {
 
 }
@@ -187,6 +194,18 @@ int cTonefilt::setupNewNames(long nEl)
     //decayF[n] = decayFN + (decayF0-decayFN) * ((double)nNotes/12.0) / pow(2.0, (double)n/12.0); // TODO
     decayF[n] = decayFN + (decayF0-decayFN) * (freq[n]-freq[0])/(freq[nNotes-1]);
   }
+  // the sine and cosine of each note are generated by rotating a phasor by the phase increment
+  // per sample, instead of calling sin() and cos() for every sample
+  gainF = (double*)malloc(sizeof(double)*nNotes);
+  rotC = (double*)malloc(sizeof(double)*nNotes);
+  rotS = (double*)malloc(sizeof(double)*nNotes);
+  phC = (double*)malloc(sizeof(double)*nNotes);
+  phS = (double*)malloc(sizeof(double)*nNotes);
+  for (n=0; n<nNotes; n++) {
+    gainF[n] = 1.0 - decayF[n];
+    rotC[n] = cos(2.0*M_PI*freq[n]*inputPeriod);
+    rotS[n] = sin(2.0*M_PI*freq[n]*inputPeriod);
+  }
   pos = (long *)calloc(1,sizeof(long)*N);
   
   namesAreSet_ = 1;
@@ -201,28 +220,77 @@ int cTonefilt::myFinaliseInstance()
 }
 */
 
-void cTonefilt::doFilter(int i, cMatrix *row, FLOAT_DMEM*y)
+// filters a block of nT input samples (stride: distance between consecutive samples in x)
+// the notes are processed in groups of 4 (2 SSE2 lanes per register), each group iterating over
+// the whole block with the filter states and phasors kept in registers
+void cTonefilt::doFilter(int i, const FLOAT_DMEM *x, long nT, long stride, FLOAT_DMEM *y)
 {
   long n,t;
   double *s = corrS[i]; // sine
   double *c = corrC[i]; // cosine
   // TOOD: check for type data
+  if (nT > xBufN) {
+    if (xBuf != NULL) free(xBuf);
+    xBuf = (double*)malloc(sizeof(double)*nT);
+    xBufN = nT;
+  }
+  for (n=0; n<nT; n++) {
+    xBuf[n] = (double)x[n*stride];
+  }
+  // the phase at the start of each block is computed exactly, so the rounding errors of the
+  // phasor rotation do not accumulate over blocks
+  double time = (double)pos[i] * inputPeriod;
   for (t=0; t<nNotes; t++) {
-    double f= freq[t];
-    FLOAT_DMEM *x = row->data;
-    long idx = pos[i];
-    for (n=0; n<row->nT; n++) {
+    phC[t] = cos(2.0*M_PI*freq[t]*time);
+    phS[t] = sin(2.0*M_PI*freq[t]*time);
+  }
+  t = 0;
+#ifdef TONEFILT_SSE2
+  for ( ; t + 4 <= nNotes; t += 4) {
+    __m128d d0 = _mm_loadu_pd(decayF+t), d1 = _mm_loadu_pd(decayF+t+2);
+    __m128d g0 = _mm_loadu_pd(gainF+t), g1 = _mm_loadu_pd(gainF+t+2);
+    __m128d rc0 = _mm_loadu_pd(rotC+t), rc1 = _mm_loadu_pd(rotC+t+2);
+    __m128d rs0 = _mm_loadu_pd(rotS+t), rs1 = _mm_loadu_pd(rotS+t+2);
+    __m128d pc0 = _mm_loadu_pd(phC+t), pc1 = _mm_loadu_pd(phC+t+2);
+    __m128d ps0 = _mm_loadu_pd(phS+t), ps1 = _mm_loadu_pd(phS+t+2);
+    __m128d s0 = _mm_loadu_pd(s+t), s1 = _mm_loadu_pd(s+t+2);
+    __m128d c0 = _mm_loadu_pd(c+t), c1 = _mm_loadu_pd(c+t+2);
+    for (n=0; n<nT; n++) {
+      __m128d xv = _mm_load1_pd(xBuf+n);
+      // s = decay * s + (1 - decay) * sin * x,  c = decay * c + (1 - decay) * cos * x
+      s0 = _mm_add_pd(_mm_mul_pd(d0, s0), _mm_mul_pd(_mm_mul_pd(g0, ps0), xv));
+      s1 = _mm_add_pd(_mm_mul_pd(d1, s1), _mm_mul_pd(_mm_mul_pd(g1, ps1), xv));
+      c0 = _mm_add_pd(_mm_mul_pd(d0, c0), _mm_mul_pd(_mm_mul_pd(g0, pc0), xv));
+      c1 = _mm_add_pd(_mm_mul_pd(d1, c1), _mm_mul_pd(_mm_mul_pd(g1, pc1), xv));
+      // advance the phasor by one sample
+      __m128d tc0 = _mm_sub_pd(_mm_mul_pd(pc0, rc0), _mm_mul_pd(ps0, rs0));
+      __m128d tc1 = _mm_sub_pd(_mm_mul_pd(pc1, rc1), _mm_mul_pd(ps1, rs1));
+      ps0 = _mm_add_pd(_mm_mul_pd(pc0, rs0), _mm_mul_pd(ps0, rc0));
+      ps1 = _mm_add_pd(_mm_mul_pd(pc1, rs1), _mm_mul_pd(ps1, rc1));
+      pc0 = tc0;
+      pc1 = tc1;
+    }
+    _mm_storeu_pd(s+t, s0); _mm_storeu_pd(s+t+2, s1);
+    _mm_storeu_pd(c+t, c0); _mm_storeu_pd(c+t+2, c1);
+  }
+#endif
+  for ( ; t<nNotes; t++) {
+    double pc = phC[t];
+    double ps = phS[t];
+    for (n=0; n<nT; n++) {
       // compute correlation with sin+cos
-      double time = (double)(idx+n) * inputPeriod;
-      //      s[t] += sin(2.0*M_PI*f*t) * x[n];
-      //      c[t] += cos(2.0*M_PI*f*t) * x[n];
-      s[t] = decayF[t] * s[t] + (1.0 - decayF[t]) * sin(2.0*M_PI*f*time) * (double)x[n];
-      c[t] = decayF[t] * c[t] + (1.0 - decayF[t]) * cos(2.0*M_PI*f*time) * (double)x[n];
+      s[t] = decayF[t] * s[t] + gainF[t] * ps * xBuf[n];
+      c[t] = decayF[t] * c[t] + gainF[t] * pc * xBuf[n];
+      double tc = pc * rotC[t] - ps * rotS[t];
+      ps = pc * rotS[t] + ps * rotC[t];
+      pc = tc;
     }
+  }
+  for (t=0; t<nNotes; t++) {
     y[t] = (FLOAT_DMEM)sqrt(c[t]*c[t] + s[t]*s[t]);  // sqrt(re^2 + im^2)
     y[t] *= 10.0;
   }
-  pos[i] += row->nT;
+  pos[i] += nT;
 }
 
 eTickResult cTonefilt::myTick(long long t)
@@ -240,9 +308,8 @@ eTickResult cTonefilt::myTick(long long t)
   
   int i;
   for (i=0; i<N; i++) {
-    cMatrix *r = mat->getRow(i);
-
-    doFilter(i,r,tmpFrame); 
+    // filter row i of the matrix in place (the samples of a row are N elements apart)
+    doFilter(i, mat->data+i, mat->nT, N, tmpFrame);
     
     // copy data into main vector
     memcpy( tmpVec->data+i*nNotes, tmpFrame, sizeof(FLOAT_DMEM)*nNotes );
@@ -266,6 +333,12 @@ cTonefilt::~cTonefilt()
   if (freq!=NULL) free(freq);
   if (pos!=NULL) free(pos);
   if (decayF !=NULL) free(decayF);
+  if (gainF !=NULL) free(gainF);
+  if (rotC !=NULL) free(rotC);
+  if (rotS !=NULL) free(rotS);
+  if (phC !=NULL) free(phC);
+  if (phS !=NULL) free(phS);
+  if (xBuf !=NULL) free(xBuf);
   int i;
   if (corrS !=NULL) {
     for (i=0; i<N; i++) { if (corrS[i] != NULL) free(corrS[i]); }
@@ -0,0 +1,146 @@
+/*F***************************************************************************
+ * This file is part of openSMILE.
+ *
+ * Copyright (c) audEERING GmbH. All rights reserved.
+ * See the file COPYING for details on license terms.
+ ***************************************************************************E*/
+
+
+/*  openSMILE component:
+
+computes MFCC directly from an FFT magnitude spectrum (cMelspec and cMfcc in one component)
+
+*/
+
+
+#include <lldcore/melMfcc.hpp>
+
+#define MODULE "cMelMfcc"
+
+
+SMILECOMPONENT_STATICS(cMelMfcc)
+
+SMILECOMPONENT_REGCOMP(cMelMfcc)
+{
+  SMILECOMPONENT_REGCOMP_INIT
+  scname = COMPONENT_NAME_CMELMFCC;
+  sdescription = COMPONENT_DESCRIPTION_CMELMFCC;
+
+  // we inherit cMelspec configType and extend it:
+  SMILECOMPONENT_INHERIT_CONFIGTYPE("cMelspec")
+
+  SMILECOMPONENT_IFNOTREGAGAIN(
+    ct->setField("nameAppend", NULL, "mfcc");
+    ct->setField("firstMfcc","The first MFCC to compute",1);
+    ct->setField("lastMfcc","The last MFCC to compute",12);
+    ct->setField("nMfcc","Use this option to specify the number of MFCC, instead of specifying lastMfcc",12);
+    ct->setField("melfloor","The minimum value allowed for melspectra when taking the log spectrum (this parameter will be forced to 1.0 when htkcompatible=1)",0.00000001);
+    ct->setField("doLog", "This defaults to 1 (on), set it to 0 to disable the log() operation on the (power) spectrum before applying the DCT. Note: If disabled, the output cannot be considered Cepstral coefficients anymore!", 1);
+    ct->setField("cepLifter","Parameter for cepstral 'liftering', set this to 0.0 to disable cepstral liftering",22.0);
+  )
+
+  SMILECOMPONENT_MAKEINFO(cMelMfcc);
+}
+
+SMILECOMPONENT_CREATE(cMelMfcc)
+
+//-----
+
+cMelMfcc::cMelMfcc(const char *_name) :
+  cMelspec(_name),
+  firstMfcc_(1), lastMfcc_(12), nMfcc_(12),
+  melfloor_(0.0), cepLifter_(0.0), doLog_(1),
+  costable_(NULL), sintable_(NULL),
+  bands_(NULL), bandsN_(0),
+  work_(NULL)
+{
+}
+
+void cMelMfcc::myFetchConfig()
+{
+  cMelspec::myFetchConfig();
+  if (inverse_) {
+    COMP_ERR("the inverse transform is not supported, use cMfcc and cMelspec with inverse=1");
+  }
+
+  firstMfcc_ = getInt("firstMfcc");
+  SMILE_IDBG(2,"firstMfcc = %i",firstMfcc_);
+  lastMfcc_ = getInt("lastMfcc");
+  melfloor_ = (FLOAT_DMEM)getDouble("melfloor");
+  doLog_ = getInt("doLog");
+  cepLifter_ = (FLOAT_DMEM)getDouble("cepLifter");
+  if (!isSet("lastMfcc")&&isSet("nMfcc")) {
+    nMfcc_ = getInt("nMfcc");
+    lastMfcc_ = firstMfcc_ + nMfcc_ - 1;
+  } else {
+    nMfcc_ = lastMfcc_ - firstMfcc_ + 1;
+  }
+  SMILE_IDBG(2,"lastMfcc = %i",lastMfcc_);
+  SMILE_IDBG(2,"nMfcc = %i",nMfcc_);
+  if (htkcompatible_) {
+    melfloor_ = 1.0;
+  }
+}
+
+// the output fields are cepstral coefficients, the band centre frequencies computed by cMelspec are not used
+void cMelMfcc::setBandInfo(double *info, long infoSize)
+{
+  free(info);
+}
+
+int cMelMfcc::setupNamesForField(int i, const char*name, long nEl)
+{
+  // the DCT tables depend only on the number of bands, so they are shared by all fields
+  if (costable_ == NULL) {
+    costable_ = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*nBands_*nMfcc_);
+    sintable_ = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*nMfcc_);
+    work_ = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*nBands_);
+    if (costable_ == NULL || sintable_ == NULL || work_ == NULL) OUT_OF_MEMORY;
+    cMfcc::computeDctTables(costable_, sintable_, nBands_, firstMfcc_, lastMfcc_, cepLifter_);
+  }
+  if ((nameAppend_ != NULL)&&(strlen(nameAppend_)>0)) {
+    if (!copyInputName_) {
+      name="";
+    }
+    addNameAppendField(name,nameAppend_,nMfcc_,firstMfcc_);
+  } else {
+    writer_->addField( name, nMfcc_, firstMfcc_);
+  }
+  return nMfcc_;
+}
+
+int cMelMfcc::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi)
+{
+  if (bands_ == NULL) {
+    bands_ = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*nBands_);
+    bandsN_ = 1;
+  }
+  applyFilterbank(src, bands_, Nsrc, getFconf(idxi));
+  cMfcc::computeMfcc(bands_, dst, work_, nBands_, costable_, sintable_, firstMfcc_, lastMfcc_,
+      doLog_, melfloor_, htkcompatible_);
+  return 1;
+}
+
+int cMelMfcc::processVectorBatch(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, long nFrames)
+{
+  if (nFrames > bandsN_) {
+    if (bands_ != NULL) free(bands_);
+    bands_ = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*nBands_*nFrames);
+    if (bands_ == NULL) OUT_OF_MEMORY;
+    bandsN_ = nFrames;
+  }
+  applyFilterbankBatch(src, bands_, Nsrc, nBands_, nFrames, getFconf(0));
+  for (long f = 0; f < nFrames; f++) {
+    cMfcc::computeMfcc(bands_ + f*nBands_, dst + f*Ndst, work_, nBands_, costable_, sintable_,
+        firstMfcc_, lastMfcc_, doLog_, melfloor_, htkcompatible_);
+  }
+  return 1;
+}
+
+cMelMfcc::~cMelMfcc()
+{
+  if (costable_ != NULL) free(costable_);
+  if (sintable_ != NULL) free(sintable_);
+  if (bands_ != NULL) free(bands_);
+  if (work_ != NULL) free(work_);
+}
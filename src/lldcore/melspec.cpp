@@ -14,6 +14,11 @@ compute mel spectrum from fft magnitude
 
 #include <lldcore/melspec.hpp>
 
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define MELSPEC_SSE
+#endif
+
 #define MODULE "cMelspec"
 
 SMILECOMPONENT_STATICS(cMelspec)
@@ -41,6 +46,7 @@ SMILECOMPONENT_REGCOMP(cMelspec)
     ct->setField("halfBwTarg", "If bwMethod=='custom' then this options gives the effective rectangular bandwidth of the triangular filters in the target frequency scale (default mel). If showFbank=1 the actual bandwidth in Hz for each center frequency will be printed at startup.", 1.0);
     ct->setField("logScaleBase","The base for log scales (a log base of 2.0 - the default - corresponds to an octave target scale)", 2.0,0,0);  
     ct->setField("firstNote","The first note (in Hz) for a semi-tone scale", 27.5,0,0);
+    ct->setField("batchFrames", "Maximum number of frames to process together in one tick (forward transform only). All frames available in the input level (up to this number) are read as one matrix and the filterbank is applied to 4 frames at a time with SSE. The output is identical to processing one frame per tick (batchFrames = 1). For offline processing, set 'blocksize' to the number of frames to wait for before processing them as one block.", 64);
     ct->setField("overrideFrameSizeSec", "In case that the original FFT frame size in seconds cannot automatically be read from the input level meta data (i.e. for average spectra in a multi-frame-size setting), use this to manually override it and force the filters to be created based on the given frame size assumption.", 0.0);
   )
 
@@ -55,6 +61,7 @@ cMelspec::cMelspec(const char *_name) :
   cVectorProcessor(_name),
   filterCoeffs_(NULL),  filterCfs_(NULL),
   chanMap_(NULL), nLoF_(NULL), nHiF_(NULL),
+  fbank_(NULL), batchFrames_(1), batchBuf_(NULL),
   nBands_(26),
   usePower_(0),
   htkcompatible_(1), inverse_(0),
@@ -130,6 +137,9 @@ void cMelspec::myFetchConfig()
     halfBwTarg_ = 1.0;
   }
 
+  batchFrames_ = getInt("batchFrames");
+  if (batchFrames_ < 1) batchFrames_ = 1;
+
   if (specScale_ == SPECTSCALE_LOG) param_ = logScaleBase_;
   else if (specScale_ == SPECTSCALE_SEMITONE) param_ = firstNote_;
   else param_ = 0.0;
@@ -143,6 +153,7 @@ int cMelspec::dataProcessorCustomFinalise()
   if (chanMap_ == NULL) chanMap_ = (long**)multiConfAlloc();
   if (nLoF_ == NULL) nLoF_ = (long *)multiConfAlloc();
   if (nHiF_ == NULL) nHiF_ = (long *)multiConfAlloc();
+  if (fbank_ == NULL) fbank_ = (sMelFilterbank **)multiConfAlloc();
   return cVectorProcessor::dataProcessorCustomFinalise();
 }
 
@@ -291,7 +302,7 @@ int cMelspec::computeFilters( long blocksize, double frameSizeSec, int idxc )
     for (int m = 1; m <= nBands; m++) {
       _info[m - 1] = (double)smileDsp_specScaleTransfInv(filterCfs[m], specScale_, param_);
     }
-    writer_->setFieldInfo(-1, DATATYPE_SPECTRUM_BANDS_MAG, _info, nBands * sizeof(double));
+    setBandInfo(_info, nBands * sizeof(double));
     for (m=0; m<nBands; m++) {
       double fc = smileDsp_specScaleTransfInv(filterCfs[m], specScale_, param_);
       double ERB7 = a*fc*fc + b* fc + c + 700.0;
@@ -352,7 +363,7 @@ int cMelspec::computeFilters( long blocksize, double frameSizeSec, int idxc )
     for (int m = 0; m < nBands; m++) {
       _info[m] = (double)smileDsp_specScaleTransfInv(filterCfs[m], specScale_, param_);
     }
-    writer_->setFieldInfo(-1, DATATYPE_SPECTRUM_BANDS_MAG, _info, nBands * sizeof(double));
+    setBandInfo(_info, nBands * sizeof(double));
     // computes filters for each band:
     for (int m = 0; m < nBands; m++) {
       double fc = smileDsp_specScaleTransfInv(filterCfs[m], specScale_, param_);
@@ -403,13 +414,13 @@ int cMelspec::computeFilters( long blocksize, double frameSizeSec, int idxc )
       for (m=0; m < blocksize; m++) {
         _info[m] = m * F0;
       }
-      writer_->setFieldInfo(-1, DATATYPE_SPECTRUM_BANDS_MAG, _info, blocksize * sizeof(double));
+      setBandInfo(_info, blocksize * sizeof(double));
     } else {
       double *_info = (double*)malloc(sizeof(double) * nBands);
       for (m=1; m <= nBands; m++) {
         _info[m-1] = (double)smileDsp_specScaleTransfInv(filterCfs[m], specScale_, param_);
       }
-      writer_->setFieldInfo(-1, DATATYPE_SPECTRUM_BANDS_MAG, _info, nBands * sizeof(double));
+      setBandInfo(_info, nBands * sizeof(double));
     }
     if (showFbank) {
       SMILE_IMSG(1, "Band -1 (left bound) : center = %f Hz",
@@ -451,9 +462,191 @@ int cMelspec::computeFilters( long blocksize, double frameSizeSec, int idxc )
   filterCoeffs_[idxc] = filterCoeffs;
   filterCfs_[idxc] = filterCfs;
   chanMap_[idxc] = chanMap;
+  if (!inverse_) buildSparseFilterbank(blocksize, idxc);
   return 0;
 }
 
+void cMelspec::setBandInfo(double *info, long infoSize)
+{
+  writer_->setFieldInfo(-1, DATATYPE_SPECTRUM_BANDS_MAG, info, infoSize);
+}
+
+void cMelspec::buildSparseFilterbank(long blocksize, int idxc)
+{
+  const FLOAT_DMEM *filterCoeffs = filterCoeffs_[idxc];
+  const long *chanMap = chanMap_[idxc];
+  long nLoF = nLoF_[idxc], nHiF = nHiF_[idxc];
+  long nBands = nBands_;
+  long m, n;
+
+  // count the non-zero weights of each band
+  long *start = (long *)calloc(1, sizeof(long) * nBands * 4);
+  long *nCompl = start + nBands, *len = start + 2*nBands, *offset = start + 3*nBands;
+  for (m=0; m<nBands; m++) start[m] = -1;
+  if (hfcc_ || customBandwidth_) {
+    for (m=0; m<nBands; m++) {
+      long n1 = MAX(chanMap[m*2], nLoF);
+      long n2 = MIN(chanMap[m*2+1] + 1, nHiF);
+      start[m] = n1;
+      len[m] = MAX(n2 - n1, 0);
+    }
+  } else {
+    // bin n contributes x*c[n] to band chanMap[n] and x - x*c[n] to band chanMap[n]+1,
+    // chanMap is non-decreasing, so each band covers a contiguous range of bins
+    for (n=nLoF; n<nHiF; n++) {
+      m = chanMap[n];
+      if (m > -2) {
+        if (m > -1) {
+          if (start[m] < 0) start[m] = n;
+          len[m]++;
+        }
+        if (m < nBands-1) {
+          if (start[m+1] < 0) start[m+1] = n;
+          len[m+1]++;
+          nCompl[m+1]++;
+        }
+      }
+    }
+  }
+  long nW = 0;
+  for (m=0; m<nBands; m++) {
+    if (start[m] < 0) start[m] = 0;
+    offset[m] = nW;
+    nW += len[m];
+  }
+
+  // a single memory block, so that it can be freed with multiConfFree
+  size_t idxSize = sizeof(long) * nBands * 4;
+  char *blk = (char *)calloc(1, sizeof(sMelFilterbank) + idxSize + sizeof(FLOAT_DMEM) * MAX(nW, 1));
+  if (blk == NULL) OUT_OF_MEMORY;
+  sMelFilterbank *fb = (sMelFilterbank *)blk;
+  fb->nBands = nBands;
+  fb->start = (long *)(blk + sizeof(sMelFilterbank));
+  fb->nCompl = fb->start + nBands;
+  fb->len = fb->start + 2*nBands;
+  fb->offset = fb->start + 3*nBands;
+  fb->w = (FLOAT_DMEM *)(blk + sizeof(sMelFilterbank) + idxSize);
+  memcpy(fb->start, start, idxSize);
+  free(start);
+
+  // weights, in the order of the bins
+  if (hfcc_ || customBandwidth_) {
+    for (m=0; m<nBands; m++) {
+      for (n=0; n<fb->len[m]; n++) {
+        fb->w[fb->offset[m] + n] = filterCoeffs[m*blocksize + fb->start[m] + n];
+      }
+    }
+  } else {
+    for (n=nLoF; n<nHiF; n++) {
+      m = chanMap[n];
+      if (m > -2) {
+        if (m > -1) fb->w[fb->offset[m] + n - fb->start[m]] = filterCoeffs[n];
+        if (m < nBands-1) fb->w[fb->offset[m+1] + n - fb->start[m+1]] = filterCoeffs[n];
+      }
+    }
+  }
+  if (fbank_[idxc] != NULL) free(fbank_[idxc]);
+  fbank_[idxc] = fb;
+}
+
+void cMelspec::applyFilterbank(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, int idxc)
+{
+  const sMelFilterbank *fb = fbank_[idxc];
+  if (fb == NULL) {
+    memset(dst, 0, nBands_*sizeof(FLOAT_DMEM));
+    return;
+  }
+  long m, j;
+  for (m=0; m<fb->nBands; m++) {
+    const FLOAT_DMEM *x = src + fb->start[m];
+    const FLOAT_DMEM *w = fb->w + fb->offset[m];
+    long nCompl = fb->nCompl[m], len = fb->len[m];
+    FLOAT_DMEM acc = 0.0;
+    if (usePower_) {
+      for (j=0; j<nCompl; j++) { FLOAT_DMEM p = x[j]*x[j]; acc += p - p*w[j]; }
+      for (; j<len; j++) { FLOAT_DMEM p = x[j]*x[j]; acc += p*w[j]; }
+    } else {
+      for (j=0; j<nCompl; j++) { acc += x[j] - x[j]*w[j]; }
+      for (; j<len; j++) { acc += x[j]*w[j]; }
+    }
+    dst[m] = acc;
+  }
+  if (htkcompatible_) {
+    // HTK does not scale the input sample values to -1 / +1
+    // thus, we must multiply by the max 16bit sample value again.
+    FLOAT_DMEM scale = usePower_ ? (FLOAT_DMEM)(32767.0*32767.0) : (FLOAT_DMEM)32767.0;
+    for (m=0; m<fb->nBands; m++) {
+      dst[m] *= scale;
+    }
+  }
+}
+
+void cMelspec::applyFilterbankBatch(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, long nFrames, int idxc)
+{
+  long f = 0;
+#ifdef MELSPEC_SSE
+  const sMelFilterbank *fb = fbank_[idxc];
+  if (fb != NULL && nFrames >= 4) {
+    long m, j, n;
+    // range of bins used by the filterbank
+    long n0 = Nsrc, n1 = 0;
+    for (m=0; m<fb->nBands; m++) {
+      if (fb->len[m] > 0) {
+        n0 = MIN(n0, fb->start[m]);
+        n1 = MAX(n1, fb->start[m] + fb->len[m]);
+      }
+    }
+    if (batchBuf_ == NULL) batchBuf_ = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM) * 4 * Nsrc);
+    FLOAT_DMEM scale = (FLOAT_DMEM)1.0;
+    if (htkcompatible_) scale = usePower_ ? (FLOAT_DMEM)(32767.0*32767.0) : (FLOAT_DMEM)32767.0;
+    for (; f+4 <= nFrames; f += 4) {
+      // interleave the bins of 4 frames, one frame per vector lane
+      const FLOAT_DMEM *s0 = src + f*Nsrc;
+      for (n=n0; n<n1; n++) {
+        __m128 x = _mm_set_ps(s0[3*Nsrc+n], s0[2*Nsrc+n], s0[Nsrc+n], s0[n]);
+        if (usePower_) x = _mm_mul_ps(x, x);
+        _mm_storeu_ps(batchBuf_ + 4*n, x);
+      }
+      for (m=0; m<fb->nBands; m++) {
+        const FLOAT_DMEM *x = batchBuf_ + 4*fb->start[m];
+        const FLOAT_DMEM *w = fb->w + fb->offset[m];
+        long nCompl = fb->nCompl[m], len = fb->len[m];
+        __m128 acc = _mm_setzero_ps();
+        for (j=0; j<nCompl; j++) {
+          __m128 p = _mm_loadu_ps(x + 4*j);
+          acc = _mm_add_ps(acc, _mm_sub_ps(p, _mm_mul_ps(p, _mm_set1_ps(w[j]))));
+        }
+        for (; j<len; j++) {
+          acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(x + 4*j), _mm_set1_ps(w[j])));
+        }
+        if (htkcompatible_) acc = _mm_mul_ps(acc, _mm_set1_ps(scale));
+        float out[4];
+        _mm_storeu_ps(out, acc);
+        for (j=0; j<4; j++) {
+          dst[(f+j)*Ndst + m] = out[j];
+        }
+      }
+    }
+  }
+#endif
+  for (; f<nFrames; f++) {
+    applyFilterbank(src + f*Nsrc, dst + f*Ndst, Nsrc, idxc);
+  }
+}
+
+eTickResult cMelspec::myTick(long long t)
+{
+  if (inverse_) return cVectorProcessor::myTick(t);
+  return tickBatched(t, MAX(batchFrames_, blocksizeR_));
+}
+
+int cMelspec::processVectorBatch(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, long nFrames)
+{
+  if (inverse_) return 0;
+  applyFilterbankBatch(src, dst, Nsrc, Ndst, nFrames, getFconf(0));
+  return 1;
+}
+
 int cMelspec::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi) // idxi=input field index
 {
   int m,n;
@@ -516,58 +709,7 @@ int cMelspec::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, l
     if ((htkcompatible_)&&(_src!=NULL)) free((void *)_src);
 
   } else {
-    // copy & square the fft magnitude
-    if (usePower_) {
-      _src = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*Nsrc);
-      if (src==NULL) OUT_OF_MEMORY;
-      for (n=0; n<Nsrc; n++) {
-        _src[n] = src[n]*src[n];
-      }
-      src = _src;
-    }
-
-    // do the mel filtering by multiplying with the filters and summing up
-    memset(dst, 0, Ndst*sizeof(FLOAT_DMEM));
-
-    if (hfcc_ || customBandwidth_) {
-      // TODO: perform alternate (less optimised) multiplication for custom bandwidth methods.
-      for (m=0; m<nBands_; m++) {
-        long n1, n2;
-        n1 = _chanMap[m*2];
-        n2 = _chanMap[m*2+1];
-        for (n=MAX(n1,nLoF_[idxi]); (n<=n2)&&(n<nHiF_[idxi]); n++) {
-          dst[m] += (FLOAT_DMEM)( (double)src[n] * (double)_filterCoeffs[m*Nsrc+n] );
-        }
-      }
-
-    } else {
-      double a;
-      for (n=nLoF_[idxi]; n<nHiF_[idxi]; n++) {
-        m = _chanMap[n];
-        a = (double)src[n] * (double)_filterCoeffs[n];
-        if (m>-2) {
-          if (m>-1) dst[m] += (FLOAT_DMEM)a;
-          if (m < nBands_-1)
-            dst[m+1] += src[n] - (FLOAT_DMEM)a;
-        }
-      }
-
-    }
-
-    if ((usePower_)&&(_src!=NULL)) free((void *)_src);
-
-    if (htkcompatible_) {
-      for (m=0; m<nBands_; m++) {
-        if (usePower_) {
-          dst[m] *= (FLOAT_DMEM)(32767.0*32767.0);
-        } else {
-          dst[m] *= (FLOAT_DMEM)32767.0;
-        }
-        // the above is for HTK compatibility....
-        // HTK does not scale the input sample values to -1 / +1
-        // thus, we must multiply by the max 16bit sample value again.
-      }
-    }
+    applyFilterbank(src, dst, Nsrc, idxi);
   }
   return 1;
 }
@@ -577,6 +719,9 @@ cMelspec::~cMelspec()
   multiConfFree(filterCoeffs_);
   multiConfFree(chanMap_);
   multiConfFree(filterCfs_);
+  multiConfFree(fbank_);
+  if (batchBuf_ != NULL)
+    free(batchBuf_);
   if (nLoF_ != NULL)
     free(nLoF_);
   if (nHiF_ != NULL) 
@@ -55,6 +55,7 @@ cMfcc::cMfcc(const char *_name) :
   cVectorProcessor(_name),
   costable(NULL),
   sintable(NULL),
+  work_(NULL), workN_(0),
   firstMfcc(1),
   lastMfcc(12),
   doLog_(1),
@@ -135,7 +136,6 @@ int cMfcc::setupNamesForField(int i, const char*name, long nEl)
 // blocksize is size of mspec block (=nBands)
 int cMfcc::initTables( long blocksize, int idxc )
 {
-  int i,m;
   FLOAT_DMEM *_costable = costable[idxc];
   FLOAT_DMEM *_sintable = sintable[idxc];
   
@@ -143,6 +143,29 @@ int cMfcc::initTables( long blocksize, int idxc )
   _costable = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*blocksize*nMfcc);
   if (_costable == NULL) OUT_OF_MEMORY;
 
+  if (_sintable != NULL) free(_sintable);
+  _sintable = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*nMfcc);
+  if (_sintable == NULL) OUT_OF_MEMORY;
+
+  computeDctTables(_costable, _sintable, blocksize, firstMfcc, lastMfcc, cepLifter);
+  costable[idxc] = _costable;
+  sintable[idxc] = _sintable;
+
+  // work buffer for processVector (mel bands, or cepstral coefficients for the inverse transform)
+  long nWork = MAX(blocksize, (long)nMfcc);
+  if (nWork > workN_) {
+    if (work_ != NULL) free(work_);
+    work_ = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*nWork);
+    if (work_ == NULL) OUT_OF_MEMORY;
+    workN_ = nWork;
+  }
+  return 1;
+}
+
+void cMfcc::computeDctTables(FLOAT_DMEM *_costable, FLOAT_DMEM *_sintable, long blocksize,
+    int firstMfcc, int lastMfcc, FLOAT_DMEM cepLifter)
+{
+  int i,m;
   double fnM = (double)(blocksize);
   for (i=firstMfcc; i <= lastMfcc; i++) {
     double fi = (double)i;
@@ -151,10 +174,6 @@ int cMfcc::initTables( long blocksize, int idxc )
     }
   }
 
-  if (_sintable != NULL) free(_sintable);
-  _sintable = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM)*nMfcc);
-  if (_sintable == NULL) OUT_OF_MEMORY;
-
   if (cepLifter > 0.0) {
     for (i=firstMfcc; i <= lastMfcc; i++) {
       _sintable[i-firstMfcc] = ((FLOAT_DMEM)1.0 + cepLifter/(FLOAT_DMEM)2.0 * sin((FLOAT_DMEM)M_PI*((FLOAT_DMEM)(i))/cepLifter));
@@ -164,9 +183,44 @@ int cMfcc::initTables( long blocksize, int idxc )
       _sintable[i-firstMfcc] = 1.0;
     }
   }
-  costable[idxc] = _costable;
-  sintable[idxc] = _sintable;
-  return 1;
+}
+
+// log of the mel spectrum, DCT and cepstral liftering (forward transform), shared with cMelMfcc
+void cMfcc::computeMfcc(const FLOAT_DMEM *src, FLOAT_DMEM *dst, FLOAT_DMEM *_src, long Nsrc,
+    const FLOAT_DMEM *_costable, const FLOAT_DMEM *_sintable, int firstMfcc, int lastMfcc,
+    int doLog, FLOAT_DMEM melfloor, int htkcompatible)
+{
+  int i,m;
+
+  // compute log mel spectrum
+  if (doLog) {
+    for (i = 0; i < Nsrc; i++) {
+      if (src[i] < melfloor) _src[i] = log(melfloor);
+      else _src[i] = (FLOAT_DMEM)log(src[i]);
+    }
+  } else {
+    for (i = 0; i < Nsrc; i++) {
+      _src[i] = (FLOAT_DMEM)src[i];
+    }
+  }
+
+  // compute dct of mel data & do cepstral liftering:
+  FLOAT_DMEM factor = (FLOAT_DMEM)sqrt((double)2.0/(double)(Nsrc));
+  for (i=firstMfcc; i <= lastMfcc; i++) {
+    int i0 = i-firstMfcc;
+    FLOAT_DMEM * outc = dst+i0;  // = outp + (i-obj->firstMFCC);
+    if (htkcompatible && (firstMfcc==0)) {
+      if (i==lastMfcc) { i0 = 0; }
+      else { i0 += 1; }
+    }
+    *outc = 0.0;
+    for (m=0; m<Nsrc; m++) {
+      *outc += _src[m] * _costable[m + i0*Nsrc];
+    }
+    //*outc *= factor;   // use this line, if you want unliftered mfcc
+    // do cepstral liftering:
+    *outc *= _sintable[i0] * factor;
+  }
 }
 
 // idxi=input field index
@@ -177,9 +231,7 @@ int cMfcc::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long
   FLOAT_DMEM *_costable = costable[idxi];
   FLOAT_DMEM *_sintable = sintable[idxi];
 
-  FLOAT_DMEM *_src;
-  _src = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*Nsrc);
-  if (_src==NULL) OUT_OF_MEMORY;
+  FLOAT_DMEM *_src = work_;
   
   if (inverse) {
     FLOAT_DMEM factor = (FLOAT_DMEM)sqrt((double)2.0/(double)(nBands));
@@ -234,49 +286,23 @@ int cMfcc::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long
       }
     } 
   } else {
-
-  // compute log mel spectrum
-  if (doLog_) {
-    for (i = 0; i < Nsrc; i++) {
-      if (src[i] < melfloor) _src[i] = log(melfloor);
-      else _src[i] = (FLOAT_DMEM)log(src[i]);
-    }
-  } else {
-    for (i = 0; i < Nsrc; i++) {
-      _src[i] = (FLOAT_DMEM)src[i];
-    }
-  }
-
-  // compute dct of mel data & do cepstral liftering:
-  FLOAT_DMEM factor = (FLOAT_DMEM)sqrt((double)2.0/(double)(Nsrc));
-  for (i=firstMfcc; i <= lastMfcc; i++) {
-    int i0 = i-firstMfcc;
-    FLOAT_DMEM * outc = dst+i0;  // = outp + (i-obj->firstMFCC);
-    if (htkcompatible && (firstMfcc==0)) {
-      if (i==lastMfcc) { i0 = 0; }
-      else { i0 += 1; }
-    }
-    *outc = 0.0;
-    for (m=0; m<Nsrc; m++) {
-      *outc += _src[m] * _costable[m + i0*Nsrc];
-    }
+    computeMfcc(src, dst, _src, Nsrc, _costable, _sintable, firstMfcc, lastMfcc, doLog_, melfloor, htkcompatible);
     if (printDctBaseFunctions) {
-      printf("base_mfcc_%i = [", i);
-      for (m=0; m<Nsrc-1; m++) {
-        printf("%e ", _costable[m + i0*Nsrc]);
+      for (i=firstMfcc; i <= lastMfcc; i++) {
+        int i0 = i-firstMfcc;
+        if (htkcompatible && (firstMfcc==0)) {
+          if (i==lastMfcc) { i0 = 0; }
+          else { i0 += 1; }
+        }
+        printf("base_mfcc_%i = [", i);
+        for (m=0; m<Nsrc-1; m++) {
+          printf("%e ", _costable[m + i0*Nsrc]);
+        }
+        printf("%e];\n", _costable[m + i0*Nsrc]);
       }
-      printf("%e];\n", _costable[m + i0*Nsrc]);
-    }
-    //*outc *= factor;   // use this line, if you want unliftered mfcc
-    // do cepstral liftering:
-    *outc *= _sintable[i0] * factor;
-  }
-  if (printDctBaseFunctions) {
       printDctBaseFunctions = 0;
+    }
   }
-
-  }
-  free(_src);
   return 1;
 }
 
@@ -284,5 +310,6 @@ cMfcc::~cMfcc()
 {
   multiConfFree(costable);
   multiConfFree(sintable);
+  if (work_ != NULL) free(work_);
 }
 
@@ -14,6 +14,11 @@ computed spectral features such as flux, roll-off, centroid, etc.
 #include <lldcore/spectral.hpp>
 #include <math.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPECTRAL_SSE2
+#endif
+
 #define MODULE "cSpectral"
 
 
@@ -74,19 +79,17 @@ cSpectral::cSpectral(const char *_name) :
   bandsL(NULL), bandsH(NULL), 
   slopesL(NULL), slopesH(NULL),
   rollOff(NULL),
-  bandsLi(NULL), bandsHi(NULL),
-  wghtLi(NULL), wghtHi(NULL),
-  slopeBandsLi(NULL), slopeBandsHi(NULL),
-  slopeWghtLi(NULL), slopeWghtHi(NULL),
   fsSec(-1.0), frq(NULL), frqScale(-1), frqScaleParam(0.0),
   buggyRollOff(0), buggySlopeScale(0),
   specRangeLower(0), specRangeUpper(0),
   specRangeLowerBin(-1), specRangeUpperBin(-1),
   specFloor((FLOAT_DMEM)(0.0000001 * 0.0000001)),
   useLogSpectrum(0), logFlatness(0),
-  requireMagSpec(true), requireLogSpec(true), requirePowerSpec(true),
+  requireMagSpec(false), requireLogSpec(false), requirePowerSpec(false),
   prevSpec(NULL), nSrcPrevSpec(NULL), nFieldsPrevSpec(0),
-  sharpnessWeights(NULL)
+  sharpnessWeights(NULL),
+  fieldTables(NULL), workNsrc(0),
+  specM(NULL), specP(NULL), specL(NULL), cumP(NULL)
 {
   logSpecFloor = (FLOAT_DMEM)(10.0 * log(specFloor) / log (10.0));
 }
@@ -249,11 +252,11 @@ void cSpectral::myFetchConfig()
     requireMagSpec = true;
   }
   fluxCentroid = getInt("fluxCentroid");
-  if (flux) {
+  if (fluxCentroid) {
     requireMagSpec = true;
   }
   fluxAtFluxCentroid = getInt("fluxAtFluxCentroid");
-  if (flux) {
+  if (fluxAtFluxCentroid) {
     requireMagSpec = true;
   }
   /*
@@ -372,6 +375,10 @@ void cSpectral::myFetchConfig()
   if (logFlatness) {
     SMILE_IDBG(2, "output of log flatness (=ln(flatness)) is enabled");
   }
+  // the frame energy is computed from the power spectrum, and so is the log spectrum
+  if (normBandEnergies || requireLogSpec) {
+    requirePowerSpec = true;
+  }
 }
 
 
@@ -582,6 +589,333 @@ int cSpectral::setupNamesForField(int i, const char*name, long nEl)
   return newNEl;
 }
 
+static void freeSpectralTables(sSpectralTables *t)
+{
+  if (t->bandIL != NULL) free(t->bandIL);
+  if (t->bandIR != NULL) free(t->bandIR);
+  if (t->bandWL != NULL) free(t->bandWL);
+  if (t->bandWR != NULL) free(t->bandWR);
+  if (t->slopeIL != NULL) free(t->slopeIL);
+  if (t->slopeIR != NULL) free(t->slopeIR);
+  if (t->slopeWL != NULL) free(t->slopeWL);
+  if (t->slopeWR != NULL) free(t->slopeWR);
+  if (t->slopeSf != NULL) free(t->slopeSf);
+  if (t->slopeS2f != NULL) free(t->slopeS2f);
+  if (t->slopeNind != NULL) free(t->slopeNind);
+  if (t->centroidFrq != NULL) free(t->centroidFrq);
+  if (t->momentFrq != NULL) free(t->momentFrq);
+  if (t->fluxFrq != NULL) free(t->fluxFrq);
+  if (t->ratioFrq != NULL) free(t->ratioFrq);
+  free(t);
+}
+
+// returns the tables of input field idxi with Nsrc bins: the bin ranges of the bands and slope bands,
+// the frequency sums of the slopes and the frequency axis tables of the other descriptors (the frequency
+// axis of the first field is used for all fields, as before), which are computed on the first call for
+// the field; (re-)allocates the work buffers if the field has more bins than the fields before
+const sSpectralTables * cSpectral::prepareTables(long Nsrc, int idxi)
+{
+  long i;
+  double F0 = 1.0/fsSec;
+  long nBins = specRangeUpperBin - specRangeLowerBin + 1;
+
+  if (fieldTables == NULL) {
+    fieldTables = (sSpectralTables**)calloc(1, sizeof(sSpectralTables*) * nFieldsPrevSpec);
+  }
+  sSpectralTables *t = fieldTables[idxi];
+  if (t != NULL && t->Nsrc == Nsrc) return t;
+  if (t != NULL) freeSpectralTables(t);
+  t = (sSpectralTables*)calloc(1, sizeof(sSpectralTables));
+  t->Nsrc = Nsrc;
+  fieldTables[idxi] = t;
+
+  bool haveFrq = (nScale >= Nsrc) && (frq != NULL);
+  bool haveFrqRange = (nScale > specRangeUpperBin) && (frq != NULL);
+
+  // band and slope band ranges (bins) and weights of the boundary bins
+  // NOTE: bands and slopes can be outside of the specRange parameter!
+  if (nBands > 0) {
+    t->bandIL = (long*)calloc(1, sizeof(long)*nBands);
+    t->bandIR = (long*)calloc(1, sizeof(long)*nBands);
+    t->bandWL = (double*)calloc(1, sizeof(double)*nBands);
+    t->bandWR = (double*)calloc(1, sizeof(double)*nBands);
+  }
+  if (nSlopes > 0) {
+    t->slopeIL = (long*)calloc(1, sizeof(long)*nSlopes);
+    t->slopeIR = (long*)calloc(1, sizeof(long)*nSlopes);
+    t->slopeWL = (double*)calloc(1, sizeof(double)*nSlopes);
+    t->slopeWR = (double*)calloc(1, sizeof(double)*nSlopes);
+    t->slopeSf = (double*)calloc(1, sizeof(double)*nSlopes);
+    t->slopeS2f = (double*)calloc(1, sizeof(double)*nSlopes);
+    t->slopeNind = (double*)calloc(1, sizeof(double)*nSlopes);
+  }
+  for (i = 0; i < nBands + nSlopes; i++) {
+    bool isSlope = (i >= nBands);
+    long bL = isSlope ? slopesL[i - nBands] : bandsL[i];
+    long bH = isSlope ? slopesH[i - nBands] : bandsH[i];
+    if (!isBandValid(bL, bH)) continue;
+    double idxL, wghtL, idxR, wghtR;
+    if ((nScale < Nsrc) || (frq == NULL)) {
+      idxL = (double)bL / F0;
+      wghtL = ceil(idxL) - idxL;
+      idxR = (double)bH / F0;
+      wghtR = idxR - floor(idxR);
+    } else { // map the frequencies to fft bin indices
+      long ii;
+      for (ii = 0; ii < nScale; ii++) {
+        if (frq[ii] > (double)bL) break;
+      }
+      if ((ii < nScale) && (ii > 0)) {
+        wghtL = (frq[ii] - (double)bL) / (frq[ii] - frq[ii-1]);
+      } else { wghtL = 1.0; }
+      idxL = (double)ii - 1.0;
+      if (idxL < 0) idxL = 0;
+      if (idxL >= Nsrc) idxL = Nsrc;
+      for (ii = 0; ii < nScale; ii++) {
+        if (frq[ii] >= (FLOAT_DMEM)bH) break;
+      }
+      if ((ii < nScale) && (ii > 0)) {
+        wghtR = ((double)bH - frq[ii-1]) / (frq[ii] - frq[ii-1]);
+      } else { wghtR = 1.0; }
+      if ((ii < nScale) && (frq[ii] == (FLOAT_DMEM)bH)) {
+        idxR = (double)ii;
+      } else {
+        idxR = (double)ii - 1.0;
+      }
+      if (idxR >= Nsrc) idxR = Nsrc - 1;
+    }
+    if (wghtL == 0.0) wghtL = 1.0;
+    if (wghtR == 0.0) wghtR = 1.0;
+    // TODO: interpolation instead of rounding boundaries to next lower bin and next higher bin
+    // TODO: spectral band filter shapes...
+    // TODO: debug output of actual filter bandwidth & range based on rounded (or interpolated) boundaries!
+    long iL = (long)floor(idxL);
+    long iR = (long)floor(idxR);
+    if (iL >= Nsrc) { iL = iR = Nsrc-1; wghtR = 0.0; wghtL = 0.0; }
+    if (iR >= Nsrc) { iR = Nsrc-1; wghtR = 1.0; }
+    if (iL < 0) iL = 0;
+    if (iR < 0) iR = 0;
+    if (!isSlope) {
+      t->bandIL[i] = iL; t->bandIR[i] = iR;
+      t->bandWL[i] = wghtL; t->bandWR[i] = wghtR;
+    } else {
+      // the frequency sums of the slope regression do not depend on the spectrum
+      long s = i - nBands;
+      double Sf, S2f;
+      long ii;
+      if ((nScale >= Nsrc && nScale > 0) && (frq != NULL)) {
+        Sf = (double)frq[iL] * wghtL;
+        S2f = Sf * Sf;
+        for (ii = iL + 1; ii < iR && ii < nScale; ii++) {
+          S2f += (double)frq[ii] * (double)frq[ii];
+          Sf += (double)frq[ii];
+        }
+        S2f += (double)frq[iR] * wghtR * (double)frq[iR] * wghtR;
+        Sf += (double)frq[iR] * wghtR;
+      } else {
+        Sf = (double)iL * wghtL;
+        S2f = Sf * Sf;
+        for (ii = iL + 1; ii < iR && ii < nScale; ii++) {
+          S2f += (double)ii * (double)ii;
+          Sf += (double)ii;
+        }
+        S2f += (double)iR * wghtR * (double)iR * wghtR;
+        Sf += (double)iR * wghtR;
+        S2f *= F0 * F0;
+        Sf *= F0;
+      }
+      t->slopeIL[s] = iL; t->slopeIR[s] = iR;
+      t->slopeWL[s] = wghtL; t->slopeWR[s] = wghtR;
+      t->slopeSf[s] = Sf; t->slopeS2f[s] = S2f;
+      t->slopeNind[s] = idxR - idxL;
+    }
+  }
+
+  // frequency sums of the spectral slope over the full range
+  if (slope) {
+    double Nind = (double)nBins;
+    if ((nScale >= Nsrc && nScale > 0) && (frq != NULL)) {
+      for (i = specRangeLowerBin; i <= specRangeUpperBin && i < nScale; i++) {
+        t->slopeS2fAll += (double)frq[i] * (double)frq[i];
+        t->slopeSfAll += (double)frq[i];
+      }
+    } else {
+      double NNm1 = Nind * (Nind - 1.0);
+      t->slopeSfAll = NNm1 / (double)2.0 * F0;  // sum of all i=0..N-1
+      t->slopeS2fAll = NNm1 * ((double)2.0 * Nind - (double)1.0) / (double)6.0 * F0 * F0; // sum of all i^2 for i=0..N-1
+    }
+  }
+
+  // bin frequencies in the spectral range (each descriptor uses the frequency axis
+  // from the meta data under slightly different conditions, the tables preserve this)
+  if (nBins > 0) {
+    t->centroidFrq = (double*)malloc(sizeof(double) * (nBins + 3));
+    t->momentFrq = (double*)malloc(sizeof(double) * (nBins + 3));
+    t->fluxFrq = (double*)malloc(sizeof(double) * (nBins + 3));
+    double f = 0.0;
+    for (i = specRangeLowerBin; i <= specRangeUpperBin; i++) {
+      long k = i - specRangeLowerBin;
+      if (haveFrq || haveFrqRange) {
+        t->centroidFrq[k] = frq[i];
+      } else {
+        t->centroidFrq[k] = f;  // NOTE: starts at 0 Hz for the first bin of the range
+        f += F0;
+      }
+      t->momentFrq[k] = haveFrq ? frq[i] : (double)i * F0;
+      t->fluxFrq[k] = haveFrqRange ? frq[i] : (double)i * F0;
+    }
+  }
+  // bin frequencies of the full spectrum for alpha ratio and hammarberg index
+  if (alphaRatio || hammarbergIndex) {
+    t->ratioFrq = (double*)malloc(sizeof(double) * Nsrc);
+    double f = 0.0;
+    for (i = 0; i < Nsrc; i++) {
+      if (haveFrq) {
+        t->ratioFrq[i] = frq[i];
+      } else {
+        t->ratioFrq[i] = f;
+        f += F0;
+      }
+    }
+  }
+
+  if (cumP == NULL && nBins > 0) {
+    cumP = (double*)malloc(sizeof(double) * (nBins + 1));
+  }
+  if (Nsrc > workNsrc) {
+    if (specM != NULL) free(specM);
+    if (specP != NULL) free(specP);
+    if (specL != NULL) free(specL);
+    specM = specP = specL = NULL;
+    // 3 extra elements, so the SIMD kernels may load a full block of 4 at the end
+    if (requireMagSpec && !squareInput) specM = (FLOAT_DMEM*)calloc(1, sizeof(FLOAT_DMEM) * (Nsrc + 3));
+    if (requirePowerSpec && squareInput) specP = (FLOAT_DMEM*)calloc(1, sizeof(FLOAT_DMEM) * (Nsrc + 3));
+    if (requireLogSpec) specL = (FLOAT_DMEM*)calloc(1, sizeof(FLOAT_DMEM) * (Nsrc + 3));
+    workNsrc = Nsrc;
+  }
+  return t;
+}
+
+// sum of x and of f*x (double accumulation), 4 bins at a time with SSE2
+static void spectralSums(const FLOAT_DMEM *x, const double *f, long N, double *sx, double *sfx)
+{
+  long i = 0;
+  double s = 0.0, sf = 0.0;
+#ifdef SPECTRAL_SSE2
+  __m128d s0 = _mm_setzero_pd(), s1 = _mm_setzero_pd();
+  __m128d sf0 = _mm_setzero_pd(), sf1 = _mm_setzero_pd();
+  for (; i + 4 <= N; i += 4) {
+    __m128 v = _mm_loadu_ps(x + i);
+    __m128d v0 = _mm_cvtps_pd(v);
+    __m128d v1 = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+    s0 = _mm_add_pd(s0, v0);
+    s1 = _mm_add_pd(s1, v1);
+    sf0 = _mm_add_pd(sf0, _mm_mul_pd(_mm_loadu_pd(f + i), v0));
+    sf1 = _mm_add_pd(sf1, _mm_mul_pd(_mm_loadu_pd(f + i + 2), v1));
+  }
+  double t[2];
+  _mm_storeu_pd(t, _mm_add_pd(s0, s1));
+  s = t[0] + t[1];
+  _mm_storeu_pd(t, _mm_add_pd(sf0, sf1));
+  sf = t[0] + t[1];
+#endif
+  for (; i < N; i++) {
+    s += (double)x[i];
+    sf += f[i] * (double)x[i];
+  }
+  *sx = s;
+  *sfx = sf;
+}
+
+// sums of d^2, max(d,0)^2 and f*d^2 for the differences d = x - y of two spectra
+static void spectralDiffSums(const FLOAT_DMEM *x, const FLOAT_DMEM *y, const double *f, long N,
+    double *sd, double *spd, double *sfd)
+{
+  long i = 0;
+  double d2 = 0.0, pd2 = 0.0, fd2 = 0.0;
+#ifdef SPECTRAL_SSE2
+  const __m128d zero = _mm_setzero_pd();
+  __m128d a0 = zero, a1 = zero, p0 = zero, p1 = zero, f0 = zero, f1 = zero;
+  for (; i + 4 <= N; i += 4) {
+    __m128 vx = _mm_loadu_ps(x + i);
+    __m128 vy = _mm_loadu_ps(y + i);
+    __m128d d0 = _mm_sub_pd(_mm_cvtps_pd(vx), _mm_cvtps_pd(vy));
+    __m128d d1 = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(vx, vx)), _mm_cvtps_pd(_mm_movehl_ps(vy, vy)));
+    __m128d q0 = _mm_mul_pd(d0, d0);
+    __m128d q1 = _mm_mul_pd(d1, d1);
+    __m128d e0 = _mm_max_pd(d0, zero);
+    __m128d e1 = _mm_max_pd(d1, zero);
+    a0 = _mm_add_pd(a0, q0);
+    a1 = _mm_add_pd(a1, q1);
+    p0 = _mm_add_pd(p0, _mm_mul_pd(e0, e0));
+    p1 = _mm_add_pd(p1, _mm_mul_pd(e1, e1));
+    f0 = _mm_add_pd(f0, _mm_mul_pd(q0, _mm_loadu_pd(f + i)));
+    f1 = _mm_add_pd(f1, _mm_mul_pd(q1, _mm_loadu_pd(f + i + 2)));
+  }
+  double t[2];
+  _mm_storeu_pd(t, _mm_add_pd(a0, a1));
+  d2 = t[0] + t[1];
+  _mm_storeu_pd(t, _mm_add_pd(p0, p1));
+  pd2 = t[0] + t[1];
+  _mm_storeu_pd(t, _mm_add_pd(f0, f1));
+  fd2 = t[0] + t[1];
+#endif
+  for (; i < N; i++) {
+    double d = (double)x[i] - (double)y[i];
+    d2 += d*d;
+    if (d > 0.0) pd2 += d*d;
+    fd2 += d*d * f[i];
+  }
+  *sd = d2;
+  *spd = pd2;
+  *sfd = fd2;
+}
+
+// 2nd, 3rd and 4th moment of the frequencies f weighted by x around u
+static void spectralMoments(const FLOAT_DMEM *x, const double *f, double u, long N,
+    double *m2, double *m3, double *m4)
+{
+  long i = 0;
+  double s2 = 0.0, s3 = 0.0, s4 = 0.0;
+#ifdef SPECTRAL_SSE2
+  const __m128d vu = _mm_set1_pd(u);
+  __m128d a2 = _mm_setzero_pd(), b2 = a2, a3 = a2, b3 = a2, a4 = a2, b4 = a2;
+  for (; i + 4 <= N; i += 4) {
+    __m128 v = _mm_loadu_ps(x + i);
+    __m128d t0 = _mm_sub_pd(_mm_loadu_pd(f + i), vu);
+    __m128d t1 = _mm_sub_pd(_mm_loadu_pd(f + i + 2), vu);
+    __m128d m0 = _mm_mul_pd(_mm_mul_pd(t0, t0), _mm_cvtps_pd(v));
+    __m128d m1 = _mm_mul_pd(_mm_mul_pd(t1, t1), _mm_cvtps_pd(_mm_movehl_ps(v, v)));
+    a2 = _mm_add_pd(a2, m0);
+    b2 = _mm_add_pd(b2, m1);
+    m0 = _mm_mul_pd(m0, t0);
+    m1 = _mm_mul_pd(m1, t1);
+    a3 = _mm_add_pd(a3, m0);
+    b3 = _mm_add_pd(b3, m1);
+    a4 = _mm_add_pd(a4, _mm_mul_pd(m0, t0));
+    b4 = _mm_add_pd(b4, _mm_mul_pd(m1, t1));
+  }
+  double t[2];
+  _mm_storeu_pd(t, _mm_add_pd(a2, b2));
+  s2 = t[0] + t[1];
+  _mm_storeu_pd(t, _mm_add_pd(a3, b3));
+  s3 = t[0] + t[1];
+  _mm_storeu_pd(t, _mm_add_pd(a4, b4));
+  s4 = t[0] + t[1];
+#endif
+  for (; i < N; i++) {
+    double t1 = f[i] - u;
+    double m = t1*t1 * (double)x[i];
+    s2 += m;
+    m *= t1;
+    s3 += m;
+    s4 += m*t1;
+  }
+  *m2 = s2;
+  *m3 = s3;
+  *m4 = s4;
+}
+
 // a derived class should override this method, in order to implement the actual processing
 int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc, long Ndst, int idxi) // idxi=input field index
 {
@@ -589,7 +923,6 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
   long i = 0;
   long j = 0;
 
-  double N = (double) ((Nsrc-1)*2);  // assumes FFT magnitude input array!!
   double F0 = 1.0/fsSec;
 
   if (frq == NULL) { // input block's frequency axis
@@ -645,17 +978,19 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
     SMILE_IMSG(3, "specRangeLower (Hz) = %i (bin = %i) ; specRangeUpper (Hz) = %i (bin = %i)",
         specRangeLower, specRangeLowerBin, specRangeUpper, specRangeUpperBin);
   }
-  long nBins = specRangeUpperBin - specRangeLowerBin + 1;
+  const long lo = specRangeLowerBin;
+  const long hi = specRangeUpperBin;
+  long nBins = hi - lo + 1;
 
   if (Nsrc <= 0) {
     return 0;
   }
+  const sSpectralTables *tb = prepareTables(Nsrc, idxi);
 
   const FLOAT_DMEM *srcM = NULL; // magnitude spectrum
   const FLOAT_DMEM *srcL = NULL; // log spectrum
   const FLOAT_DMEM *srcP = NULL; // power spectrum
   const FLOAT_DMEM *srcLP = NULL; // log or power spectrum
-  FLOAT_DMEM logSpecFactor = 1.0;
   // TODO: we might get lof spectral densities as input
   //        read the input type field and support all possible conversions!
   if (requireMagSpec) {
@@ -663,56 +998,38 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
       srcM = src;
     } else {
       // compute linear from squared
-      FLOAT_DMEM *srcTmp = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM) * Nsrc);
       for (i = 0; i < Nsrc; i++) {
         if (src[i] > 0.0) {
-          srcTmp[i] = sqrt(src[i]);
+          specM[i] = sqrt(src[i]);
         } else {
-          srcTmp[i] = 0.0;
+          specM[i] = 0.0;
         }
       }
-      srcM = srcTmp;
+      srcM = specM;
     }
   }
   if (requirePowerSpec) {
     if (squareInput) {
       // compute squared from linear
-      FLOAT_DMEM *srcTmp = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM) * Nsrc);
       for (i = 0; i < Nsrc; i++) {
-        srcTmp[i] = src[i] * src[i];
+        specP[i] = src[i] * src[i];
       }
-      srcP = srcTmp;
+      srcP = specP;
     } else {
       srcP = src;
     }
   }
   if (requireLogSpec) {
-    logSpecFactor = (FLOAT_DMEM)(10.0 / log(10.0));
-    FLOAT_DMEM myLogSpecFactor = logSpecFactor;
-    const FLOAT_DMEM *mySrc = NULL;
-    if (requirePowerSpec) {
-      // compute the log spectrum from the power spectrum we already have
-      mySrc = srcP;
-    } else if (requireMagSpec) {
-      // compute the log spectrum from the magnitude spectrum instead
-      mySrc = srcM;
-      logSpecFactor *= 2.0;
-    } else {
-      // find out what we have to do...
-      mySrc = src;
-      if (squareInput) {
-        logSpecFactor *= 2.0;
-      }
-    }
-    FLOAT_DMEM *srcTmp = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM) * Nsrc);
+    // the log spectrum is computed from the power spectrum
+    FLOAT_DMEM logSpecFactor = (FLOAT_DMEM)(10.0 / log(10.0));
     for (i = 0; i < Nsrc; i++) {
-      if (mySrc[i] <= specFloor) {
-        srcTmp[i] = logSpecFloor;
+      if (srcP[i] <= specFloor) {
+        specL[i] = logSpecFloor;
       } else {
-        srcTmp[i] = myLogSpecFactor * log(mySrc[i]);
+        specL[i] = logSpecFactor * log(srcP[i]);
       }
     }
-    srcL = srcTmp;
+    srcL = specL;
   }
   if (useLogSpectrum) {
     srcLP = srcL;
@@ -720,132 +1037,38 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
     srcLP = srcP;
   }
 
-  /*
-  if (squareInput || useLogSpectrum) {
-    src2 = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*Nsrc);
-    // NOTE: bands and slopes can be outside of the specRange parameter!
-    // thus, we need to square all inputs!
-    if (useLogSpectrum) {
-      src3 = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM)*Nsrc);
-      logSpecFactor = 10.0 / log(10.0);
-      if (squareInput) {
-        logSpecFactor *= 2.0;
-        for (i = 0; i < Nsrc; i++) {
-          if (src[i] < specFloor) {
-            src2[i] = logSpecFloor;
-          } else {
-            src2[i] = logSpecFactor * log(src[i]);
-          }
-          src3[i] = src[i] * src[i];
-        }
-      } else {
-        for (i = 0; i < Nsrc; i++) {
-          if (src[i] < specFloor) {
-            src2[i] = logSpecFloor;
-          } else {
-            src2[i] = logSpecFactor * log(src[i]);
-          }
-          src3[i] = src[i];
-        }
-      }
-    } else if (squareInput) {
-      for (i = 0; i < Nsrc; i++) {
-        src2[i] = src[i]*src[i];
-      }
-    }
-  } else {
-    srcP = (FLOAT_DMEM *)src;  // typecast ok here.. since we treat _src as read-only below...
-  }
-  */
-  
-  // compute total frame energy
+  // cumulative power spectrum over the spectral range, the last value is the total frame energy
+  // (the band energies and roll-off points are computed from the cumulative sums)
   double frameSum = 0.0;
-  if (normBandEnergies || sharpness || nRollOff > 0) {
-    for (i = specRangeLowerBin; i <= specRangeUpperBin; i++) {
-      frameSum += srcP[i];
+  bool haveCumP = false;
+  if ((normBandEnergies || sharpness || nRollOff > 0 || nBands > 0) && nBins > 0) {
+    double sum = 0.0;
+    cumP[0] = 0.0;
+    for (i = lo; i <= hi; i++) {
+      sum += srcP[i];
+      cumP[i - lo + 1] = sum;
     }
+    frameSum = sum;
+    haveCumP = true;
   }
 
   // process spectral bands (rectangular "filter")
-  // NOTE: bands and slopes can be outside of the specRange parameter!
   for (i=0; i<nBands; i++) {
     if (isBandValid(bandsL[i],bandsH[i])) {
-      double idxL;
-      double wghtL;
-      if ((nScale < Nsrc)||(frq==NULL)) {
-        idxL =  (double)bandsL[i] / F0 ;
-        wghtL =  ceil(idxL) - idxL;
-      } else {
-        if (bandsLi == NULL) { // map the frequency to an fft bin index
-          int ii,iii;
-          bandsLi=(double*)malloc(sizeof(double)*nBands);
-          wghtLi=(double*)malloc(sizeof(double)*nBands);
-          for (iii=0; iii<nBands; iii++) {
-            for (ii=0; ii<nScale; ii++) {
-              if (frq[ii] > (double)bandsL[iii]) break;
-            }
-            if ((ii<nScale)&&(ii>0)) {
-              wghtLi[iii] = (frq[ii]-(double)bandsL[iii])/(frq[ii] - frq[ii-1]);
-            } else { wghtLi[iii] = 1.0; }
-            
-            bandsLi[iii] = (double)ii-1.0;
-            if (bandsLi[iii] < 0) bandsLi[iii] = 0;
-            if (bandsLi[iii] >= Nsrc) bandsLi[iii] = Nsrc;
-          }
-        }
-        idxL = bandsLi[i];
-        wghtL = wghtLi[i];
-      }
-      if (wghtL == 0.0) wghtL = 1.0;
-
-      double idxR;
-      double wghtR ;
-      if ((nScale < Nsrc)||(frq==NULL)) {
-        idxR =  (double)bandsH[i] / F0 ;
-        wghtR = idxR-floor(idxR);
-      } else {
-        if (bandsHi == NULL) { // map the frequency to an fft bin index
-          int ii, iii;
-          bandsHi=(double*)malloc(sizeof(double)*nBands);
-          wghtHi=(double*)malloc(sizeof(double)*nBands);
-          for (iii=0; iii<nBands; iii++) {
-            for (ii=0; ii<nScale; ii++) {
-              if (frq[ii] >= (FLOAT_DMEM)bandsH[iii]) break;
-            }
-            if ((ii<nScale)&&(ii>0)) {
-              wghtHi[iii] = ((double)bandsH[iii]-frq[ii-1])/(frq[ii] - frq[ii-1]);
-            } else { wghtHi[iii] = 1.0; }
-            //if (wghtHi[iii] == 0.0) { wghtHi[iii] = 1.0; }
-            if ((ii<nScale)&&(frq[ii] == (FLOAT_DMEM)bandsH[iii])) {
-              bandsHi[iii] = (double)ii;
-            } else {
-              bandsHi[iii] = (double)ii-1.0;
-            }
-            if (bandsHi[iii] >= Nsrc) bandsHi[iii] = Nsrc-1;
+      long iL = tb->bandIL[i];
+      long iR = tb->bandIR[i];
+      double sum = (double)srcP[iL] * tb->bandWL[i];
+      if (iR - 1 > iL) {
+        if (haveCumP && iL + 1 >= lo && iR - 1 <= hi) {
+          sum += cumP[iR - lo] - cumP[iL + 1 - lo];
+        } else {
+          for (j = iL + 1; j < iR; j++) {
+            sum += (double)srcP[j];
           }
         }
-        idxR = bandsHi[i];
-        wghtR = wghtHi[i];
       }
-      // TODO: interpolation instead of rounding boundaries to next lower bin and next higher bin
-      // TODO: spectral band filter shapes...
-      // TODO: debug output of actual filter bandwidth & range based on rounded (or interpolated) boundaries!
+      sum += (double)srcP[iR] * tb->bandWR[i];
 
-      if (wghtR == 0.0) wghtR = 1.0;
-  
-      long iL = (long)floor(idxL);
-      long iR = (long)floor(idxR);
-
-      if (iL >= Nsrc) { iL=iR=Nsrc-1; wghtR=0.0; wghtL=0.0; }
-      if (iR >= Nsrc) { iR=Nsrc-1; wghtR = 1.0; } 
-      if (iL < 0) iL=0;
-      if (iR < 0) iR=0;
-      double sum=(double)srcP[iL]*wghtL;
-      for (j = iL + 1; j < iR; j++) {
-        sum += (double)srcP[j];
-      }
-      sum += (double)srcP[iR]*wghtR;
-      
       if (normBandEnergies) {
         // normalise band energy to frame energy
         if (frameSum > 0.0) {  // energy ratio .. never in dB
@@ -868,121 +1091,40 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
       }
     }
   }
-  
+
   // compute spectral slopes in bands
   for (i=0; i<nSlopes; i++) {
     if (isBandValid(slopesL[i], slopesH[i])) {
-      double idxL = 0.0;
-      double wghtL = 0.0;
-      if ((nScale < Nsrc) || (frq == NULL)) {
-        idxL =  (double)slopesL[i] / F0 ;
-        wghtL =  ceil(idxL) - idxL;
-      } else {
-        if (slopeBandsLi == NULL) { // map the frequency to an fft bin index
-          int ii, iii;
-          slopeBandsLi = (double*)malloc(sizeof(double)*nSlopes);
-          slopeWghtLi = (double*)malloc(sizeof(double)*nSlopes);
-          for (iii=0; iii<nSlopes; iii++) {
-            for (ii=0; ii<nScale; ii++) {
-              if (frq[ii] > (double)slopesL[iii]) break;
-            }
-            if ((ii<nScale)&&(ii>0)) {
-              slopeWghtLi[iii] = (frq[ii]-(double)slopesL[iii])/(frq[ii] - frq[ii-1]);
-            } else { slopeWghtLi[iii] = 1.0; }
-            slopeBandsLi[iii] = (double)ii-1.0;
-            if (slopeBandsLi[iii] < 0) slopeBandsLi[iii] = 0;
-            if (slopeBandsLi[iii] >= Nsrc) slopeBandsLi[iii] = Nsrc;
-          }
-        }
-        idxL = slopeBandsLi[i];
-        wghtL = slopeWghtLi[i];
-      }
-      if (wghtL == 0.0) wghtL = 1.0;
-      double idxR = 0.0;
-      double wghtR = 0.0;
-      if ((nScale < Nsrc) || (frq == NULL)) {
-        idxR =  (double)slopesH[i] / F0 ;
-        wghtR = idxR - floor(idxR);
-      } else {
-        if (slopeBandsHi == NULL) { // map the frequency to an fft bin index
-          int ii, iii;
-          slopeBandsHi = (double*)malloc(sizeof(double)*nSlopes);
-          slopeWghtHi = (double*)malloc(sizeof(double)*nSlopes);
-          for (iii = 0; iii < nSlopes; iii++) {
-            for (ii = 0; ii < nScale; ii++) {
-              if (frq[ii] >= (FLOAT_DMEM)slopesH[iii]) break;
-            }
-            if ((ii<nScale)&&(ii>0)) {
-              slopeWghtHi[iii] = ((double)slopesH[iii]-frq[ii-1])/(frq[ii] - frq[ii-1]);
-            } else { slopeWghtHi[iii] = 1.0; }
-            if ((ii<nScale)&&(frq[ii] == (FLOAT_DMEM)slopesH[iii])) {
-              slopeBandsHi[iii] = (double)ii;
-            } else {
-              slopeBandsHi[iii] = (double)ii - 1.0;
-            }
-            if (slopeBandsHi[iii] >= Nsrc) slopeBandsHi[iii] = Nsrc - 1;
-          }
-        }
-        idxR = slopeBandsHi[i];
-        wghtR = slopeWghtHi[i];
-      }
-      if (wghtR == 0.0) wghtR = 1.0;
-      // TODO: interpolation instead of rounding boundaries to next lower bin and next higher bin
-      // TODO: spectral band filter shapes...
-      // TODO: debug output of actual filter bandwidth & range based on rounded (or interpolated) boundaries!
-  
-      long iL = (long)floor(idxL);
-      long iR = (long)floor(idxR);
-      if (iL >= Nsrc) { iL=iR=Nsrc-1; wghtR=0.0; wghtL=0.0; }
-      if (iR >= Nsrc) { iR=Nsrc-1; wghtR = 1.0; } 
-      if (iL < 0) iL=0;
-      if (iR < 0) iR=0;
-
-      // actual spectral slope computation
-      double Sf = 0.0;
-      double S2f = 0.0;
-      double sumA = 0.0;
-      double sumB = 0.0;
-      double Nind = idxR - idxL;
+      long iL = tb->slopeIL[i];
+      long iR = tb->slopeIR[i];
+      double wghtL = tb->slopeWL[i];
+      double wghtR = tb->slopeWR[i];
+      double sumA, sumB;
+      long ii = iL + 1;
       if ((nScale >= Nsrc && nScale > 0) && (frq != NULL)) {
-        Sf  = (double)frq[iL] * wghtL;
-        S2f = Sf * Sf;
         sumA = (double)frq[iL] * wghtL * (double)srcLP[iL];
         sumB = wghtL * srcLP[iL];
-        int ii = iL + 1;
         for ( ; ii < iR && ii < nScale; ii++) {
-          S2f += (double)frq[ii] * (double)frq[ii] ;
-          Sf += (double)frq[ii];   //NOTE: if this line is commented out: old code for compatibility, dont' check into SVN!!
           sumA += (double)frq[ii] * (double)srcLP[ii];
           sumB += (double)srcLP[ii];
         }
-        S2f += (double)frq[iR] * wghtR * (double)frq[iR] * wghtR;
-        Sf  += (double)frq[iR] * wghtR;
         sumA += (double)frq[iR] * wghtR * (double)srcLP[iR];
         sumB += wghtR * (double)srcLP[iR];
-      } else { 
-        Sf   = (double)iL * wghtL;
-        S2f  = Sf * Sf;
+      } else {
         sumA = (double)iL * wghtL * (double)srcLP[iL];
         sumB = wghtL * (double)srcLP[iL];
-        int ii = iL + 1;
         for ( ; ii < iR && ii < nScale; ii++) {
-          S2f  += (double)ii * (double)ii;
-          Sf   += (double)ii;
           sumA += (double)ii * (double)srcLP[ii];
           sumB += (double)srcLP[ii];
         }
-        S2f += (double)iR * wghtR * (double)iR * wghtR;
-        Sf  += (double)iR * wghtR;
         sumA += (double)iR * wghtR * (double)srcLP[iR];
         sumB += wghtR * (double)srcLP[iR];
-        S2f *= F0 * F0;
-        Sf  *= F0;
         sumA *= F0;
       }
-      double deno = (Nind * S2f - Sf * Sf);
+      double Nind = tb->slopeNind[i];
+      double deno = (Nind * tb->slopeS2f[i] - tb->slopeSf[i] * tb->slopeSf[i]);
       double slope = 0.0;
-      if (deno != 0.0) slope = (Nind * sumA - Sf * sumB) / deno;
+      if (deno != 0.0) slope = (Nind * sumA - tb->slopeSf[i] * sumB) / deno;
       // TODO: more options for slope normalisation!
       if (buggySlopeScale) {
         dst[n++] = (FLOAT_DMEM)(slope*(Nind-1.0));
@@ -996,29 +1138,14 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
   if (alphaRatio) {
     FLOAT_DMEM sum01 = 0.0;
     FLOAT_DMEM sum15 = 0.0;
-    if ((nScale < Nsrc) || (frq == NULL)) {
-      double f = 0.0;
-      for (j = 0; j < Nsrc; j++) {
-        if (f > 5000.0) {
-          break;
-        }
-        if (f < 1000.0) {
-          sum01 += srcP[j];
-        } else {
-          sum15 += srcP[j];
-        }
-        f += F0;
+    for (j = 0; j < Nsrc; j++) {
+      if (tb->ratioFrq[j] > 5000.0) {
+        break;
       }
-    } else {
-      for (j = 0; j < Nsrc; j++) {
-        if (frq[j] > 5000.0) {
-          break;
-        }
-        if (frq[j] < 1000.0) {
-          sum01 += srcP[j];
-        } else {
-          sum15 += srcP[j];
-        }
+      if (tb->ratioFrq[j] < 1000.0) {
+        sum01 += srcP[j];
+      } else {
+        sum15 += srcP[j];
       }
     }
     if (sum01 > 0.0) {
@@ -1040,36 +1167,17 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
   if (hammarbergIndex) {
     FLOAT_DMEM max02 = 0.0;
     FLOAT_DMEM max25 = 0.0;
-    if ((nScale < Nsrc) || (frq == NULL)) {
-      double f = 0.0;
-      for (j = 0; j < Nsrc; j++) {
-        if (f > 5000.0) {
-          break;
-        }
-        if (f < 2000.0) {
-          if (srcP[j] > max02) {
-            max02 = srcP[j];
-          }
-        } else {
-          if (srcP[j] > max25) {
-            max25 = srcP[j];
-          }
-        }
-        f += F0;
+    for (j = 0; j < Nsrc; j++) {
+      if (tb->ratioFrq[j] > 5000.0) {
+        break;
       }
-    } else {
-      for (j = 0; j < Nsrc; j++) {
-        if (frq[j] > 5000.0) {
-          break;
+      if (tb->ratioFrq[j] < 2000.0) {
+        if (srcP[j] > max02) {
+          max02 = srcP[j];
         }
-        if (frq[j] < 2000.0) {
-          if (srcP[j] > max02) {
-            max02 = srcP[j];
-          }
-        } else {
-          if (srcP[j] > max25) {
-            max25 = srcP[j];
-          }
+      } else {
+        if (srcP[j] > max25) {
+          max25 = srcP[j];
         }
       }
     }
@@ -1088,38 +1196,65 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
     }
   }
 
-  // sum of all spectral amplitudes/powers/logs, required for spectral centroid/sharpness and moments
-  double sumB=0.0, sumC=0.0;
-  if (normBandEnergies && !useLogSpectrum) {
-    sumB = frameSum;  // frameSum is the power spectrum sum
-  } else {
-    for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-      sumB += (double)srcLP[j];
+  // sum of all spectral amplitudes/powers/logs (sumB) and of the frequency weighted ones (sumA),
+  // required for spectral centroid/slope, moments, harmonicity and flatness
+  double sumA = 0.0, sumB = 0.0;
+  bool needSumA = (centroid || standardDeviation || variance || skewness || kurtosis || slope);
+  if ((needSumA || harmonicity || flatness) && nBins > 0) {
+    if (needSumA) {
+      spectralSums(srcLP + lo, tb->centroidFrq, nBins, &sumB, &sumA);
+    } else {
+      double dummy;
+      spectralSums(srcLP + lo, tb->centroidFrq, nBins, &sumB, &dummy);
+    }
+    if (normBandEnergies && !useLogSpectrum) {
+      sumB = frameSum;  // frameSum is the power spectrum sum
     }
   }
 
-  
-  // compute rollOff(s):
-  FLOAT_DMEM *ro = (FLOAT_DMEM *)calloc(1,sizeof(FLOAT_DMEM)*nRollOff);
-  for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-    sumC += (double)srcP[j];
-    for (i=0; i<nRollOff; i++) {
-      if (buggyRollOff == 1 && i > 0) {
+  // compute rollOff(s) from the cumulative power spectrum:
+  if (nRollOff > 0) {
+    if (buggyRollOff) {
+      double sumC = 0.0;
+      FLOAT_DMEM *ro = (FLOAT_DMEM *)calloc(1,sizeof(FLOAT_DMEM)*nRollOff);
+      for (j = lo; j <= hi; j++) {
         sumC += (double)srcP[j];
+        for (i=0; i<nRollOff; i++) {
+          if (i > 0) {
+            sumC += (double)srcP[j];
+          }
+          if ((ro[i] == 0.0) && (sumC >= rollOff[i] * frameSum)) {
+            if ((nScale >= Nsrc) && (frq!=NULL)) {
+              ro[i] = (FLOAT_DMEM)frq[j];   // TODO: norm frequency ??
+            } else {
+              ro[i] = (FLOAT_DMEM)j * (FLOAT_DMEM)F0;   // TODO: norm frequency ??
+            }
+          }
+        }
       }
-      if ((ro[i] == 0.0) && (sumC >= rollOff[i] * frameSum)) {
-        if ((nScale >= Nsrc) && (frq!=NULL)) {
-          ro[i] = (FLOAT_DMEM)frq[j];   // TODO: norm frequency ??
-        } else {
-          ro[i] = (FLOAT_DMEM)j * (FLOAT_DMEM)F0;   // TODO: norm frequency ??
+      for (i=0; i<nRollOff; i++) {
+        dst[n++] = ro[i];
+      }
+      free(ro);
+    } else {
+      for (i=0; i<nRollOff; i++) {
+        // first bin (with non-zero frequency) where the cumulative energy reaches the roll-off point
+        FLOAT_DMEM ro = 0.0;
+        double thresh = rollOff[i] * frameSum;
+        for (j = lo; j <= hi; j++) {
+          if (cumP[j - lo + 1] >= thresh) {
+            if ((nScale >= Nsrc) && (frq!=NULL)) {
+              ro = (FLOAT_DMEM)frq[j];   // TODO: norm frequency ??
+            } else {
+              ro = (FLOAT_DMEM)j * (FLOAT_DMEM)F0;   // TODO: norm frequency ??
+            }
+            if (ro != 0.0) break;
+          }
         }
+        dst[n++] = ro;
       }
     }
   }
-  for (i=0; i<nRollOff; i++) {
-    dst[n++] = ro[i];
-  }
-  free(ro);
 
   // flux  (requireMagSpec!)
   if (specPosDiff || specDiff || flux || fluxCentroid || fluxAtFluxCentroid) {
@@ -1131,22 +1266,16 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
     }
     if (prevSpec[idxi] == NULL) {
       nSrcPrevSpec[idxi] = nBins;
-      prevSpec[idxi] = (FLOAT_DMEM*)malloc(sizeof(FLOAT_DMEM) * nSrcPrevSpec[idxi]);
+      prevSpec[idxi] = (FLOAT_DMEM*)calloc(1, sizeof(FLOAT_DMEM) * (nSrcPrevSpec[idxi] + 3));
       dst[n++] = 0.0;
     } else {
-      double normP=1.0, normC=1.0;
-      FLOAT_DMEM *magP = prevSpec[idxi];
-      double myA = 0.0;
-      double myAf = 0.0;
-      double d = 0.0;
-      double dp = 0.0;
+      const FLOAT_DMEM *magP = prevSpec[idxi];
+      // squared differences of the magnitude spectra (all, positive only, and frequency weighted)
+      double myA = 0.0, dp = 0.0, myAf = 0.0;
+      spectralDiffSums(srcM + lo, magP, tb->fluxFrq, nBins, &myA, &dp, &myAf);
       // simple absolute spectral difference (root of)
       if (specDiff) {
-        for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-          double myd = (srcM[j] - magP[j - specRangeLowerBin]);
-          d += myd*myd;
-        }
-        d /= (double)(specRangeUpperBin - specRangeLowerBin + 1);
+        double d = myA / (double)nBins;
         if (d > 0.0) {
           dst[n++] = (FLOAT_DMEM)sqrt(d);
         } else {
@@ -1155,38 +1284,13 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
       }
       // positive spectral differences only (root of)
       if (specPosDiff) {
-        for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-          double myd = (srcM[j] - magP[j - specRangeLowerBin]);
-          if (myd > 0.0) {
-            dp += myd*myd;
-          }
-        }
-        dp /= (double)(specRangeUpperBin - specRangeLowerBin + 1);
+        dp /= (double)nBins;
         if (dp > 0.0) {
           dst[n++] = (FLOAT_DMEM)sqrt(dp);
         } else {
           dst[n++] = 0.0;
         }
       }
-      if (flux || fluxCentroid) {
-         for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-           double myB = ((double)srcM[j]/normC - (double)magP[j - specRangeLowerBin]/normP);
-           myA += myB*myB;
-         }
-      }
-      if (fluxCentroid) {
-        if ((nScale>specRangeUpperBin)&&(frq!=NULL)) {
-          for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-            double myB = ((double)srcM[j]/normC - (double)magP[j - specRangeLowerBin]/normP);
-            myAf += myB*myB * frq[j];
-          }
-        } else {
-          for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-            double myB = ((double)srcM[j]/normC - (double)magP[j - specRangeLowerBin]/normP);
-            myAf += myB*myB * (double)j * F0;
-          }
-        }
-      }
       if (flux) {
         double flux = 0.0;
         if (nBins > 0) {
@@ -1200,7 +1304,8 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
       }
       if (fluxCentroid || fluxAtFluxCentroid) {
         double fluxCentr = 0.0;
-        if (myA > 0.0) {
+        // NOTE: the flux centroid is 0 if only fluxAtFluxCentroid is enabled (kept for compatibility)
+        if (myA > 0.0 && fluxCentroid) {
           fluxCentr = myAf / myA;
         }
         if (fluxCentroid) {
@@ -1208,38 +1313,29 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
         }
         if (fluxAtFluxCentroid) {
           // TODO: map flux centroid back to bin...
-          int bin = specRangeUpperBin;
-          if ((nScale>specRangeUpperBin)&&(frq!=NULL)) {
-            for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-              if (frq[j] >= fluxCentr) {
-                bin = j;
-                break;
-              }
-            }
-          } else {
-            for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-              if ((double)j * F0 >= fluxCentr) {
-                bin = j;
-                break;
-              }
+          long bin = hi;
+          for (j = lo; j <= hi; j++) {
+            if (tb->fluxFrq[j - lo] >= fluxCentr) {
+              bin = j;
+              break;
             }
           }
           // range around bin...
-          int range = 2;
+          long range = 2;
           double myF = 0.0;
-          int start = bin - range;
-          int end = bin + range;
-          if (start < specRangeLowerBin) {
-            start = specRangeLowerBin;
+          long start = bin - range;
+          long end = bin + range;
+          if (start < lo) {
+            start = lo;
           }
-          if (end > specRangeUpperBin) {
-            end = specRangeUpperBin;
+          if (end > hi) {
+            end = hi;
           }
           for (j = start; j <= end; j++) {
-            double myB = ((double)srcM[j]/normC - (double)magP[j - specRangeLowerBin]/normP);
+            double myB = ((double)srcM[j] - (double)magP[j - lo]);
             myF += myB*myB;
           }
-          if (end- start + 1 > 0) {
+          if (end - start + 1 > 0) {
             myF /= (double)(end - start + 1);
           } else {
             myF = 0.0;
@@ -1248,55 +1344,12 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
         }
       }
     }
-    for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-      prevSpec[idxi][j - specRangeLowerBin] = srcM[j];
-    }
+    memcpy(prevSpec[idxi], srcM + lo, sizeof(FLOAT_DMEM) * nBins);
   }
 
   // centroid
   FLOAT_DMEM ctr=0.0;
-  double sumA = 0.0;
-  double sumLog = 0.0;
-  double minE = 0.0;
-  double f = 0.0;
-  if (centroid||standardDeviation||variance||skewness||kurtosis||slope) { // spectral centroid (mpeg7)
-    if ((nScale >= Nsrc)&&(frq!=NULL)) {
-      minE = (double)srcLP[specRangeLowerBin];
-      for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-        sumA += (double)frq[j] * (double)srcLP[j];
-        if (useLogSpectrum && (double)srcLP[j] < minE) {
-          minE = (double)srcLP[specRangeLowerBin];
-        }
-      }
-      if (useLogSpectrum) {
-        for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-          sumLog += (double)frq[j] * minE;
-        }
-      }
-    } else {
-      if ((nScale>specRangeUpperBin)&&(frq!=NULL)) {
-        minE = (double)srcLP[specRangeLowerBin];
-        for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-          sumA += (double)frq[j] * (double)srcLP[j];
-          if (useLogSpectrum && (double)srcLP[j] < minE) {
-            minE = (double)srcLP[specRangeLowerBin];
-          }
-        }
-        if (useLogSpectrum) {
-          for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-            sumLog += (double)frq[j] * minE;
-          }
-        }
-      } else {
-        for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
-          sumA += f * (double)srcLP[j];
-          f += F0;
-        }
-        if (useLogSpectrum) {
-          sumLog = F0 * minE * (double)nBins;
-        }
-      }
-    }
+  if (needSumA) { // spectral centroid (mpeg7)
     // TODO: in sumB computation the left and right boundary weights are considered for first and last bin
     //       in sumA computation these are not considered! Need to fix?
     if (sumB != 0.0) {
@@ -1312,11 +1365,11 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
   }
   
   if ((maxPos)||(minPos)) {
-    long maP=specRangeLowerBin;
-    long miP=specRangeLowerBin;
-    FLOAT_DMEM max=srcLP[specRangeLowerBin];
-    FLOAT_DMEM min=srcLP[specRangeLowerBin];
-    for (j = specRangeLowerBin + 1; j < specRangeUpperBin; j++) {
+    long maP=lo;
+    long miP=lo;
+    FLOAT_DMEM max=srcLP[lo];
+    FLOAT_DMEM min=srcLP[lo];
+    for (j = lo + 1; j < hi; j++) {
       if (srcLP[j] < min) { min = srcLP[j]; miP = j; }
       if (srcLP[j] > max) { max = srcLP[j]; maP = j; }
     }
@@ -1332,35 +1385,14 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
   // spectral entropy
   if (entropy) {
     // TODO: normalise??
-    dst[n++] = smileStat_entropy(srcLP + specRangeLowerBin, specRangeUpperBin - specRangeLowerBin + 1);
+    dst[n++] = smileStat_entropy(srcLP + lo, nBins);
   }
 
-  // compute various spectral moments
-  double u = ctr; // use centroid as mean value
-  double m2 = 0.0;
-  double m3 = 0.0;
-  double m4 = 0.0;
-
+  // compute various spectral moments (around the centroid as mean value)
   if (standardDeviation||variance||skewness||kurtosis) {
-    if ((nScale>=Nsrc)&&(frq!=NULL)) {
-      for (i = specRangeLowerBin; i <= specRangeUpperBin; i++) {
-        double t1 = ((double)frq[i]-u);
-        double m = t1*t1 * (double)srcLP[i];
-        m2 += m;
-        m *= t1;
-        m3 += m;
-        m4 += m*t1;
-      }
-    } else {
-      for (i = specRangeLowerBin; i <= specRangeUpperBin; i++) {
-        double fi = (double)i*F0;
-        double t1 = (fi-u);
-        double m = t1*t1 * (double)srcLP[i];
-        m2 += m;
-        m *= t1;
-        m3 += m;
-        m4 += m*t1;
-      }
+    double m2 = 0.0, m3 = 0.0, m4 = 0.0;
+    if (nBins > 0) {
+      spectralMoments(srcLP + lo, tb->momentFrq, (double)ctr, nBins, &m2, &m3, &m4);
     }
 
     double sigma2=0.0;
@@ -1396,29 +1428,12 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
     }
   }
 
-  // spectral slope
+  // spectral slope (frequency sums precomputed)
   if (slope) {
-    double Sf = 0.0;
-    double S2f = 0.0;
     double Nind = (double)nBins;
-    if ((nScale >= Nsrc && nScale > 0)&&(frq!=NULL)) {
-      for (i = specRangeLowerBin; i <= specRangeUpperBin && i < nScale; i++) {
-        S2f += (double)frq[i] * (double)frq[i] ;
-        Sf += (double)frq[i];   //NOTE: if this line is commented out: old code for compatibility, don't check into SVN!!
-      }
-    } else {
-      double NNm1;
-      double S1;
-      double S2;
-      NNm1 = Nind * (Nind - 1.0);
-      S1 = NNm1/(double)2.0;  // sum of all i=0..N-1
-      S2 = NNm1*((double)2.0*Nind-(double)1.0)/(double)6.0; // sum of all i^2 for i=0..N-1
-      Sf = S1 * F0;
-      S2f = S2 * F0*F0;
-    }
-    double deno = (Nind*S2f-Sf*Sf);
+    double deno = (Nind*tb->slopeS2fAll-tb->slopeSfAll*tb->slopeSfAll);
     double slope = 0.0;
-    if (deno != 0.0) slope = (Nind*sumA-Sf*sumB)/deno;
+    if (deno != 0.0) slope = (Nind*sumA-tb->slopeSfAll*sumB)/deno;
     if (buggySlopeScale) {
       dst[n++] = (FLOAT_DMEM)(slope*(Nind-1.0));
     } else {
@@ -1460,6 +1475,12 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
         if (sharpnessWeights == NULL) {
           // compute weights and cache them
           sharpnessWeights = (double*)malloc(sizeof(double)*(specRangeUpperBin - specRangeLowerBin + 1));
+          // NOTE: the frequency continues from the end of the centroid frequency axis, if the centroid
+          // was computed (kept for compatibility with the previous implementation)
+          double f = 0.0;
+          if (needSumA && !((nScale > specRangeUpperBin) && (frq != NULL)) && nBins > 0) {
+            f = tb->centroidFrq[nBins - 1] + F0;
+          }
           for (j = specRangeLowerBin; j <= specRangeUpperBin; j++) {
             double fb = smileDsp_specScaleTransfFwd(f,SPECTSCALE_BARK,0.0);
             sharpnessWeights[j - specRangeLowerBin] = fb * smileDsp_getSharpnessWeightG(fb, SPECTSCALE_BARK, 0.0);
@@ -1542,15 +1563,6 @@ int cSpectral::processVector(const FLOAT_DMEM *src, FLOAT_DMEM *dst, long Nsrc,
      }
    }
 
-   if (srcP != NULL && srcP != src) {
-     free((FLOAT_DMEM*)srcP);
-   }
-   if (srcM != NULL && srcM != src) {
-     free((FLOAT_DMEM*)srcM);
-   }
-   if (srcL != NULL && srcL != src) {
-     free((FLOAT_DMEM*)srcL);
-   }
    return 1;
 }
 
@@ -1561,14 +1573,16 @@ cSpectral::~cSpectral()
   if (bandsH!=NULL) free(bandsH);
   if (slopesL!=NULL) free(slopesL);
   if (slopesH!=NULL) free(slopesH);
-  if (bandsLi!=NULL) free(bandsLi);
-  if (bandsHi!=NULL) free(bandsHi);
-  if (wghtLi!=NULL) free(wghtLi);
-  if (wghtHi!=NULL) free(wghtHi);
-  if (slopeBandsLi!=NULL) free(slopeBandsLi);
-  if (slopeBandsHi!=NULL) free(slopeBandsHi);
-  if (slopeWghtLi!=NULL) free(slopeWghtLi);
-  if (slopeWghtHi!=NULL) free(slopeWghtHi);
+  if (fieldTables != NULL) {
+    for (int i = 0; i < nFieldsPrevSpec; i++) {
+      if (fieldTables[i] != NULL) freeSpectralTables(fieldTables[i]);
+    }
+    free(fieldTables);
+  }
+  if (specM!=NULL) free(specM);
+  if (specP!=NULL) free(specP);
+  if (specL!=NULL) free(specL);
+  if (cumP!=NULL) free(cumP);
   if (rollOff!=NULL) free(rollOff);
   if (prevSpec != NULL) {
     for (int i = 0; i < nFieldsPrevSpec; i++) {
@@ -190,6 +190,8 @@ int cPortaudioDuplex::myConfigureInstance()
 int cPortaudioDuplex::setupNewNames(long nEl)
 {
   writer_->addField("pcm",channels);
+  // the data is written by the portaudio callback
+  writer_->setAsyncWriter();
   namesAreSet_ = 1;
   return 1;
 }
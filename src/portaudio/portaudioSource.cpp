@@ -206,6 +206,8 @@ int cPortaudioSource::setupNewNames(long nEl)
   } else {
     writer_->addField("pcm", channels);
   }
+  // the data is written by the portaudio callback
+  writer_->setAsyncWriter();
   namesAreSet_ = 1;
   return 1;
 }
@@ -25,6 +25,11 @@ Smile Util:
 #include <smileutil/smileUtil.h>
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SMILEUTIL_SSE2
+#endif
+
 //#include <smileTypes.hpp>
 
 
@@ -161,6 +166,61 @@ void smileUtil_reverseOrder_FLOATDMEM(FLOAT_DMEM *arr, long nEl)
   }
 }
 
+/* LSD radix sort for a FLOAT_DMEM (float) array with nEl elements, 3 passes of 11 bits on the
+   IEEE bit patterns mapped to unsigned integers of the same order.
+   workspace must hold nEl elements, if it is NULL it is allocated temporarily. */
+void smileUtil_radixSort_FLOATDMEM(FLOAT_DMEM *arr, long nEl, FLOAT_DMEM *workspace)
+{
+  long cnt[3][2048];
+  long i; int p, j;
+  uint32_t *k = (uint32_t *)arr;
+  uint32_t *t;
+  FLOAT_DMEM *ws = workspace;
+
+  if (sizeof(FLOAT_DMEM) != sizeof(uint32_t)) {
+    smileUtil_quickSort_FLOATDMEM(arr, nEl);
+    return;
+  }
+  if (nEl <= 1) return;
+  if (ws == NULL) {
+    ws = (FLOAT_DMEM *)malloc(sizeof(FLOAT_DMEM) * nEl);
+    if (ws == NULL) {
+      smileUtil_quickSort_FLOATDMEM(arr, nEl);
+      return;
+    }
+  }
+  t = (uint32_t *)ws;
+
+  memset(cnt, 0, sizeof(cnt));
+  for (i = 0; i < nEl; i++) {
+    // negative values: invert all bits, positive values: set the sign bit
+    uint32_t u;
+    memcpy(&u, arr + i, sizeof(u));
+    u = (u & 0x80000000u) ? ~u : (u | 0x80000000u);
+    k[i] = u;
+    cnt[0][u & 2047]++;
+    cnt[1][(u >> 11) & 2047]++;
+    cnt[2][u >> 22]++;
+  }
+  for (p = 0; p < 3; p++) {
+    long sum = 0;
+    for (j = 0; j < 2048; j++) {
+      long c = cnt[p][j];
+      cnt[p][j] = sum;
+      sum += c;
+    }
+  }
+  for (i = 0; i < nEl; i++) { uint32_t u = k[i]; t[cnt[0][u & 2047]++] = u; }
+  for (i = 0; i < nEl; i++) { uint32_t u = t[i]; k[cnt[1][(u >> 11) & 2047]++] = u; }
+  for (i = 0; i < nEl; i++) { uint32_t u = k[i]; t[cnt[2][u >> 22]++] = u; }
+  for (i = 0; i < nEl; i++) {
+    uint32_t u = t[i];
+    u = (u & 0x80000000u) ? (u & 0x7fffffffu) : ~u;
+    memcpy(arr + i, &u, sizeof(u));
+  }
+  if (workspace == NULL) free(ws);
+}
+
 
 /*******************************************************************************************
  ***********************=====   Filter functions   ===== **************************************
@@ -738,6 +798,31 @@ long smileMath_floorToNextPowOf2(long x)
   return y;
 }
 
+double smileMath_dotProduct(const FLOAT_DMEM * x, const FLOAT_DMEM * y, long N)
+{
+  long i = 0;
+  double sum = 0.0;
+#ifdef SMILEUTIL_SSE2
+  // 4 products at a time, converted to double before multiplying
+  __m128d s0 = _mm_setzero_pd();
+  __m128d s1 = _mm_setzero_pd();
+  for (; i + 4 <= N; i += 4) {
+    __m128 a = _mm_loadu_ps(x + i);
+    __m128 b = _mm_loadu_ps(y + i);
+    s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_cvtps_pd(a), _mm_cvtps_pd(b)));
+    s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(a, a)), _mm_cvtps_pd(_mm_movehl_ps(b, b))));
+  }
+  s0 = _mm_add_pd(s0, s1);
+  double tmp[2];
+  _mm_storeu_pd(tmp, s0);
+  sum = tmp[0] + tmp[1];
+#endif
+  for (; i < N; i++) {
+    sum += (double)x[i] * (double)y[i];
+  }
+  return sum;
+}
+
 FLOAT_DMEM smileMath_crossCorrelation(const FLOAT_DMEM * x, long Nx, const FLOAT_DMEM * y, long Ny)
 {
   long N = MIN(Nx,Ny);
@@ -762,6 +847,17 @@ FLOAT_DMEM smileMath_crossCorrelation(const FLOAT_DMEM * x, long Nx, const FLOAT
   return cc;
 }
 
+double smileMath_crossCorrelationFromSums(double xy, double sx, double sy, double xx, double yy, long N)
+{
+  // centred sums: sum (x-mx)*(y-my) = sum x*y - sum x * sum y / N
+  double cc = xy - sx * sy / (double)N;
+  double nx = xx - sx * sx / (double)N;
+  double ny = yy - sy * sy / (double)N;
+  if (nx < 0.0) nx = 0.0;
+  if (ny < 0.0) ny = 0.0;
+  return cc / (sqrt(nx) * sqrt(ny));
+}
+
 /***** vector math *******/
 
 FLOAT_DMEM smileMath_cosineDistance(FLOAT_DMEM * a, FLOAT_DMEM * b, int N)